@@ -30,13 +30,22 @@
 #define VIMBAX_CAMERA__VIMBAX_CAMERA_HPP_
 
 #include <string>
+#include <string_view>
 #include <memory>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <functional>
+#include <future>
 #include <optional>
 #include <vector>
 #include <queue>
 #include <utility>
 #include <unordered_map>
+#include <unordered_set>
+#include <variant>
 
 #include <rclcpp/logger.hpp>
 #include <sensor_msgs/image_encodings.hpp>
@@ -45,6 +54,9 @@
 #include <vimbax_camera/result.hpp>
 #include <vimbax_camera/loader/vmbc_api.hpp>
 #include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_correction.hpp>
+#include <vimbax_camera/vimbax_camera_index.hpp>
+#include <vimbax_camera/vimbax_camera_event_queue.hpp>
 
 
 namespace vimbax_camera
@@ -52,13 +64,35 @@ namespace vimbax_camera
 class VimbaXCamera : public std::enable_shared_from_this<VimbaXCamera>
 {
 public:
+  // Buffers of destroyed frames, reused for new frames to avoid allocating and faulting in the
+  // image memory again on every stream start
+  class FrameBufferPool
+  {
+    /* *INDENT-OFF* */
+  public:
+    /* *INDENT-ON* */
+    // Returns an empty buffer if none with at least the given capacity is available
+    std::vector<uint8_t> take(size_t capacity);
+    void put(std::vector<uint8_t> && buffer);
+    void clear();
+    // A pool not retaining buffers is cleared and drops the buffers put into it
+    void set_retaining(bool retaining);
+    /* *INDENT-OFF* */
+  private:
+    /* *INDENT-ON* */
+    std::mutex mutex_{};
+    std::vector<std::vector<uint8_t>> buffers_{};
+    bool retaining_{true};
+  };
+
   class Frame : public sensor_msgs::msg::Image, public std::enable_shared_from_this<Frame>
   {
     /* *INDENT-OFF* */
   public:
     /* *INDENT-ON* */
     static result<std::shared_ptr<Frame>> create(
-      std::shared_ptr<VimbaXCamera> camera, size_t size, size_t alignment = 1);
+      std::shared_ptr<VimbaXCamera> camera, size_t size, size_t alignment = 1,
+      uint32_t stream_index = 0);
 
     ~Frame();
 
@@ -71,10 +105,16 @@ public:
 
     std::string get_image_encoding() const;
 
+    // Significant bits per channel, the data of 10 to 14 bit formats is shifted to the most
+    // significant bits of 16 bit values
+    uint32_t get_bit_depth() const;
+
     int64_t get_frame_id() const;
 
     uint64_t get_timestamp_ns() const;
 
+    uint32_t get_stream_index() const;
+
     void on_frame_ready();
     /* *INDENT-OFF* */
   private:
@@ -90,13 +130,18 @@ public:
     void transform();
     uint64_t timestamp_to_ns(uint64_t timestamp) const;
 
-    Frame(std::shared_ptr<VimbaXCamera> camera, AllocationMode allocation_mode);
+    Frame(
+      std::shared_ptr<VimbaXCamera> camera, AllocationMode allocation_mode, uint32_t stream_index);
+
+    void allocate(size_t size);
 
     std::function<void(std::shared_ptr<Frame>)> callback_;
     std::weak_ptr<VimbaXCamera> camera_;
+    std::shared_ptr<FrameBufferPool> buffer_pool_;
     VmbFrame vmb_frame_;
 
     AllocationMode allocation_mode_;
+    uint32_t stream_index_;
   };
 
 
@@ -148,9 +193,96 @@ public:
     std::vector<TriggerInfo> trigger_info;
   };
 
+  // Feature resolved once by feature_handle_get. Accessing a feature by its handle skips the
+  // name lookup. A handle stays valid as long as the camera it was resolved by.
+  struct FeatureHandle
+  {
+    Module module;
+    VmbHandle_t module_handle;
+    // Interned copy of the feature name, always null terminated
+    const char * name;
+    const VmbFeatureInfo * info;
+    // Owns the name of features missing in the feature map
+    std::shared_ptr<const std::string> owned_name;
+  };
+
+  // Feature maps of all modules. They only depend on the device and its firmware, so they
+  // are shared with the camera reopened after a disconnect instead of listing all features
+  // again. The strings of the feature infos are interned, so they stay valid after the camera
+  // they were listed from is closed.
+  struct FeatureMetadata
+  {
+    std::string device_id;
+    std::string firmware_version;
+    std::array<std::deque<std::string>, std::size_t(Module::ModuleMax)> interned_strings;
+    std::array<std::unordered_map<std::string_view, VmbFeatureInfo>,
+      std::size_t(Module::ModuleMax)> info_map;
+    std::array<std::unordered_multimap<std::string, std::string>,
+      std::size_t(Module::ModuleMax)> category_map;
+    // Feature names in the order they were listed by VmbC, which follows the GenICam XML
+    std::array<std::vector<std::string_view>, std::size_t(Module::ModuleMax)> feature_order;
+    // Set if listing the features of a module failed, such metadata is never reused
+    std::atomic<bool> incomplete{false};
+  };
+
+  // Values of the persistable features in the order they have to be written. Selected
+  // features follow their selector, so they are written with the selector value they were
+  // read with.
+  struct FeatureSnapshot
+  {
+    using Value = std::variant<int64_t, _Float64, bool, std::string>;
+
+    struct Entry
+    {
+      Module module;
+      std::string name;
+      VmbFeatureData_t type;
+      Value value;
+      // Entry of the selector the value was read with
+      std::optional<uint32_t> selector_index;
+    };
+
+    std::string model_name;
+    std::vector<Entry> entries;
+
+    std::vector<uint8_t> serialize() const;
+    static result<FeatureSnapshot> deserialize(const std::vector<uint8_t> & data);
+
+    result<void> save(const std::string_view & file_name) const;
+    static result<FeatureSnapshot> load(const std::string_view & file_name);
+  };
+
+  struct FeatureSnapshotApplyResult
+  {
+    uint32_t written{0};
+    uint32_t unchanged{0};
+    // Indices of the written and failed snapshot entries
+    std::vector<uint32_t> written_entries{};
+    std::vector<uint32_t> failed_entries{};
+  };
+
+  // Snapshot validated against the camera once, switching to it skips all name lookups.
+  // Like feature handles it is only valid for the camera it was compiled by.
+  struct FeatureProfile
+  {
+    std::string name;
+    FeatureSnapshot snapshot;
+    std::vector<FeatureHandle> features;
+  };
+
+  // Resources of a camera that can be handed to the camera opened after it was disconnected
+  struct ReopenResources
+  {
+    std::shared_ptr<const FeatureMetadata> feature_metadata;
+    std::shared_ptr<FrameBufferPool> frame_buffer_pool;
+  };
+
+  // Cameras found in the index are opened without enumerating all cameras
   static std::shared_ptr<VimbaXCamera> open(
     std::shared_ptr<VmbCAPI> api,
-    const std::string & name = {});
+    const std::string & name = {},
+    std::shared_ptr<const VimbaXCameraIndex> index = nullptr,
+    const ReopenResources & reopen_resources = {});
 
   ~VimbaXCamera();
 
@@ -160,13 +292,24 @@ public:
   result<void> start_streaming(
     int buffer_count,
     std::function<void(std::shared_ptr<Frame>)> on_frame,
-    bool start_acquisition = true);
+    bool start_acquisition = true,
+    uint32_t stream_count = 1);
   result<void> stop_streaming();
 
+  uint32_t get_stream_count() const;
+
+  result<uint32_t> get_payload_size(uint32_t stream_index = 0) const;
+
   bool is_alive() const;
+
+  ReopenResources get_reopen_resources() const;
   bool has_feature(const std::string_view & name, const Module module = Module::RemoteDevice) const;
 
   // Feature access
+  result<FeatureHandle> feature_handle_get(
+    const std::string_view & name,
+    const Module module = Module::RemoteDevice) const;
+
   result<std::vector<std::string>> features_list_get(
     const Module module = Module::RemoteDevice) const;
 
@@ -177,55 +320,81 @@ public:
     const std::string_view & name,
     const std::optional<std::chrono::milliseconds> & timeout = std::nullopt,
     const Module module = Module::RemoteDevice) const;
+  std::future<result<void>> feature_command_run_async(
+    const std::string_view & name,
+    const std::optional<std::chrono::milliseconds> & timeout = std::nullopt,
+    const Module module = Module::RemoteDevice) const;
 
   result<int64_t> feature_int_get(
     const std::string_view & name,
-    const Module module = Module::RemoteDevice) const;
+    const Module module = Module::RemoteDevice,
+    const bool bypass_cache = false) const;
   result<void> feature_int_set(
     const std::string_view & name,
     const int64_t value,
     const Module module = Module::RemoteDevice) const;
+  result<int64_t> feature_int_get(
+    const FeatureHandle & feature, const bool bypass_cache = false) const;
+  result<void> feature_int_set(const FeatureHandle & feature, const int64_t value) const;
   result<std::array<int64_t, 3>> feature_int_info_get(
     const std::string_view & name,
     const Module module = Module::RemoteDevice) const;
 
   result<_Float64> feature_float_get(
     const std::string_view & name,
-    const Module module = Module::RemoteDevice) const;
+    const Module module = Module::RemoteDevice,
+    const bool bypass_cache = false) const;
   result<void> feature_float_set(
     const std::string_view & name,
     const _Float64 value,
     const Module module = Module::RemoteDevice) const;
+  result<_Float64> feature_float_get(
+    const FeatureHandle & feature, const bool bypass_cache = false) const;
+  result<void> feature_float_set(const FeatureHandle & feature, const _Float64 value) const;
   result<feature_float_info> feature_float_info_get(
     const std::string_view & name,
     const Module module = Module::RemoteDevice) const;
 
   result<std::string> feature_string_get(
     const std::string_view & name,
-    const Module module = Module::RemoteDevice) const;
+    const Module module = Module::RemoteDevice,
+    const bool bypass_cache = false) const;
   result<void> feature_string_set(
     const std::string_view & name,
     const std::string_view value,
     const Module module = Module::RemoteDevice) const;
+  result<std::string> feature_string_get(
+    const FeatureHandle & feature, const bool bypass_cache = false) const;
+  result<void> feature_string_set(
+    const FeatureHandle & feature, const std::string_view value) const;
   result<uint32_t> feature_string_info_get(
     const std::string_view & name,
     const Module module = Module::RemoteDevice) const;
 
   result<bool> feature_bool_get(
     const std::string_view & name,
-    const Module module = Module::RemoteDevice) const;
+    const Module module = Module::RemoteDevice,
+    const bool bypass_cache = false) const;
   result<void> feature_bool_set(
     const std::string_view & name,
     const bool value,
     const Module module = Module::RemoteDevice) const;
+  result<bool> feature_bool_get(
+    const FeatureHandle & feature, const bool bypass_cache = false) const;
+  result<void> feature_bool_set(const FeatureHandle & feature, const bool value) const;
 
   result<std::string> feature_enum_get(
     const std::string_view & name,
-    const Module module = Module::RemoteDevice) const;
+    const Module module = Module::RemoteDevice,
+    const bool bypass_cache = false) const;
   result<void> feature_enum_set(
     const std::string_view & name,
     const std::string_view & value,
     const Module module = Module::RemoteDevice) const;
+  result<std::string> feature_enum_get(
+    const FeatureHandle & feature, const bool bypass_cache = false) const;
+  result<void> feature_enum_set(
+    const FeatureHandle & feature, const std::string_view & value) const;
   result<std::array<std::vector<std::string>, 2>> feature_enum_info_get(
     const std::string_view & name,
     const Module module = Module::RemoteDevice) const;
@@ -270,68 +439,247 @@ public:
 
   result<void> settings_save(const std::string_view & file_name);
 
+  // Binary alternative to the xml settings. Applying a snapshot only writes the features whose
+  // value differs from the current one.
+  result<FeatureSnapshot> feature_snapshot_create() const;
+  result<FeatureSnapshotApplyResult> feature_snapshot_apply(const FeatureSnapshot & snapshot) const;
+
+  result<FeatureProfile> feature_profile_compile(
+    const std::string & name, FeatureSnapshot snapshot) const;
+  // Indices of the profile entries whose value differs from the current one
+  result<std::vector<uint32_t>> feature_profile_changes_get(const FeatureProfile & profile) const;
+  // Either all changed features are written or the written ones are restored
+  result<FeatureSnapshotApplyResult> feature_profile_apply(const FeatureProfile & profile) const;
+
   result<Info> camera_info_get() const;
 
   bool is_streaming() const;
 
-  result<void> feature_invalidation_register(
+  // Converts a device timestamp (e.g. of an event) to nanoseconds like the frame timestamps
+  uint64_t device_timestamp_to_ns(uint64_t timestamp) const;
+
+  // Current device time in timestamp ticks, latched with TimestampLatch or the GigE Vision
+  // GevTimestampControlLatch
+  result<uint64_t> device_timestamp_latch() const;
+
+  using InvalidationListenerId = uint64_t;
+
+  // Invalidations are queued by the VmbC notification thread and the callbacks are run by the
+  // event worker thread of the camera, so a slow callback doesn't delay other notifications.
+  // Any number of callbacks can be registered for the same feature.
+  result<InvalidationListenerId> feature_invalidation_register(
     const std::string_view & name,
     std::function<void(const std::string &)> callback);
 
-  result<void> feature_invalidation_unregister(const std::string_view & name);
+  result<void> feature_invalidation_unregister(
+    const std::string_view & name, InvalidationListenerId id);
+
+  // Invalidations dropped because the event queue was full
+  uint64_t get_invalidations_dropped() const;
 
   using EventMetaDataList = std::vector<std::pair<std::string, std::string>>;
 
   result<EventMetaDataList> get_event_meta_data(const std::string_view & name);
 
+  // Data features of an event resolved once when the event is subscribed, so reading the
+  // data of each event occurrence doesn't need any category or name lookup
+  struct EventMetaDataLayout
+  {
+    std::string event_name;
+    std::vector<FeatureHandle> features;
+    // Indices of the Event<Name>FrameID and Event<Name>Timestamp features if present
+    std::optional<std::size_t> frame_id_index;
+    std::optional<std::size_t> timestamp_index;
+  };
+
+  struct EventMetaData
+  {
+    uint64_t frame_id;
+    uint64_t timestamp;
+    // Values in the order of EventMetaDataLayout::features
+    std::vector<FeatureSnapshot::Value> values;
+    // False for values that failed to read, they are omitted from the published event data
+    std::vector<bool> valid;
+  };
+
+  result<EventMetaDataLayout> event_meta_data_layout_get(const std::string_view & name) const;
+  // Reads all data features of the layout. Features failing to read keep the default value
+  // of their type and are marked invalid.
+  result<EventMetaData> event_meta_data_read(const EventMetaDataLayout & layout) const;
+
+  // Values of non volatile features are cached and kept coherent using feature invalidation.
+  // The getters can bypass the cache per call, which reads the value from the camera and
+  // updates the cached one.
+  void set_feature_value_cache_enabled(bool enabled);
+  bool is_feature_value_cache_enabled() const;
+
+  // Applied to the frames of the first stream after the pixel values were shifted to 16 bit,
+  // frames not matching the size and format of the correction are passed unchanged
+  void set_pixel_correction(std::shared_ptr<const PixelCorrection> correction);
+  std::shared_ptr<const PixelCorrection> get_pixel_correction() const;
+
 private:
-  explicit VimbaXCamera(std::shared_ptr<VmbCAPI> api, VmbHandle_t camera_handle);
+  using feature_value = std::variant<int64_t, _Float64, bool, std::string>;
+
+  // State of one stream channel. Each stream has its own buffer pool and frame processing
+  // thread, so a slow consumer on one stream does not stall the others.
+  struct StreamContext
+  {
+    VmbHandle_t handle;
+    VmbHandle_t capture_handle;
+    std::vector<std::shared_ptr<Frame>> frames;
+    std::mutex frame_ready_queue_mutex;
+    std::condition_variable frame_ready_cv;
+    std::queue<std::shared_ptr<Frame>> frame_ready_queue;
+    std::shared_ptr<std::thread> frame_processing_thread;
+    std::atomic_bool frame_processing_enable{false};
+  };
+
+  VimbaXCamera(
+    std::shared_ptr<VmbCAPI> api, VmbHandle_t camera_handle,
+    const ReopenResources & reopen_resources);
+
+  bool reuse_feature_metadata(const std::shared_ptr<const FeatureMetadata> & feature_metadata);
+  void adjust_packet_size();
+
+  result<void> start_stream_capture(
+    StreamContext & stream,
+    uint32_t stream_index,
+    int buffer_count,
+    std::function<void(std::shared_ptr<Frame>)> on_frame);
+
+  result<void> stop_stream_capture(StreamContext & stream);
+  // Stops the first started_count streams after a failed start and resets the stream state
+  void abort_stream_capture(uint32_t started_count);
+
+  void stop_frame_processing(StreamContext & stream);
 
   static void on_feature_invalidation(VmbHandle_t, const char * name, void * context);
+  static void on_feature_value_invalidation(
+    VmbHandle_t handle, const char * name, void * context);
+
+  FeatureHandle feature_handle_resolve(const std::string_view & name, VmbHandle_t handle) const;
+
+  template<typename T>
+  result<T> feature_value_cache_get(
+    const FeatureHandle & feature,
+    std::function<result<T>()> read_value,
+    bool bypass_cache) const;
+  void feature_value_cache_invalidate(const FeatureHandle & feature) const;
+  void feature_value_cache_clear() const;
 
   void initialize_feature_map(Module module);
 
+  // The feature maps are built in the background after open, these wait for the map of the
+  // given module or build it on first access
+  const std::unordered_map<std::string_view, VmbFeatureInfo> & feature_info_map(
+    Module module) const;
+  const std::unordered_multimap<std::string, std::string> & feature_category_map(
+    Module module) const;
+
   constexpr VmbHandle_t get_module_handle(Module module) const;
 
   VmbFeatureInfo get_feature_info(
-    const std::string & name,
+    const std::string_view & name,
     Module module = Module::RemoteDevice) const;
 
   result<void> feature_command_run(
     const std::string_view & name, VmbHandle_t handle,
     const std::optional<std::chrono::milliseconds> & timeout = std::nullopt) const;
 
-  result<int64_t> feature_int_get(const std::string_view & name, VmbHandle_t handle) const;
+  result<int64_t> feature_int_get(
+    const std::string_view & name, VmbHandle_t handle, const bool bypass_cache = false) const;
 
-  result<_Float64> feature_float_get(const std::string_view & name, VmbHandle_t handle) const;
+  result<_Float64> feature_float_get(
+    const std::string_view & name, VmbHandle_t handle, const bool bypass_cache = false) const;
 
-  result<std::string> feature_enum_get(const std::string_view & name, VmbHandle_t handle) const;
+  result<std::string> feature_enum_get(
+    const std::string_view & name, VmbHandle_t handle, const bool bypass_cache = false) const;
 
-  result<std::string> feature_string_get(const std::string_view & name, VmbHandle_t handle) const;
+  result<std::string> feature_string_get(
+    const std::string_view & name, VmbHandle_t handle, const bool bypass_cache = false) const;
 
   VmbFeaturePersistSettings get_default_feature_persist_settings() const;
 
+  result<FeatureSnapshot::Entry> feature_snapshot_entry_read(
+    Module module, const VmbFeatureInfo & info) const;
+  result<FeatureSnapshot::Value> feature_snapshot_value_get(
+    const FeatureHandle & feature, VmbFeatureData_t type) const;
+  result<void> feature_snapshot_value_set(
+    const FeatureHandle & feature, VmbFeatureData_t type,
+    const FeatureSnapshot::Value & value) const;
+  bool feature_snapshot_value_matches(
+    const FeatureHandle & feature, VmbFeatureData_t type,
+    const FeatureSnapshot::Value & current_value, const FeatureSnapshot::Value & value) const;
+  result<FeatureSnapshotApplyResult> feature_snapshot_entries_apply(
+    const FeatureSnapshot & snapshot, const std::vector<FeatureHandle> & features,
+    bool atomic) const;
+
   std::shared_ptr<VmbCAPI> api_;
   VmbHandle_t camera_handle_;
-  std::vector<std::shared_ptr<Frame>> frames_;
   std::atomic<StreamState> stream_state_{StreamState::kStopped};
   bool is_valid_pixel_format(VmbPixelFormatType pixel_format);
-  VmbCameraInfo camera_info_;
+  VmbCameraInfo camera_info_{};
   std::optional<uint64_t> timestamp_frequency_;
-  std::unordered_map<std::string, std::function<void(const std::string &)>> invalidation_callbacks_;
 
-  std::mutex invalidation_callbacks_mutex_{};
-
-  std::array<std::unordered_map<std::string, VmbFeatureInfo>,
-    std::size_t(Module::ModuleMax)> feature_info_map_;
-  std::array<std::unordered_multimap<std::string, std::string>,
-    std::size_t(Module::ModuleMax)> feature_category_map_;
+  struct InvalidationListener
+  {
+    InvalidationListenerId id;
+    std::function<void(const std::string &)> callback;
+  };
 
-  mutable std::mutex frame_ready_queue_mutex_;
-  std::condition_variable frame_ready_cv_;
-  std::queue<std::shared_ptr<Frame>> frame_ready_queue_;
-  std::shared_ptr<std::thread> frame_processing_thread_;
-  std::atomic_bool frame_processing_enable_{false};
+  using InvalidationListenerTable =
+    std::unordered_map<std::string, std::vector<InvalidationListener>>;
+
+  void invalidation_worker_start();
+  void invalidation_worker_stop();
+  void invalidation_worker_run();
+  // Frees the replaced listener tables the event worker can't access anymore
+  void invalidation_listeners_reclaim(bool all);
+
+  // The listener table is only read by the event worker. It is replaced as a whole by
+  // (un)registering, so dispatching never takes a lock. Replaced tables are kept until the
+  // worker finished the invalidation it was dispatching when the table was replaced.
+  std::atomic<const InvalidationListenerTable *> invalidation_listeners_{nullptr};
+  std::mutex invalidation_listeners_write_mutex_{};
+  std::vector<std::pair<uint64_t, const InvalidationListenerTable *>>
+  invalidation_listeners_retired_{};
+  InvalidationListenerId invalidation_listener_next_id_{1};
+
+  EventQueue<std::string> invalidation_queue_{1024};
+  std::thread invalidation_worker_{};
+  std::atomic_bool invalidation_worker_stop_{false};
+  std::atomic_bool invalidation_worker_waiting_{false};
+  // Incremented after each dispatched invalidation
+  std::atomic_uint64_t invalidation_worker_dispatched_{0};
+  std::atomic_uint64_t invalidation_dropped_{0};
+  std::mutex invalidation_worker_mutex_{};
+  std::condition_variable invalidation_worker_cv_{};
+
+  mutable std::array<std::once_flag, std::size_t(Module::ModuleMax)> feature_map_once_;
+  std::vector<std::future<void>> feature_map_init_futures_;
+  // Feature names are interned once, so the info maps are keyed by views into the interned
+  // strings and lookups by std::string_view don't allocate. Only modified while a module map
+  // is built, metadata reused from a previous camera is never modified.
+  std::shared_ptr<FeatureMetadata> feature_metadata_;
+
+  std::shared_ptr<FrameBufferPool> frame_buffer_pool_;
+
+  std::vector<std::unique_ptr<StreamContext>> streams_;
+  uint32_t active_stream_count_{0};
+
+  std::atomic_bool feature_value_cache_enabled_{true};
+  // Incremented on every invalidation, so values read concurrently to an invalidation are
+  // not stored
+  mutable std::atomic_uint64_t feature_value_cache_generation_{0};
+  mutable std::mutex feature_value_cache_mutex_{};
+  mutable std::unordered_map<VmbHandle_t, std::unordered_map<std::string_view, feature_value>>
+  feature_value_cache_;
+  mutable std::unordered_map<VmbHandle_t, std::unordered_set<std::string_view>>
+  feature_value_cache_registrations_;
+
+  // Swapped atomically, frames keep the correction they started with
+  std::shared_ptr<const PixelCorrection> pixel_correction_{};
 };
 
 }  // namespace vimbax_camera
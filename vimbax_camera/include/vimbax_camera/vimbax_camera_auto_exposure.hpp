@@ -0,0 +1,188 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_AUTO_EXPOSURE_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_AUTO_EXPOSURE_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sensor_msgs/msg/region_of_interest.hpp>
+
+#include <vimbax_camera/result.hpp>
+#include <vimbax_camera/vimbax_camera.hpp>
+#include <vimbax_camera/vimbax_camera_feature_queue.hpp>
+
+namespace vimbax_camera
+{
+
+// PI loop on the logarithm of the total exposure (exposure time times linear gain), so the
+// loop gain doesn't depend on the scene brightness. Exposure time is raised before gain.
+class AutoExposureLoop
+{
+public:
+  struct Limits
+  {
+    double exposure_time_min;
+    double exposure_time_max;
+    // Gain in dB
+    double gain_min;
+    double gain_max;
+  };
+
+  AutoExposureLoop(double target, double kp, double ki, const Limits & limits);
+
+  void reset(double exposure_time, double gain);
+
+  // Returns the new exposure time and gain for the measured brightness (0 to 1)
+  std::pair<double, double> update(double brightness);
+
+private:
+  double const target_;
+  double const kp_;
+  double const ki_;
+  Limits const limits_;
+  double log_total_{0.0};
+  std::optional<double> last_error_{};
+};
+
+// Weighted region of the image the brightness is measured in
+struct AutoExposureRegion
+{
+  sensor_msgs::msg::RegionOfInterest region;
+  double weight;
+
+  // Parses a x,y,width,height,weight definition
+  static result<AutoExposureRegion> parse(const std::string & definition);
+};
+
+// Measures the brightness of the frames in the frame callback and adjusts ExposureTime and
+// Gain from a separate thread, so the feature writes don't delay the frames. With a change
+// queue the writes are applied through it, so they get a settings generation like queued
+// feature changes.
+class AutoExposureController
+{
+public:
+  struct Settings
+  {
+    double target;
+    double tolerance;
+    double kp;
+    double ki;
+    // Maximum number of feature updates per second
+    double max_update_rate;
+    // Frames skipped after an update until the new settings are expected to be active
+    uint32_t settle_frames;
+    uint32_t stride;
+    // Whole image if empty
+    std::vector<AutoExposureRegion> regions;
+    // Negative values use the camera limit
+    double exposure_time_max;
+    double gain_max;
+  };
+
+  struct Status
+  {
+    double brightness;
+    double exposure_time;
+    double gain;
+    bool converged;
+    // Updates since the loop was last outside the tolerance, 0 while not converged
+    uint64_t converged_updates;
+    // Updates it took to converge the last time
+    uint64_t settling_updates;
+    uint64_t update_count;
+  };
+
+  using StatusCallback = std::function<void (const Status &)>;
+
+  // Switches off ExposureAuto and GainAuto of the camera. The change queue must outlive the
+  // controller.
+  static result<std::shared_ptr<AutoExposureController>> create(
+    std::shared_ptr<VimbaXCamera> camera, const Settings & settings, StatusCallback callback,
+    FeatureChangeQueue * change_queue = nullptr);
+
+  ~AutoExposureController();
+
+  AutoExposureController(const AutoExposureController &) = delete;
+  AutoExposureController & operator=(const AutoExposureController &) = delete;
+
+  // Must be called with every frame of the first stream before it is requeued
+  void process(const VimbaXCamera::Frame & frame);
+
+  // Weighted mean brightness of the regions, regions outside of the image are skipped
+  static result<double> measure(
+    const sensor_msgs::msg::Image & image, uint32_t bit_depth, uint32_t stride,
+    const std::vector<AutoExposureRegion> & regions);
+
+private:
+  AutoExposureController(
+    std::shared_ptr<VimbaXCamera> camera, const Settings & settings, StatusCallback callback,
+    const AutoExposureLoop::Limits & limits);
+
+  void run();
+  // Returns false if neither feature was written
+  static bool write(
+    const VimbaXCamera & camera, const VimbaXCamera::FeatureHandle & exposure_time_feature,
+    const std::optional<VimbaXCamera::FeatureHandle> & gain_feature, double exposure_time,
+    double gain);
+
+  std::shared_ptr<VimbaXCamera> const camera_;
+  Settings const settings_;
+  StatusCallback const callback_;
+  FeatureChangeQueue * change_queue_{nullptr};
+  AutoExposureLoop loop_;
+  VimbaXCamera::FeatureHandle exposure_time_feature_{};
+  std::optional<VimbaXCamera::FeatureHandle> gain_feature_{};
+  // Only accessed by the controller thread once it was started
+  Status status_{};
+
+  std::mutex mutex_{};
+  std::condition_variable cv_{};
+  std::optional<double> brightness_{};
+  // Frames processed, an update waits for settle_frames frames before the next measurement
+  uint64_t frame_count_{0};
+  uint64_t settled_frame_count_{0};
+  std::optional<int64_t> last_frame_id_{};
+  bool stop_{false};
+  std::thread thread_{};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_AUTO_EXPOSURE_HPP_
@@ -0,0 +1,138 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_CORRECTION_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_CORRECTION_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sensor_msgs/msg/image.hpp>
+
+#include <vimbax_camera/result.hpp>
+
+namespace vimbax_camera
+{
+
+// Mean of a number of mono or Bayer frames with 8 or 16 bit, used to calibrate the correction
+class FrameAverage
+{
+public:
+  // Frames whose 16 bit pixels can be summed up without overflowing the 32 bit sums
+  static constexpr uint32_t max_frame_count = UINT32_MAX / UINT16_MAX;
+
+  // frame_count is clamped to 1 to max_frame_count
+  explicit FrameAverage(uint32_t frame_count);
+
+  // Fails with VmbErrorNotSupported for other encodings and with VmbErrorInvalidValue if the
+  // format differs from the first frame
+  result<void> add(const sensor_msgs::msg::Image & image);
+
+  bool complete() const;
+
+  uint32_t count() const;
+
+  // Rounded mean of every pixel, row by row without padding
+  std::vector<uint16_t> mean() const;
+
+  uint32_t width() const;
+  uint32_t height() const;
+  uint32_t bytes_per_pixel() const;
+  bool is_bayer() const;
+
+private:
+  uint32_t const frame_count_;
+  uint32_t count_{0};
+  uint32_t width_{0};
+  uint32_t height_{0};
+  uint32_t bytes_per_pixel_{0};
+  bool is_bayer_{false};
+  std::vector<uint32_t> sums_{};
+};
+
+// Per pixel dark offset and gain correction with replacement of defective pixels for mono and
+// Bayer images with 8 or 16 bit. The maps are in units of the pixel container, so 10 to 14 bit
+// formats are corrected after their values were shifted to 16 bit.
+class PixelCorrection
+{
+public:
+  // The gain map is 4.12 fixed point
+  static constexpr uint32_t gain_shift = 12;
+  static constexpr uint16_t gain_one = 1 << gain_shift;
+
+  static result<std::shared_ptr<const PixelCorrection>> create(
+    uint32_t width, uint32_t height, uint32_t bytes_per_pixel, std::vector<uint16_t> dark,
+    std::vector<uint16_t> gain, std::vector<uint32_t> defects);
+
+  static result<std::shared_ptr<const PixelCorrection>> load(const std::string & filename);
+  result<void> save(const std::string & filename) const;
+
+  // Replaces the dark map with the averaged dark frames. The gain map of base is kept if it has
+  // the same size. Pixels exceeding the median dark level by threshold times the full scale are
+  // marked defective.
+  static result<std::shared_ptr<const PixelCorrection>> from_dark(
+    const FrameAverage & dark, double threshold, const PixelCorrection * base);
+
+  // Computes the gain map from the averaged frames of a uniformly lit scene, each Bayer color
+  // is scaled to its own median. The dark map of base is kept if it has the same size. Pixels
+  // whose response deviates by more than threshold from the median are marked defective.
+  static result<std::shared_ptr<const PixelCorrection>> from_flat(
+    const FrameAverage & flat, double threshold, const PixelCorrection * base);
+
+  // Corrects the image in place, returns false if its size or format doesn't match the maps
+  bool apply(sensor_msgs::msg::Image & image) const;
+
+  uint32_t width() const;
+  uint32_t height() const;
+  uint32_t bytes_per_pixel() const;
+  const std::vector<uint16_t> & dark() const;
+  const std::vector<uint16_t> & gain() const;
+  // Pixel indices, ascending
+  const std::vector<uint32_t> & defects() const;
+
+private:
+  PixelCorrection() = default;
+
+  static std::vector<uint32_t> find_defects(
+    const std::vector<uint16_t> & dark, const std::vector<uint16_t> & gain,
+    uint32_t bytes_per_pixel, double threshold);
+
+  uint32_t width_{0};
+  uint32_t height_{0};
+  uint32_t bytes_per_pixel_{0};
+  std::vector<uint16_t> dark_{};
+  std::vector<uint16_t> gain_{};
+  std::vector<uint32_t> defects_{};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_CORRECTION_HPP_
@@ -0,0 +1,142 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_EVENT_QUEUE_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_EVENT_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace vimbax_camera
+{
+
+// Bounded lock-free queue for multiple producers and a single consumer. Pushing never blocks,
+// if the queue is full the element is rejected. The slots keep their values, so for types
+// like std::string the queue doesn't allocate once the slots are warmed up.
+template<typename T>
+class EventQueue
+{
+public:
+  explicit EventQueue(std::size_t capacity)
+  : capacity_{round_up_capacity(capacity)},
+    slots_{std::make_unique<Slot[]>(capacity_)}
+  {
+    for (std::size_t i = 0; i < capacity_; i++) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  EventQueue(const EventQueue &) = delete;
+  EventQueue & operator=(const EventQueue &) = delete;
+
+  // Safe to call from any number of threads
+  template<typename U>
+  bool try_push(U && value)
+  {
+    auto position = tail_.load(std::memory_order_relaxed);
+
+    for (;; ) {
+      auto & slot = slots_[position & (capacity_ - 1)];
+      auto const sequence = slot.sequence.load(std::memory_order_acquire);
+      auto const diff = static_cast<std::intptr_t>(sequence) -
+        static_cast<std::intptr_t>(position);
+
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          slot.value = std::forward<U>(value);
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Must only be called by the consumer thread. The popped value is swapped with value, so
+  // the previous content of value is reused by the slot.
+  bool try_pop(T & value)
+  {
+    auto & slot = slots_[head_ & (capacity_ - 1)];
+
+    if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+      return false;
+    }
+
+    using std::swap;
+    swap(value, slot.value);
+    slot.sequence.store(head_ + capacity_, std::memory_order_release);
+    head_++;
+
+    return true;
+  }
+
+  // Must only be called by the consumer thread
+  bool empty() const
+  {
+    return slots_[head_ & (capacity_ - 1)].sequence.load(std::memory_order_acquire) != head_ + 1;
+  }
+
+  std::size_t capacity() const
+  {
+    return capacity_;
+  }
+
+private:
+  struct Slot
+  {
+    std::atomic_size_t sequence;
+    T value;
+  };
+
+  static std::size_t round_up_capacity(std::size_t capacity)
+  {
+    std::size_t rounded = 2;
+
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+
+    return rounded;
+  }
+
+  std::size_t const capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(64) std::atomic_size_t tail_{0};
+  alignas(64) std::size_t head_{0};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_EVENT_QUEUE_HPP_
@@ -0,0 +1,97 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_FEATURE_JOURNAL_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_FEATURE_JOURNAL_HPP_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <vimbax_camera_msgs/msg/feature_value.hpp>
+
+#include <vimbax_camera/vimbax_camera.hpp>
+
+namespace vimbax_camera
+{
+
+// Feature writes made through the services, replayed in order after a reconnect. A write
+// replaces an earlier write of the same feature made with the same selector values and a
+// selector write overwritten before any other feature was written is dropped, so the journal is
+// bounded by the combinations of selector values that were written. Recording a write takes
+// O(log n) in the journal size. Not thread safe.
+class FeatureWriteJournal
+{
+public:
+  struct Write
+  {
+    std::string name;
+    VimbaXCamera::Module module;
+    vimbax_camera_msgs::msg::FeatureValue value;
+    bool is_selector;
+  };
+
+  void record(Write write);
+
+  // Returns the writes in the order they must be replayed and clears the journal
+  std::vector<Write> take();
+
+  void clear();
+
+  std::size_t size() const;
+
+private:
+  using FeatureKey = std::pair<std::string, VimbaXCamera::Module>;
+  using ValueKey = std::tuple<uint8_t, int64_t, double, bool, std::string>;
+  using SelectorState = std::map<FeatureKey, ValueKey>;
+
+  using Writes = std::map<uint64_t, Write>;
+
+  static ValueKey value_key(const vimbax_camera_msgs::msg::FeatureValue & value);
+
+  // Drops the selector writes right before pos that are overwritten by the ones starting at pos
+  void selectors_prune(Writes::iterator pos);
+
+  // Ordered by sequence number, erasing keeps the order of the other writes
+  Writes writes_{};
+  uint64_t next_sequence_{0};
+  // Sequence number of the last write of each feature for each selector state
+  std::map<std::pair<FeatureKey, uint32_t>, uint64_t> feature_writes_{};
+  // Selector values of all journaled selector writes, each combination gets an id
+  SelectorState selector_state_{};
+  std::map<SelectorState, uint32_t> selector_state_ids_{};
+  uint32_t selector_state_id_{0};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_FEATURE_JOURNAL_HPP_
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_FEATURE_QUEUE_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_FEATURE_QUEUE_HPP_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace vimbax_camera
+{
+
+// Feature changes applied at frame boundaries. Every change gets a settings generation id when
+// it is queued, the frame callback applies the pending changes after a frame arrived and from
+// then on the frames are tagged with the generation they were exposed with. Frames still in
+// flight while the features are written, latency frames after the current one, keep the
+// previous generation. With a write timestamp function the device time after each write is
+// recorded, so the generation of a frame can be confirmed from its exposure start.
+class FeatureChangeQueue
+{
+public:
+  // Writes the features of one change, returns false if the change wasn't applied and
+  // nothing if it can't be written right now and must be retried with the next apply
+  using Apply = std::function<std::optional<bool>()>;
+  // Device time in nanoseconds, nothing if it can't be read
+  using WriteTimestamp = std::function<std::optional<uint64_t>()>;
+
+  explicit FeatureChangeQueue(uint32_t latency_frames);
+
+  // Must be set before the first change is applied
+  void set_write_timestamp(WriteTimestamp write_timestamp);
+
+  FeatureChangeQueue(const FeatureChangeQueue &) = delete;
+  FeatureChangeQueue & operator=(const FeatureChangeQueue &) = delete;
+
+  // Returns the generation of the change and a future that is set once it was applied
+  std::pair<uint64_t, std::future<bool>> push(Apply apply);
+
+  // Applies all pending changes. frame_id is the frame the changes are applied after, or empty
+  // if the stream is stopped and the changes are active for all following frames. A deferred
+  // change stays pending together with all changes queued after it.
+  void apply(std::optional<int64_t> frame_id);
+
+  // Removes the change if it is still pending, its future is set to false. Returns false if
+  // the change is being applied or was already applied.
+  bool cancel(uint64_t generation);
+
+  bool pending() const;
+
+  // Generation of the last applied change active for frame_id. Frames must be passed in
+  // ascending order.
+  uint64_t generation(int64_t frame_id);
+
+  // Generation of the last change written before exposure_start_ns (device time), nothing if
+  // the write times recorded don't reach back that far
+  std::optional<uint64_t> generation_at(uint64_t exposure_start_ns) const;
+
+  // Must be called when the stream is restarted, as the frame ids may start over
+  void restart();
+
+private:
+  struct Pending
+  {
+    uint64_t generation;
+    Apply apply;
+    std::promise<bool> applied;
+  };
+
+  struct Applied
+  {
+    uint64_t generation;
+    int64_t first_frame_id;
+  };
+
+  struct Written
+  {
+    uint64_t generation;
+    uint64_t previous_generation;
+    uint64_t timestamp_ns;
+  };
+
+  uint32_t const latency_frames_;
+  WriteTimestamp write_timestamp_{};
+
+  // Serializes apply calls, so the changes are applied in the order they were queued
+  std::mutex apply_mutex_{};
+  mutable std::mutex mutex_{};
+  std::vector<Pending> pending_{};
+  // Ordered by first frame id
+  std::deque<Applied> applied_{};
+  uint64_t next_generation_{1};
+  // Generation of the frames before the first applied entry
+  uint64_t generation_{0};
+  uint64_t last_applied_generation_{0};
+  // Ordered by timestamp, only the most recent writes are kept
+  std::deque<Written> written_{};
+  bool written_dropped_{false};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_FEATURE_QUEUE_HPP_
@@ -0,0 +1,141 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_FRAME_CORRELATOR_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_FRAME_CORRELATOR_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace vimbax_camera
+{
+
+// Joins camera events with the frames they belong to. Events carrying a frame id are kept
+// for the last window frame ids until the frame is taken, events without a frame id (e.g.
+// line events) are attached to the next frame taken. Events are added by the event worker.
+// As the events are usually delivered after their frame, the frame processing thread hands
+// its frames to the thread of the correlator, which waits for their events.
+class FrameEventCorrelator
+{
+public:
+  struct Event
+  {
+    std::string name;
+    uint64_t timestamp_ns;
+  };
+
+  struct FrameEvents
+  {
+    int64_t frame_id;
+    std::optional<uint64_t> exposure_start_ns;
+    std::optional<uint64_t> exposure_end_ns;
+    std::vector<Event> events;
+
+    std::optional<uint64_t> exposure_midpoint_ns() const;
+  };
+
+  using CompleteFunction = std::function<void(FrameEvents && frame_events)>;
+
+  // Frames wait for the expected events that were added with a frame id since the last clear,
+  // other events are matched but never waited for
+  FrameEventCorrelator(std::size_t window, std::vector<std::string> expected_events);
+  ~FrameEventCorrelator();
+
+  FrameEventCorrelator(const FrameEventCorrelator &) = delete;
+  FrameEventCorrelator & operator=(const FrameEventCorrelator &) = delete;
+
+  void add_event(std::string_view name, int64_t frame_id, uint64_t timestamp_ns);
+  void add_event(std::string_view name, uint64_t timestamp_ns);
+
+  // Events of frame_id. Events of older frames that were never taken are dropped. Waits up to
+  // max_wait until the expected events arrived for frame_id.
+  FrameEvents take(int64_t frame_id, std::chrono::nanoseconds max_wait = {});
+
+  // Returns immediately, the frame is taken on the thread of the correlator up to max_wait
+  // after this call and passed to complete. Frames are completed in order, when more than
+  // window frames are queued the oldest is completed without waiting any longer.
+  void take_async(int64_t frame_id, std::chrono::nanoseconds max_wait, CompleteFunction complete);
+
+  // Exposure midpoint of the events already added for frame_id
+  std::optional<uint64_t> exposure_midpoint_ns(int64_t frame_id) const;
+
+  // Must be called when the stream is restarted, as the frame ids may start over. Wakes up
+  // a waiting take, frames queued before are completed without events.
+  void clear();
+
+  // Number of events dropped because their frame was already taken or out of the window
+  uint64_t dropped_count() const;
+
+private:
+  struct QueuedFrame
+  {
+    int64_t frame_id;
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t clear_count;
+    CompleteFunction complete;
+  };
+
+  // Must be called with the mutex locked
+  bool is_complete(int64_t frame_id) const;
+  FrameEvents take_locked(int64_t frame_id);
+
+  void run();
+
+  std::size_t const window_;
+  std::vector<std::string> const expected_events_;
+
+  mutable std::mutex mutex_{};
+  // Notified when events or frames are added, on clear and on stop
+  std::condition_variable cv_{};
+  uint64_t clear_count_{0};
+  // Expected events added with a frame id since the last clear, a frame is complete once it
+  // has all of them
+  std::vector<std::string> frame_event_names_{};
+  std::deque<QueuedFrame> queued_{};
+  bool stop_{false};
+  // Ordered by frame id
+  std::deque<FrameEvents> pending_{};
+  std::vector<Event> unassigned_{};
+  std::optional<int64_t> last_taken_frame_id_{};
+  uint64_t dropped_count_{0};
+  std::thread thread_{};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_FRAME_CORRELATOR_HPP_
@@ -0,0 +1,163 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_FRAME_SET_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_FRAME_SET_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+#include <vimbax_camera/result.hpp>
+
+namespace vimbax_camera
+{
+
+// Groups the frames of several cameras of one process into sets, either by frame id or by
+// device timestamp within a tolerance. Cameras join an aggregator by name, so the nodes of one
+// container share it without knowing each other.
+class FrameSetAggregator
+{
+public:
+  enum class Match
+  {
+    FrameId,
+    Timestamp,
+  };
+
+  struct Settings
+  {
+    std::vector<std::string> members;
+    Match match;
+    // Maximum distance of the timestamps in a set, ignored when matching by frame id
+    uint64_t tolerance_ns;
+    // Oldest open set is released incomplete when this number is exceeded
+    std::size_t max_pending;
+
+    bool operator==(const Settings & other) const;
+  };
+
+  struct Frame
+  {
+    // Empty while the images aren't wanted, the frame is then only matched and counted
+    std::shared_ptr<sensor_msgs::msg::Image> image;
+    sensor_msgs::msg::CameraInfo camera_info;
+    uint64_t frame_id;
+    uint64_t timestamp_ns;
+  };
+
+  struct Set
+  {
+    uint64_t id;
+    // Indexed like the members, missing frames are empty
+    std::vector<std::optional<Frame>> frames;
+    std::size_t count;
+    // Difference of the last and the first timestamp in the set
+    uint64_t skew_ns;
+
+    bool complete() const;
+  };
+
+  struct Statistics
+  {
+    uint64_t complete_count;
+    uint64_t incomplete_count;
+    // Frames missing in incomplete sets per member
+    std::vector<uint64_t> missing_count;
+    uint64_t max_skew_ns;
+  };
+
+  using ReleaseFunction = std::function<void(Set && set, const Statistics & statistics)>;
+
+  // Returns the aggregator of that name, creating it on the first call. Fails with
+  // VmbErrorInvalidValue if it exists with other settings or the settings are invalid.
+  static result<std::shared_ptr<FrameSetAggregator>> join(
+    const std::string & name, const Settings & settings);
+
+  ~FrameSetAggregator();
+
+  FrameSetAggregator(const FrameSetAggregator &) = delete;
+  FrameSetAggregator & operator=(const FrameSetAggregator &) = delete;
+
+  std::optional<std::size_t> member_index(const std::string & member) const;
+
+  // Called with complete sets and with incomplete sets pushed out of the pending window, from
+  // the thread adding the frame completing or pushing out the set. Sets are released in order
+  // and the callback isn't called anymore once this returns.
+  void set_release_callback(ReleaseFunction release);
+
+  // Set by the publishing member, so the others only copy their images while they are consumed
+  void set_images_wanted(bool wanted);
+  bool images_wanted() const;
+
+  void add(std::size_t member, Frame && frame);
+
+  Statistics statistics() const;
+
+private:
+  FrameSetAggregator(std::string name, Settings settings);
+
+  struct PendingSet
+  {
+    // Frame id or timestamp of the first frame of the set
+    uint64_t key;
+    Set set;
+  };
+
+  uint64_t key(const Frame & frame) const;
+  // Updates the statistics, must be called with the mutex held
+  Set release(PendingSet && pending);
+
+  std::string const name_;
+  Settings const settings_;
+
+  mutable std::mutex mutex_{};
+  // Taken before the mutex is released and held while calling the callback, so the sets are
+  // released in order and not anymore once the callback was reset
+  std::mutex callback_mutex_{};
+  ReleaseFunction release_{};
+  std::atomic_bool images_wanted_{false};
+  // Oldest set first
+  std::deque<PendingSet> pending_{};
+  uint64_t next_id_{0};
+  Statistics statistics_{};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_FRAME_SET_HPP_
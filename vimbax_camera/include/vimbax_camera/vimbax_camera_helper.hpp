@@ -74,11 +74,17 @@ struct SFNCFeatures
   static constexpr std::string_view TriggerMode = "TriggerMode";
   static constexpr std::string_view TriggerSource = "TriggerSource";
   static constexpr std::string_view TriggerSelector = "TriggerSelector";
+  static constexpr std::string_view TriggerSoftware = "TriggerSoftware";
   static constexpr std::string_view DeviceFirmwareVersion = "DeviceFirmwareVersion";
   static constexpr std::string_view DeviceUserId = "DeviceUserID";
   static constexpr std::string_view AcquisitionFrameRate = "AcquisitionFrameRate";
   static constexpr std::string_view DeviceTimestampFrequency = "DeviceTimestampFrequency";
   static constexpr std::string_view GVSPAdjustPacketSize = "GVSPAdjustPacketSize";
+  static constexpr std::string_view GVSPPacketSize = "GVSPPacketSize";
+  static constexpr std::string_view ExposureTime = "ExposureTime";
+  static constexpr std::string_view ExposureAuto = "ExposureAuto";
+  static constexpr std::string_view Gain = "Gain";
+  static constexpr std::string_view GainAuto = "GainAuto";
 
   static constexpr std::string_view InterfaceId = "InterfaceID";
   static constexpr std::string_view TransportLayerId = "TLID";
@@ -88,6 +94,25 @@ struct SFNCFeatures
 
   static constexpr std::string_view StreamBufferAlignment = "StreamBufferAlignment";
 
+  static constexpr std::string_view PtpEnable = "PtpEnable";
+  static constexpr std::string_view PtpMode = "PtpMode";
+  static constexpr std::string_view GevIEEE1588 = "GevIEEE1588";
+  static constexpr std::string_view PtpStatus = "PtpStatus";
+  static constexpr std::string_view PtpOffsetFromMaster = "PtpOffsetFromMaster";
+  static constexpr std::string_view PtpDataSetLatch = "PtpDataSetLatch";
+  static constexpr std::string_view TimestampLatch = "TimestampLatch";
+  static constexpr std::string_view TimestampLatchValue = "TimestampLatchValue";
+  static constexpr std::string_view GevTimestampControlLatch = "GevTimestampControlLatch";
+  static constexpr std::string_view GevTimestampValue = "GevTimestampValue";
+
+  static constexpr std::string_view ActionSelector = "ActionSelector";
+  static constexpr std::string_view ActionDeviceKey = "ActionDeviceKey";
+  static constexpr std::string_view ActionGroupKey = "ActionGroupKey";
+  static constexpr std::string_view ActionGroupMask = "ActionGroupMask";
+  static constexpr std::string_view ActionCommand = "ActionCommand";
+  static constexpr std::string_view ActionScheduledTimeEnable = "ActionScheduledTimeEnable";
+  static constexpr std::string_view ActionScheduledTime = "ActionScheduledTime";
+
   static constexpr std::string_view EventSelector = "EventSelector";
   static constexpr std::string_view EventNotification = "EventNotification";
   static constexpr std::string_view EventCameraDiscovery = "EventCameraDiscovery";
@@ -106,6 +131,30 @@ rclcpp::Logger get_logger();
 rclcpp::Node::SharedPtr create_node(const std::string & name, const rclcpp::NodeOptions & options);
 
 void left_shift16(void * out, const void * in, size_t size, int shift);
+
+// Statistics of one image row, sum and saturated are split into even and odd columns
+struct row_statistics
+{
+  uint64_t sum[2];
+  uint64_t saturated[2];
+  // Sum of the squared differences of pixels two columns apart
+  uint64_t gradient;
+};
+
+void accumulate_row8(
+  row_statistics & statistics, const uint8_t * row, size_t width, uint8_t saturation);
+
+// Subtracts the dark offset and multiplies with the gain in 4.12 fixed point, saturating at
+// the maximum value
+void correct_row8(uint8_t * row, const uint16_t * dark, const uint16_t * gain, size_t width);
+void correct_row16(uint16_t * row, const uint16_t * dark, const uint16_t * gain, size_t width);
+
+// Bilinear interpolation of mono8 pixels. offsets holds the byte offset of the top left source
+// pixel or -1 for black, fractions the horizontal fraction in the low and the vertical in the
+// high byte, with 7 fraction bits.
+void remap_row8(
+  uint8_t * dst, const uint8_t * src, size_t src_size, size_t step, const int32_t * offsets,
+  const uint16_t * fractions, size_t width);
 }  // namespace vimbax_camera::helper
 
 #endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_HELPER_HPP_
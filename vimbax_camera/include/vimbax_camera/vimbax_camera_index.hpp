@@ -0,0 +1,121 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_INDEX_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_INDEX_HPP_
+
+#include <string>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <vimbax_camera/result.hpp>
+#include <vimbax_camera/loader/vmbc_api.hpp>
+
+namespace vimbax_camera
+{
+std::optional<uint32_t> decode_ip_addr(const std::string & ip_addr_str);
+
+std::optional<uint64_t> decode_mac_addr(const std::string & mac_addr_str);
+
+std::string ip_addr_to_string(uint32_t ip_addr);
+
+std::string mac_addr_to_string(uint64_t mac_addr);
+
+// Index of all cameras known to VmbC. It is built by a single enumeration and kept up to
+// date by the camera discovery events, so looking up a camera does not enumerate the
+// cameras or walk the device selectors of the GigE Vision interfaces again.
+class VimbaXCameraIndex
+{
+public:
+  struct Entry
+  {
+    std::string camera_id;
+    std::string extended_id;
+    std::string display_name;
+    std::string model_name;
+    std::string serial_number;
+    std::string interface_id;
+    std::optional<uint32_t> ip_address;
+    std::optional<uint64_t> mac_address;
+    VmbAccessMode_t permitted_access;
+  };
+
+  explicit VimbaXCameraIndex(std::shared_ptr<VmbCAPI> api);
+
+  VimbaXCameraIndex(const VimbaXCameraIndex &) = delete;
+  VimbaXCameraIndex & operator=(const VimbaXCameraIndex &) = delete;
+
+  // Enumerates all cameras and replaces the content of the index
+  result<void> rebuild();
+
+  // Queries the camera again, also used when it became reachable or unreachable, e.g. because
+  // its ip address changed
+  void on_camera_detected(const std::string & camera_id);
+  void on_camera_missing(const std::string & camera_id);
+
+  // Looks up a camera by its id, extended id, serial number, ip address or mac address
+  std::optional<Entry> find(const std::string & key) const;
+
+  // The permitted access of the entries is queried on each call, as it changes whenever a
+  // camera is opened or closed by any process
+  std::vector<Entry> list() const;
+
+private:
+  struct GevDevice
+  {
+    std::string device_id;
+    std::optional<uint32_t> ip_address;
+    std::optional<uint64_t> mac_address;
+  };
+
+  std::vector<GevDevice> gev_devices_get(VmbHandle_t interface_handle) const;
+
+  Entry create_entry(
+    const VmbCameraInfo & info, const std::vector<GevDevice> & gev_devices) const;
+
+  void insert(Entry entry);
+  void erase(const std::string & camera_id);
+
+  std::optional<std::string> camera_id_find(const std::string & key) const;
+
+  std::shared_ptr<VmbCAPI> api_;
+
+  mutable std::shared_mutex mutex_{};
+  std::unordered_map<std::string, Entry> entries_;
+  // All keys map to the camera id, which is the key of entries_
+  std::unordered_map<std::string, std::string> camera_id_by_name_;
+  std::unordered_map<uint32_t, std::string> camera_id_by_ip_;
+  std::unordered_map<uint64_t, std::string> camera_id_by_mac_;
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_INDEX_HPP_
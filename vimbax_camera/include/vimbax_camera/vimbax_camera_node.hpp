@@ -34,15 +34,28 @@
 #include <thread>
 #include <mutex>
 #include <shared_mutex>
+#include <condition_variable>
+#include <future>
 #include <memory_resource>
 #include <atomic>
+#include <array>
+#include <unordered_map>
+#include <vector>
+#include <map>
+#include <deque>
+#include <algorithm>
+#include <chrono>
+#include <limits>
 
 #include <rclcpp/rclcpp.hpp>
+#include <rclcpp_action/rclcpp_action.hpp>
 
 #include <image_transport/image_transport.hpp>
 #include <camera_info_manager/camera_info_manager.hpp>
 
 #include <vimbax_camera_msgs/srv/features_list_get.hpp>
+#include <vimbax_camera_msgs/srv/features_batch.hpp>
+#include <vimbax_camera_msgs/srv/features_queue_set.hpp>
 #include <vimbax_camera_msgs/srv/feature_int_get.hpp>
 #include <vimbax_camera_msgs/srv/feature_int_set.hpp>
 #include <vimbax_camera_msgs/srv/feature_int_info_get.hpp>
@@ -67,16 +80,50 @@
 #include <vimbax_camera_msgs/srv/feature_access_mode_get.hpp>
 #include <vimbax_camera_msgs/srv/feature_info_query.hpp>
 #include <vimbax_camera_msgs/srv/settings_load_save.hpp>
+#include <vimbax_camera_msgs/srv/settings_snapshot_load.hpp>
 #include <vimbax_camera_msgs/srv/status.hpp>
 #include <vimbax_camera_msgs/srv/stream_start_stop.hpp>
 #include <vimbax_camera_msgs/srv/connection_status.hpp>
+#include <vimbax_camera_msgs/srv/cameras_list.hpp>
+#include <vimbax_camera_msgs/srv/profiles_list.hpp>
+#include <vimbax_camera_msgs/srv/profile_switch.hpp>
+#include <vimbax_camera_msgs/srv/recording_start.hpp>
+#include <vimbax_camera_msgs/srv/recording_stop.hpp>
+#include <vimbax_camera_msgs/srv/pre_trigger_dump.hpp>
+#include <vimbax_camera_msgs/srv/correction_capture.hpp>
+#include <vimbax_camera_msgs/srv/ptp_sync_trigger.hpp>
 
 #include <vimbax_camera_msgs/msg/event_data.hpp>
+#include <vimbax_camera_msgs/msg/typed_event_data.hpp>
+#include <vimbax_camera_msgs/msg/frame_metadata.hpp>
+#include <vimbax_camera_msgs/msg/shared_frame.hpp>
+#include <vimbax_camera_msgs/msg/image_statistics.hpp>
+#include <vimbax_camera_msgs/msg/auto_exposure_status.hpp>
+#include <vimbax_camera_msgs/msg/frame_set.hpp>
+#include <vimbax_camera_msgs/msg/frame_set_statistics.hpp>
+#include <vimbax_camera_msgs/msg/ptp_sync_status.hpp>
+#include <vimbax_camera_msgs/msg/ptp_sync_skew.hpp>
+
+#include <vimbax_camera_msgs/action/burst_capture.hpp>
 
 #include <vimbax_camera/loader/vmbc_api.hpp>
 #include <vimbax_camera/vimbax_camera.hpp>
+#include <vimbax_camera/vimbax_camera_frame_correlator.hpp>
+#include <vimbax_camera/vimbax_camera_recorder.hpp>
+#include <vimbax_camera/vimbax_camera_roi.hpp>
+#include <vimbax_camera/vimbax_camera_shared_memory.hpp>
+#include <vimbax_camera/vimbax_camera_statistics.hpp>
+#include <vimbax_camera/vimbax_camera_auto_exposure.hpp>
+#include <vimbax_camera/vimbax_camera_feature_queue.hpp>
+#include <vimbax_camera/vimbax_camera_feature_journal.hpp>
+#include <vimbax_camera/vimbax_camera_pretrigger.hpp>
+#include <vimbax_camera/vimbax_camera_correction.hpp>
+#include <vimbax_camera/vimbax_camera_rectify.hpp>
+#include <vimbax_camera/vimbax_camera_frame_set.hpp>
+#include <vimbax_camera/vimbax_camera_sync.hpp>
 
 #include <std_msgs/msg/empty.hpp>
+#include <std_msgs/msg/header.hpp>
 
 #include <vimbax_camera_events/event_publisher.hpp>
 
@@ -97,6 +144,8 @@ public:
 
 private:
   using OnSetParametersCallbackHandle = rclcpp::Node::OnSetParametersCallbackHandle;
+  using BurstCaptureGoalHandle =
+    rclcpp_action::ServerGoalHandle<vimbax_camera_msgs::action::BurstCapture>;
 
   const std::string parameter_camera_id = "camera_id";
   const std::string parameter_settings_file = "settings_file";
@@ -106,11 +155,61 @@ private:
   const std::string parameter_camera_info_url = "camera_info_url";
   const std::string parameter_command_feature_timeout = "command_feature_timeout";
   const std::string parameter_use_ros_time = "use_ros_time";
+  const std::string parameter_stream_count = "stream_count";
+  const std::string parameter_feature_value_cache = "feature_value_cache";
+  const std::string parameter_fast_reconnect = "fast_reconnect";
+  const std::string parameter_burst_max_size = "burst_max_size";
+  const std::string parameter_profiles = "profiles";
+  const std::string parameter_frame_correlation_events = "frame_correlation_events";
+  const std::string parameter_frame_correlation_window = "frame_correlation_window";
+  const std::string parameter_frame_correlation_timeout = "frame_correlation_timeout";
+  const std::string parameter_stamp_exposure_midpoint = "stamp_exposure_midpoint";
+  const std::string parameter_feature_queue_latency = "feature_queue_latency";
+  const std::string parameter_feature_queue_timeout = "feature_queue_timeout";
+  const std::string parameter_shared_memory_slots = "shared_memory_slots";
+  const std::string parameter_rois = "rois";
+  const std::string parameter_rectify_thread_count = "rectify_thread_count";
+  const std::string parameter_statistics_interval = "statistics_interval";
+  const std::string parameter_statistics_stride = "statistics_stride";
+  const std::string parameter_pretrigger_duration = "pretrigger_duration";
+  const std::string parameter_pretrigger_max_size = "pretrigger_max_size";
+  const std::string parameter_pretrigger_compression = "pretrigger_compression";
+  const std::string parameter_pretrigger_events = "pretrigger_events";
+  const std::string parameter_pretrigger_directory = "pretrigger_directory";
+  const std::string parameter_frame_set = "frame_set";
+  const std::string parameter_frame_set_members = "frame_set_members";
+  const std::string parameter_frame_set_match = "frame_set_match";
+  const std::string parameter_frame_set_tolerance = "frame_set_tolerance";
+  const std::string parameter_frame_set_max_pending = "frame_set_max_pending";
+  const std::string parameter_ptp_sync = "ptp_sync";
+  const std::string parameter_ptp_sync_members = "ptp_sync_members";
+  const std::string parameter_ptp_sync_device_key = "ptp_sync_device_key";
+  const std::string parameter_ptp_sync_group_key = "ptp_sync_group_key";
+  const std::string parameter_ptp_sync_group_mask = "ptp_sync_group_mask";
+  const std::string parameter_ptp_sync_monitor_interval = "ptp_sync_monitor_interval";
+  const std::string parameter_correction_file = "correction_file";
+  const std::string parameter_correction_enable = "correction_enable";
+  const std::string parameter_correction_defect_threshold = "correction_defect_threshold";
+  const std::string parameter_auto_exposure = "auto_exposure";
+  const std::string parameter_auto_exposure_target = "auto_exposure_target";
+  const std::string parameter_auto_exposure_tolerance = "auto_exposure_tolerance";
+  const std::string parameter_auto_exposure_kp = "auto_exposure_kp";
+  const std::string parameter_auto_exposure_ki = "auto_exposure_ki";
+  const std::string parameter_auto_exposure_max_rate = "auto_exposure_max_rate";
+  const std::string parameter_auto_exposure_settle_frames = "auto_exposure_settle_frames";
+  const std::string parameter_auto_exposure_stride = "auto_exposure_stride";
+  const std::string parameter_auto_exposure_regions = "auto_exposure_regions";
+  const std::string parameter_auto_exposure_exposure_time_max = "auto_exposure_exposure_time_max";
+  const std::string parameter_auto_exposure_gain_max = "auto_exposure_gain_max";
 
   std::atomic_bool stream_stopped_by_service_ = false;
   std::atomic_bool is_available_ = false;
   std::atomic_bool stream_restart_required_ = false;
+  std::atomic_bool burst_capture_active_ = false;
   std::string last_camera_id_{};
+  // Settings file loaded by the settings/load service, replaces the settings_file parameter
+  // on reconnect
+  std::string last_settings_file_{};
   mutable std::shared_mutex camera_mutex_{};
   mutable std::mutex stream_state_mutex_{};
 
@@ -121,8 +220,10 @@ private:
   bool initialize_parameters();
   bool initialize_api();
   bool initialize_publisher();
+  bool initialize_roi_publisher();
   bool initialize_camera(bool reconnect = false);
   bool initialize_camera_observer();
+  bool initialize_profiles();
   bool initialize_graph_notify();
   bool initialize_callback_groups();
   bool initialize_feature_services();
@@ -135,25 +236,159 @@ private:
   bool initialize_raw_feature_services();
   bool initialize_generic_feature_services();
   bool initialize_settings_services();
+  bool initialize_profile_services();
   bool initialize_status_services();
   bool initialize_stream_services();
+  bool initialize_recording_services();
+  bool initialize_burst_capture_action();
   bool initialize_events();
+  bool initialize_frame_correlation();
+  bool initialize_pretrigger();
+  bool initialize_pixel_correction();
+  bool initialize_frame_set();
+  bool initialize_ptp_sync();
   bool deinitialize_camera_observer();
 
   result<void> start_streaming();
   result<void> stop_streaming();
   bool is_streaming();
+  size_t get_num_subscribers() const;
+  void set_frame_header(VimbaXCamera::Frame & frame) const;
+  void set_frame_stamp(VimbaXCamera::Frame & frame, uint64_t timestamp_ns) const;
+  void publish_frame_metadata(VimbaXCamera::Frame & frame);
+  void publish_frame_metadata(
+    const std_msgs::msg::Header & header, uint64_t settings_generation,
+    const FrameEventCorrelator::FrameEvents & frame_events);
+  void publish_shared_frame(const VimbaXCamera::Frame & frame);
+  void publish_image_statistics(const VimbaXCamera::Frame & frame);
+  void publish_frame_set(
+    FrameSetAggregator::Set && set, const FrameSetAggregator::Statistics & statistics);
+  void publish_ptp_sync_status(const PtpSyncGroup::Status & status);
+  void publish_ptp_sync_skew(const PtpSyncGroup::Skew & skew);
+  void publish_rectified(
+    const VimbaXCamera::Frame & frame, const sensor_msgs::msg::CameraInfo & camera_info);
+  result<void> create_shared_frame_ring();
+  result<void> create_auto_exposure_controller();
+  recording::Metadata recording_metadata_get(const VimbaXCamera & camera) const;
+  // Writes the pre-trigger ring to a recording, or publishes it if filename is empty. Opening
+  // the file and writing it runs on the dump thread of the ring, opened is set once the file
+  // was opened.
+  result<std::size_t> pretrigger_dump(
+    const VimbaXCamera & camera, const std::string & filename,
+    std::promise<result<void>> opened = {});
+  // Averages frame_count frames of the running stream without correction and updates the dark
+  // or gain map of the active correction, returns the number of defective pixels
+  result<uint32_t> pixel_correction_capture(uint8_t type, uint32_t frame_count);
+  void pixel_correction_add_frame(const VimbaXCamera::Frame & frame);
+  void execute_burst_capture(std::shared_ptr<BurstCaptureGoalHandle> goal_handle);
+  result<void> burst_capture_size_check(const VimbaXCamera & camera, uint32_t frame_count) const;
+
+  result<vimbax_camera_msgs::msg::FeatureValue> feature_value_get(
+    const std::string & name, VimbaXCamera::Module module, uint8_t type) const;
+  result<void> feature_value_set(
+    const std::string & name, VimbaXCamera::Module module,
+    const vimbax_camera_msgs::msg::FeatureValue & value) const;
+  void feature_write_record(
+    const std::string & name, VimbaXCamera::Module module,
+    const vimbax_camera_msgs::msg::FeatureValue & value) const;
+  void feature_write_journal_replay();
+  // Writes the set operations of a queued change, restoring the previous values on failure.
+  // Returns nothing if the camera is locked by a (re)connect, the change is retried then.
+  std::optional<bool> feature_change_apply(
+    const std::vector<vimbax_camera_msgs::msg::FeatureOperation> & operations,
+    std::vector<vimbax_camera_msgs::msg::FeatureOperationResult> & results,
+    vimbax_camera_msgs::msg::Error & error_msg);
+  void feature_snapshot_record(
+    const VimbaXCamera::FeatureSnapshot & snapshot,
+    const VimbaXCamera::FeatureSnapshotApplyResult & apply_result) const;
+  void compile_profiles();
+
+  enum class EventConsumer : std::size_t
+  {
+    Events,
+    TypedEvents,
+    FrameCorrelation,
+    PreTrigger,
+    EventConsumerMax
+  };
+
+  // Subscription of one camera event shared by all its consumers, so the event data is read
+  // only once per occurrence
+  struct EventSubscription
+  {
+    VimbaXCamera::EventMetaDataLayout layout;
+    std::array<std::atomic_bool, std::size_t(EventConsumer::EventConsumerMax)> consumers{};
+    VimbaXCamera::InvalidationListenerId listener_id{};
+
+    bool is_consumed_by(EventConsumer consumer) const
+    {
+      return consumers[std::size_t(consumer)];
+    }
+  };
+
+  vimbax_camera_msgs::msg::Error event_subscribe(
+    const std::string & name, EventConsumer consumer);
+  void event_unsubscribe(const std::string & name, EventConsumer consumer);
+  result<void> event_subscription_register(
+    const std::string & name, std::shared_ptr<EventSubscription> subscription);
+  void event_subscriptions_restore();
+  void event_publish(const VimbaXCamera & camera, const EventSubscription & subscription);
 
   rclcpp::Node::SharedPtr node_;
   std::shared_ptr<VmbCAPI> api_;
   std::shared_ptr<VimbaXCamera> camera_;
+  // Kept up to date by the camera discovery events
+  std::shared_ptr<VimbaXCameraIndex> camera_index_;
+  // Taken from the disconnected camera and handed to the reopened one
+  VimbaXCamera::ReopenResources reopen_resources_;
+
+  mutable std::mutex feature_write_journal_mutex_{};
+  mutable FeatureWriteJournal feature_write_journal_{};
+
+  // Profiles loaded at startup, compiled for every (re)opened camera
+  std::vector<std::pair<std::string, VimbaXCamera::FeatureSnapshot>> profile_snapshots_;
+  std::unordered_map<std::string, VimbaXCamera::FeatureProfile> profiles_;
+  std::mutex active_profile_mutex_{};
+  std::string active_profile_{};
 
   // Publishers
   image_transport::CameraPublisher camera_publisher_;
+  rclcpp::Publisher<vimbax_camera_msgs::msg::FrameMetadata>::SharedPtr frame_metadata_publisher_;
+  rclcpp::Publisher<vimbax_camera_msgs::msg::SharedFrame>::SharedPtr shared_frame_publisher_;
+  rclcpp::Publisher<vimbax_camera_msgs::msg::ImageStatistics>::SharedPtr
+    image_statistics_publisher_;
+  rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr pretrigger_image_publisher_;
+  rclcpp::Publisher<vimbax_camera_msgs::msg::AutoExposureStatus>::SharedPtr
+    auto_exposure_status_publisher_;
+  // Only created on the first member of a frame set
+  rclcpp::Publisher<vimbax_camera_msgs::msg::FrameSet>::SharedPtr frame_set_publisher_;
+  rclcpp::Publisher<vimbax_camera_msgs::msg::FrameSetStatistics>::SharedPtr
+    frame_set_statistics_publisher_;
+  // Only created on the first member of a PTP sync group
+  rclcpp::Publisher<vimbax_camera_msgs::msg::PtpSyncStatus>::SharedPtr ptp_sync_status_publisher_;
+  rclcpp::Publisher<vimbax_camera_msgs::msg::PtpSyncSkew>::SharedPtr ptp_sync_skew_publisher_;
+  // Only accessed by the frame callback of the first stream
+  uint64_t image_statistics_frame_count_{0};
+  // Publishers for the additional stream channels, index 0 belongs to stream 1
+  std::vector<image_transport::CameraPublisher> stream_publishers_;
+  // One publisher per configured region of interest, in the order of the roi pipeline
+  std::vector<image_transport::CameraPublisher> roi_publishers_;
+  std::unique_ptr<RoiPipeline> roi_pipeline_;
+  std::vector<bool> roi_active_{};
+  // Only created if rectify_thread_count is not 0, only used by the frame callback of the first
+  // stream
+  image_transport::CameraPublisher rect_publisher_;
+  std::unique_ptr<Rectifier> rectifier_;
+  sensor_msgs::msg::Image rect_image_{};
+  int32_t rectify_error_{VmbErrorSuccess};
 
   // Services
   rclcpp::Service<vimbax_camera_msgs::srv::FeaturesListGet>::SharedPtr
     features_list_get_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::FeaturesBatch>::SharedPtr
+    features_batch_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::FeaturesQueueSet>::SharedPtr
+    features_queue_set_service_;
   rclcpp::Service<vimbax_camera_msgs::srv::FeatureIntGet>::SharedPtr
     feature_int_get_service_;
   rclcpp::Service<vimbax_camera_msgs::srv::FeatureIntSet>::SharedPtr
@@ -204,6 +439,24 @@ private:
     settings_save_service_;
   rclcpp::Service<vimbax_camera_msgs::srv::SettingsLoadSave>::SharedPtr
     settings_load_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::SettingsLoadSave>::SharedPtr
+    settings_snapshot_save_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::SettingsSnapshotLoad>::SharedPtr
+    settings_snapshot_load_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::ProfilesList>::SharedPtr
+    profiles_list_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::ProfileSwitch>::SharedPtr
+    profile_switch_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::RecordingStart>::SharedPtr
+    recording_start_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::RecordingStop>::SharedPtr
+    recording_stop_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::PreTriggerDump>::SharedPtr
+    pretrigger_dump_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::CorrectionCapture>::SharedPtr
+    correction_capture_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::PtpSyncTrigger>::SharedPtr
+    ptp_sync_trigger_service_;
   rclcpp::Service<vimbax_camera_msgs::srv::Status>::SharedPtr
     status_service_;
   rclcpp::Service<vimbax_camera_msgs::srv::StreamStartStop>::SharedPtr
@@ -212,6 +465,12 @@ private:
     stream_stop_service_;
   rclcpp::Service<vimbax_camera_msgs::srv::ConnectionStatus>::SharedPtr
     connection_status_service_;
+  rclcpp::Service<vimbax_camera_msgs::srv::CamerasList>::SharedPtr
+    cameras_list_service_;
+
+  // Actions
+  rclcpp_action::Server<vimbax_camera_msgs::action::BurstCapture>::SharedPtr
+    burst_capture_action_server_;
 
   vimbax_camera_events::EventPublisher<std_msgs::msg::Empty>::SharedPtr
     feature_invalidation_event_publisher_;
@@ -219,6 +478,74 @@ private:
   vimbax_camera_events::EventPublisher<vimbax_camera_msgs::msg::EventData>::SharedPtr
     event_event_publisher_;
 
+  vimbax_camera_events::EventPublisher<vimbax_camera_msgs::msg::TypedEventData>::SharedPtr
+    typed_event_publisher_;
+
+  std::mutex feature_invalidation_listeners_mutex_{};
+  std::unordered_map<std::string, VimbaXCamera::InvalidationListenerId>
+  feature_invalidation_listeners_;
+
+  // Frames of the first stream are written to the recorder while a recording is active
+  std::mutex recorder_mutex_{};
+  std::shared_ptr<FrameRecorder> recorder_;
+
+  // Only created if a pre-trigger duration or size is configured, fed with the frames of the
+  // first stream
+  std::shared_ptr<PreTriggerRing> pretrigger_ring_;
+
+  // Recreated on every stream start if shared memory slots are configured, so slots held by
+  // crashed clients don't stay blocked
+  std::mutex shared_frame_ring_mutex_{};
+  std::shared_ptr<SharedFrameRing> shared_frame_ring_;
+  uint32_t shared_frame_ring_count_{0};
+  uint64_t shared_frames_dropped_{0};
+
+  // Loaded from correction_file or created by correction/capture, set on the camera while
+  // correction_enable is set
+  std::mutex pixel_correction_mutex_{};
+  std::shared_ptr<const PixelCorrection> pixel_correction_;
+
+  // Frames of the first stream are averaged while a correction capture is active
+  std::atomic_bool correction_capture_active_{false};
+  std::mutex correction_capture_mutex_{};
+  std::condition_variable correction_capture_cv_{};
+  std::unique_ptr<FrameAverage> correction_capture_;
+  int32_t correction_capture_error_{VmbErrorSuccess};
+
+  // Changes queued through features/queue_set, applied by the frame callback of the first stream
+  // and by the auto exposure
+  std::unique_ptr<FeatureChangeQueue> feature_change_queue_;
+
+  // Created on stream start if auto_exposure is enabled, only used by the frame callback of
+  // the first stream while streaming. Declared after the change queue it writes through.
+  std::shared_ptr<AutoExposureController> auto_exposure_controller_;
+
+  // Shared with the other cameras of the frame set in this process, the first member publishes
+  // the sets
+  std::shared_ptr<FrameSetAggregator> frame_set_;
+  std::size_t frame_set_member_{0};
+  // Released sets waiting for the publish worker of the first member
+  std::mutex frame_set_publish_mutex_;
+  std::condition_variable frame_set_publish_cv_;
+  std::deque<std::pair<FrameSetAggregator::Set, FrameSetAggregator::Statistics>>
+  frame_set_publish_queue_;
+  std::unique_ptr<std::thread> frame_set_publish_thread_;
+
+  // Shared with the other cameras of the PTP sync group in this process, the first member
+  // publishes the status and skew
+  std::shared_ptr<PtpSyncGroup> ptp_sync_;
+  std::size_t ptp_sync_member_{0};
+
+  std::chrono::milliseconds frame_correlation_timeout_{};
+  // Only accessed by the thread of the correlator
+  uint64_t frame_correlation_dropped_{0};
+  // Only created if frame correlation events are configured. Declared after the members its
+  // thread uses, so it is stopped before they are destroyed.
+  std::unique_ptr<FrameEventCorrelator> frame_event_correlator_;
+
+  std::mutex event_subscriptions_mutex_{};
+  std::unordered_map<std::string, std::shared_ptr<EventSubscription>> event_subscriptions_;
+
   OnSetParametersCallbackHandle::SharedPtr parameter_callback_handle_;
 
   std::shared_ptr<camera_info_manager::CameraInfoManager> camera_info_manager_;
@@ -230,7 +557,11 @@ private:
 
   std::unique_ptr<std::thread> graph_notify_thread_;
   std::atomic_bool stop_threads_{false};
-  std::optional<uint64_t> last_frame_id_{};
+  // Burst capture goals run on their own threads, the destructor waits for all of them
+  std::mutex burst_capture_mutex_{};
+  std::condition_variable burst_capture_cv_{};
+  uint32_t burst_capture_threads_{0};
+  std::vector<std::optional<uint64_t>> last_frame_id_{};
 };
 
 }  // namespace vimbax_camera
@@ -0,0 +1,81 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_PLAYBACK_NODE_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_PLAYBACK_NODE_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <image_transport/image_transport.hpp>
+
+#include <vimbax_camera/vimbax_camera_recorder.hpp>
+
+namespace vimbax_camera
+{
+class VimbaXCameraPlaybackNode
+{
+public:
+  using NodeBaseInterface = rclcpp::node_interfaces::NodeBaseInterface;
+  explicit VimbaXCameraPlaybackNode(const rclcpp::NodeOptions & options = rclcpp::NodeOptions{});
+  ~VimbaXCameraPlaybackNode();
+
+  NodeBaseInterface::SharedPtr get_node_base_interface() const;
+
+private:
+  const std::string parameter_filename = "filename";
+  const std::string parameter_rate = "rate";
+  const std::string parameter_loop = "loop";
+
+  bool initialize(const rclcpp::NodeOptions & options);
+  bool initialize_parameters();
+  bool initialize_reader();
+  bool initialize_publisher();
+
+  void playback_thread_func();
+
+  rclcpp::Node::SharedPtr node_;
+  std::shared_ptr<RecordingReader> reader_;
+  image_transport::Publisher image_publisher_;
+
+  std::unique_ptr<std::thread> playback_thread_;
+  std::atomic_bool stop_threads_{false};
+  // Wakes up the playback thread waiting for the time of the next frame
+  std::mutex stop_mutex_{};
+  std::condition_variable stop_cv_{};
+};
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_PLAYBACK_NODE_HPP_
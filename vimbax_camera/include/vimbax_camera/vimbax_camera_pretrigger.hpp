@@ -0,0 +1,140 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_PRETRIGGER_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_PRETRIGGER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sensor_msgs/msg/image.hpp>
+
+#include <vimbax_camera/result.hpp>
+
+namespace vimbax_camera
+{
+
+// In memory ring of the most recent frames, limited by their time span and size. The frame
+// callback only copies the image into a pooled buffer, compression and dumps run on their
+// own threads, so neither stalls the stream.
+class PreTriggerRing
+{
+public:
+  struct Settings
+  {
+    // 0 disables the limit
+    uint64_t duration_ns;
+    std::size_t max_bytes;
+    // zlib level 1 to 9, 0 keeps the frames uncompressed
+    int compression_level;
+  };
+
+  struct Frame
+  {
+    int64_t frame_id;
+    uint64_t timestamp_ns;
+    // Size of the uncompressed data
+    std::size_t size;
+    bool compressed;
+    // image.data holds the compressed data if compressed is set
+    sensor_msgs::msg::Image image;
+  };
+
+  using Frames = std::vector<std::shared_ptr<const Frame>>;
+  using Consumer = std::function<void(const Frames &)>;
+
+  static result<std::shared_ptr<PreTriggerRing>> create(const Settings & settings);
+
+  ~PreTriggerRing();
+
+  PreTriggerRing(const PreTriggerRing &) = delete;
+  PreTriggerRing & operator=(const PreTriggerRing &) = delete;
+
+  void push(const sensor_msgs::msg::Image & image, int64_t frame_id, uint64_t timestamp_ns);
+
+  // Frames currently held, oldest first. They stay valid while the ring moves on.
+  Frames snapshot() const;
+
+  // Runs consumer with a snapshot on the dump thread and returns the number of frames.
+  // Fails with VmbErrorBusy while the previous dump is still running.
+  result<std::size_t> dump(Consumer consumer);
+
+  bool is_dumping() const;
+
+  // Copies the frame into image, decompressing the data if needed
+  static result<void> decode(const Frame & frame, sensor_msgs::msg::Image & image);
+
+  std::size_t byte_count() const;
+
+private:
+  // Number of evicted buffers kept for reuse
+  static constexpr std::size_t pool_size = 4;
+
+  struct Entry
+  {
+    uint64_t sequence;
+    std::shared_ptr<Frame> frame;
+  };
+
+  explicit PreTriggerRing(const Settings & settings);
+
+  std::vector<uint8_t> take_buffer(std::size_t size);
+  // Returns the buffer of frame to the pool, if it isn't referenced by a snapshot
+  void recycle(std::shared_ptr<Frame> && frame);
+  void evict();
+  void compressor_run();
+
+  Settings const settings_;
+
+  mutable std::mutex mutex_{};
+  std::condition_variable compressor_cv_{};
+  std::deque<Entry> entries_{};
+  std::size_t byte_count_{0};
+  uint64_t next_sequence_{0};
+  // Sequence of the next frame to compress
+  uint64_t compress_sequence_{0};
+  std::vector<std::vector<uint8_t>> pool_{};
+  bool stop_{false};
+  std::thread compressor_thread_{};
+
+  std::mutex dump_mutex_{};
+  std::atomic_bool dumping_{false};
+  std::thread dump_thread_{};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_PRETRIGGER_HPP_
@@ -0,0 +1,200 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_RECORDER_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_RECORDER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sensor_msgs/msg/image.hpp>
+
+#include <vimbax_camera/result.hpp>
+#include <vimbax_camera/loader/vmbc_api.hpp>
+
+namespace vimbax_camera
+{
+
+// Raw recording container (all values little endian):
+//   header block   4096 bytes: magic "VXRC", version, metadata strings
+//   frame records  record header followed by the image data, each 8 byte aligned
+//   index          one entry (frame id, timestamp, record offset) per frame
+//   footer         index offset, frame count and magic "VXRI" at the very end of the file
+// The file is written in large chunks at block aligned offsets and the index is padded so
+// the file size is a multiple of the block size, which allows writing it with O_DIRECT.
+namespace recording
+{
+constexpr std::size_t block_size = 4096;
+constexpr uint32_t version = 1;
+
+struct Metadata
+{
+  std::string camera_model;
+  std::string camera_id;
+  std::string frame_id;
+  uint64_t created_ns;
+};
+}  // namespace recording
+
+class FrameRecorder
+{
+public:
+  struct Statistics
+  {
+    uint64_t frames_written;
+    uint64_t frames_dropped;
+    uint64_t bytes_written;
+  };
+
+  static result<std::shared_ptr<FrameRecorder>> create(
+    const std::string & filename, const recording::Metadata & metadata,
+    std::size_t chunk_size = 64 * 1024 * 1024, std::size_t chunk_count = 4);
+
+  ~FrameRecorder();
+
+  FrameRecorder(const FrameRecorder &) = delete;
+  FrameRecorder & operator=(const FrameRecorder &) = delete;
+
+  // Copies the image into the current chunk. Chunks are written to disk by the writer thread,
+  // so this never waits for the disk. If no chunk is free the frame is dropped, unless wait is
+  // set, then it waits until the writer thread freed enough chunks.
+  bool write(
+    const sensor_msgs::msg::Image & image, int64_t frame_id, uint64_t timestamp_ns,
+    bool wait = false);
+
+  // Writes the remaining frames and the index
+  result<Statistics> close();
+
+  Statistics statistics() const;
+
+private:
+  struct AlignedFree
+  {
+    void operator()(uint8_t * ptr) const;
+  };
+
+  using Chunk = std::unique_ptr<uint8_t, AlignedFree>;
+
+  struct IndexEntry
+  {
+    int64_t frame_id;
+    uint64_t timestamp_ns;
+    uint64_t offset;
+  };
+
+  FrameRecorder(int fd, std::size_t chunk_size);
+
+  static Chunk allocate_chunk(std::size_t size);
+
+  // Copies data behind the current write position, continuing in the next free chunk
+  void append(const void * data, std::size_t size);
+  void append_padding(std::size_t size);
+  // Hands the current chunk to the writer thread
+  void submit_chunk(std::size_t used);
+  result<void> write_block(const uint8_t * data, std::size_t size, uint64_t offset);
+  void writer_run();
+
+  int fd_;
+  std::size_t const chunk_size_;
+  std::size_t chunk_count_{0};
+
+  // Only accessed by the thread calling write
+  Chunk current_chunk_{};
+  std::size_t current_used_{0};
+  // Offset of the next record in the file
+  uint64_t stream_offset_{recording::block_size};
+  std::vector<IndexEntry> index_{};
+  bool closed_{false};
+
+  mutable std::mutex chunks_mutex_{};
+  std::condition_variable chunks_cv_{};
+  std::vector<Chunk> free_chunks_{};
+  std::deque<std::pair<Chunk, std::size_t>> full_chunks_{};
+  bool writer_stop_{false};
+  std::optional<error> writer_error_{};
+  std::thread writer_thread_{};
+
+  std::atomic_uint64_t frames_written_{0};
+  std::atomic_uint64_t frames_dropped_{0};
+  std::atomic_uint64_t bytes_written_{0};
+};
+
+// Memory mapped read access to a recording
+class RecordingReader
+{
+public:
+  struct FrameView
+  {
+    int64_t frame_id;
+    uint64_t timestamp_ns;
+    uint32_t width;
+    uint32_t height;
+    uint32_t step;
+    bool is_bigendian;
+    std::string_view encoding;
+    const uint8_t * data;
+    std::size_t size;
+  };
+
+  static result<std::shared_ptr<RecordingReader>> open(const std::string & filename);
+
+  ~RecordingReader();
+
+  RecordingReader(const RecordingReader &) = delete;
+  RecordingReader & operator=(const RecordingReader &) = delete;
+
+  const recording::Metadata & metadata() const;
+
+  std::size_t frame_count() const;
+
+  result<FrameView> frame(std::size_t index) const;
+
+private:
+  RecordingReader(const uint8_t * data, std::size_t size);
+
+  result<void> parse();
+
+  const uint8_t * data_;
+  std::size_t size_;
+  recording::Metadata metadata_{};
+  std::vector<uint64_t> record_offsets_{};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_RECORDER_HPP_
@@ -0,0 +1,131 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_RECTIFY_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_RECTIFY_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+#include <vimbax_camera/result.hpp>
+
+namespace vimbax_camera
+{
+
+// Remap table from the rectified image to the raw image of one calibration and image format.
+// Every pixel stores the byte offset of its top left source pixel and the bilinear fractions
+// in 7 bit fixed point.
+class RectifyMap
+{
+public:
+  static constexpr uint32_t fraction_bits = 7;
+
+  // Supports the plumb_bob, rational_polynomial and equidistant models for mono8, mono16, rgb8
+  // and bgr8 images. Fails with VmbErrorNotSupported for other models and encodings and with
+  // VmbErrorInvalidValue if the camera is not calibrated for the image size.
+  static result<std::shared_ptr<const RectifyMap>> create(
+    const sensor_msgs::msg::CameraInfo & camera_info, const sensor_msgs::msg::Image & image);
+
+  // True if the map was created for the calibration and the format of the image
+  bool matches(
+    const sensor_msgs::msg::CameraInfo & camera_info,
+    const sensor_msgs::msg::Image & image) const;
+
+  // Fills the tile of the rectified image, which must have the size and format of the image
+  void remap(
+    const sensor_msgs::msg::Image & image, sensor_msgs::msg::Image & rectified, uint32_t x,
+    uint32_t y, uint32_t width, uint32_t height) const;
+
+  uint32_t width() const;
+  uint32_t height() const;
+  uint32_t bytes_per_pixel() const;
+
+private:
+  RectifyMap() = default;
+
+  sensor_msgs::msg::CameraInfo camera_info_{};
+  std::string encoding_{};
+  uint32_t step_{0};
+  uint32_t channels_{0};
+  uint32_t bytes_per_channel_{0};
+  std::vector<int32_t> offsets_{};
+  std::vector<uint16_t> fractions_{};
+};
+
+// Rectifies images in tiles on a pool of worker threads together with the calling thread. The
+// map is rebuilt whenever the calibration or the image format changes.
+class Rectifier
+{
+public:
+  static constexpr uint32_t tile_width = 256;
+  static constexpr uint32_t tile_height = 16;
+
+  explicit Rectifier(uint32_t thread_count);
+  ~Rectifier();
+
+  Rectifier(const Rectifier &) = delete;
+  Rectifier & operator=(const Rectifier &) = delete;
+
+  // The header of the rectified image is copied from the image
+  result<void> process(
+    const sensor_msgs::msg::Image & image, const sensor_msgs::msg::CameraInfo & camera_info,
+    sensor_msgs::msg::Image & rectified);
+
+private:
+  void worker_run();
+  void run_tiles();
+
+  std::shared_ptr<const RectifyMap> map_;
+
+  std::mutex mutex_{};
+  std::condition_variable job_cv_{};
+  std::condition_variable done_cv_{};
+  const sensor_msgs::msg::Image * image_{nullptr};
+  sensor_msgs::msg::Image * rectified_{nullptr};
+  uint32_t tile_columns_{0};
+  uint32_t tile_count_{0};
+  std::atomic_uint32_t next_tile_{0};
+  uint64_t job_{0};
+  std::size_t pending_{0};
+  bool stop_{false};
+  std::vector<std::thread> workers_{};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_RECTIFY_HPP_
@@ -0,0 +1,114 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_ROI_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_ROI_HPP_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/region_of_interest.hpp>
+
+#include <vimbax_camera/result.hpp>
+
+namespace vimbax_camera
+{
+
+// Software region of interest cut out of every frame of the first stream
+struct Roi
+{
+  std::string name;
+  uint32_t x;
+  uint32_t y;
+  uint32_t width;
+  uint32_t height;
+
+  // Parses a name=x,y,width,height definition
+  static result<Roi> parse(const std::string & definition);
+
+  // Strided copy of the region, returns the region actually cut. Offsets of Bayer and YUV
+  // images are rounded down to even values to keep the color pattern. Fails if the region is
+  // not inside the image.
+  result<sensor_msgs::msg::RegionOfInterest> crop(
+    const sensor_msgs::msg::Image & image, sensor_msgs::msg::Image & roi_image) const;
+};
+
+// Crops the regions on one worker thread per region, so the cropping runs in parallel with
+// publishing the full image. The image must stay unchanged until wait returned.
+class RoiPipeline
+{
+public:
+  using PublishFunction = std::function<void(
+        std::size_t index, const sensor_msgs::msg::Image & image,
+        const sensor_msgs::msg::CameraInfo & camera_info)>;
+
+  RoiPipeline(std::vector<Roi> rois, PublishFunction publish);
+  ~RoiPipeline();
+
+  RoiPipeline(const RoiPipeline &) = delete;
+  RoiPipeline & operator=(const RoiPipeline &) = delete;
+
+  const std::vector<Roi> & rois() const;
+
+  // Starts cropping the regions flagged in active
+  void process(
+    const sensor_msgs::msg::Image & image, const sensor_msgs::msg::CameraInfo & camera_info,
+    const std::vector<bool> & active);
+
+  // Waits until all regions started by process are published
+  void wait();
+
+private:
+  void worker_run(std::size_t index);
+
+  std::vector<Roi> const rois_;
+  PublishFunction const publish_;
+
+  std::mutex mutex_{};
+  std::condition_variable job_cv_{};
+  std::condition_variable done_cv_{};
+  const sensor_msgs::msg::Image * image_{nullptr};
+  const sensor_msgs::msg::CameraInfo * camera_info_{nullptr};
+  std::vector<bool> active_{};
+  uint64_t job_{0};
+  std::size_t pending_{0};
+  bool stop_{false};
+  std::vector<std::thread> workers_{};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_ROI_HPP_
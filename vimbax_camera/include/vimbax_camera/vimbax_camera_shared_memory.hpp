@@ -0,0 +1,160 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_SHARED_MEMORY_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_SHARED_MEMORY_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <sensor_msgs/msg/image.hpp>
+
+#include <vimbax_camera_msgs/msg/shared_frame.hpp>
+
+#include <vimbax_camera/result.hpp>
+
+namespace vimbax_camera
+{
+
+// Shared memory segment (native byte order, only shared between processes on one host):
+//   segment header  magic "VXSM", version, slot count, slot capacity
+//   slots           slot header followed by the image data, each 64 byte aligned
+// A slot generation is odd while the node writes the slot and even once it is complete.
+// Clients lease a slot by entering their PID in one of its reader entries, the node only
+// overwrites slots without leases, so an acquired frame stays valid until it is destroyed.
+// Leases of processes that no longer exist are reclaimed by the node, so a crashed client
+// doesn't pin its slots. This requires the clients to share the PID namespace of the node.
+namespace shared_memory
+{
+constexpr uint32_t version = 2;
+constexpr std::size_t alignment = 64;
+// Frames of one slot that can be held at the same time by all clients together
+constexpr std::size_t max_slot_readers = 16;
+
+struct SegmentHeader;
+struct SlotHeader;
+}  // namespace shared_memory
+
+// Ring of frame slots written by the camera node
+class SharedFrameRing
+{
+public:
+  struct Slot
+  {
+    uint32_t index;
+    uint64_t generation;
+  };
+
+  // The segment is created with the given name, an existing segment is replaced
+  static result<std::shared_ptr<SharedFrameRing>> create(
+    const std::string & name, std::size_t slot_size, uint32_t slot_count);
+
+  ~SharedFrameRing();
+
+  SharedFrameRing(const SharedFrameRing &) = delete;
+  SharedFrameRing & operator=(const SharedFrameRing &) = delete;
+
+  // Copies the image into the next slot not held by a client. Returns nothing if the image
+  // doesn't fit or every slot is held. Leases of exited clients are released on the way.
+  std::optional<Slot> write(const sensor_msgs::msg::Image & image);
+
+  const std::string & name() const;
+
+  std::size_t slot_size() const;
+
+  uint32_t slot_count() const;
+
+private:
+  SharedFrameRing(
+    std::string name, uint8_t * data, std::size_t size, std::size_t slot_size,
+    uint32_t slot_count);
+
+  shared_memory::SlotHeader * slot_header(uint32_t index) const;
+
+  std::string const name_;
+  uint8_t * const data_;
+  std::size_t const size_;
+  std::size_t const slot_size_;
+  uint32_t const slot_count_;
+  uint32_t next_slot_{0};
+};
+
+// Client side of the ring, maps the segment announced by the frame descriptors
+class SharedFrameClient
+{
+public:
+  struct Mapping;
+
+  // Image in a slot of the ring. The slot is released when the frame is destroyed.
+  class Frame
+  {
+public:
+    ~Frame();
+
+    Frame(const Frame &) = delete;
+    Frame & operator=(const Frame &) = delete;
+
+    uint32_t width() const;
+    uint32_t height() const;
+    uint32_t step() const;
+    bool is_bigendian() const;
+    std::string_view encoding() const;
+    const uint8_t * data() const;
+    std::size_t size() const;
+
+private:
+    friend class SharedFrameClient;
+
+    Frame(std::shared_ptr<Mapping> mapping, shared_memory::SlotHeader * slot, std::size_t lease);
+
+    std::shared_ptr<Mapping> mapping_;
+    shared_memory::SlotHeader * slot_;
+    // Index of the reader entry holding the PID of this process
+    std::size_t lease_;
+  };
+
+  // Maps the segment of the descriptor on first use and whenever the node created a new one.
+  // Fails with VmbErrorNotAvailable if the slot was already overwritten and with VmbErrorBusy
+  // if max_slot_readers frames of the slot are already held.
+  result<std::shared_ptr<const Frame>> acquire(
+    const vimbax_camera_msgs::msg::SharedFrame & descriptor);
+
+private:
+  result<void> map(const std::string & name);
+
+  // Frames keep the mapping they were acquired from alive
+  std::shared_ptr<Mapping> mapping_;
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_SHARED_MEMORY_HPP_
@@ -0,0 +1,71 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_STATISTICS_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_STATISTICS_HPP_
+
+#include <array>
+#include <cstdint>
+
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/region_of_interest.hpp>
+
+#include <vimbax_camera/result.hpp>
+
+namespace vimbax_camera
+{
+
+// Brightness, saturation and sharpness of a mono or Bayer image. Values are normalized to the
+// full scale of the bit depth, so they don't change with the pixel format.
+struct ImageStatistics
+{
+  static constexpr std::size_t histogram_bins = 256;
+
+  // Samples every stride-th pixel, or 2x2 cell for Bayer images, in both directions of the
+  // region. An empty region selects the whole image. Fails with VmbErrorNotSupported for
+  // encodings other than mono and Bayer with 8 or 16 bit.
+  static result<ImageStatistics> compute(
+    const sensor_msgs::msg::Image & image, uint32_t bit_depth, uint32_t stride = 1,
+    const sensor_msgs::msg::RegionOfInterest & region = {});
+
+  uint64_t sample_count;
+  double mean;
+  // Red, green and blue, all equal to mean for mono images
+  std::array<double, 3> channel_means;
+  // Share of the samples at the maximum value of the bit depth
+  double saturation_ratio;
+  // Mean squared difference of same color pixels two columns apart (Brenner gradient)
+  double sharpness;
+  // Bins over the full scale
+  std::array<uint32_t, histogram_bins> histogram;
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_STATISTICS_HPP_
@@ -0,0 +1,176 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef VIMBAX_CAMERA__VIMBAX_CAMERA_SYNC_HPP_
+#define VIMBAX_CAMERA__VIMBAX_CAMERA_SYNC_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vimbax_camera/result.hpp>
+#include <vimbax_camera/vimbax_camera.hpp>
+
+namespace vimbax_camera
+{
+
+// Synchronizes the GigE Vision cameras of one process with IEEE 1588 (PTP) and triggers them at
+// the same time with a scheduled action command. Cameras join a group by name like frame sets,
+// the group monitors their PTP state and measures the skew of the frames of every action.
+class PtpSyncGroup
+{
+public:
+  struct Settings
+  {
+    std::vector<std::string> members;
+    // Keys and mask configured on the cameras and sent with the action command
+    uint32_t device_key;
+    uint32_t group_key;
+    uint32_t group_mask;
+    // Zero disables monitoring
+    std::chrono::milliseconds monitor_interval;
+
+    bool operator==(const Settings & other) const;
+  };
+
+  struct CameraStatus
+  {
+    // False if the member has no opened camera
+    bool attached;
+    // Value of PtpStatus, e.g. Slave, Master or Listening
+    std::string status;
+    std::optional<int64_t> offset_from_master_ns;
+    // The camera is Master or a calibrated Slave
+    bool locked;
+  };
+
+  struct Status
+  {
+    // Indexed like the members
+    std::vector<CameraStatus> cameras;
+    // All members are attached and locked
+    bool locked;
+  };
+
+  struct Skew
+  {
+    uint64_t action_time_ns;
+    // Time from the action to the timestamp of the first frame of each member
+    std::vector<std::optional<int64_t>> latency_ns;
+    // Difference of the last and the first frame timestamp
+    uint64_t skew_ns;
+    // Every attached member delivered a frame
+    bool complete;
+  };
+
+  using StatusFunction = std::function<void(const Status & status)>;
+  using SkewFunction = std::function<void(const Skew & skew)>;
+
+  // Returns the group of that name, creating it on the first call. Fails with
+  // VmbErrorInvalidValue if it exists with other settings or the settings are invalid.
+  static result<std::shared_ptr<PtpSyncGroup>> join(
+    const std::string & name, const Settings & settings);
+
+  ~PtpSyncGroup();
+
+  PtpSyncGroup(const PtpSyncGroup &) = delete;
+  PtpSyncGroup & operator=(const PtpSyncGroup &) = delete;
+
+  std::optional<std::size_t> member_index(const std::string & member) const;
+
+  // Enables PTP on the camera and switches its frame start trigger to the action command. The
+  // group only keeps a weak reference, so closed cameras are reported as detached.
+  result<void> attach(std::size_t member, const std::shared_ptr<VimbaXCamera> & camera);
+  // Waits until the group doesn't use the camera anymore, must be called before the camera is
+  // closed or reopened
+  void detach(std::size_t member);
+
+  // Called from the monitor thread after every interval
+  void set_status_callback(StatusFunction callback);
+  // Called from the thread adding the last frame of an action, or from schedule() if the
+  // previous action is still incomplete
+  void set_skew_callback(SkewFunction callback);
+
+  // Reads the PTP state of all attached cameras
+  Status status() const;
+
+  // Sends an action command executed by all cameras at the PTP time of the first attached
+  // camera plus delay. Returns the scheduled time in ns.
+  result<uint64_t> schedule(std::chrono::nanoseconds delay);
+
+  // Reports the timestamp of a received frame of the member, frames before the last action are
+  // ignored
+  void add_timestamp(std::size_t member, uint64_t timestamp_ns);
+
+private:
+  PtpSyncGroup(std::string name, Settings settings);
+
+  struct PendingAction
+  {
+    uint64_t action_time_ns;
+    // Members attached when the action was sent
+    std::vector<bool> expected;
+    std::vector<std::optional<uint64_t>> timestamps;
+  };
+
+  static CameraStatus camera_status(const VimbaXCamera & camera);
+
+  std::vector<std::shared_ptr<VimbaXCamera>> cameras() const;
+  static Skew release(PendingAction && pending);
+
+  void run();
+
+  std::string const name_;
+  Settings const settings_;
+
+  // Held while the attached cameras are used and until the references to them are dropped, so
+  // they are neither accessed nor destroyed by the group after detach()
+  mutable std::mutex access_mutex_{};
+  mutable std::mutex mutex_{};
+  std::condition_variable cv_{};
+  std::vector<std::weak_ptr<VimbaXCamera>> cameras_{};
+  std::optional<PendingAction> pending_{};
+  bool stop_{false};
+  // Held while calling the callbacks, so they aren't called anymore once they were reset
+  std::mutex callback_mutex_{};
+  StatusFunction status_callback_{};
+  SkewFunction skew_callback_{};
+  std::thread thread_{};
+};
+
+}  // namespace vimbax_camera
+
+#endif  // VIMBAX_CAMERA__VIMBAX_CAMERA_SYNC_HPP_
@@ -26,6 +26,8 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <array>
 #include <optional>
 #include <filesystem>
 #include <regex>
@@ -41,43 +43,14 @@ namespace vimbax_camera
 using helper::get_logger;
 using helper::vmb_error_to_string;
 
-std::optional<uint32_t> decode_ip_addr(const std::string & ip_addr_str)
+namespace
 {
-  const std::regex ip_addr_regex{"([0-9]{1,3}).([0-9]{1,3}).([0-9]{1,3}).([0-9]{1,3})"};
-  std::smatch match;
-  if (!std::regex_match(ip_addr_str, match, ip_addr_regex)) {
-    return {};
-  }
-
-  uint32_t ip_addr = uint32_t(std::stoi(match[1]) & 0xFF) << 24 |
-    uint32_t(std::stoi(match[2]) & 0xFF) << 16 |
-    uint32_t(std::stoi(match[3]) & 0xFF) << 8 |
-    uint32_t(std::stoi(match[4]) & 0xFF);
-
-  return ip_addr;
-}
-
-
-std::optional<uint64_t> decode_mac_addr(const std::string & mac_addr_str)
-{
-  // Matching formats: aa:bb:cc:dd:ee:ff, aa-bb-cc-dd-ee-ff, aabbccddeeff
-  const std::regex mac_addr_regex{
-    "([0-9a-zA-Z]{2})[:-]?([0-9a-zA-Z]{2})[:-]?([0-9a-zA-Z]{2})[:-]?"
-    "([0-9a-zA-Z]{2})[:-]?([0-9a-zA-Z]{2})[:-]?([0-9a-zA-Z]{2})"};
-  std::smatch match;
-  if (!std::regex_match(mac_addr_str, match, mac_addr_regex)) {
-    return {};
-  }
-
-  uint64_t mac_addr = uint64_t(std::stoi(match[1], 0, 16) & 0xFF) << 40 |
-    uint64_t(std::stoi(match[2], 0, 16) & 0xFF) << 32 |
-    uint64_t(std::stoi(match[3], 0, 16) & 0xFF) << 24 |
-    uint64_t(std::stoi(match[4], 0, 16) & 0xFF) << 16 |
-    uint64_t(std::stoi(match[5], 0, 16) & 0xFF) << 8 |
-    uint64_t(std::stoi(match[6], 0, 16) & 0xFF);
-
-  return mac_addr;
-}
+// Commands loading or resetting the configuration change arbitrary feature values, so the
+// value cache is cleared after them. All other commands (e.g. TriggerSoftware or the latches)
+// rely on the invalidation callbacks.
+constexpr std::array<std::string_view, 4> cache_clearing_commands{
+  "UserSetLoad", "SequencerSetLoad", "DeviceReset", "DeviceFactoryReset"};
+}  // namespace
 
 std::optional<std::string> get_camera_id_from_addr(
   std::shared_ptr<VmbCAPI> api,
@@ -163,7 +136,9 @@ std::optional<std::string> get_camera_id_from_addr(
 
 std::shared_ptr<VimbaXCamera> VimbaXCamera::open(
   std::shared_ptr<VmbCAPI> api,
-  const std::string & name)
+  const std::string & name,
+  std::shared_ptr<const VimbaXCameraIndex> index,
+  const ReopenResources & reopen_resources)
 {
   auto check_access = [](const VmbCameraInfo_t & info) {
       return (info.permittedAccess & VmbAccessModeType::VmbAccessModeExclusive) != 0;
@@ -185,6 +160,24 @@ std::shared_ptr<VimbaXCamera> VimbaXCamera::open(
       return camera_handle;
     };
 
+  if (index && !name.empty()) {
+    auto const entry = index->find(name);
+
+    if (entry && (entry->permitted_access & VmbAccessModeExclusive) != 0) {
+      RCLCPP_INFO(
+        get_logger(), "Opening camera with extended id %s from camera index",
+        entry->extended_id.c_str());
+
+      auto const opt_handle = open_camera(entry->extended_id);
+
+      if (opt_handle) {
+        return std::unique_ptr<VimbaXCamera>(new VimbaXCamera{api, *opt_handle, reopen_resources});
+      }
+    }
+
+    RCLCPP_DEBUG(get_logger(), "Camera %s not found in camera index", name.c_str());
+  }
+
   auto const available_cameras =
     [&]() -> std::vector<VmbCameraInfo_t> {
       uint32_t available_cameras_count{0};
@@ -229,7 +222,8 @@ std::shared_ptr<VimbaXCamera> VimbaXCamera::open(
         auto const opt_handle = open_camera(info.cameraIdExtended);
 
         if (opt_handle) {
-          return std::unique_ptr<VimbaXCamera>(new VimbaXCamera{api, *opt_handle});
+          return std::unique_ptr<VimbaXCamera>(
+            new VimbaXCamera{api, *opt_handle, reopen_resources});
         }
       }
     }
@@ -251,7 +245,8 @@ std::shared_ptr<VimbaXCamera> VimbaXCamera::open(
           auto const opt_handle = open_camera(info.cameraIdExtended);
 
           if (opt_handle) {
-            return std::unique_ptr<VimbaXCamera>(new VimbaXCamera{api, *opt_handle});
+            return std::unique_ptr<VimbaXCamera>(
+              new VimbaXCamera{api, *opt_handle, reopen_resources});
           }
         }
       }
@@ -264,7 +259,7 @@ std::shared_ptr<VimbaXCamera> VimbaXCamera::open(
       auto const opt_handle = open_camera(*opt_id_by_addr);
 
       if (opt_handle) {
-        return std::unique_ptr<VimbaXCamera>(new VimbaXCamera{api, *opt_handle});
+        return std::unique_ptr<VimbaXCamera>(new VimbaXCamera{api, *opt_handle, reopen_resources});
       }
     }
 
@@ -273,7 +268,7 @@ std::shared_ptr<VimbaXCamera> VimbaXCamera::open(
     auto const opt_handle = open_camera(name);
 
     if (opt_handle) {
-      return std::unique_ptr<VimbaXCamera>(new VimbaXCamera{api, *opt_handle});
+      return std::unique_ptr<VimbaXCamera>(new VimbaXCamera{api, *opt_handle, reopen_resources});
     }
 
     RCLCPP_ERROR(get_logger(), "Failed to open given camera %s", name.c_str());
@@ -282,9 +277,14 @@ std::shared_ptr<VimbaXCamera> VimbaXCamera::open(
   return nullptr;
 }
 
-VimbaXCamera::VimbaXCamera(std::shared_ptr<VmbCAPI> api, VmbHandle_t camera_handle)
-: api_{std::move(api)}, camera_handle_{camera_handle}
+VimbaXCamera::VimbaXCamera(
+  std::shared_ptr<VmbCAPI> api, VmbHandle_t camera_handle,
+  const ReopenResources & reopen_resources)
+: api_{std::move(api)}, camera_handle_{camera_handle},
+  frame_buffer_pool_{reopen_resources.frame_buffer_pool}
 {
+  auto const start_tp = std::chrono::steady_clock::now();
+
   auto const err =
     api_->CameraInfoQueryByHandle(camera_handle_, &camera_info_, sizeof(camera_info_));
 
@@ -298,12 +298,45 @@ VimbaXCamera::VimbaXCamera(std::shared_ptr<VmbCAPI> api, VmbHandle_t camera_hand
 
   RCLCPP_INFO(get_logger(), "Camera extended id %s", camera_info_.cameraIdExtended);
 
-  initialize_feature_map(Module::System);
-  initialize_feature_map(Module::Interface);
-  initialize_feature_map(Module::LocalDevice);
-  initialize_feature_map(Module::RemoteDevice);
-  initialize_feature_map(Module::Stream);
+  // VmbC accepts the camera handle as an alias for the first stream, so stream 0 keeps using it
+  // for the capture calls. All other streams are addressed by their own stream handle.
+  auto const stream_count =
+    (err == VmbErrorSuccess && camera_info_.streamHandles) ? camera_info_.streamCount : 0;
 
+  for (uint32_t i = 0; i < std::max(stream_count, 1U); i++) {
+    auto stream = std::make_unique<StreamContext>();
+    stream->handle = (i < stream_count) ? camera_info_.streamHandles[i] : nullptr;
+    stream->capture_handle = (i == 0) ? camera_handle_ : stream->handle;
+    streams_.push_back(std::move(stream));
+  }
+
+  RCLCPP_INFO(get_logger(), "Camera provides %u stream(s)", stream_count);
+
+  if (!frame_buffer_pool_) {
+    frame_buffer_pool_ = std::make_shared<FrameBufferPool>();
+  }
+
+  auto const feature_metadata_reused = reuse_feature_metadata(reopen_resources.feature_metadata);
+
+  if (!feature_metadata_reused) {
+    feature_metadata_ = std::make_shared<FeatureMetadata>();
+    feature_metadata_->device_id = camera_info_.cameraIdString ? camera_info_.cameraIdString : "";
+
+    auto const firmware_version =
+      api_->feature_string_get(camera_handle_, SFNCFeatures::DeviceFirmwareVersion);
+
+    feature_metadata_->firmware_version = firmware_version ? *firmware_version : "";
+
+    // Large GenICam trees make building the feature maps the most expensive part of opening a
+    // camera, so all modules are listed concurrently
+    for (std::size_t module = 0; module < std::size_t(Module::ModuleMax); module++) {
+      feature_map_init_futures_.push_back(
+        std::async(
+          std::launch::async, [this, module] {
+            feature_info_map(Module(module));
+          }));
+    }
+  }
 
   if (has_feature(SFNCFeatures::DeviceTimestampFrequency, Module::LocalDevice)) {
     auto const handle = get_module_handle(Module::LocalDevice);
@@ -315,29 +348,114 @@ VimbaXCamera::VimbaXCamera(std::shared_ptr<VmbCAPI> api, VmbHandle_t camera_hand
     }
   }
 
-  if (has_feature(SFNCFeatures::GVSPAdjustPacketSize, Module::Stream)) {
-    auto const result =
-      feature_command_run(SFNCFeatures::GVSPAdjustPacketSize, get_module_handle(Module::Stream));
-    if (!result) {
-      RCLCPP_INFO(
-        get_logger(),
-        "Packet size adjustment failed with %s",
-        vmb_error_to_string(result.error().code).data());
-    }
+  adjust_packet_size();
+
+  RCLCPP_INFO(
+    get_logger(), "Camera initialization took %ld ms",
+    std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_tp).count());
+}
+
+bool VimbaXCamera::reuse_feature_metadata(
+  const std::shared_ptr<const FeatureMetadata> & feature_metadata)
+{
+  if (!feature_metadata || !camera_info_.cameraIdString ||
+    feature_metadata->device_id != camera_info_.cameraIdString)
+  {
+    return false;
+  }
+
+  auto const firmware_version =
+    api_->feature_string_get(camera_handle_, SFNCFeatures::DeviceFirmwareVersion);
+
+  if (!firmware_version || *firmware_version != feature_metadata->firmware_version) {
+    RCLCPP_INFO(get_logger(), "Firmware version changed, rebuilding feature maps");
+    return false;
+  }
+
+  if (feature_metadata->incomplete) {
+    RCLCPP_INFO(get_logger(), "Previous feature maps are incomplete, rebuilding them");
+    return false;
+  }
+
+  // The metadata is never modified once all maps are built, so marking the maps as built is
+  // enough to share it
+  feature_metadata_ = std::const_pointer_cast<FeatureMetadata>(feature_metadata);
+
+  for (auto & once : feature_map_once_) {
+    std::call_once(once, [] {});
   }
+
+  RCLCPP_INFO(get_logger(), "Reusing feature maps of previously opened camera");
+
+  return true;
+}
+
+void VimbaXCamera::adjust_packet_size()
+{
+  if (!has_feature(SFNCFeatures::GVSPAdjustPacketSize, Module::Stream)) {
+    return;
+  }
+
+  // Always adjusted again, the path to the reconnected camera might support another size
+  auto const result = feature_command_run(
+    SFNCFeatures::GVSPAdjustPacketSize, get_module_handle(Module::Stream));
+  if (!result) {
+    RCLCPP_INFO(
+      get_logger(),
+      "Packet size adjustment failed with %s",
+      vmb_error_to_string(result.error().code).data());
+  }
+}
+
+VimbaXCamera::ReopenResources VimbaXCamera::get_reopen_resources() const
+{
+  // All maps are built by the tasks started on open, waiting for them guarantees the metadata
+  // is complete even if the camera is already disconnected
+  for (auto const & future : feature_map_init_futures_) {
+    future.wait();
+  }
+
+  return {feature_metadata_, frame_buffer_pool_};
 }
 
 VimbaXCamera::~VimbaXCamera()
 {
+  for (auto const & future : feature_map_init_futures_) {
+    future.wait();
+  }
+
   if (is_alive()) {
     stop_streaming();
-  } else if (frame_processing_thread_) {
-    frame_processing_enable_.store(false);
-    frame_ready_cv_.notify_all();
-    frame_processing_thread_->join();
+  } else {
+    for (auto & stream : streams_) {
+      stop_frame_processing(*stream);
+    }
   }
 
   if (api_ && camera_handle_) {
+    if (auto const listeners = invalidation_listeners_.load()) {
+      for (auto const & [name, feature_listeners] : *listeners) {
+        api_->FeatureInvalidationUnregister(camera_handle_, name.c_str(), on_feature_invalidation);
+      }
+    }
+  }
+
+  invalidation_worker_stop();
+
+  {
+    std::lock_guard lock{invalidation_listeners_write_mutex_};
+    invalidation_listeners_reclaim(true);
+    delete invalidation_listeners_.exchange(nullptr);
+  }
+
+  if (api_ && camera_handle_) {
+    for (auto const & [handle, names] : feature_value_cache_registrations_) {
+      for (auto const & name : names) {
+        api_->FeatureInvalidationUnregister(handle, name.data(), on_feature_value_invalidation);
+      }
+    }
+
     api_->CameraClose(camera_handle_);
     camera_handle_ = nullptr;
   }
@@ -345,22 +463,84 @@ VimbaXCamera::~VimbaXCamera()
 
 void VimbaXCamera::initialize_feature_map(Module module)
 {
+  auto const start_tp = std::chrono::steady_clock::now();
   auto const handle = get_module_handle(module);
   VmbUint32_t feature_list_size{};
 
-  api_->FeaturesList(handle, nullptr, 0, &feature_list_size, 0);
+  auto const size_error = api_->FeaturesList(handle, nullptr, 0, &feature_list_size, 0);
 
   std::vector<VmbFeatureInfo_t> feature_list{};
-  feature_list.resize(feature_list_size);
+  feature_list.resize(size_error == VmbErrorSuccess ? feature_list_size : 0);
 
-  api_->FeaturesList(
+  auto const list_error = size_error != VmbErrorSuccess ? size_error : api_->FeaturesList(
     handle, feature_list.data(), feature_list.size(),
     &feature_list_size, sizeof(VmbFeatureInfo_t));
 
-  for (auto const & info : feature_list) {
-    feature_info_map_[std::size_t(module)].emplace(info.name, info);
-    feature_category_map_[std::size_t(module)].emplace(info.category, info.name);
+  // Features added since the size query are missing, but the listed ones are valid
+  if (list_error != VmbErrorSuccess && list_error != VmbErrorMoreData) {
+    RCLCPP_ERROR(
+      get_logger(), "Listing the features of module %zu failed with %d (%s)",
+      std::size_t(module), list_error, vmb_error_to_string(list_error).data());
+    feature_metadata_->incomplete = true;
+    return;
+  }
+
+  feature_list.resize(std::min<size_t>(feature_list_size, feature_list.size()));
+
+  auto & info_map = feature_metadata_->info_map[std::size_t(module)];
+  auto & category_map = feature_metadata_->category_map[std::size_t(module)];
+  auto & strings = feature_metadata_->interned_strings[std::size_t(module)];
+  auto & order = feature_metadata_->feature_order[std::size_t(module)];
+
+  info_map.reserve(feature_list.size());
+  category_map.reserve(feature_list.size());
+  order.reserve(feature_list.size());
+
+  // The strings of the infos are owned by the camera handle, interning them keeps the maps
+  // valid for a camera reopened after this one is closed
+  auto const intern = [&strings](const char * str) -> const char * {
+      return str ? strings.emplace_back(str).c_str() : nullptr;
+    };
+
+  for (auto info : feature_list) {
+    info.name = intern(info.name);
+    info.category = intern(info.category);
+    info.displayName = intern(info.displayName);
+    info.tooltip = intern(info.tooltip);
+    info.description = intern(info.description);
+    info.sfncNamespace = intern(info.sfncNamespace);
+    info.unit = intern(info.unit);
+    info.representation = intern(info.representation);
+
+    info_map.emplace(info.name, info);
+    category_map.emplace(info.category ? info.category : "", info.name);
+    order.emplace_back(info.name);
   }
+
+  RCLCPP_DEBUG(
+    get_logger(), "Feature map of module %zu with %zu features built in %ld us",
+    std::size_t(module), feature_list.size(),
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start_tp).count());
+}
+
+const std::unordered_map<std::string_view, VmbFeatureInfo> &
+VimbaXCamera::feature_info_map(Module module) const
+{
+  std::call_once(
+    feature_map_once_[std::size_t(module)], [this, module] {
+      const_cast<VimbaXCamera *>(this)->initialize_feature_map(module);
+    });
+
+  return feature_metadata_->info_map[std::size_t(module)];
+}
+
+const std::unordered_multimap<std::string, std::string> &
+VimbaXCamera::feature_category_map(Module module) const
+{
+  feature_info_map(module);
+
+  return feature_metadata_->category_map[std::size_t(module)];
 }
 
 constexpr VmbHandle_t VimbaXCamera::get_module_handle(Module module) const
@@ -383,9 +563,185 @@ constexpr VmbHandle_t VimbaXCamera::get_module_handle(Module module) const
   return nullptr;
 }
 
-VmbFeatureInfo VimbaXCamera::get_feature_info(const std::string & name, Module module) const
+VmbFeatureInfo VimbaXCamera::get_feature_info(const std::string_view & name, Module module) const
 {
-  return feature_info_map_[std::size_t(module)].at(name);
+  return feature_info_map(module).at(name);
+}
+
+VimbaXCamera::FeatureHandle VimbaXCamera::feature_handle_resolve(
+  const std::string_view & name, VmbHandle_t handle) const
+{
+  for (std::size_t module = 0; module < std::size_t(Module::ModuleMax); module++) {
+    if (get_module_handle(Module(module)) == handle) {
+      auto const & feature_map = feature_info_map(Module(module));
+      auto const it = feature_map.find(name);
+
+      if (it != feature_map.end()) {
+        return FeatureHandle{Module(module), handle, it->first.data(), &it->second, nullptr};
+      }
+
+      break;
+    }
+  }
+
+  // Features missing in the feature map (e.g. of additional streams) are accessed by name
+  // and never cached. The view isn't necessarily null terminated, so the name is copied.
+  auto owned_name = std::make_shared<const std::string>(name);
+  return FeatureHandle{Module::ModuleMax, handle, owned_name->c_str(), nullptr, owned_name};
+}
+
+template<typename T>
+result<T> VimbaXCamera::feature_value_cache_get(
+  const FeatureHandle & feature,
+  std::function<result<T>()> read_value,
+  bool bypass_cache) const
+{
+  if (!feature_value_cache_enabled_ || feature.info == nullptr ||
+    (feature.info->featureFlags & VmbFeatureFlagsVolatile) != 0)
+  {
+    return read_value();
+  }
+
+  auto const handle = feature.module_handle;
+  std::string_view const name{feature.name};
+
+  // A bypassing read still updates the cached value
+  if (!bypass_cache) {
+    std::lock_guard lock{feature_value_cache_mutex_};
+    auto const module_it = feature_value_cache_.find(handle);
+    if (module_it != feature_value_cache_.end()) {
+      auto const value_it = module_it->second.find(name);
+      if (value_it != module_it->second.end() && std::holds_alternative<T>(value_it->second)) {
+        return std::get<T>(value_it->second);
+      }
+    }
+  }
+
+  // A value is only cached when we get notified about its changes
+  auto const registered = [&] {
+      {
+        std::lock_guard lock{feature_value_cache_mutex_};
+        if (feature_value_cache_registrations_[handle].count(name) > 0) {
+          return true;
+        }
+      }
+
+      auto const err = api_->FeatureInvalidationRegister(
+        handle, name.data(), on_feature_value_invalidation,
+        const_cast<VimbaXCamera *>(this));
+
+      if (err != VmbErrorSuccess) {
+        RCLCPP_DEBUG(
+          get_logger(), "Not caching '%s', invalidation register failed with %d",
+          name.data(), err);
+        return false;
+      }
+
+      std::lock_guard lock{feature_value_cache_mutex_};
+      feature_value_cache_registrations_[handle].emplace(name);
+      return true;
+    }();
+
+  auto const generation = feature_value_cache_generation_.load();
+  auto const value = read_value();
+
+  if (value && registered) {
+    std::lock_guard lock{feature_value_cache_mutex_};
+    if (feature_value_cache_enabled_ && generation == feature_value_cache_generation_) {
+      feature_value_cache_[handle].insert_or_assign(name, *value);
+    }
+  }
+
+  return value;
+}
+
+void VimbaXCamera::feature_value_cache_invalidate(const FeatureHandle & feature) const
+{
+  feature_value_cache_generation_++;
+
+  if (!feature_value_cache_enabled_) {
+    return;
+  }
+
+  auto const handle = feature.module_handle;
+
+  // Changing a selector changes the value of all features it selects
+  std::vector<VmbFeatureInfo_t> selected_features{};
+
+  if (feature.info != nullptr && feature.info->hasSelectedFeatures) {
+    VmbUint32_t selected_count{};
+
+    auto const err = api_->FeatureListSelected(
+      handle, feature.name, nullptr, 0, &selected_count, sizeof(VmbFeatureInfo_t));
+
+    if (err == VmbErrorSuccess && selected_count > 0) {
+      selected_features.resize(selected_count);
+      api_->FeatureListSelected(
+        handle, feature.name, selected_features.data(), selected_features.size(),
+        &selected_count, sizeof(VmbFeatureInfo_t));
+      selected_features.resize(std::min<size_t>(selected_count, selected_features.size()));
+    }
+  }
+
+  std::lock_guard lock{feature_value_cache_mutex_};
+  auto const module_it = feature_value_cache_.find(handle);
+  if (module_it == feature_value_cache_.end()) {
+    return;
+  }
+
+  module_it->second.erase(feature.name);
+
+  for (auto const & info : selected_features) {
+    if (info.name != nullptr) {
+      module_it->second.erase(info.name);
+    }
+  }
+}
+
+void VimbaXCamera::feature_value_cache_clear() const
+{
+  feature_value_cache_generation_++;
+
+  std::lock_guard lock{feature_value_cache_mutex_};
+  feature_value_cache_.clear();
+}
+
+void VimbaXCamera::on_feature_value_invalidation(
+  VmbHandle_t handle, const char * name, void * context)
+{
+  auto const _this = reinterpret_cast<VimbaXCamera *>(context);
+
+  _this->feature_value_cache_generation_++;
+
+  std::lock_guard lock{_this->feature_value_cache_mutex_};
+  auto const module_it = _this->feature_value_cache_.find(handle);
+  if (module_it != _this->feature_value_cache_.end()) {
+    module_it->second.erase(name);
+  }
+}
+
+void VimbaXCamera::set_pixel_correction(std::shared_ptr<const PixelCorrection> correction)
+{
+  std::atomic_store(&pixel_correction_, std::move(correction));
+}
+
+std::shared_ptr<const PixelCorrection> VimbaXCamera::get_pixel_correction() const
+{
+  return std::atomic_load(&pixel_correction_);
+}
+
+void VimbaXCamera::set_feature_value_cache_enabled(bool enabled)
+{
+  feature_value_cache_enabled_ = enabled;
+
+  if (!enabled) {
+    feature_value_cache_clear();
+  }
+}
+
+bool VimbaXCamera::is_feature_value_cache_enabled() const
+{
+  return feature_value_cache_enabled_;
 }
 
 bool VimbaXCamera::is_alive() const
@@ -399,31 +755,104 @@ bool VimbaXCamera::is_alive() const
 
 bool VimbaXCamera::has_feature(const std::string_view & name, Module module) const
 {
-  if (feature_info_map_[std::size_t(module)].count(name.data())) {
+  if (feature_info_map(module).count(name)) {
     return true;
   }
 
   return false;
 }
 
+result<VimbaXCamera::FeatureHandle> VimbaXCamera::feature_handle_get(
+  const std::string_view & name,
+  const Module module) const
+{
+  auto const & feature_map = feature_info_map(module);
+  auto const it = feature_map.find(name);
+
+  if (it == feature_map.end()) {
+    return error{VmbErrorNotFound};
+  }
+
+  return FeatureHandle{
+    module, get_module_handle(module), it->first.data(), &it->second, nullptr};
+}
+
 result<void> VimbaXCamera::start_streaming(
   int buffer_count,
   std::function<void(std::shared_ptr<Frame>)> on_frame,
-  bool start_acquisition)
+  bool start_acquisition,
+  uint32_t stream_count)
 {
+  if (stream_count == 0 || stream_count > get_stream_count()) {
+    RCLCPP_ERROR(
+      get_logger(), "Requested %u streams, but camera only provides %u", stream_count,
+      get_stream_count());
+    return error{VmbErrorBadParameter};
+  }
+
   auto expected_state = StreamState::kStopped;
 
   if (stream_state_.compare_exchange_strong(expected_state, StreamState::kStarting)) {
-    frames_.clear();
-    frames_.resize(buffer_count);
+    active_stream_count_ = stream_count;
 
-    uint32_t payload_size{};
+    for (uint32_t i = 0; i < active_stream_count_; i++) {
+      auto const stream_start_error =
+        start_stream_capture(*streams_[i], i, buffer_count, on_frame);
 
-    auto const payload_size_error = api_->PayloadSizeGet(camera_handle_, &payload_size);
-    if (payload_size_error != VmbErrorSuccess) {
-      return error{payload_size_error};
+      if (!stream_start_error) {
+        // The failed stream may be partially started as well
+        abort_stream_capture(i + 1);
+        return stream_start_error.error();
+      }
     }
 
+    if (start_acquisition) {
+      auto const acquisition_start_error = feature_command_run(SFNCFeatures::AcquisitionStart);
+      if (!acquisition_start_error) {
+        RCLCPP_ERROR(
+          get_logger(), "Acquisition start failed with error %d (%s)",
+          acquisition_start_error.error().code,
+          (vmb_error_to_string(acquisition_start_error.error().code)).data());
+        abort_stream_capture(active_stream_count_);
+        return acquisition_start_error.error();
+      }
+    }
+
+    // Buffers not taken by the new frames don't fit the current payload anymore. The buffers
+    // of the new frames are retained for the camera reopened after a disconnect.
+    frame_buffer_pool_->clear();
+    frame_buffer_pool_->set_retaining(true);
+
+    stream_state_.store(StreamState::kActive);
+
+    return {};
+  } else if (expected_state == StreamState::kActive) {
+    return {};
+  } else {
+    return error{VmbErrorInvalidCall};
+  }
+}
+
+result<void> VimbaXCamera::start_stream_capture(
+  StreamContext & stream,
+  uint32_t stream_index,
+  int buffer_count,
+  std::function<void(std::shared_ptr<Frame>)> on_frame)
+{
+  stream.frames.clear();
+  stream.frames.resize(buffer_count);
+
+  uint32_t payload_size{};
+
+  auto const payload_size_error = api_->PayloadSizeGet(stream.capture_handle, &payload_size);
+  if (payload_size_error != VmbErrorSuccess) {
+    return error{payload_size_error};
+  }
+
+  auto alignment{1};
+
+  // Only the first stream carries the image configured by the remote device features
+  if (stream_index == 0) {
     auto const pixel_format = get_pixel_format();
 
     if (!is_valid_pixel_format(*pixel_format)) {
@@ -431,93 +860,82 @@ result<void> VimbaXCamera::start_streaming(
       return error{VmbErrorNotSupported};
     }
 
-    auto alignment{1};
-
     if (has_feature(SFNCFeatures::StreamBufferAlignment)) {
       auto const alignment_res =
-        feature_int_get(SFNCFeatures::StreamBufferAlignment, camera_info_.streamHandles[0]);
+        feature_int_get(SFNCFeatures::StreamBufferAlignment, stream.handle);
 
       alignment = alignment_res ? *alignment_res : 1;
     }
+  } else {
+    VmbInt64_t stream_alignment{};
+    auto const alignment_error = api_->FeatureIntGet(
+      stream.handle, SFNCFeatures::StreamBufferAlignment.data(), &stream_alignment);
 
-    RCLCPP_INFO(get_logger(), "Buffer alignment: %d", alignment);
-
-    for (auto & frame : frames_) {
-      auto new_frame = Frame::create(shared_from_this(), payload_size, alignment);
+    alignment = (alignment_error == VmbErrorSuccess) ? int(stream_alignment) : 1;
+  }
 
-      if (!new_frame) {
-        RCLCPP_ERROR(get_logger(), "Failed to create frame");
-        return new_frame.error();
-      }
+  RCLCPP_INFO(
+    get_logger(), "Stream %u payload size: %u buffer alignment: %d", stream_index, payload_size,
+    alignment);
 
-      frame = *new_frame;
+  for (auto & frame : stream.frames) {
+    auto new_frame = Frame::create(shared_from_this(), payload_size, alignment, stream_index);
 
-      frame->set_callback(on_frame);
+    if (!new_frame) {
+      RCLCPP_ERROR(get_logger(), "Failed to create frame");
+      return new_frame.error();
     }
 
-    frame_processing_enable_ = true;
-    frame_processing_thread_ = std::make_shared<std::thread>(
-      [this] {
-        while (frame_processing_enable_) {
-          auto const frame_opt = [&]() -> std::optional<std::shared_ptr<Frame>> {
-            std::unique_lock lock{frame_ready_queue_mutex_};
-            frame_ready_cv_.wait(
-              lock, [&]  {
-                return !frame_ready_queue_.empty() || !frame_processing_enable_;
-              });
-
-            if (!frame_ready_queue_.empty()) {
-              auto const ret = frame_ready_queue_.front();
-              frame_ready_queue_.pop();
-              return ret;
-            } else {
-              return std::nullopt;
-            }
-          }();
+    frame = *new_frame;
 
-          if (frame_opt) {
-            (*frame_opt)->on_frame_ready();
-          }
-        }
-      });
+    frame->set_callback(on_frame);
+  }
 
-    auto const capture_start_error = api_->CaptureStart(camera_handle_);
-    if (capture_start_error != VmbErrorSuccess) {
-      RCLCPP_ERROR(
-        get_logger(), "Capture start failed with error %d (%s)", capture_start_error,
-        (vmb_error_to_string(capture_start_error)).data());
-      return error{capture_start_error};
-    }
+  stream.frame_processing_enable = true;
+  stream.frame_processing_thread = std::make_shared<std::thread>(
+    [&stream] {
+      while (stream.frame_processing_enable) {
+        auto const frame_opt = [&]() -> std::optional<std::shared_ptr<Frame>> {
+          std::unique_lock lock{stream.frame_ready_queue_mutex};
+          stream.frame_ready_cv.wait(
+            lock, [&]  {
+              return !stream.frame_ready_queue.empty() || !stream.frame_processing_enable;
+            });
 
-    for (auto const & frame : frames_) {
-      auto const queue_error = frame->queue();
-      if (queue_error != VmbErrorSuccess) {
-        RCLCPP_ERROR(
-          get_logger(), "Queue frame failed with error %d (%s)", queue_error,
-          (vmb_error_to_string(queue_error)).data());
-        return error{queue_error};
-      }
-    }
+          if (!stream.frame_ready_queue.empty()) {
+            auto const ret = stream.frame_ready_queue.front();
+            stream.frame_ready_queue.pop();
+            return ret;
+          } else {
+            return std::nullopt;
+          }
+        }();
 
-    if (start_acquisition) {
-      auto const acquisition_start_error = feature_command_run(SFNCFeatures::AcquisitionStart);
-      if (!acquisition_start_error) {
-        RCLCPP_ERROR(
-          get_logger(), "Acquisition start failed with error %d (%s)",
-          acquisition_start_error.error().code,
-          (vmb_error_to_string(acquisition_start_error.error().code)).data());
-        return acquisition_start_error.error();
+        if (frame_opt) {
+          (*frame_opt)->on_frame_ready();
+        }
       }
-    }
+    });
 
-    stream_state_.store(StreamState::kActive);
+  auto const capture_start_error = api_->CaptureStart(stream.capture_handle);
+  if (capture_start_error != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "Capture start failed with error %d (%s)", capture_start_error,
+      (vmb_error_to_string(capture_start_error)).data());
+    return error{capture_start_error};
+  }
 
-    return {};
-  } else if (expected_state == StreamState::kActive) {
-    return {};
-  } else {
-    return error{VmbErrorInvalidCall};
+  for (auto const & frame : stream.frames) {
+    auto const queue_error = frame->queue();
+    if (queue_error != VmbErrorSuccess) {
+      RCLCPP_ERROR(
+        get_logger(), "Queue frame failed with error %d (%s)", queue_error,
+        (vmb_error_to_string(queue_error)).data());
+      return error{queue_error};
+    }
   }
+
+  return {};
 }
 
 result<void> VimbaXCamera::stop_streaming()
@@ -536,46 +954,22 @@ result<void> VimbaXCamera::stop_streaming()
       }
     }
 
-    auto const capture_stop_error = api_->CaptureEnd(camera_handle_);
-    if (capture_stop_error != VmbErrorSuccess) {
-      RCLCPP_ERROR(
-        get_logger(), "Capture stop failed with error %d (%s)", capture_stop_error,
-        (vmb_error_to_string(capture_stop_error)).data());
-      return error{capture_stop_error};
-    }
+    for (uint32_t i = 0; i < active_stream_count_; i++) {
+      auto const stream_stop_error = stop_stream_capture(*streams_[i]);
 
-    // Stop frame processing before revoking the frames to avoid requeue errors
-    if (frame_processing_thread_) {
-      frame_processing_enable_ = false;
-      {
-        std::lock_guard guard{frame_ready_queue_mutex_};
-        while (!frame_ready_queue_.empty()) {
-          frame_ready_queue_.pop();
-        }
+      if (!stream_stop_error) {
+        return stream_stop_error.error();
       }
-      frame_ready_cv_.notify_all();
-      frame_processing_thread_->join();
-      frame_processing_thread_.reset();
     }
 
-    auto const flush_error = api_->CaptureQueueFlush(camera_handle_);
-    if (flush_error != VmbErrorSuccess) {
-      RCLCPP_ERROR(
-        get_logger(), "Flush capture queue failed with error %d (%s)", flush_error,
-        (vmb_error_to_string(flush_error)).data());
-      return error{flush_error};
-    }
+    active_stream_count_ = 0;
 
-    auto const revoke_error = api_->FrameRevokeAll(camera_handle_);
-    if (revoke_error != VmbErrorSuccess) {
-      RCLCPP_ERROR(
-        get_logger(), "Revoking frames failed with error %d (%s)", revoke_error,
-        (vmb_error_to_string(revoke_error)).data());
-      return error{revoke_error};
+    // Only the stream of a disconnected camera is restarted with the pooled buffers, the ones of
+    // a stopped stream would just keep the memory of a full sized stream occupied
+    if (is_alive()) {
+      frame_buffer_pool_->set_retaining(false);
     }
 
-    frames_.clear();
-
     stream_state_.store(StreamState::kStopped);
 
     return {};
@@ -586,6 +980,94 @@ result<void> VimbaXCamera::stop_streaming()
   }
 }
 
+result<void> VimbaXCamera::stop_stream_capture(StreamContext & stream)
+{
+  auto const capture_stop_error = api_->CaptureEnd(stream.capture_handle);
+  if (capture_stop_error != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "Capture stop failed with error %d (%s)", capture_stop_error,
+      (vmb_error_to_string(capture_stop_error)).data());
+    return error{capture_stop_error};
+  }
+
+  // Stop frame processing before revoking the frames to avoid requeue errors
+  stop_frame_processing(stream);
+
+  auto const flush_error = api_->CaptureQueueFlush(stream.capture_handle);
+  if (flush_error != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "Flush capture queue failed with error %d (%s)", flush_error,
+      (vmb_error_to_string(flush_error)).data());
+    return error{flush_error};
+  }
+
+  auto const revoke_error = api_->FrameRevokeAll(stream.capture_handle);
+  if (revoke_error != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "Revoking frames failed with error %d (%s)", revoke_error,
+      (vmb_error_to_string(revoke_error)).data());
+    return error{revoke_error};
+  }
+
+  stream.frames.clear();
+
+  return {};
+}
+
+void VimbaXCamera::abort_stream_capture(uint32_t started_count)
+{
+  // Errors are ignored, the streams may have failed at any step of their start
+  for (uint32_t i = 0; i < started_count; i++) {
+    auto & stream = *streams_[i];
+
+    api_->CaptureEnd(stream.capture_handle);
+    stop_frame_processing(stream);
+    api_->CaptureQueueFlush(stream.capture_handle);
+    api_->FrameRevokeAll(stream.capture_handle);
+    stream.frames.clear();
+  }
+
+  active_stream_count_ = 0;
+  stream_state_.store(StreamState::kStopped);
+}
+
+void VimbaXCamera::stop_frame_processing(StreamContext & stream)
+{
+  if (stream.frame_processing_thread) {
+    stream.frame_processing_enable = false;
+    {
+      std::lock_guard guard{stream.frame_ready_queue_mutex};
+      while (!stream.frame_ready_queue.empty()) {
+        stream.frame_ready_queue.pop();
+      }
+    }
+    stream.frame_ready_cv.notify_all();
+    stream.frame_processing_thread->join();
+    stream.frame_processing_thread.reset();
+  }
+}
+
+uint32_t VimbaXCamera::get_stream_count() const
+{
+  return uint32_t(streams_.size());
+}
+
+result<uint32_t> VimbaXCamera::get_payload_size(uint32_t stream_index) const
+{
+  if (stream_index >= streams_.size()) {
+    return error{VmbErrorBadParameter};
+  }
+
+  uint32_t payload_size{};
+
+  auto const err = api_->PayloadSizeGet(streams_[stream_index]->capture_handle, &payload_size);
+  if (err != VmbErrorSuccess) {
+    return error{err};
+  }
+
+  return payload_size;
+}
+
 result<VmbCameraInfo> VimbaXCamera::query_camera_info() const
 {
   RCLCPP_DEBUG(get_logger(), "%s", __FUNCTION__);
@@ -608,12 +1090,12 @@ result<std::vector<std::string>> VimbaXCamera::features_list_get(Module module)
 
   std::vector<std::string> feature_list{};
 
-  auto const & feature_map = feature_info_map_[std::size_t(module)];
+  auto const & feature_map = feature_info_map(module);
 
   std::transform(
     feature_map.begin(), feature_map.end(), std::back_insert_iterator(feature_list),
-    [](auto feature_info) {
-      return feature_info.first;
+    [](auto const & feature_info) {
+      return std::string{feature_info.first};
     });
 
   return feature_list;
@@ -649,12 +1131,28 @@ result<void> VimbaXCamera::feature_command_run(
   return feature_command_run(name, get_module_handle(module), timeout);
 }
 
+std::future<result<void>> VimbaXCamera::feature_command_run_async(
+  const std::string_view & name,
+  const std::optional<std::chrono::milliseconds> & timeout,
+  const Module module) const
+{
+  return std::async(
+    std::launch::async,
+    [camera = shared_from_this(), name = std::string{name}, timeout, module] {
+      return camera->feature_command_run(name, timeout, module);
+    });
+}
+
 result<void> VimbaXCamera::feature_command_run(
   const std::string_view & name, VmbHandle_t handle,
   const std::optional<std::chrono::milliseconds> & timeout) const
 {
   using namespace std::chrono_literals;
   auto const default_timeout = 1s;
+  // Most commands are done right after running them, so poll without delay first and
+  // only back off exponentially for long running commands (e.g. UserSetLoad)
+  auto const spin_duration = 50us;
+  auto const max_backoff = std::chrono::microseconds{10ms};
 
   auto const run_error = api_->FeatureCommandRun(handle, name.data());
 
@@ -663,45 +1161,65 @@ result<void> VimbaXCamera::feature_command_run(
   }
 
   auto const poll_start_tp = std::chrono::steady_clock::now();
+  auto const deadline_tp = poll_start_tp + timeout.value_or(default_timeout);
+  auto backoff = 10us;
 
-  auto is_timed_out = [&]() -> bool {
-      auto const now_tp = std::chrono::steady_clock::now();
-      auto const diff = now_tp - poll_start_tp;
-
-      return diff >= timeout.value_or(default_timeout);
-    };
-
-  bool done{false};
-
-  do {
+  while (true) {
+    bool done{false};
     auto const done_error = api_->FeatureCommandIsDone(handle, name.data(), &done);
     if (done_error != VmbErrorSuccess) {
       return error{done_error};
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (done) {
+      if (std::find(
+          cache_clearing_commands.begin(), cache_clearing_commands.end(), name) !=
+        cache_clearing_commands.end())
+      {
+        feature_value_cache_clear();
+      }
+
+      return {};
+    }
+
+    auto const now_tp = std::chrono::steady_clock::now();
 
-    if (is_timed_out()) {
+    if (now_tp >= deadline_tp) {
       RCLCPP_ERROR(get_logger(), "Waiting for command %s done timed out!", name.data());
       return error{VmbErrorTimeout};
     }
-  } while(!done);
 
-  return {};
+    if (now_tp - poll_start_tp < spin_duration) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(
+        std::min<std::chrono::steady_clock::duration>(backoff, deadline_tp - now_tp));
+      backoff = std::min(backoff * 2, max_backoff);
+    }
+  }
 }
 
 result<int64_t> VimbaXCamera::feature_int_get(
   const std::string_view & name,
-  const Module module) const
+  const Module module,
+  const bool bypass_cache) const
 {
-  return feature_int_get(name, get_module_handle(module));
+  return feature_int_get(name, get_module_handle(module), bypass_cache);
 }
 
 result<int64_t> VimbaXCamera::feature_int_get(
-  const std::string_view & name,
-  VmbHandle_t handle) const
+  const std::string_view & name, VmbHandle_t handle, const bool bypass_cache) const
+{
+  return feature_int_get(feature_handle_resolve(name, handle), bypass_cache);
+}
+
+result<int64_t> VimbaXCamera::feature_int_get(
+  const FeatureHandle & feature, const bool bypass_cache) const
 {
-  return api_->feature_int_get(handle, name);
+  return feature_value_cache_get<int64_t>(
+    feature, [&] {
+      return api_->feature_int_get(feature.module_handle, feature.name);
+    }, bypass_cache);
 }
 
 result<void> VimbaXCamera::feature_int_set(
@@ -709,9 +1227,18 @@ result<void> VimbaXCamera::feature_int_set(
   const int64_t value,
   const Module module) const
 {
-  auto const handle = get_module_handle(module);
+  return feature_int_set(feature_handle_resolve(name, get_module_handle(module)), value);
+}
+
+result<void> VimbaXCamera::feature_int_set(
+  const FeatureHandle & feature,
+  const int64_t value) const
+{
+  auto const result = api_->feature_int_set(feature.module_handle, feature.name, value);
+
+  feature_value_cache_invalidate(feature);
 
-  return api_->feature_int_set(handle, name, value);
+  return result;
 }
 
 result<std::array<int64_t, 3>>
@@ -735,28 +1262,38 @@ VimbaXCamera::feature_int_info_get(
 
 result<_Float64> VimbaXCamera::feature_float_get(
   const std::string_view & name,
-  const Module module) const
+  const Module module,
+  const bool bypass_cache) const
 {
-  return feature_float_get(name, get_module_handle(module));
+  return feature_float_get(name, get_module_handle(module), bypass_cache);
 }
 
 result<_Float64> VimbaXCamera::feature_float_get(
-  const std::string_view & name, VmbHandle_t handle) const
+  const std::string_view & name, VmbHandle_t handle, const bool bypass_cache) const
 {
-  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, name.data());
+  return feature_float_get(feature_handle_resolve(name, handle), bypass_cache);
+}
 
-  _Float64 value{};
-  auto const err =
-    api_->FeatureFloatGet(handle, name.data(), reinterpret_cast<_Float64 *>(&value));
+result<_Float64> VimbaXCamera::feature_float_get(
+  const FeatureHandle & feature, const bool bypass_cache) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, feature.name);
 
-  if (err != VmbErrorSuccess) {
-    RCLCPP_ERROR(
-      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
-      vmb_error_to_string(err).data());
-    return error{err};
-  }
+  return feature_value_cache_get<_Float64>(
+    feature, [&]() -> result<_Float64> {
+      _Float64 value{};
+      auto const err = api_->FeatureFloatGet(
+        feature.module_handle, feature.name, reinterpret_cast<_Float64 *>(&value));
 
-  return value;
+      if (err != VmbErrorSuccess) {
+        RCLCPP_ERROR(
+          get_logger(), "feature_float_get failed with error %d (%s)", err,
+          vmb_error_to_string(err).data());
+        return error{err};
+      }
+
+      return value;
+    }, bypass_cache);
 }
 
 result<void>
@@ -765,12 +1302,19 @@ VimbaXCamera::feature_float_set(
   const _Float64 value,
   const Module module) const
 {
-  RCLCPP_DEBUG(get_logger(), "%s('%s', %lf)", __FUNCTION__, name.data(), value);
+  return feature_float_set(feature_handle_resolve(name, get_module_handle(module)), value);
+}
 
-  auto const handle = get_module_handle(module);
+result<void> VimbaXCamera::feature_float_set(
+  const FeatureHandle & feature,
+  const _Float64 value) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s', %lf)", __FUNCTION__, feature.name, value);
 
   auto const err =
-    api_->FeatureFloatSet(handle, name.data(), value);
+    api_->FeatureFloatSet(feature.module_handle, feature.name, value);
+
+  feature_value_cache_invalidate(feature);
 
   if (err != VmbErrorSuccess) {
     RCLCPP_ERROR(
@@ -825,17 +1369,26 @@ result<feature_float_info> VimbaXCamera::feature_float_info_get(
 
 result<std::string> VimbaXCamera::feature_string_get(
   const std::string_view & name,
-  const Module module) const
+  const Module module,
+  const bool bypass_cache) const
 {
-  return feature_string_get(name, get_module_handle(module));
+  return feature_string_get(name, get_module_handle(module), bypass_cache);
 }
 
 
 result<std::string> VimbaXCamera::feature_string_get(
-  const std::string_view & name,
-  VmbHandle_t handle) const
+  const std::string_view & name, VmbHandle_t handle, const bool bypass_cache) const
+{
+  return feature_string_get(feature_handle_resolve(name, handle), bypass_cache);
+}
+
+result<std::string> VimbaXCamera::feature_string_get(
+  const FeatureHandle & feature, const bool bypass_cache) const
 {
-  return api_->feature_string_get(handle, name);
+  return feature_value_cache_get<std::string>(
+    feature, [&] {
+      return api_->feature_string_get(feature.module_handle, feature.name);
+    }, bypass_cache);
 }
 
 
@@ -845,12 +1398,19 @@ VimbaXCamera::feature_string_set(
   const std::string_view value,
   const Module module) const
 {
-  RCLCPP_DEBUG(get_logger(), "%s('%s', '%s')", __FUNCTION__, name.data(), value.data());
+  return feature_string_set(feature_handle_resolve(name, get_module_handle(module)), value);
+}
 
-  auto const handle = get_module_handle(module);
+result<void> VimbaXCamera::feature_string_set(
+  const FeatureHandle & feature,
+  const std::string_view value) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s', '%s')", __FUNCTION__, feature.name, value.data());
 
   auto const err =
-    api_->FeatureStringSet(handle, name.data(), value.data());
+    api_->FeatureStringSet(feature.module_handle, feature.name, value.data());
+
+  feature_value_cache_invalidate(feature);
 
   if (err != VmbErrorSuccess) {
     RCLCPP_ERROR(
@@ -890,24 +1450,33 @@ result<uint32_t> VimbaXCamera::feature_string_info_get(
 
 result<bool> VimbaXCamera::feature_bool_get(
   const std::string_view & name,
-  const Module module) const
+  const Module module,
+  const bool bypass_cache) const
 {
-  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, name.data());
+  return feature_bool_get(
+    feature_handle_resolve(name, get_module_handle(module)), bypass_cache);
+}
 
-  auto const handle = get_module_handle(module);
+result<bool> VimbaXCamera::feature_bool_get(
+  const FeatureHandle & feature, const bool bypass_cache) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, feature.name);
 
-  bool value{};
-  auto const err =
-    api_->FeatureBoolGet(handle, name.data(), reinterpret_cast<bool *>(&value));
+  return feature_value_cache_get<bool>(
+    feature, [&]() -> result<bool> {
+      bool value{};
+      auto const err = api_->FeatureBoolGet(
+        feature.module_handle, feature.name, reinterpret_cast<bool *>(&value));
 
-  if (err != VmbErrorSuccess) {
-    RCLCPP_ERROR(
-      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
-      vmb_error_to_string(err).data());
-    return error{err};
-  }
+      if (err != VmbErrorSuccess) {
+        RCLCPP_ERROR(
+          get_logger(), "feature_bool_get failed with error %d (%s)", err,
+          vmb_error_to_string(err).data());
+        return error{err};
+      }
 
-  return value;
+      return value;
+    }, bypass_cache);
 }
 
 result<void> VimbaXCamera::feature_bool_set(
@@ -915,12 +1484,19 @@ result<void> VimbaXCamera::feature_bool_set(
   const bool value,
   const Module module) const
 {
-  RCLCPP_DEBUG(get_logger(), "%s('%s', %d)", __FUNCTION__, name.data(), value);
+  return feature_bool_set(feature_handle_resolve(name, get_module_handle(module)), value);
+}
 
-  auto const handle = get_module_handle(module);
+result<void> VimbaXCamera::feature_bool_set(
+  const FeatureHandle & feature,
+  const bool value) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s', %d)", __FUNCTION__, feature.name, value);
 
   auto const err =
-    api_->FeatureBoolSet(handle, name.data(), value);
+    api_->FeatureBoolSet(feature.module_handle, feature.name, value);
+
+  feature_value_cache_invalidate(feature);
 
   if (err != VmbErrorSuccess) {
     RCLCPP_ERROR(
@@ -934,28 +1510,37 @@ result<void> VimbaXCamera::feature_bool_set(
 
 result<std::string> VimbaXCamera::feature_enum_get(
   const std::string_view & name,
-  const Module module) const
+  const Module module,
+  const bool bypass_cache) const
 {
-  return feature_enum_get(name, get_module_handle(module));
+  return feature_enum_get(name, get_module_handle(module), bypass_cache);
 }
 
 result<std::string> VimbaXCamera::feature_enum_get(
-  const std::string_view & name,
-  VmbHandle_t handle) const
+  const std::string_view & name, VmbHandle_t handle, const bool bypass_cache) const
 {
-  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, name.data());
+  return feature_enum_get(feature_handle_resolve(name, handle), bypass_cache);
+}
 
-  const char * value{nullptr};
-  auto const err = api_->FeatureEnumGet(handle, name.data(), &value);
+result<std::string> VimbaXCamera::feature_enum_get(
+  const FeatureHandle & feature, const bool bypass_cache) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, feature.name);
 
-  if (err != VmbErrorSuccess) {
-    RCLCPP_ERROR(
-      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
-      vmb_error_to_string(err).data());
-    return error{err};
-  }
+  return feature_value_cache_get<std::string>(
+    feature, [&]() -> result<std::string> {
+      const char * value{nullptr};
+      auto const err = api_->FeatureEnumGet(feature.module_handle, feature.name, &value);
+
+      if (err != VmbErrorSuccess) {
+        RCLCPP_ERROR(
+          get_logger(), "feature_enum_get failed with error %d (%s)", err,
+          vmb_error_to_string(err).data());
+        return error{err};
+      }
 
-  return std::string{value};
+      return std::string{value};
+    }, bypass_cache);
 }
 
 result<void>
@@ -964,12 +1549,19 @@ VimbaXCamera::feature_enum_set(
   const std::string_view & value,
   const Module module) const
 {
-  RCLCPP_DEBUG(get_logger(), "%s('%s', '%s')", __FUNCTION__, name.data(), value.data());
+  return feature_enum_set(feature_handle_resolve(name, get_module_handle(module)), value);
+}
 
-  auto const handle = get_module_handle(module);
+result<void> VimbaXCamera::feature_enum_set(
+  const FeatureHandle & feature,
+  const std::string_view & value) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s', '%s')", __FUNCTION__, feature.name, value.data());
 
   auto const err =
-    api_->FeatureEnumSet(handle, name.data(), value.data());
+    api_->FeatureEnumSet(feature.module_handle, feature.name, value.data());
+
+  feature_value_cache_invalidate(feature);
 
   if (err != VmbErrorSuccess) {
     RCLCPP_ERROR(
@@ -1140,15 +1732,17 @@ result<void> VimbaXCamera::feature_raw_set(
   RCLCPP_DEBUG(
     get_logger(), "%s('%s', buffer.size()=%ld)", __FUNCTION__, name.data(), buffer.size());
 
-  auto const handle = get_module_handle(module);
+  auto const feature = feature_handle_resolve(name, get_module_handle(module));
 
   auto const err =
     api_->FeatureRawSet(
-    handle,
-    name.data(),
+    feature.module_handle,
+    feature.name,
     reinterpret_cast<const char *>(buffer.data()),
     static_cast<uint32_t>(buffer.size()));
 
+  feature_value_cache_invalidate(feature);
+
   if (err != VmbErrorSuccess) {
     RCLCPP_ERROR(
       get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
@@ -1319,6 +1913,8 @@ result<void> VimbaXCamera::settings_load(const std::string_view & file_name)
     &persist_settings,
     sizeof(persist_settings));
 
+  feature_value_cache_clear();
+
   if (err != VmbErrorSuccess) {
     return error{err};
   }
@@ -1462,12 +2058,7 @@ result<VimbaXCamera::Info> VimbaXCamera::camera_info_get() const
     auto const ip_address =
       feature_int_get(SFNCFeatures::GevDeviceIPAddress, camera_info_.localDeviceHandle);
     if (ip_address) {
-      auto const u8ptr = reinterpret_cast<const uint8_t *>(&(*ip_address));
-      info.ip_address =
-        std::to_string(u8ptr[3]) + "." +
-        std::to_string(u8ptr[2]) + "." +
-        std::to_string(u8ptr[1]) + "." +
-        std::to_string(u8ptr[0]);
+      info.ip_address = ip_addr_to_string(uint32_t(*ip_address));
     }
   }
 
@@ -1475,19 +2066,47 @@ result<VimbaXCamera::Info> VimbaXCamera::camera_info_get() const
     auto const mac_address =
       feature_int_get(SFNCFeatures::GevDeviceMACAddress, camera_info_.localDeviceHandle);
     if (mac_address) {
-      auto const u8ptr = reinterpret_cast<const uint8_t *>(&(*mac_address));
+      info.mac_address = mac_addr_to_string(uint64_t(*mac_address));
+    }
+  }
 
-      std::stringstream mac_address_stream{};
-      mac_address_stream << std::hex << std::setfill('0') << std::setw(2) << int(u8ptr[5]);
-      for (int i = 4; i >= 0; i--) {
-        mac_address_stream << ":" << std::hex << std::setfill('0') << std::setw(2) << int(u8ptr[i]);
-      }
+  return info;
+}
+
+uint64_t VimbaXCamera::device_timestamp_to_ns(uint64_t timestamp) const
+{
+  if (timestamp_frequency_) {
+    RCLCPP_DEBUG(get_logger(), "Using timestamp frequency %ld", *timestamp_frequency_);
 
-      info.mac_address = mac_address_stream.str();
+    if (*timestamp_frequency_ > std::nano::den) {
+      return timestamp / ((*timestamp_frequency_) / std::nano::den);
+    } else {
+      return timestamp * (std::nano::den / (*timestamp_frequency_));
     }
   }
 
-  return info;
+  return timestamp;
+}
+
+result<uint64_t> VimbaXCamera::device_timestamp_latch() const
+{
+  auto const [latch, value] = has_feature(SFNCFeatures::TimestampLatch) ?
+    std::pair{SFNCFeatures::TimestampLatch, SFNCFeatures::TimestampLatchValue} :
+    std::pair{SFNCFeatures::GevTimestampControlLatch, SFNCFeatures::GevTimestampValue};
+
+  auto const latch_result = feature_command_run(latch);
+
+  if (!latch_result) {
+    return latch_result.error();
+  }
+
+  auto const timestamp = feature_int_get(value);
+
+  if (!timestamp) {
+    return timestamp.error();
+  }
+
+  return uint64_t(*timestamp);
 }
 
 bool VimbaXCamera::is_streaming() const
@@ -1500,40 +2119,195 @@ bool VimbaXCamera::is_streaming() const
 void VimbaXCamera::on_feature_invalidation(VmbHandle_t, const char * name, void * context)
 {
   auto _this = reinterpret_cast<VimbaXCamera *>(context);
-  std::lock_guard guard{_this->invalidation_callbacks_mutex_};
-  auto const it = _this->invalidation_callbacks_.find(name);
-  if (it != _this->invalidation_callbacks_.end()) {
-    it->second(name);
+
+  // Runs on the VmbC notification thread, so only queue the invalidation
+  if (!_this->invalidation_queue_.try_push(name)) {
+    _this->invalidation_dropped_++;
+    return;
+  }
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (_this->invalidation_worker_waiting_.load()) {
+    std::lock_guard lock{_this->invalidation_worker_mutex_};
+    _this->invalidation_worker_cv_.notify_one();
+  }
+}
+
+void VimbaXCamera::invalidation_worker_start()
+{
+  if (invalidation_worker_.joinable()) {
+    return;
+  }
+
+  invalidation_worker_stop_ = false;
+  invalidation_worker_ = std::thread{[this] {invalidation_worker_run();}};
+}
+
+void VimbaXCamera::invalidation_worker_stop()
+{
+  if (!invalidation_worker_.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard lock{invalidation_worker_mutex_};
+    invalidation_worker_stop_ = true;
+    invalidation_worker_cv_.notify_one();
+  }
+
+  invalidation_worker_.join();
+}
+
+void VimbaXCamera::invalidation_worker_run()
+{
+  std::string name{};
+  uint64_t reported_dropped{0};
+
+  auto const report_dropped = [&] {
+      auto const dropped = invalidation_dropped_.load();
+      if (dropped != reported_dropped) {
+        RCLCPP_WARN(
+          get_logger(), "Event queue overflow, %lu invalidations dropped",
+          dropped - reported_dropped);
+        reported_dropped = dropped;
+      }
+    };
+
+  while (!invalidation_worker_stop_) {
+    // Checked before waiting as well, the drops are reported even if nothing follows them
+    report_dropped();
+
+    if (!invalidation_queue_.try_pop(name)) {
+      std::unique_lock lock{invalidation_worker_mutex_};
+      invalidation_worker_waiting_ = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      invalidation_worker_cv_.wait(
+        lock, [this] {return invalidation_worker_stop_ || !invalidation_queue_.empty();});
+      invalidation_worker_waiting_ = false;
+      continue;
+    }
+
+    // Sequentially consistent with the table replacement and the read of the dispatch count in
+    // feature_invalidation_(un)register. A table replaced before the count the writer read was
+    // incremented is never loaded here again, so it can be reclaimed once the count passed it.
+    auto const listeners = invalidation_listeners_.load(std::memory_order_seq_cst);
+
+    if (listeners != nullptr) {
+      auto const it = listeners->find(name);
+      if (it != listeners->end()) {
+        for (auto const & listener : it->second) {
+          listener.callback(name);
+        }
+      }
+    }
+
+    invalidation_worker_dispatched_.fetch_add(1, std::memory_order_seq_cst);
+  }
+
+  report_dropped();
+}
+
+void VimbaXCamera::invalidation_listeners_reclaim(bool all)
+{
+  auto const dispatched = invalidation_worker_dispatched_.load(std::memory_order_seq_cst);
+
+  auto const reclaimable = [&](auto const & retired) {
+      return all || dispatched > retired.first;
+    };
+
+  for (auto const & retired : invalidation_listeners_retired_) {
+    if (reclaimable(retired)) {
+      delete retired.second;
+    }
   }
+
+  invalidation_listeners_retired_.erase(
+    std::remove_if(
+      invalidation_listeners_retired_.begin(), invalidation_listeners_retired_.end(),
+      reclaimable), invalidation_listeners_retired_.end());
 }
 
-result<void> VimbaXCamera::feature_invalidation_register(
+result<VimbaXCamera::InvalidationListenerId> VimbaXCamera::feature_invalidation_register(
   const std::string_view & name,
   std::function<void(const std::string &)> callback)
 {
-  std::unique_lock lock{invalidation_callbacks_mutex_};
-  invalidation_callbacks_.emplace(name, callback);
-  lock.unlock();
+  std::lock_guard lock{invalidation_listeners_write_mutex_};
 
-  auto const err = api_->FeatureInvalidationRegister(
-    camera_handle_, name.data(),
-    on_feature_invalidation, this);
+  auto const current = invalidation_listeners_.load(std::memory_order_acquire);
+  auto const first_listener = current == nullptr || current->count(std::string{name}) == 0;
 
-  if (err != VmbErrorSuccess) {
-    return error{err};
+  if (first_listener) {
+    auto const err = api_->FeatureInvalidationRegister(
+      camera_handle_, name.data(),
+      on_feature_invalidation, this);
+
+    if (err != VmbErrorSuccess) {
+      return error{err};
+    }
   }
 
-  return {};
+  invalidation_worker_start();
+
+  auto const id = invalidation_listener_next_id_++;
+  auto listeners = current != nullptr ?
+    std::make_unique<InvalidationListenerTable>(*current) :
+    std::make_unique<InvalidationListenerTable>();
+  (*listeners)[std::string{name}].push_back({id, std::move(callback)});
+
+  invalidation_listeners_.store(listeners.release(), std::memory_order_seq_cst);
+
+  if (current != nullptr) {
+    invalidation_listeners_retired_.emplace_back(
+      invalidation_worker_dispatched_.load(std::memory_order_seq_cst), current);
+  }
+
+  invalidation_listeners_reclaim(false);
+
+  return id;
 }
 
-result<void> VimbaXCamera::feature_invalidation_unregister(const std::string_view & name)
+result<void> VimbaXCamera::feature_invalidation_unregister(
+  const std::string_view & name, InvalidationListenerId id)
 {
-  std::unique_lock lock{invalidation_callbacks_mutex_};
-  invalidation_callbacks_.extract(std::string{name});
-  lock.unlock();
+  std::lock_guard lock{invalidation_listeners_write_mutex_};
 
-  auto const err =
-    api_->FeatureInvalidationUnregister(camera_handle_, name.data(), on_feature_invalidation);
+  auto const current = invalidation_listeners_.load(std::memory_order_acquire);
+
+  if (current == nullptr) {
+    return error{VmbErrorNotFound};
+  }
+
+  auto listeners = std::make_unique<InvalidationListenerTable>(*current);
+  auto const it = listeners->find(std::string{name});
+
+  if (it == listeners->end()) {
+    return error{VmbErrorNotFound};
+  }
+
+  auto & feature_listeners = it->second;
+  auto const listener_it = std::find_if(
+    feature_listeners.begin(), feature_listeners.end(),
+    [id](auto const & listener) {return listener.id == id;});
+
+  if (listener_it == feature_listeners.end()) {
+    return error{VmbErrorNotFound};
+  }
+
+  feature_listeners.erase(listener_it);
+
+  VmbError_t err = VmbErrorSuccess;
+
+  if (feature_listeners.empty()) {
+    listeners->erase(it);
+    err = api_->FeatureInvalidationUnregister(
+      camera_handle_, name.data(), on_feature_invalidation);
+  }
+
+  invalidation_listeners_.store(listeners.release(), std::memory_order_seq_cst);
+  invalidation_listeners_retired_.emplace_back(
+    invalidation_worker_dispatched_.load(std::memory_order_seq_cst), current);
+  invalidation_listeners_reclaim(false);
 
   if (err != VmbErrorSuccess) {
     return error{err};
@@ -1542,65 +2316,140 @@ result<void> VimbaXCamera::feature_invalidation_unregister(const std::string_vie
   return {};
 }
 
+uint64_t VimbaXCamera::get_invalidations_dropped() const
+{
+  return invalidation_dropped_.load();
+}
+
 result<VimbaXCamera::EventMetaDataList>
 VimbaXCamera::get_event_meta_data(const std::string_view & name)
 {
-  auto const category_path = "/EventControl/EventsData/Event" + std::string{name} + "Data";
+  auto const layout = event_meta_data_layout_get(name);
 
-  auto const & [start, end] =
-    feature_category_map_[std::size_t(Module::RemoteDevice)].equal_range(category_path);
+  if (!layout) {
+    return layout.error();
+  }
+
+  auto const data = event_meta_data_read(*layout);
+
+  if (!data) {
+    return data.error();
+  }
 
   EventMetaDataList meta_data_list{};
+  meta_data_list.reserve(layout->features.size());
+
+  for (std::size_t i = 0; i < layout->features.size(); i++) {
+    if (!data->valid[i]) {
+      continue;
+    }
+
+    auto const & value = data->values[i];
+
+    meta_data_list.emplace_back(
+      layout->features[i].name, std::visit(
+        [](auto const & v) -> std::string {
+          if constexpr (std::is_same_v<std::decay_t<decltype(v)>, std::string>) {
+            return v;
+          } else {
+            return std::to_string(v);
+          }
+        }, value));
+  }
+
+  return meta_data_list;
+}
+
+result<VimbaXCamera::EventMetaDataLayout>
+VimbaXCamera::event_meta_data_layout_get(const std::string_view & name) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, name.data());
+
+  auto const event_feature_prefix = "Event" + std::string{name};
+  auto const category_path = "/EventControl/EventsData/" + event_feature_prefix + "Data";
+
+  auto const & [start, end] =
+    feature_category_map(Module::RemoteDevice).equal_range(category_path);
+
+  EventMetaDataLayout layout{};
+  layout.event_name = name;
 
   for (auto it = start; it != end; it++) {
-    auto const info = get_feature_info(it->second);
-    switch (info.featureDataType) {
+    auto const feature = feature_handle_get(it->second, Module::RemoteDevice);
+
+    if (!feature) {
+      continue;
+    }
+
+    switch (feature->info->featureDataType) {
       case VmbFeatureDataInt:
-        {
-          auto const value_res = feature_int_get(it->second);
-          if (value_res) {
-            meta_data_list.emplace_back(it->second, std::to_string(*value_res));
-          }
-        }
-        break;
-      case VmbFeatureDataBool:
-        {
-          auto const value_res = feature_bool_get(it->second);
-          if (value_res) {
-            meta_data_list.emplace_back(it->second, std::to_string(*value_res));
-          }
-        }
-        break;
       case VmbFeatureDataFloat:
-        {
-          auto const value_res = feature_float_get(it->second);
-          if (value_res) {
-            meta_data_list.emplace_back(it->second, std::to_string(*value_res));
-          }
-        }
-        break;
+      case VmbFeatureDataBool:
       case VmbFeatureDataString:
-        {
-          auto const value_res = feature_string_get(it->second);
-          if (value_res) {
-            meta_data_list.emplace_back(it->second, *value_res);
-          }
-        }
-        break;
       case VmbFeatureDataEnum:
-        {
-          auto const value_res = feature_enum_get(it->second);
-          if (value_res) {
-            meta_data_list.emplace_back(it->second, *value_res);
-          }
-        }
         break;
       default:
-        break;
+        continue;
     }
+
+    if (it->second == event_feature_prefix + "FrameID") {
+      layout.frame_id_index = layout.features.size();
+    } else if (it->second == event_feature_prefix + "Timestamp") {
+      layout.timestamp_index = layout.features.size();
+    }
+
+    layout.features.push_back(*feature);
   }
 
-  return meta_data_list;
+  return layout;
+}
+
+result<VimbaXCamera::EventMetaData>
+VimbaXCamera::event_meta_data_read(const EventMetaDataLayout & layout) const
+{
+  EventMetaData data{};
+  data.values.reserve(layout.features.size());
+  data.valid.reserve(layout.features.size());
+
+  for (auto const & feature : layout.features) {
+    auto const type = feature.info->featureDataType;
+    auto value = feature_snapshot_value_get(feature, type);
+
+    data.valid.push_back(bool(value));
+
+    if (value) {
+      data.values.push_back(std::move(*value));
+    } else {
+      switch (type) {
+        case VmbFeatureDataInt:
+          data.values.emplace_back(int64_t{});
+          break;
+        case VmbFeatureDataFloat:
+          data.values.emplace_back(_Float64{});
+          break;
+        case VmbFeatureDataBool:
+          data.values.emplace_back(false);
+          break;
+        default:
+          data.values.emplace_back(std::string{});
+          break;
+      }
+    }
+  }
+
+  auto const unsigned_value = [&](std::optional<std::size_t> index) -> uint64_t {
+      if (index && data.valid[*index]) {
+        if (auto const value = std::get_if<int64_t>(&data.values[*index])) {
+          return uint64_t(*value);
+        }
+      }
+      return 0;
+    };
+
+  data.frame_id = unsigned_value(layout.frame_id_index);
+  data.timestamp = unsigned_value(layout.timestamp_index);
+
+  return data;
 }
 
 bool VimbaXCamera::is_valid_pixel_format(VmbPixelFormatType pixel_format)
@@ -1641,8 +2490,36 @@ bool VimbaXCamera::is_valid_pixel_format(VmbPixelFormatType pixel_format)
 result<std::shared_ptr<VimbaXCamera::Frame>> VimbaXCamera::Frame::create(
   std::shared_ptr<VimbaXCamera> camera,
   size_t size,
-  size_t alignment)
+  size_t alignment,
+  uint32_t stream_index)
 {
+  if (stream_index >= camera->get_stream_count()) {
+    return error{VmbErrorBadParameter};
+  }
+
+  auto const capture_handle = camera->streams_[stream_index]->capture_handle;
+
+  // Additional streams don't follow the remote device image format (e.g. metadata streams),
+  // so they get the whole payload buffer and the image layout is taken from the received frame.
+  if (stream_index != 0) {
+    std::shared_ptr<VimbaXCamera::Frame> frame(
+      new VimbaXCamera::Frame{camera, AllocationMode::kByImage, stream_index});
+
+    frame->allocate(size);
+
+    frame->vmb_frame_.buffer = frame->data.data();
+    frame->vmb_frame_.bufferSize = frame->data.size();
+
+    auto announce_error =
+      camera->api_->FrameAnnounce(capture_handle, &frame->vmb_frame_, sizeof(vmb_frame_));
+
+    if (announce_error != VmbErrorSuccess) {
+      return error{announce_error};
+    }
+
+    return frame;
+  }
+
   auto const pixel_format = camera->get_pixel_format();
 
   if (!pixel_format) {
@@ -1680,15 +2557,16 @@ result<std::shared_ptr<VimbaXCamera::Frame>> VimbaXCamera::Frame::create(
   auto const alloc_mode =
     (real_size == aligned_size) ? AllocationMode::kByImage : AllocationMode::kByTl;
 
-  std::shared_ptr<VimbaXCamera::Frame> frame(new VimbaXCamera::Frame{camera, alloc_mode});
+  std::shared_ptr<VimbaXCamera::Frame> frame(
+    new VimbaXCamera::Frame{camera, alloc_mode, stream_index});
 
   if (alloc_mode == AllocationMode::kByTl) {
-    frame->data.resize(real_size);
+    frame->allocate(real_size);
 
     frame->vmb_frame_.buffer = nullptr;
     frame->vmb_frame_.bufferSize = size;
   } else {
-    frame->data.resize(size);
+    frame->allocate(size);
 
     frame->vmb_frame_.buffer = frame->data.data();
     frame->vmb_frame_.bufferSize = frame->data.size();
@@ -1697,7 +2575,7 @@ result<std::shared_ptr<VimbaXCamera::Frame>> VimbaXCamera::Frame::create(
   frame->step = line;
 
   auto announce_error =
-    camera->api_->FrameAnnounce(camera->camera_handle_, &frame->vmb_frame_, sizeof(vmb_frame_));
+    camera->api_->FrameAnnounce(capture_handle, &frame->vmb_frame_, sizeof(vmb_frame_));
 
   if (announce_error != VmbErrorSuccess) {
     return error{announce_error};
@@ -1715,11 +2593,12 @@ void VimbaXCamera::Frame::vmb_frame_callback(
   if (frame->receiveStatus == VmbFrameStatusType::VmbFrameStatusComplete) {
     auto shared_camera = shared_frame->camera_.lock();
     if (shared_camera) {
+      auto & stream = *shared_camera->streams_[shared_frame->stream_index_];
       {
-        std::lock_guard guard{shared_camera->frame_ready_queue_mutex_};
-        shared_camera->frame_ready_queue_.push(shared_frame);
+        std::lock_guard guard{stream.frame_ready_queue_mutex};
+        stream.frame_ready_queue.push(shared_frame);
       }
-      shared_camera->frame_ready_cv_.notify_one();
+      stream.frame_ready_cv.notify_one();
     }
   } else {
     RCLCPP_WARN(get_logger(), "Frame with status %d received", frame->receiveStatus);
@@ -1734,6 +2613,10 @@ void VimbaXCamera::Frame::on_frame_ready()
   height = vmb_frame_.height;
   is_bigendian = false;
 
+  if (stream_index_ != 0) {
+    step = width * ((vmb_frame_.pixelFormat >> 16) & 0xFF) / 8;
+  }
+
 
   transform();
 
@@ -1747,16 +2630,7 @@ uint64_t VimbaXCamera::Frame::timestamp_to_ns(uint64_t timestamp) const
   if (!camera_.expired()) {
     auto camera = camera_.lock();
 
-
-    if (camera->timestamp_frequency_) {
-      RCLCPP_DEBUG(get_logger(), "Using timestamp frequency %ld", *camera->timestamp_frequency_);
-
-      if (*camera->timestamp_frequency_ > std::nano::den) {
-        return timestamp / ((*camera->timestamp_frequency_) / std::nano::den);
-      } else {
-        return timestamp * (std::nano::den / (*camera->timestamp_frequency_));
-      }
-    }
+    return camera->device_timestamp_to_ns(timestamp);
   }
 
   return timestamp;
@@ -1789,16 +2663,85 @@ void VimbaXCamera::Frame::transform()
       }
       break;
   }
+
+  if (stream_index_ == 0) {
+    if (auto camera = camera_.lock()) {
+      if (auto correction = camera->get_pixel_correction()) {
+        correction->apply(*this);
+      }
+    }
+  }
 }
 
-VimbaXCamera::Frame::Frame(std::shared_ptr<VimbaXCamera> camera, AllocationMode allocation_mode)
-: camera_{camera}, allocation_mode_{allocation_mode}
+VimbaXCamera::Frame::Frame(
+  std::shared_ptr<VimbaXCamera> camera, AllocationMode allocation_mode, uint32_t stream_index)
+: camera_{camera}, buffer_pool_{camera->frame_buffer_pool_},
+  allocation_mode_{allocation_mode}, stream_index_{stream_index}
 {
   vmb_frame_.context[0] = this;
 }
 
 VimbaXCamera::Frame::~Frame()
 {
+  if (buffer_pool_) {
+    buffer_pool_->put(std::move(data));
+  }
+}
+
+void VimbaXCamera::Frame::allocate(size_t size)
+{
+  if (buffer_pool_) {
+    data = buffer_pool_->take(size);
+  }
+
+  data.resize(size);
+}
+
+std::vector<uint8_t> VimbaXCamera::FrameBufferPool::take(size_t capacity)
+{
+  std::lock_guard lock{mutex_};
+
+  auto const it = std::find_if(
+    buffers_.begin(), buffers_.end(), [capacity](const auto & buffer) {
+      return buffer.capacity() >= capacity;
+    });
+
+  if (it == buffers_.end()) {
+    return {};
+  }
+
+  auto buffer = std::move(*it);
+  buffers_.erase(it);
+  buffer.clear();
+
+  return buffer;
+}
+
+void VimbaXCamera::FrameBufferPool::put(std::vector<uint8_t> && buffer)
+{
+  if (buffer.capacity() == 0) {
+    return;
+  }
+
+  std::lock_guard lock{mutex_};
+  if (retaining_) {
+    buffers_.push_back(std::move(buffer));
+  }
+}
+
+void VimbaXCamera::FrameBufferPool::clear()
+{
+  std::lock_guard lock{mutex_};
+  buffers_.clear();
+}
+
+void VimbaXCamera::FrameBufferPool::set_retaining(bool retaining)
+{
+  std::lock_guard lock{mutex_};
+  retaining_ = retaining;
+  if (!retaining_) {
+    buffers_.clear();
+  }
 }
 
 
@@ -1811,12 +2754,35 @@ int32_t VimbaXCamera::Frame::queue() const
 {
   if (!camera_.expired()) {
     auto camera = camera_.lock();
-    return camera->api_->CaptureFrameQueue(camera->camera_handle_, &vmb_frame_, vmb_frame_callback);
+    return camera->api_->CaptureFrameQueue(
+      camera->streams_[stream_index_]->capture_handle, &vmb_frame_, vmb_frame_callback);
   }
 
   return VmbErrorUnknown;
 }
 
+uint32_t VimbaXCamera::Frame::get_bit_depth() const
+{
+  switch (VmbPixelFormatType(vmb_frame_.pixelFormat)) {
+    case VmbPixelFormatMono10:
+    case VmbPixelFormatBayerBG10:
+    case VmbPixelFormatBayerGB10:
+    case VmbPixelFormatBayerGR10:
+    case VmbPixelFormatBayerRG10:
+      return 10;
+    case VmbPixelFormatMono12:
+    case VmbPixelFormatBayerBG12:
+    case VmbPixelFormatBayerGB12:
+    case VmbPixelFormatBayerGR12:
+    case VmbPixelFormatBayerRG12:
+      return 12;
+    case VmbPixelFormatMono14:
+      return 14;
+    default:
+      return uint32_t(sensor_msgs::image_encodings::bitDepth(encoding));
+  }
+}
+
 std::string VimbaXCamera::Frame::get_image_encoding() const
 {
   switch (VmbPixelFormatType(vmb_frame_.pixelFormat)) {
@@ -1902,4 +2868,9 @@ uint64_t VimbaXCamera::Frame::get_timestamp_ns() const
   return timestamp_to_ns(vmb_frame_.timestamp);
 }
 
+uint32_t VimbaXCamera::Frame::get_stream_index() const
+{
+  return stream_index_;
+}
+
 }  // namespace vimbax_camera
@@ -0,0 +1,386 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_statistics.hpp>
+#include <vimbax_camera/vimbax_camera_auto_exposure.hpp>
+
+namespace vimbax_camera
+{
+
+using helper::get_logger;
+using helper::vmb_error_to_string;
+
+namespace
+{
+// Natural logarithm of the linear gain per dB
+const double log_gain_per_db = std::log(10.0) / 20.0;
+// Lower bound of the measured brightness, so a black image doesn't produce an infinite step
+constexpr double brightness_min = 1e-4;
+}  // namespace
+
+AutoExposureLoop::AutoExposureLoop(double target, double kp, double ki, const Limits & limits)
+: target_{target}, kp_{kp}, ki_{ki}, limits_{limits}
+{
+}
+
+void AutoExposureLoop::reset(double exposure_time, double gain)
+{
+  log_total_ = std::log(std::max(exposure_time, 1e-9)) + gain * log_gain_per_db;
+  last_error_.reset();
+}
+
+std::pair<double, double> AutoExposureLoop::update(double brightness)
+{
+  auto const error = std::log(target_) - std::log(std::max(brightness, brightness_min));
+
+  // Velocity form, the proportional part acts on the change of the error. The integral
+  // is the log total itself, so clamping it prevents windup.
+  log_total_ += kp_ * (error - last_error_.value_or(error)) + ki_ * error;
+  last_error_ = error;
+
+  auto const log_total_min =
+    std::log(limits_.exposure_time_min) + limits_.gain_min * log_gain_per_db;
+  auto const log_total_max =
+    std::log(limits_.exposure_time_max) + limits_.gain_max * log_gain_per_db;
+  log_total_ = std::clamp(log_total_, log_total_min, log_total_max);
+
+  auto const exposure_time = std::clamp(
+    std::exp(log_total_ - limits_.gain_min * log_gain_per_db),
+    limits_.exposure_time_min, limits_.exposure_time_max);
+  auto const gain = std::clamp(
+    (log_total_ - std::log(exposure_time)) / log_gain_per_db, limits_.gain_min, limits_.gain_max);
+
+  return {exposure_time, gain};
+}
+
+result<AutoExposureRegion> AutoExposureRegion::parse(const std::string & definition)
+{
+  std::istringstream stream{definition};
+  int64_t values[4]{};
+  double weight{};
+  char comma{};
+
+  stream >> values[0];
+  for (std::size_t i = 1; i < 4; i++) {
+    stream >> comma >> values[i];
+
+    if (comma != ',') {
+      return error{VmbErrorBadParameter};
+    }
+  }
+
+  stream >> comma >> weight;
+
+  if (comma != ',' || stream.fail() || !(stream >> std::ws).eof()) {
+    return error{VmbErrorBadParameter};
+  }
+
+  if (values[0] < 0 || values[1] < 0 || values[2] <= 0 || values[3] <= 0 || weight <= 0.0 ||
+    values[0] + values[2] > UINT32_MAX || values[1] + values[3] > UINT32_MAX)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  return AutoExposureRegion{
+    sensor_msgs::msg::RegionOfInterest{}
+    .set__x_offset(uint32_t(values[0])).set__y_offset(uint32_t(values[1]))
+    .set__width(uint32_t(values[2])).set__height(uint32_t(values[3])),
+    weight};
+}
+
+result<std::shared_ptr<AutoExposureController>> AutoExposureController::create(
+  std::shared_ptr<VimbaXCamera> camera, const Settings & settings, StatusCallback callback,
+  FeatureChangeQueue * change_queue)
+{
+  RCLCPP_DEBUG(get_logger(), "%s", __FUNCTION__);
+
+  auto const exposure_time_feature = camera->feature_handle_get(SFNCFeatures::ExposureTime);
+
+  if (!exposure_time_feature) {
+    return exposure_time_feature.error();
+  }
+
+  auto const exposure_time_info = camera->feature_float_info_get(SFNCFeatures::ExposureTime);
+
+  if (!exposure_time_info) {
+    return exposure_time_info.error();
+  }
+
+  auto limits = AutoExposureLoop::Limits{
+    std::max(exposure_time_info->min, 1e-3), exposure_time_info->max, 0.0, 0.0};
+
+  if (settings.exposure_time_max >= 0.0) {
+    limits.exposure_time_max =
+      std::clamp(settings.exposure_time_max, limits.exposure_time_min, limits.exposure_time_max);
+  }
+
+  // Cameras without gain are controlled by the exposure time only
+  auto const gain_feature = camera->feature_handle_get(SFNCFeatures::Gain);
+  auto const gain_info = camera->feature_float_info_get(SFNCFeatures::Gain);
+
+  if (gain_feature && gain_info) {
+    limits.gain_min = gain_info->min;
+    limits.gain_max = settings.gain_max >= 0.0 ?
+      std::clamp(settings.gain_max, gain_info->min, gain_info->max) : gain_info->max;
+  }
+
+  for (auto const & auto_feature : {SFNCFeatures::ExposureAuto, SFNCFeatures::GainAuto}) {
+    if (camera->has_feature(auto_feature)) {
+      auto const off_result = camera->feature_enum_set(auto_feature, "Off");
+
+      if (!off_result) {
+        RCLCPP_WARN(
+          get_logger(), "Switching off %s failed with %d (%s)", auto_feature.data(),
+          off_result.error().code, vmb_error_to_string(off_result.error().code).data());
+      }
+    }
+  }
+
+  std::shared_ptr<AutoExposureController> controller{
+    new AutoExposureController(camera, settings, std::move(callback), limits)};
+
+  controller->exposure_time_feature_ = *exposure_time_feature;
+  controller->change_queue_ = change_queue;
+
+  if (gain_feature && gain_info) {
+    controller->gain_feature_ = *gain_feature;
+  }
+
+  auto const exposure_time = camera->feature_float_get(*exposure_time_feature);
+  auto const gain = controller->gain_feature_ ?
+    camera->feature_float_get(*controller->gain_feature_) : result<_Float64>{limits.gain_min};
+
+  controller->status_.exposure_time = exposure_time ? *exposure_time : limits.exposure_time_min;
+  controller->status_.gain = gain ? *gain : limits.gain_min;
+  controller->loop_.reset(controller->status_.exposure_time, controller->status_.gain);
+
+  controller->thread_ = std::thread{[controller = controller.get()] {controller->run();}};
+
+  return controller;
+}
+
+AutoExposureController::AutoExposureController(
+  std::shared_ptr<VimbaXCamera> camera, const Settings & settings, StatusCallback callback,
+  const AutoExposureLoop::Limits & limits)
+: camera_{std::move(camera)}, settings_{settings}, callback_{std::move(callback)},
+  loop_{settings.target, settings.kp, settings.ki, limits}
+{
+}
+
+AutoExposureController::~AutoExposureController()
+{
+  {
+    std::lock_guard lock{mutex_};
+    stop_ = true;
+  }
+
+  cv_.notify_all();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+result<double> AutoExposureController::measure(
+  const sensor_msgs::msg::Image & image, uint32_t bit_depth, uint32_t stride,
+  const std::vector<AutoExposureRegion> & regions)
+{
+  if (regions.empty()) {
+    auto const statistics = ImageStatistics::compute(image, bit_depth, stride);
+
+    if (!statistics) {
+      return statistics.error();
+    }
+
+    return statistics->mean;
+  }
+
+  double weighted_sum{0.0};
+  double weight_sum{0.0};
+
+  for (auto const & region : regions) {
+    auto const statistics = ImageStatistics::compute(image, bit_depth, stride, region.region);
+
+    if (statistics) {
+      weighted_sum += statistics->mean * region.weight;
+      weight_sum += region.weight;
+    } else if (statistics.error().code == VmbErrorNotSupported) {
+      return statistics.error();
+    }
+  }
+
+  if (weight_sum == 0.0) {
+    return error{VmbErrorInvalidValue};
+  }
+
+  return weighted_sum / weight_sum;
+}
+
+void AutoExposureController::process(const VimbaXCamera::Frame & frame)
+{
+  {
+    std::lock_guard lock{mutex_};
+    frame_count_++;
+    last_frame_id_ = frame.get_frame_id();
+
+    // Frames still exposed with the previous settings would make the loop overshoot
+    if (frame_count_ <= settled_frame_count_) {
+      return;
+    }
+  }
+
+  auto const brightness =
+    measure(frame, frame.get_bit_depth(), settings_.stride, settings_.regions);
+
+  if (!brightness) {
+    return;
+  }
+
+  {
+    std::lock_guard lock{mutex_};
+    brightness_ = *brightness;
+  }
+
+  cv_.notify_one();
+}
+
+void AutoExposureController::run()
+{
+  auto const update_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(
+      settings_.max_update_rate > 0.0 ? 1.0 / settings_.max_update_rate : 0.0));
+  auto next_update = std::chrono::steady_clock::now();
+
+  auto & status = status_;
+  uint64_t settling_start{0};
+
+  while (true) {
+    double brightness{};
+
+    {
+      std::unique_lock lock{mutex_};
+      cv_.wait_until(lock, next_update, [this] {return stop_;});
+      cv_.wait(lock, [this] {return stop_ || brightness_;});
+
+      if (stop_) {
+        return;
+      }
+
+      brightness = *std::exchange(brightness_, std::nullopt);
+    }
+
+    status.brightness = brightness;
+    status.update_count++;
+
+    auto const converged = std::abs(brightness - settings_.target) <= settings_.tolerance;
+
+    if (converged && !status.converged) {
+      status.settling_updates = status.update_count - settling_start;
+    } else if (!converged && status.converged) {
+      settling_start = status.update_count;
+    }
+
+    status.converged_updates = converged ? status.converged_updates + 1 : 0;
+    status.converged = converged;
+
+    if (!converged) {
+      auto const [exposure_time, gain] = loop_.update(brightness);
+
+      if (change_queue_) {
+        auto const last_frame_id = [this] {
+            std::lock_guard lock{mutex_};
+            return last_frame_id_;
+          }();
+
+        // Applied right away from this thread together with the changes queued meanwhile.
+        // A frame callback applying the queue first may write it instead, or it may stay
+        // queued behind a deferred change, so it is not waited for and doesn't refer to the
+        // controller.
+        change_queue_->push(
+          [camera = camera_, exposure_time_feature = exposure_time_feature_,
+          gain_feature = gain_feature_, exposure_time = exposure_time, gain = gain] {
+            return std::optional<bool>{
+              write(*camera, exposure_time_feature, gain_feature, exposure_time, gain)};
+          });
+        change_queue_->apply(last_frame_id);
+      } else {
+        write(*camera_, exposure_time_feature_, gain_feature_, exposure_time, gain);
+      }
+
+      {
+        std::lock_guard lock{mutex_};
+        settled_frame_count_ = frame_count_ + settings_.settle_frames;
+        brightness_.reset();
+      }
+
+      status.exposure_time = exposure_time;
+      status.gain = gain;
+      next_update = std::chrono::steady_clock::now() + update_interval;
+    }
+
+    if (callback_) {
+      callback_(status);
+    }
+  }
+}
+
+bool AutoExposureController::write(
+  const VimbaXCamera & camera, const VimbaXCamera::FeatureHandle & exposure_time_feature,
+  const std::optional<VimbaXCamera::FeatureHandle> & gain_feature, double exposure_time,
+  double gain)
+{
+  auto const exposure_result = camera.feature_float_set(exposure_time_feature, exposure_time);
+  if (!exposure_result) {
+    RCLCPP_WARN(
+      get_logger(), "Setting ExposureTime failed with %d (%s)", exposure_result.error().code,
+      vmb_error_to_string(exposure_result.error().code).data());
+  }
+
+  if (!gain_feature) {
+    return bool(exposure_result);
+  }
+
+  auto const gain_result = camera.feature_float_set(*gain_feature, gain);
+  if (!gain_result) {
+    RCLCPP_WARN(
+      get_logger(), "Setting Gain failed with %d (%s)", gain_result.error().code,
+      vmb_error_to_string(gain_result.error().code).data());
+  }
+
+  return exposure_result || gain_result;
+}
+
+}  // namespace vimbax_camera
@@ -0,0 +1,517 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_correction.hpp>
+
+namespace vimbax_camera
+{
+
+using helper::get_logger;
+
+namespace
+{
+// Correction file (all values little endian):
+//   header   magic "VXPC", version, width, height, bytes per pixel, defect count, 2 reserved
+//   dark     width * height uint16
+//   gain     width * height uint16
+//   defects  defect count uint32 pixel indices
+constexpr uint32_t file_magic = 0x43505856;  // "VXPC"
+constexpr uint32_t file_version = 1;
+constexpr std::size_t header_size = 32;
+
+template<typename T>
+void put_le(uint8_t * dst, T value)
+{
+  for (std::size_t i = 0; i < sizeof(T); i++) {
+    dst[i] = uint8_t(uint64_t(value) >> (8 * i));
+  }
+}
+
+template<typename T>
+T get_le(const uint8_t * src)
+{
+  uint64_t value{};
+  for (std::size_t i = 0; i < sizeof(T); i++) {
+    value |= uint64_t(src[i]) << (8 * i);
+  }
+  return T(value);
+}
+
+struct Format
+{
+  uint32_t bytes_per_pixel;
+  bool is_bayer;
+};
+
+// Mono and Bayer images with 8 or 16 bit, bytes_per_pixel is 0 for other encodings
+Format image_format(const sensor_msgs::msg::Image & image)
+{
+  std::string_view const encoding{image.encoding};
+  auto const is_bayer = encoding.rfind("bayer_", 0) == 0 && encoding.size() > 10;
+
+  if (encoding == "mono8" || (is_bayer && encoding.substr(10) == "8")) {
+    return {1, is_bayer};
+  } else if (encoding == "mono16" || (is_bayer && encoding.substr(10) == "16")) {
+    return {2, is_bayer};
+  }
+
+  return {0, false};
+}
+
+// Median is robust against the defective pixels the maps are used to find
+template<typename T>
+double median(std::vector<T> values)
+{
+  if (values.empty()) {
+    return 0.0;
+  }
+
+  auto const middle = values.begin() + values.size() / 2;
+  std::nth_element(values.begin(), middle, values.end());
+
+  return double(*middle);
+}
+
+uint32_t full_scale(uint32_t bytes_per_pixel)
+{
+  return bytes_per_pixel == 1 ? 0xFF : 0xFFFF;
+}
+
+// Averages the defective pixels of a row from the next pixels of the same color, defects is
+// advanced past the row
+template<typename T>
+void replace_defects(
+  T * row, uint32_t width, uint32_t row_begin, uint32_t distance,
+  std::vector<uint32_t>::const_iterator & defect, std::vector<uint32_t>::const_iterator end)
+{
+  for (; defect != end && *defect < row_begin + width; defect++) {
+    auto const x = *defect - row_begin;
+    auto const has_left = x >= distance;
+    auto const has_right = x + distance < width;
+
+    if (has_left && has_right) {
+      row[x] = T((uint32_t(row[x - distance]) + row[x + distance] + 1) / 2);
+    } else if (has_left) {
+      row[x] = row[x - distance];
+    } else if (has_right) {
+      row[x] = row[x + distance];
+    }
+  }
+}
+}  // namespace
+
+FrameAverage::FrameAverage(uint32_t frame_count)
+: frame_count_{std::clamp<uint32_t>(frame_count, 1, max_frame_count)}
+{
+}
+
+result<void> FrameAverage::add(const sensor_msgs::msg::Image & image)
+{
+  auto const format = image_format(image);
+
+  if (format.bytes_per_pixel == 0) {
+    return error{VmbErrorNotSupported};
+  }
+
+  if (image.step < image.width * format.bytes_per_pixel ||
+    image.data.size() < std::size_t(image.step) * image.height)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  if (count_ == 0) {
+    width_ = image.width;
+    height_ = image.height;
+    bytes_per_pixel_ = format.bytes_per_pixel;
+    is_bayer_ = format.is_bayer;
+    sums_.assign(std::size_t(width_) * height_, 0);
+  } else if (image.width != width_ || image.height != height_ ||
+    format.bytes_per_pixel != bytes_per_pixel_ || format.is_bayer != is_bayer_)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  if (complete()) {
+    return {};
+  }
+
+  for (uint32_t y = 0; y < height_; y++) {
+    auto const row = image.data.data() + std::size_t(y) * image.step;
+    auto sum = sums_.data() + std::size_t(y) * width_;
+
+    if (bytes_per_pixel_ == 1) {
+      for (uint32_t x = 0; x < width_; x++) {
+        sum[x] += row[x];
+      }
+    } else {
+      for (uint32_t x = 0; x < width_; x++) {
+        uint16_t value;
+        std::memcpy(&value, row + x * 2, sizeof(value));
+        sum[x] += value;
+      }
+    }
+  }
+
+  count_++;
+
+  return {};
+}
+
+bool FrameAverage::complete() const
+{
+  return count_ >= frame_count_;
+}
+
+uint32_t FrameAverage::count() const
+{
+  return count_;
+}
+
+std::vector<uint16_t> FrameAverage::mean() const
+{
+  std::vector<uint16_t> mean(sums_.size());
+
+  if (count_ > 0) {
+    std::transform(
+      sums_.begin(), sums_.end(), mean.begin(), [this](uint32_t sum) {
+        // Rounding a sum of max_frame_count saturated pixels exceeds 32 bit
+        return uint16_t((uint64_t{sum} + count_ / 2) / count_);
+      });
+  }
+
+  return mean;
+}
+
+uint32_t FrameAverage::width() const
+{
+  return width_;
+}
+
+uint32_t FrameAverage::height() const
+{
+  return height_;
+}
+
+uint32_t FrameAverage::bytes_per_pixel() const
+{
+  return bytes_per_pixel_;
+}
+
+bool FrameAverage::is_bayer() const
+{
+  return is_bayer_;
+}
+
+result<std::shared_ptr<const PixelCorrection>> PixelCorrection::create(
+  uint32_t width, uint32_t height, uint32_t bytes_per_pixel, std::vector<uint16_t> dark,
+  std::vector<uint16_t> gain, std::vector<uint32_t> defects)
+{
+  auto const pixel_count = std::size_t(width) * height;
+
+  if (width == 0 || height == 0 || (bytes_per_pixel != 1 && bytes_per_pixel != 2) ||
+    dark.size() != pixel_count || gain.size() != pixel_count)
+  {
+    return error{VmbErrorBadParameter};
+  }
+
+  std::sort(defects.begin(), defects.end());
+  defects.erase(std::unique(defects.begin(), defects.end()), defects.end());
+
+  if (!defects.empty() && defects.back() >= pixel_count) {
+    return error{VmbErrorBadParameter};
+  }
+
+  std::shared_ptr<PixelCorrection> correction{new PixelCorrection()};
+  correction->width_ = width;
+  correction->height_ = height;
+  correction->bytes_per_pixel_ = bytes_per_pixel;
+  correction->dark_ = std::move(dark);
+  correction->gain_ = std::move(gain);
+  correction->defects_ = std::move(defects);
+
+  return std::shared_ptr<const PixelCorrection>{correction};
+}
+
+result<std::shared_ptr<const PixelCorrection>> PixelCorrection::load(const std::string & filename)
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, filename.c_str());
+
+  std::ifstream file{filename, std::ios::binary};
+
+  if (!file) {
+    return error{VmbErrorNotFound};
+  }
+
+  std::vector<uint8_t> const data{
+    std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+  if (data.size() < header_size || get_le<uint32_t>(data.data()) != file_magic ||
+    get_le<uint32_t>(data.data() + 4) != file_version)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  auto const width = get_le<uint32_t>(data.data() + 8);
+  auto const height = get_le<uint32_t>(data.data() + 12);
+  auto const bytes_per_pixel = get_le<uint32_t>(data.data() + 16);
+  auto const defect_count = get_le<uint32_t>(data.data() + 20);
+  auto const pixel_count = std::size_t(width) * height;
+
+  if (data.size() != header_size + pixel_count * 4 + std::size_t(defect_count) * 4) {
+    return error{VmbErrorInvalidValue};
+  }
+
+  std::vector<uint16_t> dark(pixel_count);
+  std::vector<uint16_t> gain(pixel_count);
+  std::vector<uint32_t> defects(defect_count);
+
+  auto position = data.data() + header_size;
+  for (auto & value : dark) {
+    value = get_le<uint16_t>(position);
+    position += 2;
+  }
+  for (auto & value : gain) {
+    value = get_le<uint16_t>(position);
+    position += 2;
+  }
+  for (auto & value : defects) {
+    value = get_le<uint32_t>(position);
+    position += 4;
+  }
+
+  return create(
+    width, height, bytes_per_pixel, std::move(dark), std::move(gain), std::move(defects));
+}
+
+result<void> PixelCorrection::save(const std::string & filename) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, filename.c_str());
+
+  std::vector<uint8_t> data(header_size + dark_.size() * 4 + defects_.size() * 4);
+
+  put_le<uint32_t>(data.data(), file_magic);
+  put_le<uint32_t>(data.data() + 4, file_version);
+  put_le<uint32_t>(data.data() + 8, width_);
+  put_le<uint32_t>(data.data() + 12, height_);
+  put_le<uint32_t>(data.data() + 16, bytes_per_pixel_);
+  put_le<uint32_t>(data.data() + 20, uint32_t(defects_.size()));
+
+  auto position = data.data() + header_size;
+  for (auto const value : dark_) {
+    put_le<uint16_t>(position, value);
+    position += 2;
+  }
+  for (auto const value : gain_) {
+    put_le<uint16_t>(position, value);
+    position += 2;
+  }
+  for (auto const value : defects_) {
+    put_le<uint32_t>(position, value);
+    position += 4;
+  }
+
+  std::ofstream file{filename, std::ios::binary | std::ios::trunc};
+  file.write(reinterpret_cast<const char *>(data.data()), std::streamsize(data.size()));
+
+  if (!file) {
+    RCLCPP_ERROR(get_logger(), "Failed to write correction file %s", filename.c_str());
+    return error{VmbErrorIO};
+  }
+
+  return {};
+}
+
+result<std::shared_ptr<const PixelCorrection>> PixelCorrection::from_dark(
+  const FrameAverage & dark, double threshold, const PixelCorrection * base)
+{
+  if (dark.count() == 0) {
+    return error{VmbErrorInvalidValue};
+  }
+
+  auto const pixel_count = std::size_t(dark.width()) * dark.height();
+  auto const keep_base = base != nullptr && base->width_ == dark.width() &&
+    base->height_ == dark.height() && base->bytes_per_pixel_ == dark.bytes_per_pixel();
+
+  auto dark_map = dark.mean();
+  auto gain_map = keep_base ? base->gain_ : std::vector<uint16_t>(pixel_count, gain_one);
+  auto defects = find_defects(dark_map, gain_map, dark.bytes_per_pixel(), threshold);
+
+  return create(
+    dark.width(), dark.height(), dark.bytes_per_pixel(), std::move(dark_map),
+    std::move(gain_map), std::move(defects));
+}
+
+result<std::shared_ptr<const PixelCorrection>> PixelCorrection::from_flat(
+  const FrameAverage & flat, double threshold, const PixelCorrection * base)
+{
+  if (flat.count() == 0) {
+    return error{VmbErrorInvalidValue};
+  }
+
+  auto const width = flat.width();
+  auto const height = flat.height();
+  auto const pixel_count = std::size_t(width) * height;
+  auto const keep_base = base != nullptr && base->width_ == width &&
+    base->height_ == height && base->bytes_per_pixel_ == flat.bytes_per_pixel();
+
+  auto dark_map = keep_base ? base->dark_ : std::vector<uint16_t>(pixel_count, 0);
+  auto const mean = flat.mean();
+
+  // Response above the dark level, each Bayer position of the 2x2 cell is its own channel
+  // normalized to its median
+  auto const channel = [&](std::size_t index) -> std::size_t {
+      return flat.is_bayer() ? ((index / width) % 2) * 2 + (index % width) % 2 : 0;
+    };
+
+  std::vector<uint32_t> response(pixel_count);
+  std::vector<uint32_t> channel_responses[4]{};
+
+  for (std::size_t i = 0; i < pixel_count; i++) {
+    response[i] = mean[i] > dark_map[i] ? uint32_t(mean[i] - dark_map[i]) : 0;
+    channel_responses[channel(i)].push_back(response[i]);
+  }
+
+  double channel_level[4]{};
+  for (std::size_t c = 0; c < 4; c++) {
+    channel_level[c] = median(std::move(channel_responses[c]));
+  }
+
+  std::vector<uint16_t> gain_map(pixel_count);
+
+  for (std::size_t i = 0; i < pixel_count; i++) {
+    auto const gain = response[i] > 0 ?
+      std::round(channel_level[channel(i)] / response[i] * gain_one) : double(UINT16_MAX);
+
+    gain_map[i] = uint16_t(std::clamp(gain, 0.0, double(UINT16_MAX)));
+  }
+
+  auto defects = find_defects(dark_map, gain_map, flat.bytes_per_pixel(), threshold);
+
+  return create(
+    width, height, flat.bytes_per_pixel(), std::move(dark_map), std::move(gain_map),
+    std::move(defects));
+}
+
+std::vector<uint32_t> PixelCorrection::find_defects(
+  const std::vector<uint16_t> & dark, const std::vector<uint16_t> & gain,
+  uint32_t bytes_per_pixel, double threshold)
+{
+  std::vector<uint32_t> defects{};
+
+  if (dark.empty()) {
+    return defects;
+  }
+
+  auto const dark_limit = median(dark) + threshold * full_scale(bytes_per_pixel);
+
+  for (std::size_t i = 0; i < dark.size(); i++) {
+    // The gain is the inverse of the response relative to the median of its color
+    auto const response = gain[i] > 0 ? double(gain_one) / gain[i] : 0.0;
+
+    if (dark[i] > dark_limit || std::abs(response - 1.0) > threshold) {
+      defects.push_back(uint32_t(i));
+    }
+  }
+
+  return defects;
+}
+
+bool PixelCorrection::apply(sensor_msgs::msg::Image & image) const
+{
+  auto const format = image_format(image);
+
+  if (image.width != width_ || image.height != height_ ||
+    format.bytes_per_pixel != bytes_per_pixel_ || image.step < width_ * bytes_per_pixel_ ||
+    image.data.size() < std::size_t(image.step) * height_)
+  {
+    return false;
+  }
+
+  // Pixels of the same color are two columns apart in Bayer images
+  auto const distance = format.is_bayer ? 2u : 1u;
+  auto defect = defects_.cbegin();
+
+  for (uint32_t y = 0; y < height_; y++) {
+    auto const row = image.data.data() + std::size_t(y) * image.step;
+    auto const offset = std::size_t(y) * width_;
+
+    if (bytes_per_pixel_ == 1) {
+      helper::correct_row8(row, dark_.data() + offset, gain_.data() + offset, width_);
+      replace_defects(row, width_, uint32_t(offset), distance, defect, defects_.cend());
+    } else {
+      auto const row16 = reinterpret_cast<uint16_t *>(row);
+      helper::correct_row16(row16, dark_.data() + offset, gain_.data() + offset, width_);
+      replace_defects(row16, width_, uint32_t(offset), distance, defect, defects_.cend());
+    }
+  }
+
+  return true;
+}
+
+uint32_t PixelCorrection::width() const
+{
+  return width_;
+}
+
+uint32_t PixelCorrection::height() const
+{
+  return height_;
+}
+
+uint32_t PixelCorrection::bytes_per_pixel() const
+{
+  return bytes_per_pixel_;
+}
+
+const std::vector<uint16_t> & PixelCorrection::dark() const
+{
+  return dark_;
+}
+
+const std::vector<uint16_t> & PixelCorrection::gain() const
+{
+  return gain_;
+}
+
+const std::vector<uint32_t> & PixelCorrection::defects() const
+{
+  return defects_;
+}
+
+}  // namespace vimbax_camera
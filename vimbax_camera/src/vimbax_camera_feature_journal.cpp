@@ -0,0 +1,124 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <iterator>
+#include <set>
+
+#include <vimbax_camera/vimbax_camera_feature_journal.hpp>
+
+namespace vimbax_camera
+{
+
+void FeatureWriteJournal::record(Write write)
+{
+  FeatureKey key{write.name, write.module};
+
+  if (write.is_selector) {
+    selector_state_[key] = value_key(write.value);
+    selector_state_id_ = selector_state_ids_.try_emplace(
+      selector_state_, uint32_t(selector_state_ids_.size() + 1)).first->second;
+
+    selectors_prune(writes_.emplace_hint(writes_.end(), next_sequence_++, std::move(write)));
+    return;
+  }
+
+  auto const [it, inserted] =
+    feature_writes_.try_emplace({std::move(key), selector_state_id_}, next_sequence_);
+
+  if (!inserted) {
+    // The selector writes around the replaced write may now directly follow each other
+    selectors_prune(writes_.erase(writes_.find(it->second)));
+    it->second = next_sequence_;
+  }
+
+  writes_.emplace_hint(writes_.end(), next_sequence_++, std::move(write));
+}
+
+std::vector<FeatureWriteJournal::Write> FeatureWriteJournal::take()
+{
+  std::vector<Write> writes{};
+  writes.reserve(writes_.size());
+
+  for (auto & [sequence, write] : writes_) {
+    writes.push_back(std::move(write));
+  }
+
+  clear();
+
+  return writes;
+}
+
+void FeatureWriteJournal::clear()
+{
+  writes_.clear();
+  feature_writes_.clear();
+  selector_state_.clear();
+  selector_state_ids_.clear();
+  selector_state_id_ = 0;
+}
+
+std::size_t FeatureWriteJournal::size() const
+{
+  return writes_.size();
+}
+
+FeatureWriteJournal::ValueKey FeatureWriteJournal::value_key(
+  const vimbax_camera_msgs::msg::FeatureValue & value)
+{
+  return {value.type, value.int_value, value.float_value, value.bool_value, value.string_value};
+}
+
+void FeatureWriteJournal::selectors_prune(Writes::iterator pos)
+{
+  std::set<FeatureKey> overwritten{};
+
+  for (auto it = pos; it != writes_.end() && it->second.is_selector; it++) {
+    overwritten.emplace(it->second.name, it->second.module);
+  }
+
+  if (overwritten.empty()) {
+    return;
+  }
+
+  // The run of selector writes before pos holds each selector at most once
+  for (auto it = pos; it != writes_.begin(); ) {
+    auto const previous = std::prev(it);
+
+    if (!previous->second.is_selector) {
+      break;
+    }
+
+    if (overwritten.count({previous->second.name, previous->second.module})) {
+      writes_.erase(previous);
+    } else {
+      it = previous;
+    }
+  }
+}
+
+}  // namespace vimbax_camera
@@ -0,0 +1,184 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include <vimbax_camera/vimbax_camera_feature_queue.hpp>
+
+namespace vimbax_camera
+{
+
+namespace
+{
+// Covers the frames waiting for their events in the frame correlator
+constexpr std::size_t max_written_count = 256;
+}  // namespace
+
+FeatureChangeQueue::FeatureChangeQueue(uint32_t latency_frames)
+: latency_frames_{latency_frames}
+{
+}
+
+void FeatureChangeQueue::set_write_timestamp(WriteTimestamp write_timestamp)
+{
+  write_timestamp_ = std::move(write_timestamp);
+}
+
+std::pair<uint64_t, std::future<bool>> FeatureChangeQueue::push(Apply apply)
+{
+  std::lock_guard lock{mutex_};
+
+  auto & entry = pending_.emplace_back(Pending{next_generation_++, std::move(apply), {}});
+
+  return {entry.generation, entry.applied.get_future()};
+}
+
+void FeatureChangeQueue::apply(std::optional<int64_t> frame_id)
+{
+  std::lock_guard apply_lock{apply_mutex_};
+
+  std::vector<Pending> pending{};
+  {
+    std::lock_guard lock{mutex_};
+    pending.swap(pending_);
+  }
+
+  for (auto it = pending.begin(); it != pending.end(); it++) {
+    auto & entry = *it;
+    auto const applied = entry.apply();
+
+    if (!applied) {
+      // Put back in front of the changes queued in the meantime to keep the order
+      std::lock_guard lock{mutex_};
+      pending_.insert(
+        pending_.begin(), std::make_move_iterator(it), std::make_move_iterator(pending.end()));
+      return;
+    }
+
+    if (*applied) {
+      auto const timestamp = write_timestamp_ ? write_timestamp_() : std::nullopt;
+
+      std::lock_guard lock{mutex_};
+
+      if (frame_id) {
+        // Changes applied late by another thread don't become active before earlier ones
+        auto const first_frame_id = std::max(
+          *frame_id + 1 + latency_frames_,
+          applied_.empty() ? std::numeric_limits<int64_t>::min() : applied_.back().first_frame_id);
+        applied_.push_back(Applied{entry.generation, first_frame_id});
+      } else {
+        applied_.clear();
+        generation_ = entry.generation;
+      }
+
+      if (timestamp) {
+        if (written_.size() == max_written_count) {
+          written_.pop_front();
+          written_dropped_ = true;
+        }
+
+        written_.push_back(Written{entry.generation, last_applied_generation_, *timestamp});
+      }
+
+      last_applied_generation_ = entry.generation;
+    }
+
+    entry.applied.set_value(*applied);
+  }
+}
+
+bool FeatureChangeQueue::cancel(uint64_t generation)
+{
+  std::lock_guard lock{mutex_};
+
+  auto const it = std::find_if(
+    pending_.begin(), pending_.end(),
+    [generation](auto const & entry) {return entry.generation == generation;});
+
+  if (it == pending_.end()) {
+    return false;
+  }
+
+  it->applied.set_value(false);
+  pending_.erase(it);
+
+  return true;
+}
+
+bool FeatureChangeQueue::pending() const
+{
+  std::lock_guard lock{mutex_};
+
+  return !pending_.empty();
+}
+
+uint64_t FeatureChangeQueue::generation(int64_t frame_id)
+{
+  std::lock_guard lock{mutex_};
+
+  while (!applied_.empty() && applied_.front().first_frame_id <= frame_id) {
+    generation_ = applied_.front().generation;
+    applied_.pop_front();
+  }
+
+  return generation_;
+}
+
+std::optional<uint64_t> FeatureChangeQueue::generation_at(uint64_t exposure_start_ns) const
+{
+  std::lock_guard lock{mutex_};
+
+  auto const it = std::upper_bound(
+    written_.begin(), written_.end(), exposure_start_ns,
+    [](uint64_t timestamp_ns, auto const & written) {return timestamp_ns < written.timestamp_ns;});
+
+  if (it != written_.begin()) {
+    return std::prev(it)->generation;
+  }
+
+  if (written_.empty() || written_dropped_) {
+    return std::nullopt;
+  }
+
+  return written_.front().previous_generation;
+}
+
+void FeatureChangeQueue::restart()
+{
+  std::lock_guard lock{mutex_};
+
+  if (!applied_.empty()) {
+    generation_ = applied_.back().generation;
+    applied_.clear();
+  }
+}
+
+}  // namespace vimbax_camera
@@ -0,0 +1,274 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+
+#include <vimbax_camera/vimbax_camera_frame_correlator.hpp>
+
+namespace vimbax_camera
+{
+
+namespace
+{
+constexpr std::string_view exposure_start_event = "ExposureStart";
+constexpr std::string_view exposure_end_event = "ExposureEnd";
+}  // namespace
+
+std::optional<uint64_t> FrameEventCorrelator::FrameEvents::exposure_midpoint_ns() const
+{
+  if (!exposure_start_ns || !exposure_end_ns || *exposure_end_ns < *exposure_start_ns) {
+    return std::nullopt;
+  }
+
+  return *exposure_start_ns + (*exposure_end_ns - *exposure_start_ns) / 2;
+}
+
+FrameEventCorrelator::FrameEventCorrelator(
+  std::size_t window, std::vector<std::string> expected_events)
+: window_{std::max<std::size_t>(window, 1)}, expected_events_{std::move(expected_events)}
+{
+  thread_ = std::thread{&FrameEventCorrelator::run, this};
+}
+
+FrameEventCorrelator::~FrameEventCorrelator()
+{
+  {
+    std::lock_guard lock{mutex_};
+    stop_ = true;
+  }
+
+  cv_.notify_all();
+  thread_.join();
+}
+
+void FrameEventCorrelator::add_event(
+  std::string_view name, int64_t frame_id, uint64_t timestamp_ns)
+{
+  std::lock_guard lock{mutex_};
+
+  if (std::find(expected_events_.begin(), expected_events_.end(), name) !=
+    expected_events_.end() &&
+    std::find(frame_event_names_.begin(), frame_event_names_.end(), name) ==
+    frame_event_names_.end())
+  {
+    frame_event_names_.emplace_back(name);
+  }
+
+  if (last_taken_frame_id_ && frame_id <= *last_taken_frame_id_) {
+    dropped_count_++;
+    return;
+  }
+
+  // Events usually arrive in frame order, so the entry is searched from the back
+  auto it = std::find_if(
+    pending_.rbegin(), pending_.rend(),
+    [frame_id](auto const & frame) {return frame.frame_id <= frame_id;}).base();
+
+  if (it == pending_.begin() || std::prev(it)->frame_id != frame_id) {
+    if (pending_.size() >= window_ && it == pending_.begin()) {
+      // Older than every frame in the window
+      dropped_count_++;
+      return;
+    }
+
+    it = pending_.insert(it, FrameEvents{frame_id, std::nullopt, std::nullopt, {}});
+
+    if (pending_.size() > window_) {
+      dropped_count_ += pending_.front().events.size();
+      pending_.pop_front();
+    }
+  } else {
+    it = std::prev(it);
+  }
+
+  if (name == exposure_start_event) {
+    it->exposure_start_ns = timestamp_ns;
+  } else if (name == exposure_end_event) {
+    it->exposure_end_ns = timestamp_ns;
+  }
+
+  it->events.push_back(Event{std::string{name}, timestamp_ns});
+
+  cv_.notify_all();
+}
+
+void FrameEventCorrelator::add_event(std::string_view name, uint64_t timestamp_ns)
+{
+  std::lock_guard lock{mutex_};
+
+  if (unassigned_.size() >= window_) {
+    dropped_count_++;
+    return;
+  }
+
+  unassigned_.push_back(Event{std::string{name}, timestamp_ns});
+}
+
+bool FrameEventCorrelator::is_complete(int64_t frame_id) const
+{
+  auto const it = std::find_if(
+    pending_.begin(), pending_.end(),
+    [frame_id](auto const & frame) {return frame.frame_id == frame_id;});
+
+  if (it == pending_.end()) {
+    return frame_event_names_.empty();
+  }
+
+  return std::all_of(
+    frame_event_names_.begin(), frame_event_names_.end(), [&it](auto const & name) {
+      return std::any_of(
+        it->events.begin(), it->events.end(),
+        [&name](auto const & event) {return event.name == name;});
+    });
+}
+
+FrameEventCorrelator::FrameEvents FrameEventCorrelator::take(
+  int64_t frame_id, std::chrono::nanoseconds max_wait)
+{
+  std::unique_lock lock{mutex_};
+
+  if (max_wait.count() > 0) {
+    auto const clear_count = clear_count_;
+    cv_.wait_for(
+      lock, max_wait, [&] {return clear_count_ != clear_count || is_complete(frame_id);});
+  }
+
+  return take_locked(frame_id);
+}
+
+FrameEventCorrelator::FrameEvents FrameEventCorrelator::take_locked(int64_t frame_id)
+{
+  FrameEvents frame_events{frame_id, std::nullopt, std::nullopt, {}};
+
+  while (!pending_.empty() && pending_.front().frame_id < frame_id) {
+    dropped_count_ += pending_.front().events.size();
+    pending_.pop_front();
+  }
+
+  if (!pending_.empty() && pending_.front().frame_id == frame_id) {
+    frame_events = std::move(pending_.front());
+    pending_.pop_front();
+  }
+
+  frame_events.events.insert(
+    frame_events.events.end(), std::make_move_iterator(unassigned_.begin()),
+    std::make_move_iterator(unassigned_.end()));
+  unassigned_.clear();
+
+  last_taken_frame_id_ = frame_id;
+
+  return frame_events;
+}
+
+void FrameEventCorrelator::take_async(
+  int64_t frame_id, std::chrono::nanoseconds max_wait, CompleteFunction complete)
+{
+  {
+    std::lock_guard lock{mutex_};
+    queued_.push_back(
+      QueuedFrame{
+        frame_id, std::chrono::steady_clock::now() + max_wait, clear_count_, std::move(complete)});
+  }
+
+  cv_.notify_all();
+}
+
+std::optional<uint64_t> FrameEventCorrelator::exposure_midpoint_ns(int64_t frame_id) const
+{
+  std::lock_guard lock{mutex_};
+
+  auto const it = std::find_if(
+    pending_.begin(), pending_.end(),
+    [frame_id](auto const & frame) {return frame.frame_id == frame_id;});
+
+  if (it == pending_.end()) {
+    return std::nullopt;
+  }
+
+  return it->exposure_midpoint_ns();
+}
+
+void FrameEventCorrelator::clear()
+{
+  std::lock_guard lock{mutex_};
+
+  pending_.clear();
+  unassigned_.clear();
+  frame_event_names_.clear();
+  last_taken_frame_id_.reset();
+  clear_count_++;
+
+  cv_.notify_all();
+}
+
+void FrameEventCorrelator::run()
+{
+  std::unique_lock lock{mutex_};
+
+  while (true) {
+    cv_.wait(lock, [this] {return stop_ || !queued_.empty();});
+
+    if (stop_) {
+      return;
+    }
+
+    // Only the back is added while waiting, so the front stays valid
+    auto const & front = queued_.front();
+    cv_.wait_until(
+      lock, front.deadline, [&] {
+        return stop_ || front.clear_count != clear_count_ || queued_.size() > window_ ||
+        is_complete(front.frame_id);
+      });
+
+    if (stop_) {
+      return;
+    }
+
+    auto queued = std::move(queued_.front());
+    queued_.pop_front();
+
+    // Frames of the stream before the last clear must not take events of the new one
+    auto frame_events = queued.clear_count == clear_count_ ?
+      take_locked(queued.frame_id) :
+      FrameEvents{queued.frame_id, std::nullopt, std::nullopt, {}};
+
+    lock.unlock();
+    queued.complete(std::move(frame_events));
+    lock.lock();
+  }
+}
+
+uint64_t FrameEventCorrelator::dropped_count() const
+{
+  std::lock_guard lock{mutex_};
+
+  return dropped_count_;
+}
+
+}  // namespace vimbax_camera
@@ -0,0 +1,236 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_frame_set.hpp>
+
+namespace vimbax_camera
+{
+
+using helper::get_logger;
+
+namespace
+{
+// Aggregators are shared by name between the nodes of one process
+std::mutex registry_mutex{};
+std::unordered_map<std::string, std::weak_ptr<FrameSetAggregator>> registry{};
+}  // namespace
+
+bool FrameSetAggregator::Settings::operator==(const Settings & other) const
+{
+  return members == other.members && match == other.match &&
+         tolerance_ns == other.tolerance_ns && max_pending == other.max_pending;
+}
+
+bool FrameSetAggregator::Set::complete() const
+{
+  return count == frames.size();
+}
+
+result<std::shared_ptr<FrameSetAggregator>> FrameSetAggregator::join(
+  const std::string & name, const Settings & settings)
+{
+  std::unordered_set<std::string> const unique{settings.members.begin(), settings.members.end()};
+
+  if (name.empty() || settings.members.empty() || unique.size() != settings.members.size() ||
+    settings.max_pending == 0)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  std::lock_guard lock{registry_mutex};
+
+  if (auto const existing = registry[name].lock()) {
+    if (!(existing->settings_ == settings)) {
+      RCLCPP_ERROR(get_logger(), "Frame set %s joined with different settings", name.c_str());
+      return error{VmbErrorInvalidValue};
+    }
+
+    return existing;
+  }
+
+  std::shared_ptr<FrameSetAggregator> aggregator{new FrameSetAggregator(name, settings)};
+  registry[name] = aggregator;
+
+  return aggregator;
+}
+
+FrameSetAggregator::FrameSetAggregator(std::string name, Settings settings)
+: name_{std::move(name)}, settings_{std::move(settings)}
+{
+  statistics_.missing_count.assign(settings_.members.size(), 0);
+}
+
+FrameSetAggregator::~FrameSetAggregator()
+{
+  std::lock_guard lock{registry_mutex};
+
+  // A new aggregator of the same name may already be registered
+  auto const it = registry.find(name_);
+  if (it != registry.end() && it->second.expired()) {
+    registry.erase(it);
+  }
+}
+
+std::optional<std::size_t> FrameSetAggregator::member_index(const std::string & member) const
+{
+  auto const it = std::find(settings_.members.begin(), settings_.members.end(), member);
+
+  if (it == settings_.members.end()) {
+    return std::nullopt;
+  }
+
+  return std::size_t(it - settings_.members.begin());
+}
+
+void FrameSetAggregator::set_release_callback(ReleaseFunction release)
+{
+  std::lock_guard lock{callback_mutex_};
+  release_ = std::move(release);
+}
+
+void FrameSetAggregator::set_images_wanted(bool wanted)
+{
+  images_wanted_.store(wanted, std::memory_order_relaxed);
+}
+
+bool FrameSetAggregator::images_wanted() const
+{
+  return images_wanted_.load(std::memory_order_relaxed);
+}
+
+uint64_t FrameSetAggregator::key(const Frame & frame) const
+{
+  return settings_.match == Match::FrameId ? frame.frame_id : frame.timestamp_ns;
+}
+
+void FrameSetAggregator::add(std::size_t member, Frame && frame)
+{
+  std::vector<Set> released{};
+  Statistics statistics{};
+  std::unique_lock<std::mutex> callback_lock{};
+
+  {
+    std::lock_guard lock{mutex_};
+
+    if (member >= settings_.members.size()) {
+      return;
+    }
+
+    auto const frame_key = key(frame);
+    auto const tolerance = settings_.match == Match::FrameId ? 0 : settings_.tolerance_ns;
+
+    auto const pending = std::find_if(
+      pending_.begin(), pending_.end(), [&](const PendingSet & candidate) {
+        auto const distance = std::max(candidate.key, frame_key) -
+        std::min(candidate.key, frame_key);
+        return distance <= tolerance && !candidate.set.frames[member];
+      });
+
+    if (pending != pending_.end()) {
+      pending->set.frames[member] = std::move(frame);
+      pending->set.count++;
+
+      if (pending->set.complete()) {
+        released.push_back(release(std::move(*pending)));
+        pending_.erase(pending);
+      }
+    } else {
+      PendingSet new_set{frame_key, Set{next_id_++, {}, 1, 0}};
+      new_set.set.frames.resize(settings_.members.size());
+      new_set.set.frames[member] = std::move(frame);
+
+      if (new_set.set.complete()) {
+        released.push_back(release(std::move(new_set)));
+      } else {
+        pending_.push_back(std::move(new_set));
+      }
+    }
+
+    while (pending_.size() > settings_.max_pending) {
+      released.push_back(release(std::move(pending_.front())));
+      pending_.pop_front();
+    }
+
+    if (released.empty()) {
+      return;
+    }
+
+    statistics = statistics_;
+    // Taken before the next frame can release later sets
+    callback_lock = std::unique_lock{callback_mutex_};
+  }
+
+  if (release_) {
+    for (auto & set : released) {
+      release_(std::move(set), statistics);
+    }
+  }
+}
+
+FrameSetAggregator::Set FrameSetAggregator::release(PendingSet && pending)
+{
+  auto & set = pending.set;
+  uint64_t first{UINT64_MAX};
+  uint64_t last{0};
+
+  for (std::size_t i = 0; i < set.frames.size(); i++) {
+    if (set.frames[i]) {
+      first = std::min(first, set.frames[i]->timestamp_ns);
+      last = std::max(last, set.frames[i]->timestamp_ns);
+    } else {
+      statistics_.missing_count[i]++;
+    }
+  }
+
+  set.skew_ns = last - first;
+
+  if (set.complete()) {
+    statistics_.complete_count++;
+    statistics_.max_skew_ns = std::max(statistics_.max_skew_ns, set.skew_ns);
+  } else {
+    statistics_.incomplete_count++;
+  }
+
+  return std::move(set);
+}
+
+FrameSetAggregator::Statistics FrameSetAggregator::statistics() const
+{
+  std::lock_guard lock{mutex_};
+  return statistics_;
+}
+
+}  // namespace vimbax_camera
@@ -38,6 +38,9 @@
 #define ATTRIBUTE_TARGET(tgt)
 #endif
 
+#include <algorithm>
+#include <limits>
+
 #include <VmbC/VmbCommonTypes.h>
 
 #include <vimbax_camera/vimbax_camera_helper.hpp>
@@ -140,6 +143,374 @@ void left_shift16(void * out, const void * in, ssize_t size, const int shift)
 }
 #endif
 
+static void accumulate_sum8_default(
+  row_statistics & statistics, const uint8_t * row, size_t begin, size_t width,
+  uint8_t saturation)
+{
+  for (size_t x = begin; x < width; x++) {
+    statistics.sum[x & 1] += row[x];
+    statistics.saturated[x & 1] += row[x] >= saturation ? 1 : 0;
+  }
+}
+
+static void accumulate_gradient8_default(
+  row_statistics & statistics, const uint8_t * row, size_t begin, size_t width)
+{
+  for (size_t x = begin; x + 2 < width; x++) {
+    auto const diff = int32_t(row[x + 2]) - int32_t(row[x]);
+    statistics.gradient += uint64_t(diff * diff);
+  }
+}
+
+#ifdef USE_X86_SIMD
+ATTRIBUTE_TARGET(avx2)
+void accumulate_row8(
+  row_statistics & statistics, const uint8_t * row, size_t width, uint8_t saturation)
+{
+  auto const zero = _mm256_setzero_si256();
+  auto const even_mask = _mm256_set1_epi16(0x00FF);
+  auto const threshold = _mm256_set1_epi8(char(saturation));
+  auto sum_even = zero;
+  auto sum_odd = zero;
+  auto gradient = zero;
+
+  size_t x = 0;
+  for (; x + 32 <= width; x += 32) {
+    auto const value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + x));
+    sum_even = _mm256_add_epi64(
+      sum_even, _mm256_sad_epu8(_mm256_and_si256(value, even_mask), zero));
+    sum_odd = _mm256_add_epi64(sum_odd, _mm256_sad_epu8(_mm256_srli_epi16(value, 8), zero));
+
+    auto const saturated = uint32_t(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(value, threshold), value)));
+    statistics.saturated[0] += __builtin_popcount(saturated & 0x55555555u);
+    statistics.saturated[1] += __builtin_popcount(saturated & 0xAAAAAAAAu);
+  }
+
+  accumulate_sum8_default(statistics, row, x, width, saturation);
+
+  // Each 32 bit lane grows by at most 4 * 255^2 per iteration, rows would need more than
+  // 130000 pixels to overflow it
+  x = 0;
+  for (; x + 34 <= width; x += 32) {
+    auto const value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + x));
+    auto const next = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + x + 2));
+    auto const diff = _mm256_or_si256(_mm256_subs_epu8(value, next), _mm256_subs_epu8(next, value));
+    auto const diff_low = _mm256_unpacklo_epi8(diff, zero);
+    auto const diff_high = _mm256_unpackhi_epi8(diff, zero);
+    gradient = _mm256_add_epi32(gradient, _mm256_madd_epi16(diff_low, diff_low));
+    gradient = _mm256_add_epi32(gradient, _mm256_madd_epi16(diff_high, diff_high));
+  }
+
+  accumulate_gradient8_default(statistics, row, x, width);
+
+  alignas(32) uint64_t sums[4];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(sums), sum_even);
+  statistics.sum[0] += sums[0] + sums[1] + sums[2] + sums[3];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(sums), sum_odd);
+  statistics.sum[1] += sums[0] + sums[1] + sums[2] + sums[3];
+
+  alignas(32) uint32_t gradients[8];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(gradients), gradient);
+  for (auto const value : gradients) {
+    statistics.gradient += value;
+  }
+}
+
+ATTRIBUTE_TARGET(sse2)
+void accumulate_row8(
+  row_statistics & statistics, const uint8_t * row, size_t width, uint8_t saturation)
+{
+  auto const zero = _mm_setzero_si128();
+  auto const even_mask = _mm_set1_epi16(0x00FF);
+  auto const threshold = _mm_set1_epi8(char(saturation));
+  auto sum_even = zero;
+  auto sum_odd = zero;
+  auto gradient = zero;
+
+  size_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    auto const value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+    sum_even = _mm_add_epi64(sum_even, _mm_sad_epu8(_mm_and_si128(value, even_mask), zero));
+    sum_odd = _mm_add_epi64(sum_odd, _mm_sad_epu8(_mm_srli_epi16(value, 8), zero));
+
+    auto const saturated = uint32_t(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(value, threshold), value)));
+    statistics.saturated[0] += __builtin_popcount(saturated & 0x5555u);
+    statistics.saturated[1] += __builtin_popcount(saturated & 0xAAAAu);
+  }
+
+  accumulate_sum8_default(statistics, row, x, width, saturation);
+
+  x = 0;
+  for (; x + 18 <= width; x += 16) {
+    auto const value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+    auto const next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x + 2));
+    auto const diff = _mm_or_si128(_mm_subs_epu8(value, next), _mm_subs_epu8(next, value));
+    auto const diff_low = _mm_unpacklo_epi8(diff, zero);
+    auto const diff_high = _mm_unpackhi_epi8(diff, zero);
+    gradient = _mm_add_epi32(gradient, _mm_madd_epi16(diff_low, diff_low));
+    gradient = _mm_add_epi32(gradient, _mm_madd_epi16(diff_high, diff_high));
+  }
+
+  accumulate_gradient8_default(statistics, row, x, width);
+
+  alignas(16) uint64_t sums[2];
+  _mm_store_si128(reinterpret_cast<__m128i *>(sums), sum_even);
+  statistics.sum[0] += sums[0] + sums[1];
+  _mm_store_si128(reinterpret_cast<__m128i *>(sums), sum_odd);
+  statistics.sum[1] += sums[0] + sums[1];
+
+  alignas(16) uint32_t gradients[4];
+  _mm_store_si128(reinterpret_cast<__m128i *>(gradients), gradient);
+  for (auto const value : gradients) {
+    statistics.gradient += value;
+  }
+}
+#endif
+
+ATTRIBUTE_TARGET(default)
+void accumulate_row8(
+  row_statistics & statistics, const uint8_t * row, size_t width, uint8_t saturation)
+{
+  accumulate_sum8_default(statistics, row, 0, width, saturation);
+  accumulate_gradient8_default(statistics, row, 0, width);
+}
+
+template<typename T>
+static void correct_row_default(
+  T * row, const uint16_t * dark, const uint16_t * gain, size_t begin, size_t width)
+{
+  constexpr uint32_t max = std::numeric_limits<T>::max();
+
+  for (size_t x = begin; x < width; x++) {
+    auto const value = row[x] > dark[x] ? uint32_t(row[x] - dark[x]) : 0u;
+    row[x] = T(std::min((value * gain[x]) >> 12, max));
+  }
+}
+
+#ifdef USE_X86_SIMD
+ATTRIBUTE_TARGET(avx2)
+void correct_row8(uint8_t * row, const uint16_t * dark, const uint16_t * gain, size_t width)
+{
+  auto const zero = _mm256_setzero_si256();
+
+  size_t x = 0;
+  for (; x + 32 <= width; x += 32) {
+    auto const value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + x));
+    // The unpacked halves hold the pixels 0-7 and 16-23, 8-15 and 24-31 because the unpack
+    // works within 128 bit lanes, the maps are loaded in the same order
+    auto const dark_0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dark + x));
+    auto const dark_1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dark + x + 16));
+    auto const gain_0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(gain + x));
+    auto const gain_1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(gain + x + 16));
+    auto const dark_low = _mm256_permute2x128_si256(dark_0, dark_1, 0x20);
+    auto const dark_high = _mm256_permute2x128_si256(dark_0, dark_1, 0x31);
+    auto const gain_low = _mm256_permute2x128_si256(gain_0, gain_1, 0x20);
+    auto const gain_high = _mm256_permute2x128_si256(gain_0, gain_1, 0x31);
+
+    // (value << 4) * gain >> 16 is value * gain >> 12, the products of 8 bit values fit
+    auto const low = _mm256_mulhi_epu16(
+      _mm256_slli_epi16(_mm256_subs_epu16(_mm256_unpacklo_epi8(value, zero), dark_low), 4),
+      gain_low);
+    auto const high = _mm256_mulhi_epu16(
+      _mm256_slli_epi16(_mm256_subs_epu16(_mm256_unpackhi_epi8(value, zero), dark_high), 4),
+      gain_high);
+
+    _mm256_storeu_si256(
+      reinterpret_cast<__m256i *>(row + x), _mm256_packus_epi16(low, high));
+  }
+
+  correct_row_default(row, dark, gain, x, width);
+}
+
+ATTRIBUTE_TARGET(avx2)
+void correct_row16(uint16_t * row, const uint16_t * dark, const uint16_t * gain, size_t width)
+{
+  auto const limit = _mm256_set1_epi16(0x0FFF);
+  auto const zero = _mm256_setzero_si256();
+  auto const ones = _mm256_cmpeq_epi16(zero, zero);
+
+  size_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    auto const value = _mm256_subs_epu16(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + x)),
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dark + x)));
+    auto const factor = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(gain + x));
+
+    // Bits 12 to 27 of the 32 bit product, saturated if any higher bit is set
+    auto const low = _mm256_mullo_epi16(value, factor);
+    auto const high = _mm256_mulhi_epu16(value, factor);
+    auto const result = _mm256_or_si256(_mm256_slli_epi16(high, 4), _mm256_srli_epi16(low, 12));
+    auto const in_range = _mm256_cmpeq_epi16(_mm256_subs_epu16(high, limit), zero);
+
+    _mm256_storeu_si256(
+      reinterpret_cast<__m256i *>(row + x),
+      _mm256_or_si256(result, _mm256_andnot_si256(in_range, ones)));
+  }
+
+  correct_row_default(row, dark, gain, x, width);
+}
+
+ATTRIBUTE_TARGET(sse2)
+void correct_row8(uint8_t * row, const uint16_t * dark, const uint16_t * gain, size_t width)
+{
+  auto const zero = _mm_setzero_si128();
+
+  size_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    auto const value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+    auto const low = _mm_mulhi_epu16(
+      _mm_slli_epi16(
+        _mm_subs_epu16(
+          _mm_unpacklo_epi8(value, zero),
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(dark + x))), 4),
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(gain + x)));
+    auto const high = _mm_mulhi_epu16(
+      _mm_slli_epi16(
+        _mm_subs_epu16(
+          _mm_unpackhi_epi8(value, zero),
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(dark + x + 8))), 4),
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(gain + x + 8)));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(row + x), _mm_packus_epi16(low, high));
+  }
+
+  correct_row_default(row, dark, gain, x, width);
+}
+
+ATTRIBUTE_TARGET(sse2)
+void correct_row16(uint16_t * row, const uint16_t * dark, const uint16_t * gain, size_t width)
+{
+  auto const limit = _mm_set1_epi16(0x0FFF);
+  auto const zero = _mm_setzero_si128();
+  auto const ones = _mm_cmpeq_epi16(zero, zero);
+
+  size_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    auto const value = _mm_subs_epu16(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x)),
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(dark + x)));
+    auto const factor = _mm_loadu_si128(reinterpret_cast<const __m128i *>(gain + x));
+
+    auto const low = _mm_mullo_epi16(value, factor);
+    auto const high = _mm_mulhi_epu16(value, factor);
+    auto const result = _mm_or_si128(_mm_slli_epi16(high, 4), _mm_srli_epi16(low, 12));
+    auto const in_range = _mm_cmpeq_epi16(_mm_subs_epu16(high, limit), zero);
+
+    _mm_storeu_si128(
+      reinterpret_cast<__m128i *>(row + x), _mm_or_si128(result, _mm_andnot_si128(in_range, ones)));
+  }
+
+  correct_row_default(row, dark, gain, x, width);
+}
+#endif
+
+ATTRIBUTE_TARGET(default)
+void correct_row8(uint8_t * row, const uint16_t * dark, const uint16_t * gain, size_t width)
+{
+  correct_row_default(row, dark, gain, 0, width);
+}
+
+ATTRIBUTE_TARGET(default)
+void correct_row16(uint16_t * row, const uint16_t * dark, const uint16_t * gain, size_t width)
+{
+  correct_row_default(row, dark, gain, 0, width);
+}
+
+static void remap_row8_default(
+  uint8_t * dst, const uint8_t * src, size_t step, const int32_t * offsets,
+  const uint16_t * fractions, size_t begin, size_t width)
+{
+  for (size_t x = begin; x < width; x++) {
+    if (offsets[x] < 0) {
+      dst[x] = 0;
+      continue;
+    }
+
+    auto const top = src + offsets[x];
+    auto const bottom = top + step;
+    uint32_t const fx = fractions[x] & 0xFF;
+    uint32_t const fy = fractions[x] >> 8;
+    auto const top_value = top[0] * (128 - fx) + top[1] * fx;
+    auto const bottom_value = bottom[0] * (128 - fx) + bottom[1] * fx;
+
+    dst[x] = uint8_t((top_value * (128 - fy) + bottom_value * fy + 8192) >> 14);
+  }
+}
+
+#ifdef USE_X86_SIMD
+ATTRIBUTE_TARGET(avx2)
+void remap_row8(
+  uint8_t * dst, const uint8_t * src, size_t src_size, size_t step, const int32_t * offsets,
+  const uint16_t * fractions, size_t width)
+{
+  // The gathers read 4 bytes, groups with an offset closer to the end fall back to scalar
+  auto const limit = _mm256_set1_epi32(
+    int32_t(std::min<size_t>(src_size - std::min(src_size, step + 4), INT32_MAX)));
+  auto const low_byte = _mm256_set1_epi32(0xFF);
+  auto const high_byte = _mm256_set1_epi32(0xFF00);
+  auto const one = _mm256_set1_epi32(128);
+  auto const round = _mm256_set1_epi32(8192);
+  auto const minus_one = _mm256_set1_epi32(-1);
+  auto const order = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+  auto const bottom_src = reinterpret_cast<const int *>(src + step);
+
+  size_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    auto const offset = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(offsets + x));
+
+    if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(offset, limit)) != 0) {
+      remap_row8_default(dst, src, step, offsets, fractions, x, x + 8);
+      continue;
+    }
+
+    // Lanes of pixels outside of the image are not loaded and stay 0
+    auto const valid = _mm256_cmpgt_epi32(offset, minus_one);
+    auto const top = _mm256_mask_i32gather_epi32(
+      _mm256_setzero_si256(), reinterpret_cast<const int *>(src), offset, valid, 1);
+    auto const bottom = _mm256_mask_i32gather_epi32(
+      _mm256_setzero_si256(), bottom_src, offset, valid, 1);
+
+    // Both pixels of a row as 16 bit pair, weighted with 128 - f and f by one madd
+    auto const top_pair = _mm256_or_si256(
+      _mm256_and_si256(top, low_byte), _mm256_slli_epi32(_mm256_and_si256(top, high_byte), 8));
+    auto const bottom_pair = _mm256_or_si256(
+      _mm256_and_si256(bottom, low_byte),
+      _mm256_slli_epi32(_mm256_and_si256(bottom, high_byte), 8));
+
+    auto const fraction = _mm256_cvtepu16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(fractions + x)));
+    auto const fx = _mm256_and_si256(fraction, low_byte);
+    auto const fy = _mm256_srli_epi32(fraction, 8);
+    auto const weight_x = _mm256_or_si256(_mm256_sub_epi32(one, fx), _mm256_slli_epi32(fx, 16));
+    auto const weight_y = _mm256_or_si256(_mm256_sub_epi32(one, fy), _mm256_slli_epi32(fy, 16));
+
+    auto const top_value = _mm256_madd_epi16(top_pair, weight_x);
+    auto const bottom_value = _mm256_madd_epi16(bottom_pair, weight_x);
+    auto const value = _mm256_srli_epi32(
+      _mm256_add_epi32(
+        _mm256_madd_epi16(
+          _mm256_or_si256(top_value, _mm256_slli_epi32(bottom_value, 16)), weight_y), round), 14);
+
+    // Each lane holds its 4 bytes in the first element after packing
+    auto const words = _mm256_packus_epi32(value, value);
+    auto const bytes = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(words, words), order);
+
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + x), _mm256_castsi256_si128(bytes));
+  }
+
+  remap_row8_default(dst, src, step, offsets, fractions, x, width);
+}
+#endif
+
+ATTRIBUTE_TARGET(default)
+void remap_row8(
+  uint8_t * dst, const uint8_t * src, size_t, size_t step, const int32_t * offsets,
+  const uint16_t * fractions, size_t width)
+{
+  remap_row8_default(dst, src, step, offsets, fractions, 0, width);
+}
 
 std::string_view vmb_error_to_string(int32_t error_code)
 {
@@ -0,0 +1,395 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <regex>
+#include <sstream>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_index.hpp>
+
+namespace vimbax_camera
+{
+using helper::get_logger;
+using helper::vmb_error_to_string;
+
+std::optional<uint32_t> decode_ip_addr(const std::string & ip_addr_str)
+{
+  const std::regex ip_addr_regex{"([0-9]{1,3}).([0-9]{1,3}).([0-9]{1,3}).([0-9]{1,3})"};
+  std::smatch match;
+  if (!std::regex_match(ip_addr_str, match, ip_addr_regex)) {
+    return {};
+  }
+
+  uint32_t ip_addr = uint32_t(std::stoi(match[1]) & 0xFF) << 24 |
+    uint32_t(std::stoi(match[2]) & 0xFF) << 16 |
+    uint32_t(std::stoi(match[3]) & 0xFF) << 8 |
+    uint32_t(std::stoi(match[4]) & 0xFF);
+
+  return ip_addr;
+}
+
+
+std::optional<uint64_t> decode_mac_addr(const std::string & mac_addr_str)
+{
+  // Matching formats: aa:bb:cc:dd:ee:ff, aa-bb-cc-dd-ee-ff, aabbccddeeff
+  const std::regex mac_addr_regex{
+    "([0-9a-zA-Z]{2})[:-]?([0-9a-zA-Z]{2})[:-]?([0-9a-zA-Z]{2})[:-]?"
+    "([0-9a-zA-Z]{2})[:-]?([0-9a-zA-Z]{2})[:-]?([0-9a-zA-Z]{2})"};
+  std::smatch match;
+  if (!std::regex_match(mac_addr_str, match, mac_addr_regex)) {
+    return {};
+  }
+
+  uint64_t mac_addr = uint64_t(std::stoi(match[1], 0, 16) & 0xFF) << 40 |
+    uint64_t(std::stoi(match[2], 0, 16) & 0xFF) << 32 |
+    uint64_t(std::stoi(match[3], 0, 16) & 0xFF) << 24 |
+    uint64_t(std::stoi(match[4], 0, 16) & 0xFF) << 16 |
+    uint64_t(std::stoi(match[5], 0, 16) & 0xFF) << 8 |
+    uint64_t(std::stoi(match[6], 0, 16) & 0xFF);
+
+  return mac_addr;
+}
+
+std::string ip_addr_to_string(uint32_t ip_addr)
+{
+  return std::to_string((ip_addr >> 24) & 0xFF) + "." +
+         std::to_string((ip_addr >> 16) & 0xFF) + "." +
+         std::to_string((ip_addr >> 8) & 0xFF) + "." +
+         std::to_string(ip_addr & 0xFF);
+}
+
+std::string mac_addr_to_string(uint64_t mac_addr)
+{
+  std::stringstream mac_addr_stream{};
+  mac_addr_stream << std::hex << std::setfill('0') << std::setw(2) << ((mac_addr >> 40) & 0xFF);
+  for (int i = 4; i >= 0; i--) {
+    mac_addr_stream << ":" << std::hex << std::setfill('0') << std::setw(2) <<
+      ((mac_addr >> (i * 8)) & 0xFF);
+  }
+
+  return mac_addr_stream.str();
+}
+
+VimbaXCameraIndex::VimbaXCameraIndex(std::shared_ptr<VmbCAPI> api)
+: api_{std::move(api)}
+{
+}
+
+result<void> VimbaXCameraIndex::rebuild()
+{
+  std::unordered_map<VmbHandle_t, std::vector<GevDevice>> gev_devices_by_interface{};
+
+  auto const interface_list = api_->interface_list_get();
+  if (interface_list) {
+    for (auto const & interface : *interface_list) {
+      if (interface.interfaceType == VmbTransportLayerTypeGEV) {
+        gev_devices_by_interface.emplace(
+          interface.interfaceHandle, gev_devices_get(interface.interfaceHandle));
+      }
+    }
+  }
+
+  uint32_t available_cameras_count{0};
+  auto const count_error = api_->CamerasList(nullptr, 0, &available_cameras_count, 0);
+
+  if (count_error != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "Reading camera list size failed with error %d (%s)", count_error,
+      (vmb_error_to_string(count_error)).data());
+    return error{count_error};
+  }
+
+  std::vector<VmbCameraInfo_t> camera_list{};
+  camera_list.resize(available_cameras_count);
+  uint32_t cameras_found = 0;
+
+  auto const list_error = api_->CamerasList(
+    camera_list.data(), available_cameras_count, &cameras_found, sizeof(VmbCameraInfo_t));
+
+  if (list_error != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "Listing cameras failed with error %d (%s)", list_error,
+      (vmb_error_to_string(list_error)).data());
+    return error{list_error};
+  }
+
+  camera_list.resize(std::min(cameras_found, available_cameras_count));
+
+  std::vector<Entry> entries{};
+  for (auto const & info : camera_list) {
+    auto const gev_devices_it = gev_devices_by_interface.find(info.interfaceHandle);
+    entries.push_back(
+      create_entry(
+        info, gev_devices_it != gev_devices_by_interface.end() ?
+        gev_devices_it->second : std::vector<GevDevice>{}));
+  }
+
+  std::unique_lock lock{mutex_};
+  entries_.clear();
+  camera_id_by_name_.clear();
+  camera_id_by_ip_.clear();
+  camera_id_by_mac_.clear();
+
+  for (auto & entry : entries) {
+    insert(std::move(entry));
+  }
+
+  RCLCPP_DEBUG(get_logger(), "Camera index holds %zu camera(s)", entries_.size());
+
+  return {};
+}
+
+void VimbaXCameraIndex::on_camera_detected(const std::string & camera_id)
+{
+  VmbCameraInfo info{};
+  auto const err = api_->CameraInfoQuery(camera_id.c_str(), &info, sizeof(info));
+
+  if (err != VmbErrorSuccess) {
+    RCLCPP_WARN(
+      get_logger(), "Querying detected camera %s failed with error %d (%s)", camera_id.c_str(),
+      err, (vmb_error_to_string(err)).data());
+    return;
+  }
+
+  // Only the interface the camera was detected on needs to be scanned for its addresses
+  auto entry = create_entry(info, gev_devices_get(info.interfaceHandle));
+
+  std::unique_lock lock{mutex_};
+  erase(entry.camera_id);
+  insert(std::move(entry));
+}
+
+void VimbaXCameraIndex::on_camera_missing(const std::string & camera_id)
+{
+  std::unique_lock lock{mutex_};
+  auto const indexed_camera_id = camera_id_find(camera_id);
+
+  if (indexed_camera_id) {
+    erase(*indexed_camera_id);
+  }
+}
+
+std::optional<VimbaXCameraIndex::Entry> VimbaXCameraIndex::find(const std::string & key) const
+{
+  std::shared_lock lock{mutex_};
+  auto const camera_id = camera_id_find(key);
+
+  if (!camera_id) {
+    return std::nullopt;
+  }
+
+  return entries_.at(*camera_id);
+}
+
+std::vector<VimbaXCameraIndex::Entry> VimbaXCameraIndex::list() const
+{
+  std::vector<Entry> entries{};
+
+  {
+    std::shared_lock lock{mutex_};
+    entries.reserve(entries_.size());
+    for (auto const & [camera_id, entry] : entries_) {
+      entries.push_back(entry);
+    }
+  }
+
+  std::sort(
+    entries.begin(), entries.end(), [](auto const & lhs, auto const & rhs) {
+      return lhs.camera_id < rhs.camera_id;
+    });
+
+  for (auto & entry : entries) {
+    VmbCameraInfo info{};
+    auto const err = api_->CameraInfoQuery(entry.camera_id.c_str(), &info, sizeof(info));
+
+    if (err == VmbErrorSuccess) {
+      entry.permitted_access = info.permittedAccess;
+    }
+  }
+
+  return entries;
+}
+
+std::vector<VimbaXCameraIndex::GevDevice> VimbaXCameraIndex::gev_devices_get(
+  VmbHandle_t interface_handle) const
+{
+  std::vector<GevDevice> devices{};
+
+  if (!interface_handle) {
+    return devices;
+  }
+
+  auto const selector_info = api_->feature_int_info_get(interface_handle, "DeviceSelector");
+  if (!selector_info) {
+    return devices;
+  }
+
+  for (VmbInt64_t i = (*selector_info)[0]; i <= (*selector_info)[1]; i++) {
+    if (!api_->feature_int_set(interface_handle, "DeviceSelector", i)) {
+      continue;
+    }
+
+    auto const device_id = api_->feature_string_get(interface_handle, "DeviceID");
+    if (!device_id) {
+      continue;
+    }
+
+    auto & device = devices.emplace_back(GevDevice{*device_id, std::nullopt, std::nullopt});
+
+    auto const ip_address =
+      api_->feature_int_get(interface_handle, SFNCFeatures::GevDeviceIPAddress);
+    if (ip_address) {
+      device.ip_address = uint32_t(*ip_address);
+    }
+
+    auto const mac_address =
+      api_->feature_int_get(interface_handle, SFNCFeatures::GevDeviceMACAddress);
+    if (mac_address) {
+      device.mac_address = uint64_t(*mac_address);
+    }
+  }
+
+  return devices;
+}
+
+VimbaXCameraIndex::Entry VimbaXCameraIndex::create_entry(
+  const VmbCameraInfo & info, const std::vector<GevDevice> & gev_devices) const
+{
+  auto const to_string = [](const char * str) {
+      return str ? std::string{str} : std::string{};
+    };
+
+  Entry entry{};
+  entry.camera_id = to_string(info.cameraIdString);
+  entry.extended_id = to_string(info.cameraIdExtended);
+  entry.display_name = to_string(info.cameraName);
+  entry.model_name = to_string(info.modelName);
+  entry.serial_number = to_string(info.serialString);
+  entry.permitted_access = info.permittedAccess;
+
+  if (info.interfaceHandle) {
+    auto const interface_id =
+      api_->feature_string_get(info.interfaceHandle, SFNCFeatures::InterfaceId);
+    if (interface_id) {
+      entry.interface_id = *interface_id;
+    }
+  }
+
+  auto const device_it = std::find_if(
+    gev_devices.begin(), gev_devices.end(), [&entry](auto const & device) {
+      return device.device_id == entry.camera_id;
+    });
+
+  if (device_it != gev_devices.end()) {
+    entry.ip_address = device_it->ip_address;
+    entry.mac_address = device_it->mac_address;
+  }
+
+  return entry;
+}
+
+void VimbaXCameraIndex::insert(Entry entry)
+{
+  auto const camera_id = entry.camera_id;
+
+  for (auto const & name : {entry.camera_id, entry.extended_id, entry.serial_number}) {
+    if (!name.empty()) {
+      camera_id_by_name_.insert_or_assign(name, camera_id);
+    }
+  }
+
+  if (entry.ip_address) {
+    camera_id_by_ip_.insert_or_assign(*entry.ip_address, camera_id);
+  }
+
+  if (entry.mac_address) {
+    camera_id_by_mac_.insert_or_assign(*entry.mac_address, camera_id);
+  }
+
+  entries_.insert_or_assign(camera_id, std::move(entry));
+}
+
+void VimbaXCameraIndex::erase(const std::string & camera_id)
+{
+  auto const it = entries_.find(camera_id);
+  if (it == entries_.end()) {
+    return;
+  }
+
+  auto const & entry = it->second;
+
+  for (auto const & name : {entry.camera_id, entry.extended_id, entry.serial_number}) {
+    auto const name_it = camera_id_by_name_.find(name);
+    if (name_it != camera_id_by_name_.end() && name_it->second == camera_id) {
+      camera_id_by_name_.erase(name_it);
+    }
+  }
+
+  if (entry.ip_address) {
+    auto const ip_it = camera_id_by_ip_.find(*entry.ip_address);
+    if (ip_it != camera_id_by_ip_.end() && ip_it->second == camera_id) {
+      camera_id_by_ip_.erase(ip_it);
+    }
+  }
+
+  if (entry.mac_address) {
+    auto const mac_it = camera_id_by_mac_.find(*entry.mac_address);
+    if (mac_it != camera_id_by_mac_.end() && mac_it->second == camera_id) {
+      camera_id_by_mac_.erase(mac_it);
+    }
+  }
+
+  entries_.erase(it);
+}
+
+std::optional<std::string> VimbaXCameraIndex::camera_id_find(const std::string & key) const
+{
+  auto const name_it = camera_id_by_name_.find(key);
+  if (name_it != camera_id_by_name_.end()) {
+    return name_it->second;
+  }
+
+  auto const ip_addr = decode_ip_addr(key);
+  if (ip_addr) {
+    auto const ip_it = camera_id_by_ip_.find(*ip_addr);
+    return ip_it != camera_id_by_ip_.end() ? std::optional{ip_it->second} : std::nullopt;
+  }
+
+  auto const mac_addr = decode_mac_addr(key);
+  if (mac_addr) {
+    auto const mac_it = camera_id_by_mac_.find(*mac_addr);
+    return mac_it != camera_id_by_mac_.end() ? std::optional{mac_it->second} : std::nullopt;
+  }
+
+  return std::nullopt;
+}
+
+}  // namespace vimbax_camera
@@ -94,6 +94,10 @@ bool VimbaXCameraNode::initialize(const rclcpp::NodeOptions & options)
     return false;
   }
 
+  if (!initialize_profiles()) {
+    return false;
+  }
+
   if (!initialize_camera()) {
     return false;
   }
@@ -106,6 +110,10 @@ bool VimbaXCameraNode::initialize(const rclcpp::NodeOptions & options)
     return false;
   }
 
+  if (!initialize_roi_publisher()) {
+    return false;
+  }
+
   if (!initialize_feature_services()) {
     return false;
   }
@@ -114,6 +122,10 @@ bool VimbaXCameraNode::initialize(const rclcpp::NodeOptions & options)
     return false;
   }
 
+  if (!initialize_profile_services()) {
+    return false;
+  }
+
   if (!initialize_status_services()) {
     return false;
   }
@@ -122,10 +134,38 @@ bool VimbaXCameraNode::initialize(const rclcpp::NodeOptions & options)
     return false;
   }
 
+  if (!initialize_recording_services()) {
+    return false;
+  }
+
+  if (!initialize_burst_capture_action()) {
+    return false;
+  }
+
   if (!initialize_events()) {
     return false;
   }
 
+  if (!initialize_frame_correlation()) {
+    return false;
+  }
+
+  if (!initialize_pretrigger()) {
+    return false;
+  }
+
+  if (!initialize_pixel_correction()) {
+    return false;
+  }
+
+  if (!initialize_frame_set()) {
+    return false;
+  }
+
+  if (!initialize_ptp_sync()) {
+    return false;
+  }
+
   if (!initialize_graph_notify()) {
     return false;
   }
@@ -139,6 +179,36 @@ VimbaXCameraNode::~VimbaXCameraNode()
 {
   stop_threads_.store(true, std::memory_order::memory_order_relaxed);
 
+  // Burst capture threads abort once they see stop_threads_
+  {
+    std::unique_lock lock{burst_capture_mutex_};
+    burst_capture_cv_.wait(lock, [this] {return burst_capture_threads_ == 0;});
+  }
+
+  // The other members of the frame set may outlive this node
+  if (frame_set_ && frame_set_member_ == 0) {
+    frame_set_->set_release_callback(nullptr);
+
+    {
+      std::lock_guard lock{frame_set_publish_mutex_};
+      frame_set_publish_queue_.clear();
+    }
+    frame_set_publish_cv_.notify_all();
+
+    if (frame_set_publish_thread_) {
+      frame_set_publish_thread_->join();
+    }
+  }
+
+  if (ptp_sync_) {
+    if (ptp_sync_member_ == 0) {
+      ptp_sync_->set_status_callback(nullptr);
+      ptp_sync_->set_skew_callback(nullptr);
+    }
+
+    ptp_sync_->detach(ptp_sync_member_);
+  }
+
   if (api_) {
     deinitialize_camera_observer();
   }
@@ -175,6 +245,9 @@ bool VimbaXCameraNode::initialize_events()
         if (!res) {
           return res.error().to_error_msg();
         }
+
+        std::lock_guard listeners_lock{feature_invalidation_listeners_mutex_};
+        feature_invalidation_listeners_.insert_or_assign(name, *res);
       } else {
         return vimbax_camera_msgs::msg::Error{}
         .set__code(VmbErrorNotFound).set__text("VmbErrorNotFound");
@@ -183,7 +256,19 @@ bool VimbaXCameraNode::initialize_events()
       return vimbax_camera_msgs::msg::Error{};
     },
     [this](const std::string & name) -> void {
-      camera_->feature_invalidation_unregister(name);
+      std::shared_lock lock(camera_mutex_);
+      std::lock_guard listeners_lock{feature_invalidation_listeners_mutex_};
+
+      auto const listener_it = feature_invalidation_listeners_.find(name);
+      if (listener_it == feature_invalidation_listeners_.end()) {
+        return;
+      }
+
+      if (is_available_) {
+        camera_->feature_invalidation_unregister(name, listener_it->second);
+      }
+
+      feature_invalidation_listeners_.erase(listener_it);
     });
 
   if (!feature_invalidation_event_publisher_) {
@@ -194,559 +279,1960 @@ bool VimbaXCameraNode::initialize_events()
     std::make_shared<vimbax_camera_events::EventPublisher<vimbax_camera_msgs::msg::EventData>>(
     node_, "events", [this](const std::string & name) -> vimbax_camera_msgs::msg::Error
     {
-      std::shared_lock lock(camera_mutex_);
-      if (is_available_) {
-        auto const event_feature_name = "Event" + name;
+      return event_subscribe(name, EventConsumer::Events);
+    },
+    [this](const std::string & name) -> void {
+      event_unsubscribe(name, EventConsumer::Events);
+    });
 
-        auto const sel_res = camera_->feature_enum_set(SFNCFeatures::EventSelector.data(), name);
+  if (!event_event_publisher_) {
+    return false;
+  }
 
-        if (!sel_res) {
-          return sel_res.error().to_error_msg();
-        }
+  typed_event_publisher_ = std::make_shared<
+    vimbax_camera_events::EventPublisher<vimbax_camera_msgs::msg::TypedEventData>>(
+    node_, "typed_events", [this](const std::string & name) -> vimbax_camera_msgs::msg::Error
+    {
+      return event_subscribe(name, EventConsumer::TypedEvents);
+    },
+    [this](const std::string & name) -> void {
+      event_unsubscribe(name, EventConsumer::TypedEvents);
+    });
 
-        auto const on_res = camera_->feature_enum_set(SFNCFeatures::EventNotification.data(), "On");
+  if (!typed_event_publisher_) {
+    return false;
+  }
 
-        if (!on_res) {
-          return on_res.error().to_error_msg();
-        }
+  return true;
+}
 
-        auto const res = camera_->feature_invalidation_register(
-          event_feature_name,
-          [this, name](auto)
-          {
-            auto const res = camera_->get_event_meta_data(name);
+bool VimbaXCameraNode::initialize_frame_correlation()
+{
+  auto const events = node_->get_parameter(parameter_frame_correlation_events).as_string_array();
 
-            vimbax_camera_msgs::msg::EventData data{};
+  if (events.empty()) {
+    return true;
+  }
 
-            if (res) {
-              std::transform(
-                res->cbegin(), res->cend(), std::back_inserter(data.entries),
-                [](auto pair) {
-                  return vimbax_camera_msgs::msg::EventDataEntry{}
-                  .set__name(pair.first).set__value(pair.second);
-                });
-            }
+  RCLCPP_INFO(get_logger(), "Initializing frame correlation ...");
 
-            event_event_publisher_->publish_event(name, data);
-          });
+  frame_event_correlator_ = std::make_unique<FrameEventCorrelator>(
+    node_->get_parameter(parameter_frame_correlation_window).as_int(), events);
+  frame_correlation_timeout_ = std::chrono::milliseconds{
+    node_->get_parameter(parameter_frame_correlation_timeout).as_int()};
 
-        if (!res) {
-          return res.error().to_error_msg();
+  for (auto const & event : events) {
+    auto const res = event_subscribe(event, EventConsumer::FrameCorrelation);
+
+    if (res.code != VmbErrorSuccess) {
+      RCLCPP_ERROR(
+        get_logger(), "Enabling event %s for frame correlation failed with error %d (%s)",
+        event.c_str(), res.code, res.text.c_str());
+    }
+  }
+
+  // The exposure start of the frames confirms which queued change they were exposed with
+  if (std::find(events.begin(), events.end(), "ExposureStart") != events.end()) {
+    feature_change_queue_->set_write_timestamp(
+      [this]() -> std::optional<uint64_t> {
+        std::shared_lock lock(camera_mutex_, std::try_to_lock);
+        if (!lock.owns_lock() || !is_available_) {
+          return std::nullopt;
         }
-      } else {
-        return vimbax_camera_msgs::msg::Error{}
-        .set__code(VmbErrorNotFound).set__text("VmbErrorNotFound");
-      }
 
-      return vimbax_camera_msgs::msg::Error{};
-    },
-    [this](const std::string & name) -> void {
-      std::shared_lock lock(camera_mutex_);
-      if (is_available_) {
-        auto const event_feature_name = "Event" + name;
+        auto const timestamp = camera_->device_timestamp_latch();
+        if (!timestamp) {
+          return std::nullopt;
+        }
 
-        camera_->feature_invalidation_unregister(event_feature_name);
+        return camera_->device_timestamp_to_ns(*timestamp);
+      });
+  }
 
-        auto const sel_res = camera_->feature_enum_set(SFNCFeatures::EventSelector.data(), name);
+  return true;
+}
 
-        if (!sel_res) {
-          return;
-        }
+bool VimbaXCameraNode::initialize_pretrigger()
+{
+  auto const duration = node_->get_parameter(parameter_pretrigger_duration).as_double();
+  auto const max_size = node_->get_parameter(parameter_pretrigger_max_size).as_int();
 
-        auto const off_res = camera_->feature_enum_set(
-          SFNCFeatures::EventNotification.data(), "Off");
+  if (duration <= 0.0 && max_size <= 0) {
+    return true;
+  }
 
-        if (!off_res) {
-          return;
-        }
-      } else {
-        return;
-      }
+  RCLCPP_INFO(get_logger(), "Initializing pre-trigger ring ...");
 
-      return;
-    });
+  auto const ring = PreTriggerRing::create(
+    PreTriggerRing::Settings{
+      uint64_t(std::max(duration, 0.0) * 1e9),
+      std::size_t(std::max<int64_t>(max_size, 0)) * 1024 * 1024,
+      int(node_->get_parameter(parameter_pretrigger_compression).as_int())});
 
-  if (!event_event_publisher_) {
+  if (!ring) {
+    RCLCPP_ERROR(
+      get_logger(), "Creating the pre-trigger ring failed with %d (%s)",
+      ring.error().code, vmb_error_to_string(ring.error().code).data());
     return false;
   }
 
-  return true;
-}
+  pretrigger_ring_ = *ring;
 
-bool VimbaXCameraNode::initialize_parameters()
-{
-  auto const cameraIdParamDesc = rcl_interfaces::msg::ParameterDescriptor{}
-  .set__description("Id of camera to open").set__read_only(true);
-  node_->declare_parameter(parameter_camera_id, "", cameraIdParamDesc);
+  // Keep all frames of a dump, as they are published at once
+  pretrigger_image_publisher_ = node_->create_publisher<sensor_msgs::msg::Image>(
+    "pretrigger/image_raw", rclcpp::QoS{rclcpp::KeepAll()});
 
-  auto const settingsFileParamDesc = rcl_interfaces::msg::ParameterDescriptor{}
-  .set__description("Settings file to load at startup").set__read_only(true);
-  node_->declare_parameter(parameter_settings_file, "", settingsFileParamDesc);
+  if (!pretrigger_image_publisher_) {
+    return false;
+  }
 
-  auto const bufferCountRange = rcl_interfaces::msg::IntegerRange{}
-  .set__from_value(3).set__step(1).set__to_value(1000);
-  auto const bufferCountParamDesc = rcl_interfaces::msg::ParameterDescriptor{}
-  .set__description("Number of buffers used for streaming").set__integer_range({bufferCountRange});
-  node_->declare_parameter(parameter_buffer_count, 7, bufferCountParamDesc);
+  pretrigger_dump_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::PreTriggerDump>(
+    "pretrigger/dump", [this](
+      const vimbax_camera_msgs::srv::PreTriggerDump::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::PreTriggerDump::Response::SharedPtr response)
+    {
+      std::shared_lock lock(camera_mutex_);
+      if (!is_available_) {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+        return;
+      }
 
-  auto const autostartStreamParamDesc = rcl_interfaces::msg::ParameterDescriptor{}
-  .set__description(
-    "Auto start/stop stream while subscribing/unsubscribing to image publisher").set__read_only(
-    false);
-  node_->declare_parameter(parameter_autostream, 1, autostartStreamParamDesc);
+      std::promise<result<void>> opened{};
+      auto opened_future = opened.get_future();
 
-  auto const command_feature_timeout_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
-  .set__description("Timeout for command features");
-  node_->declare_parameter(
-    parameter_command_feature_timeout, 0, command_feature_timeout_param_desc);
+      auto const frame_count = pretrigger_dump(*camera_, request->filename, std::move(opened));
 
-  auto const use_ros_time_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
-  .set__description("Use ROS time instead of camera timestamp in image message header");
-  node_->declare_parameter(parameter_use_ros_time, false, use_ros_time_param_desc);
+      if (!frame_count) {
+        response->set__error(frame_count.error().to_error_msg());
+        return;
+      }
 
-  parameter_callback_handle_ = node_->add_on_set_parameters_callback(
-    [this](
-      const std::vector<rclcpp::Parameter> & params) -> rcl_interfaces::msg::SetParametersResult {
-      for (auto const & param : params) {
-        if (param.get_name() == parameter_buffer_count) {
-          if (camera_->is_streaming()) {
-            return rcl_interfaces::msg::SetParametersResult{}
-            .set__successful(false)
-            .set__reason("Buffer count change not supported while streaming");
-          }
-        }
+      // Errors opening the file are still reported to the caller
+      auto const open_result = opened_future.get();
+
+      if (!open_result) {
+        response->set__error(open_result.error().to_error_msg());
+        return;
       }
 
-      return rcl_interfaces::msg::SetParametersResult{}.set__successful(true);
-    });
+      response->set__frame_count(*frame_count);
+    }, rmw_qos_profile_services_default, stream_start_stop_callback_group_);
 
-  return true;
-}
+  CHK_SVC(pretrigger_dump_service_);
 
-bool VimbaXCameraNode::initialize_api()
-{
-  RCLCPP_INFO(get_logger(), "Initializing VimbaX API ...");
-  RCLCPP_INFO(get_logger(), "Starting VimbaX camera node ...");
-  RCLCPP_INFO(get_logger(), "Loading VimbaX api ...");
-  api_ = VmbCAPI::get_instance();
-  if (!api_) {
-    RCLCPP_FATAL(get_logger(), "VmbC loading failed!");
-    rclcpp::shutdown();
-    return false;
-  }
+  for (auto const & event : node_->get_parameter(parameter_pretrigger_events).as_string_array()) {
+    auto const res = event_subscribe(event, EventConsumer::PreTrigger);
 
-  VmbVersionInfo_t versionInfo{};
-  if (api_->VersionQuery(&versionInfo, sizeof(versionInfo)) != VmbErrorSuccess) {
-    RCLCPP_WARN(get_logger(), "Reading VmbC version failed!");
+    if (res.code != VmbErrorSuccess) {
+      RCLCPP_ERROR(
+        get_logger(), "Enabling event %s for the pre-trigger ring failed with error %d (%s)",
+        event.c_str(), res.code, res.text.c_str());
+    }
   }
 
-  RCLCPP_INFO(
-    get_logger(), "Successfully loaded VmbC API version %d.%d.%d",
-    versionInfo.major, versionInfo.minor, versionInfo.patch);
-
   return true;
 }
 
-bool VimbaXCameraNode::initialize_publisher()
+bool VimbaXCameraNode::initialize_pixel_correction()
 {
-  RCLCPP_INFO(get_logger(), "Initializing publisher ...");
+  auto const filename = node_->get_parameter(parameter_correction_file).as_string();
+
+  if (!filename.empty()) {
+    auto const correction = PixelCorrection::load(filename);
+
+    if (correction) {
+      RCLCPP_INFO(
+        get_logger(), "Loaded %ux%u pixel correction with %zu defective pixels from %s",
+        (*correction)->width(), (*correction)->height(), (*correction)->defects().size(),
+        filename.c_str());
+
+      std::lock_guard correction_lock{pixel_correction_mutex_};
+      pixel_correction_ = *correction;
+    } else if (correction.error().code == VmbErrorNotFound) {
+      RCLCPP_WARN(
+        get_logger(), "Correction file %s not found, use correction/capture to create it",
+        filename.c_str());
+    } else {
+      RCLCPP_ERROR(
+        get_logger(), "Loading correction file %s failed with %d (%s)", filename.c_str(),
+        correction.error().code, vmb_error_to_string(correction.error().code).data());
+    }
+  }
 
-  auto qos = rmw_qos_profile_default;
-  qos.depth = 10;
+  {
+    std::shared_lock lock(camera_mutex_);
+    std::lock_guard correction_lock{pixel_correction_mutex_};
+    if (camera_ && node_->get_parameter(parameter_correction_enable).as_bool()) {
+      camera_->set_pixel_correction(pixel_correction_);
+    }
+  }
 
-  camera_publisher_ = image_transport::create_camera_publisher(node_.get(), "image_raw", qos);
+  correction_capture_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::CorrectionCapture>(
+    "correction/capture", [this](
+      const vimbax_camera_msgs::srv::CorrectionCapture::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::CorrectionCapture::Response::SharedPtr response)
+    {
+      auto const defect_count = pixel_correction_capture(request->type, request->frame_count);
 
-  if (!camera_publisher_) {
-    return false;
-  }
+      if (!defect_count) {
+        response->set__error(defect_count.error().to_error_msg());
+        return;
+      }
+
+      response->set__defect_count(*defect_count);
+    }, rmw_qos_profile_services_default, stream_start_stop_callback_group_);
+
+  CHK_SVC(correction_capture_service_);
 
   return true;
 }
 
-bool VimbaXCameraNode::initialize_camera(bool reconnect /*= false*/)
+result<uint32_t> VimbaXCameraNode::pixel_correction_capture(uint8_t type, uint32_t frame_count)
 {
-  RCLCPP_INFO(get_logger(), "Initializing camera ...");
+  using vimbax_camera_msgs::srv::CorrectionCapture;
 
-  std::unique_lock lock(camera_mutex_);
-  camera_ = VimbaXCamera::open(
-    api_, last_camera_id_.empty() ?
-    node_->get_parameter(parameter_camera_id).as_string() : last_camera_id_);
+  auto const is_dark = type == CorrectionCapture::Request::TYPE_DARK;
 
-  if (!camera_) {
-    if (reconnect) {
-      RCLCPP_WARN(get_logger(), "Failed to reopen camera");
-    } else {
-      RCLCPP_FATAL(get_logger(), "Failed to open camera");
-      rclcpp::shutdown();
-    }
-    return false;
+  if (frame_count == 0 || frame_count > FrameAverage::max_frame_count ||
+    (!is_dark && type != CorrectionCapture::Request::TYPE_FLAT))
+  {
+    return error{VmbErrorBadParameter};
   }
 
-  auto const result = camera_->query_camera_info();
-  if (result) {
-    last_camera_id_ = (*result).cameraIdString;
+  std::shared_lock lock(camera_mutex_);
+  if (!is_available_) {
+    return error{VmbErrorNotFound};
   }
 
-  auto const settingsFile = node_->get_parameter(parameter_settings_file).as_string();
+  if (!camera_->is_streaming()) {
+    return error{VmbErrorInvalidCall};
+  }
 
-  if (!settingsFile.empty()) {
-    auto const loadResult = camera_->settings_load(settingsFile);
-    if (!loadResult) {
-      RCLCPP_ERROR(
-        get_logger(), "Loading settings from file %s failed with error %d (%s)",
-        settingsFile.c_str(), loadResult.error().code,
-        (vmb_error_to_string(loadResult.error().code)).data());
-    }
+  {
+    std::lock_guard capture_lock{correction_capture_mutex_};
+    correction_capture_ = std::make_unique<FrameAverage>(frame_count);
+    correction_capture_error_ = VmbErrorSuccess;
   }
 
-  auto const info_res = camera_->camera_info_get();
+  // The maps are computed from uncorrected frames
+  camera_->set_pixel_correction(nullptr);
+  correction_capture_active_ = true;
+
+  auto const average = [&] {
+      std::unique_lock capture_lock{correction_capture_mutex_};
+      auto count = correction_capture_->count();
+
+      // Times out if no frame arrived for 5 s, so long exposures don't need a frame count
+      // dependent timeout
+      while (correction_capture_cv_.wait_for(
+          capture_lock, std::chrono::seconds(5), [&] {
+            return correction_capture_->complete() ||
+            correction_capture_error_ != VmbErrorSuccess || correction_capture_->count() != count;
+          }))
+      {
+        if (correction_capture_->complete() || correction_capture_error_ != VmbErrorSuccess) {
+          break;
+        }
 
-  if (!info_res) {
-    return false;
-  }
+        count = correction_capture_->count();
+      }
 
-  if (!reconnect) {
-    auto const camera_frame_id_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
-    .set__description("Frame id of published images").set__read_only(true);
-    node_->declare_parameter(
-      parameter_frame_id, "vimbax_camera_" + info_res->device_id, camera_frame_id_param_desc);
+      correction_capture_active_ = false;
 
+      return std::move(correction_capture_);
+    }();
 
-    auto const camera_info_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
-    .set__description("Url of camera info file").set__read_only(true);
+  std::lock_guard correction_lock{pixel_correction_mutex_};
 
-    node_->declare_parameter(parameter_camera_info_url, "", camera_info_param_desc);
+  if (node_->get_parameter(parameter_correction_enable).as_bool()) {
+    camera_->set_pixel_correction(pixel_correction_);
   }
 
-  camera_info_manager_ = std::make_shared<camera_info_manager::CameraInfoManager>(
-    node_.get(), info_res->device_id,
-    node_->get_parameter(parameter_camera_info_url).as_string());
+  if (correction_capture_error_ != VmbErrorSuccess) {
+    return error{correction_capture_error_};
+  }
 
-  is_available_ = true;
+  if (!average->complete()) {
+    RCLCPP_ERROR(
+      get_logger(), "Correction capture timed out after %u of %u frames", average->count(),
+      frame_count);
+    return error{VmbErrorTimeout};
+  }
 
-  return true;
-}
+  auto const threshold = node_->get_parameter(parameter_correction_defect_threshold).as_double();
+  auto const correction = is_dark ?
+    PixelCorrection::from_dark(*average, threshold, pixel_correction_.get()) :
+    PixelCorrection::from_flat(*average, threshold, pixel_correction_.get());
 
-bool VimbaXCameraNode::initialize_camera_observer()
-{
-  RCLCPP_INFO(get_logger(), "Initializing camera observer...");
+  if (!correction) {
+    return correction.error();
+  }
 
-  auto err = api_->FeatureEnumSet(
-    gVmbHandle, SFNCFeatures::EventSelector.data(), "CameraDiscovery");
+  auto const filename = node_->get_parameter(parameter_correction_file).as_string();
 
-  if (err != VmbErrorSuccess) {
-    RCLCPP_ERROR(
-      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
-      (vmb_error_to_string(err)).data());
-    return false;
+  if (!filename.empty()) {
+    auto const save_result = (*correction)->save(filename);
+
+    if (!save_result) {
+      return save_result.error();
+    }
   }
 
-  err = api_->FeatureEnumSet(
-    gVmbHandle, SFNCFeatures::EventNotification.data(), "On");
+  pixel_correction_ = *correction;
 
-  if (err != VmbErrorSuccess) {
-    RCLCPP_ERROR(
-      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
-      (vmb_error_to_string(err)).data());
-    return false;
+  if (node_->get_parameter(parameter_correction_enable).as_bool()) {
+    camera_->set_pixel_correction(pixel_correction_);
   }
 
-  err = api_->FeatureInvalidationRegister(
-    gVmbHandle, SFNCFeatures::EventCameraDiscovery.data(),
-    this->camera_discovery_callback, reinterpret_cast<void *>(this));
+  RCLCPP_INFO(
+    get_logger(), "Captured %s correction from %u frames, %zu defective pixels",
+    is_dark ? "dark" : "flat", frame_count,
+    pixel_correction_->defects().size());
 
-  if (err != VmbErrorSuccess) {
-    RCLCPP_ERROR(
-      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
-      (vmb_error_to_string(err)).data());
-    return false;
+  return uint32_t(pixel_correction_->defects().size());
+}
+
+void VimbaXCameraNode::pixel_correction_add_frame(const VimbaXCamera::Frame & frame)
+{
+  {
+    std::lock_guard capture_lock{correction_capture_mutex_};
+    if (!correction_capture_ || correction_capture_->complete() ||
+      correction_capture_error_ != VmbErrorSuccess)
+    {
+      return;
+    }
+
+    auto const add_result = correction_capture_->add(frame);
+
+    if (!add_result) {
+      correction_capture_error_ = add_result.error().code;
+    }
   }
 
-  return true;
+  correction_capture_cv_.notify_all();
 }
 
-bool VimbaXCameraNode::deinitialize_camera_observer()
+bool VimbaXCameraNode::initialize_frame_set()
 {
-  auto err = api_->FeatureEnumSet(
-    gVmbHandle, SFNCFeatures::EventSelector.data(), "CameraDiscovery");
+  auto const name = node_->get_parameter(parameter_frame_set).as_string();
 
-  if (err != VmbErrorSuccess) {
-    RCLCPP_ERROR(
-      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
-      (vmb_error_to_string(err)).data());
-    return false;
+  if (name.empty()) {
+    return true;
   }
 
-  err = api_->FeatureEnumSet(gVmbHandle, SFNCFeatures::EventNotification.data(), "Off");
+  RCLCPP_INFO(get_logger(), "Initializing frame set %s ...", name.c_str());
 
-  if (err != VmbErrorSuccess) {
+  auto const match = node_->get_parameter(parameter_frame_set_match).as_string();
+
+  if (match != "frame_id" && match != "timestamp") {
     RCLCPP_ERROR(
-      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
-      (vmb_error_to_string(err)).data());
+      get_logger(), "Invalid frame set match '%s', expected frame_id or timestamp", match.c_str());
     return false;
   }
 
-  err = api_->FeatureInvalidationUnregister(
-    gVmbHandle, SFNCFeatures::EventCameraDiscovery.data(),
-    this->camera_discovery_callback);
+  auto const aggregator = FrameSetAggregator::join(
+    name, FrameSetAggregator::Settings{
+      node_->get_parameter(parameter_frame_set_members).as_string_array(),
+      match == "frame_id" ? FrameSetAggregator::Match::FrameId :
+      FrameSetAggregator::Match::Timestamp,
+      uint64_t(node_->get_parameter(parameter_frame_set_tolerance).as_double() * 1e9),
+      std::size_t(node_->get_parameter(parameter_frame_set_max_pending).as_int())});
 
-  if (err != VmbErrorSuccess) {
+  if (!aggregator) {
     RCLCPP_ERROR(
-      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
-      (vmb_error_to_string(err)).data());
+      get_logger(), "Joining frame set %s failed with %d (%s)", name.c_str(),
+      aggregator.error().code, vmb_error_to_string(aggregator.error().code).data());
     return false;
   }
 
-  return true;
-}
+  auto const member = (*aggregator)->member_index(node_->get_name());
 
-void VimbaXCameraNode::camera_discovery_callback(
-  const VmbHandle_t handle, const char * name, void * context)
-{
-  if (context) {
-    (reinterpret_cast<VimbaXCameraNode *>(context))->on_camera_discovery_callback(handle, name);
+  if (!member) {
+    RCLCPP_ERROR(
+      get_logger(), "Node %s is not a member of frame set %s", node_->get_name(), name.c_str());
+    return false;
   }
-}
-
-void VimbaXCameraNode::on_camera_discovery_callback(const VmbHandle_t handle, const char *)
-{
-  std::string camera_id;
-  VmbUint32_t count = 0;
 
-  auto err = api_->FeatureStringGet(
-    handle, SFNCFeatures::EventCameraDiscoveryCameraID.data(), nullptr, count, &count);
+  if (*member == 0) {
+    frame_set_publisher_ = node_->create_publisher<vimbax_camera_msgs::msg::FrameSet>(
+      "frame_set", rclcpp::QoS{10});
+    frame_set_statistics_publisher_ =
+      node_->create_publisher<vimbax_camera_msgs::msg::FrameSetStatistics>(
+      "frame_set/statistics", rclcpp::QoS{10});
 
-  if (err == VmbErrorSuccess && count > 0) {
-    std::string str_id;
-    str_id.resize(count);
-    err = api_->FeatureStringGet(
-      handle, SFNCFeatures::EventCameraDiscoveryCameraID.data(), &str_id[0], count, &count);
-    if (err == VmbErrorSuccess) {
-      camera_id = &*str_id.begin();
+    if (!frame_set_publisher_ || !frame_set_statistics_publisher_) {
+      return false;
     }
   }
 
-  std::shared_lock camera_lock(camera_mutex_);
-  auto const camera_connected = (camera_ != nullptr);
-  auto const last_camera_id = last_camera_id_;
-  camera_lock.unlock();
+  frame_set_ = *aggregator;
+  frame_set_member_ = *member;
+
+  if (*member == 0) {
+    auto const max_pending = std::size_t(
+      node_->get_parameter(parameter_frame_set_max_pending).as_int());
+
+    // Sets are released on the capture thread of the completing member, they are published by
+    // the worker so that thread doesn't copy and serialize the images of all members
+    frame_set_publish_thread_ = std::make_unique<std::thread>(
+      [this] {
+        while (true) {
+          std::unique_lock lock{frame_set_publish_mutex_};
+          frame_set_publish_cv_.wait(
+            lock, [this] {
+              return stop_threads_ || !frame_set_publish_queue_.empty();
+            });
 
-  // When last_camera_id is empty no camera was ever connected so return here.
-  if (last_camera_id.empty()) {
-    return;
-  }
+          if (stop_threads_) {
+            return;
+          }
 
-  if (err == VmbErrorSuccess) {
-    const char * reason = nullptr;
-    static bool stream_restart_required = false;
+          auto released = std::move(frame_set_publish_queue_.front());
+          frame_set_publish_queue_.pop_front();
+          lock.unlock();
 
-    err = api_->FeatureEnumGet(handle, SFNCFeatures::EventCameraDiscoveryType.data(), &reason);
-    if (err == VmbErrorSuccess) {
-      if (std::strcmp(reason, "Missing") == 0) {
-        if ((camera_id.find(last_camera_id) != std::string::npos) && camera_connected) {
-          RCLCPP_ERROR(
-            get_logger(), "%s: Camera '%s' disconnected. Waiting for reconnection...",
-            __FUNCTION__, last_camera_id.c_str());
-
-          stream_restart_required = camera_->is_streaming();
-          std::unique_lock lock{camera_mutex_};
-          is_available_ = false;
-          camera_.reset();
-        }
-      } else if (std::strcmp(reason, "Detected") == 0) {
-        if (camera_id.find(last_camera_id) != std::string::npos && !camera_connected) {
-          RCLCPP_INFO(
-            get_logger(), "%s: Camera '%s' reconnected.", __FUNCTION__, last_camera_id.c_str());
-
-          std::thread(
-            [this] {
-              if (initialize_camera(true)) {
-                // Notify graph context that a stream restart is required
-                stream_restart_required_ = stream_restart_required;
-                stream_restart_required = false;
-              }
-            }).detach();
+          publish_frame_set(std::move(released.first), released.second);
         }
-      }
-    }
-  } else {
-    RCLCPP_ERROR(
-      get_logger(), "%s: Error while accessing EventCameraDiscoveryCameraID: %d (%s)", __FUNCTION__,
-      err, (vmb_error_to_string(err)).data());
+      });
+
+    frame_set_->set_release_callback(
+      [this, max_pending](
+        FrameSetAggregator::Set && set, const FrameSetAggregator::Statistics & statistics) {
+        {
+          std::lock_guard lock{frame_set_publish_mutex_};
+          // Dropping a set requeues its frames, so a slow publisher doesn't starve the streams
+          if (frame_set_publish_queue_.size() >= max_pending) {
+            frame_set_publish_queue_.pop_front();
+          }
+          frame_set_publish_queue_.emplace_back(std::move(set), statistics);
+        }
+        frame_set_publish_cv_.notify_one();
+      });
   }
+
+  return true;
 }
 
-bool VimbaXCameraNode::initialize_graph_notify()
+void VimbaXCameraNode::publish_frame_set(
+  FrameSetAggregator::Set && set, const FrameSetAggregator::Statistics & statistics)
 {
-  RCLCPP_INFO(get_logger(), "Initializing graph notify ...");
-  graph_notify_thread_ = std::make_unique<std::thread>(
-    [this] {
-      size_t last_num_subscribers = 0;
-      while (!stop_threads_.load(std::memory_order::memory_order_relaxed)) {
-        auto event = node_->get_graph_event();
-        node_->wait_for_graph_change(event, std::chrono::milliseconds(50));
-        auto current_num_subscribers = camera_publisher_.getNumSubscribers();
+  auto const & members = node_->get_parameter(parameter_frame_set_members).as_string_array();
+
+  // Statistics are published for every incomplete set and every 100th complete set
+  if (!set.complete() || statistics.complete_count % 100 == 1) {
+    auto message = vimbax_camera_msgs::msg::FrameSetStatistics{}
+    .set__complete_count(statistics.complete_count)
+    .set__incomplete_count(statistics.incomplete_count)
+    .set__cameras(members)
+    .set__missing_count(statistics.missing_count)
+    .set__max_skew_ns(statistics.max_skew_ns);
+    message.header.stamp = node_->now();
+    message.header.frame_id = node_->get_parameter(parameter_frame_set).as_string();
+
+    frame_set_statistics_publisher_->publish(message);
+  }
 
-        if (stream_restart_required_) {
-          start_streaming();
-          stream_restart_required_ = false;
-        }
+  // The members copy their images only while they are consumed, so the first sets after a
+  // subscription may still come without them
+  auto const subscribed = frame_set_publisher_->get_subscription_count() > 0;
+  frame_set_->set_images_wanted(subscribed);
 
-        event->check_and_clear();
+  auto const has_images = std::all_of(
+    set.frames.begin(), set.frames.end(), [](const auto & frame) {
+      return frame && frame->image;
+    });
 
-        if (is_available_) {
-          auto const subscriber_change =
-          int64_t(current_num_subscribers) - int64_t(last_num_subscribers);
+  if (!subscribed || !has_images) {
+    return;
+  }
 
-          if (subscriber_change > 0) {
-            if (node_->get_parameter(parameter_autostream).as_int() == 1 &&
-            !is_streaming() &&
-            (!stream_stopped_by_service_ || current_num_subscribers > last_num_subscribers))
-            {
-              start_streaming();
-              stream_stopped_by_service_ = false;
-            }
-          } else if (subscriber_change < 0 && current_num_subscribers == 0) {
-            if (node_->get_parameter(parameter_autostream).as_int() == 1 &&
-            is_streaming())
-            {
-              stop_streaming();
-            }
-            stream_stopped_by_service_ = false;
-          }
+  auto message = std::make_unique<vimbax_camera_msgs::msg::FrameSet>();
+  message->header.frame_id = node_->get_parameter(parameter_frame_set).as_string();
+  message->set_id = set.id;
+  message->skew_ns = set.skew_ns;
+  message->cameras = members;
 
-          last_num_subscribers = current_num_subscribers;
-        }
-      }
-    });
+  // Stamped like the first exposed frame of the set
+  uint64_t first{UINT64_MAX};
 
-  if (!graph_notify_thread_) {
-    return false;
+  for (auto & frame : set.frames) {
+    if (frame->timestamp_ns < first) {
+      first = frame->timestamp_ns;
+      message->header.stamp = frame->image->header.stamp;
+    }
+
+    // Copied, the image is the buffer of the held frame
+    message->images.push_back(*frame->image);
+    message->camera_infos.push_back(std::move(frame->camera_info));
   }
 
-  return true;
+  frame_set_publisher_->publish(std::move(message));
 }
 
-bool VimbaXCameraNode::initialize_callback_groups()
+bool VimbaXCameraNode::initialize_ptp_sync()
 {
-  feature_callback_group_ = node_->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
-  if (!feature_callback_group_) {
-    return false;
+  auto const name = node_->get_parameter(parameter_ptp_sync).as_string();
+
+  if (name.empty()) {
+    return true;
   }
 
-  settings_load_save_callback_group_ =
-    node_->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  RCLCPP_INFO(get_logger(), "Initializing PTP sync group %s ...", name.c_str());
 
-  if (!settings_load_save_callback_group_) {
+  auto const group = PtpSyncGroup::join(
+    name, PtpSyncGroup::Settings{
+      node_->get_parameter(parameter_ptp_sync_members).as_string_array(),
+      uint32_t(node_->get_parameter(parameter_ptp_sync_device_key).as_int()),
+      uint32_t(node_->get_parameter(parameter_ptp_sync_group_key).as_int()),
+      uint32_t(node_->get_parameter(parameter_ptp_sync_group_mask).as_int()),
+      std::chrono::milliseconds{int64_t(
+          node_->get_parameter(parameter_ptp_sync_monitor_interval).as_double() * 1000.0)}});
+
+  if (!group) {
+    RCLCPP_ERROR(
+      get_logger(), "Joining PTP sync group %s failed with %d (%s)", name.c_str(),
+      group.error().code, vmb_error_to_string(group.error().code).data());
     return false;
   }
 
-  status_callback_group_ = node_->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  auto const member = (*group)->member_index(node_->get_name());
 
-  if (!status_callback_group_) {
+  if (!member) {
+    RCLCPP_ERROR(
+      get_logger(), "Node %s is not a member of PTP sync group %s", node_->get_name(),
+      name.c_str());
     return false;
   }
 
-  stream_start_stop_callback_group_ = node_->create_callback_group(
-    rclcpp::CallbackGroupType::MutuallyExclusive);
+  {
+    std::shared_lock lock(camera_mutex_);
+    auto const attach_result = (*group)->attach(*member, camera_);
 
-  if (!stream_start_stop_callback_group_) {
-    return false;
+    if (!attach_result) {
+      RCLCPP_ERROR(
+        get_logger(), "Enabling PTP and action trigger failed with %d (%s)",
+        attach_result.error().code, vmb_error_to_string(attach_result.error().code).data());
+      return false;
+    }
   }
 
-  return true;
-}
+  if (*member == 0) {
+    ptp_sync_status_publisher_ = node_->create_publisher<vimbax_camera_msgs::msg::PtpSyncStatus>(
+      "ptp_sync/status", rclcpp::QoS{10});
+    ptp_sync_skew_publisher_ = node_->create_publisher<vimbax_camera_msgs::msg::PtpSyncSkew>(
+      "ptp_sync/skew", rclcpp::QoS{10});
 
-bool VimbaXCameraNode::initialize_feature_services()
-{
-  RCLCPP_INFO(get_logger(), "Initializing feature services ...");
+    if (!ptp_sync_status_publisher_ || !ptp_sync_skew_publisher_) {
+      return false;
+    }
 
-  if (!initialize_int_feature_services()) {
-    return false;
+    (*group)->set_status_callback(
+      [this](const PtpSyncGroup::Status & status) {
+        publish_ptp_sync_status(status);
+      });
+    (*group)->set_skew_callback(
+      [this](const PtpSyncGroup::Skew & skew) {
+        publish_ptp_sync_skew(skew);
+      });
   }
 
-  if (!initialize_float_feature_services()) {
-    return false;
-  }
+  ptp_sync_ = *group;
+  ptp_sync_member_ = *member;
 
-  if (!initialize_bool_feature_services()) {
-    return false;
-  }
+  ptp_sync_trigger_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::PtpSyncTrigger>(
+    "ptp_sync/trigger", [this](
+      const vimbax_camera_msgs::srv::PtpSyncTrigger::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::PtpSyncTrigger::Response::SharedPtr response)
+    {
+      if (!std::isfinite(request->delay) || request->delay < 0.0) {
+        response->set__error(error{VmbErrorBadParameter}.to_error_msg());
+        return;
+      }
 
-  if (!initialize_command_feature_services()) {
-    return false;
-  }
+      auto const action_time = ptp_sync_->schedule(
+        std::chrono::nanoseconds{int64_t(request->delay * 1e9)});
 
-  if (!initialize_enum_feature_services()) {
-    return false;
-  }
+      if (!action_time) {
+        response->set__error(action_time.error().to_error_msg());
+        return;
+      }
 
-  if (!initialize_string_feature_services()) {
-    return false;
+      response->set__action_time_ns(*action_time);
+    }, rmw_qos_profile_services_default, stream_start_stop_callback_group_);
+
+  CHK_SVC(ptp_sync_trigger_service_);
+
+  return true;
+}
+
+void VimbaXCameraNode::publish_ptp_sync_status(const PtpSyncGroup::Status & status)
+{
+  auto message = vimbax_camera_msgs::msg::PtpSyncStatus{}
+  .set__locked(status.locked)
+  .set__cameras(node_->get_parameter(parameter_ptp_sync_members).as_string_array());
+  message.header.stamp = node_->now();
+  message.header.frame_id = node_->get_parameter(parameter_ptp_sync).as_string();
+
+  for (auto const & camera : status.cameras) {
+    message.attached.push_back(camera.attached);
+    message.status.push_back(camera.status);
+    message.camera_locked.push_back(camera.locked);
+    message.offset_valid.push_back(camera.offset_from_master_ns.has_value());
+    message.offset_from_master_ns.push_back(camera.offset_from_master_ns.value_or(0));
   }
 
-  if (!initialize_raw_feature_services()) {
-    return false;
+  ptp_sync_status_publisher_->publish(message);
+}
+
+void VimbaXCameraNode::publish_ptp_sync_skew(const PtpSyncGroup::Skew & skew)
+{
+  auto message = vimbax_camera_msgs::msg::PtpSyncSkew{}
+  .set__action_time_ns(skew.action_time_ns)
+  .set__complete(skew.complete)
+  .set__skew_ns(skew.skew_ns)
+  .set__cameras(node_->get_parameter(parameter_ptp_sync_members).as_string_array());
+  message.header.stamp = node_->now();
+  message.header.frame_id = node_->get_parameter(parameter_ptp_sync).as_string();
+
+  for (auto const & latency : skew.latency_ns) {
+    message.received.push_back(latency.has_value());
+    message.latency_ns.push_back(latency.value_or(0));
   }
 
-  if (!initialize_generic_feature_services()) {
-    return false;
+  if (!skew.complete) {
+    RCLCPP_WARN(
+      get_logger(), "Action at %lu was not received by all cameras of PTP sync group %s",
+      skew.action_time_ns, message.header.frame_id.c_str());
   }
 
-  return true;
+  ptp_sync_skew_publisher_->publish(message);
 }
 
+recording::Metadata VimbaXCameraNode::recording_metadata_get(const VimbaXCamera & camera) const
+{
+  auto const info = camera.camera_info_get();
+
+  return recording::Metadata{
+    info ? info->model_name : "",
+    info ? info->device_id : "",
+    node_->get_parameter(parameter_frame_id).as_string(),
+    uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count())};
+}
 
-bool VimbaXCameraNode::initialize_int_feature_services()
+result<std::size_t> VimbaXCameraNode::pretrigger_dump(
+  const VimbaXCamera & camera, const std::string & filename,
+  std::promise<result<void>> opened)
 {
-  feature_int_get_service_ =
-    node_->create_service<vimbax_camera_msgs::srv::FeatureIntGet>(
-    "features/int_get", [this](
-      const vimbax_camera_msgs::srv::FeatureIntGet::Request::ConstSharedPtr request,
-      const vimbax_camera_msgs::srv::FeatureIntGet::Response::SharedPtr response)
-    {
-      std::shared_lock lock(camera_mutex_);
-      if (is_available_) {
-        auto const feature_module = map_module(request->feature_module);
-        if (feature_module) {
-          auto const result = camera_->feature_int_get(request->feature_name, *feature_module);
-          if (!result) {
-            response->set__error(result.error().to_error_msg());
-          } else {
-            response->value = *result;
-          }
-        } else {
-          response->set__error(error{VmbErrorBadParameter}.to_error_msg());
-        }
-      } else {
-        response->set__error(error{VmbErrorNotFound}.to_error_msg());
-      }
-    }, rmw_qos_profile_services_default, feature_callback_group_);
+  if (filename.empty()) {
+    opened.set_value({});
 
-  CHK_SVC(feature_int_get_service_);
+    return pretrigger_ring_->dump(
+      [this](const PreTriggerRing::Frames & frames) {
+        sensor_msgs::msg::Image image{};
 
-  feature_int_set_service_ =
-    node_->create_service<vimbax_camera_msgs::srv::FeatureIntSet>(
-    "features/int_set", [this](
-      const vimbax_camera_msgs::srv::FeatureIntSet::Request::ConstSharedPtr request,
-      const vimbax_camera_msgs::srv::FeatureIntSet::Response::SharedPtr response)
-    {
-      std::shared_lock lock(camera_mutex_);
-      if (is_available_) {
-        auto const feature_module = map_module(request->feature_module);
-        if (feature_module) {
-          auto const result = camera_->feature_int_set(
-            request->feature_name, request->value, *feature_module);
-          if (!result) {
-            response->set__error(result.error().to_error_msg());
+        for (auto const & frame : frames) {
+          if (PreTriggerRing::decode(*frame, image)) {
+            pretrigger_image_publisher_->publish(image);
           }
-        } else {
-          response->set__error(error{VmbErrorBadParameter}.to_error_msg());
         }
-      } else {
-        response->set__error(error{VmbErrorNotFound}.to_error_msg());
-      }
-    }, rmw_qos_profile_services_default, feature_callback_group_);
+
+        RCLCPP_INFO(get_logger(), "Published %zu pre-trigger frames", frames.size());
+      });
+  }
+
+  // The dump is claimed before the file is created, so a dump rejected as busy doesn't leave
+  // an empty file behind. Creating the file allocates the write buffers, which would stall the
+  // event worker, so it is done by the dump thread as well.
+  return pretrigger_ring_->dump(
+    [this, metadata = recording_metadata_get(camera), filename,
+    opened = std::make_shared<std::promise<result<void>>>(std::move(opened))](
+      const PreTriggerRing::Frames & frames) {
+      auto const recorder = FrameRecorder::create(filename, metadata);
+
+      if (!recorder) {
+        RCLCPP_ERROR(
+          get_logger(), "Creating pre-trigger recording %s failed with %d (%s)",
+          filename.c_str(), recorder.error().code,
+          vmb_error_to_string(recorder.error().code).data());
+        opened->set_value(recorder.error());
+        return;
+      }
+
+      opened->set_value({});
+
+      sensor_msgs::msg::Image image{};
+
+      for (auto const & frame : frames) {
+        // Waits for the disk instead of dropping, as the frames are already in memory
+        if (PreTriggerRing::decode(*frame, image)) {
+          (*recorder)->write(image, frame->frame_id, frame->timestamp_ns, true);
+        }
+      }
+
+      auto const statistics = (*recorder)->close();
+
+      if (!statistics) {
+        RCLCPP_ERROR(
+          get_logger(), "Writing pre-trigger frames to %s failed with %d (%s)",
+          filename.c_str(), statistics.error().code,
+          vmb_error_to_string(statistics.error().code).data());
+        return;
+      }
+
+      RCLCPP_INFO(
+        get_logger(), "%lu pre-trigger frames written to %s",
+        statistics->frames_written, filename.c_str());
+    });
+}
+
+vimbax_camera_msgs::msg::Error VimbaXCameraNode::event_subscribe(
+  const std::string & name, EventConsumer consumer)
+{
+  std::shared_lock lock(camera_mutex_);
+  if (!is_available_) {
+    return vimbax_camera_msgs::msg::Error{}
+           .set__code(VmbErrorNotFound).set__text("VmbErrorNotFound");
+  }
+
+  std::lock_guard subscriptions_lock{event_subscriptions_mutex_};
+
+  auto subscription_it = event_subscriptions_.find(name);
+
+  if (subscription_it == event_subscriptions_.end()) {
+    auto subscription = std::make_shared<EventSubscription>();
+
+    auto const res = event_subscription_register(name, subscription);
+
+    if (!res) {
+      return res.error().to_error_msg();
+    }
+
+    subscription_it = event_subscriptions_.emplace(name, std::move(subscription)).first;
+  }
+
+  subscription_it->second->consumers[std::size_t(consumer)].store(true);
+
+  return vimbax_camera_msgs::msg::Error{};
+}
+
+void VimbaXCameraNode::event_unsubscribe(const std::string & name, EventConsumer consumer)
+{
+  std::shared_lock lock(camera_mutex_);
+  std::lock_guard subscriptions_lock{event_subscriptions_mutex_};
+
+  auto const subscription_it = event_subscriptions_.find(name);
+
+  if (subscription_it == event_subscriptions_.end()) {
+    return;
+  }
+
+  auto & subscription = *subscription_it->second;
+
+  subscription.consumers[std::size_t(consumer)].store(false);
+
+  if (std::any_of(
+      subscription.consumers.begin(), subscription.consumers.end(),
+      [](auto const & consumed) {return consumed.load();}))
+  {
+    return;
+  }
+
+  auto const listener_id = subscription.listener_id;
+  event_subscriptions_.erase(subscription_it);
+
+  if (!is_available_) {
+    return;
+  }
+
+  camera_->feature_invalidation_unregister("Event" + name, listener_id);
+
+  auto const sel_res = camera_->feature_enum_set(SFNCFeatures::EventSelector.data(), name);
+
+  if (!sel_res) {
+    return;
+  }
+
+  camera_->feature_enum_set(SFNCFeatures::EventNotification.data(), "Off");
+}
+
+result<void> VimbaXCameraNode::event_subscription_register(
+  const std::string & name, std::shared_ptr<EventSubscription> subscription)
+{
+  // The data features are resolved here once instead of on every event occurrence
+  auto layout = camera_->event_meta_data_layout_get(name);
+
+  if (!layout) {
+    return layout.error();
+  }
+
+  subscription->layout = std::move(*layout);
+
+  auto const sel_res = camera_->feature_enum_set(SFNCFeatures::EventSelector.data(), name);
+
+  if (!sel_res) {
+    return sel_res.error();
+  }
+
+  auto const on_res = camera_->feature_enum_set(SFNCFeatures::EventNotification.data(), "On");
+
+  if (!on_res) {
+    return on_res.error();
+  }
+
+  // The callback runs on the event worker of the camera, which is stopped before the camera
+  // is destroyed, so the camera can be used without holding camera_mutex_
+  auto const res = camera_->feature_invalidation_register(
+    "Event" + name, [this, subscription, camera = camera_.get()](auto) {
+      event_publish(*camera, *subscription);
+    });
+
+  if (!res) {
+    return res.error();
+  }
+
+  subscription->listener_id = *res;
+
+  return {};
+}
+
+void VimbaXCameraNode::event_subscriptions_restore()
+{
+  std::lock_guard subscriptions_lock{event_subscriptions_mutex_};
+
+  for (auto const & [name, subscription] : event_subscriptions_) {
+    auto const res = event_subscription_register(name, subscription);
+
+    if (!res) {
+      RCLCPP_WARN(
+        get_logger(), "Restoring subscription of event %s failed with error %d (%s)",
+        name.c_str(), res.error().code, vmb_error_to_string(res.error().code).data());
+    }
+  }
+}
+
+void VimbaXCameraNode::event_publish(
+  const VimbaXCamera & camera, const EventSubscription & subscription)
+{
+  using vimbax_camera_msgs::msg::FeatureValue;
+
+  auto const data = camera.event_meta_data_read(subscription.layout);
+
+  if (!data) {
+    return;
+  }
+
+  auto const & features = subscription.layout.features;
+  auto const & event_name = subscription.layout.event_name;
+
+  if (subscription.is_consumed_by(EventConsumer::FrameCorrelation) && frame_event_correlator_) {
+    auto const timestamp_ns = camera.device_timestamp_to_ns(data->timestamp);
+
+    if (subscription.layout.frame_id_index) {
+      frame_event_correlator_->add_event(event_name, int64_t(data->frame_id), timestamp_ns);
+    } else {
+      frame_event_correlator_->add_event(event_name, timestamp_ns);
+    }
+  }
+
+  if (subscription.is_consumed_by(EventConsumer::PreTrigger) && pretrigger_ring_) {
+    auto const filename = node_->get_parameter(parameter_pretrigger_directory).as_string() +
+      "/pretrigger_" + event_name + "_" +
+      std::to_string(camera.device_timestamp_to_ns(data->timestamp)) + ".vxr";
+
+    // Events during a running dump are covered by it
+    auto const frame_count = pretrigger_dump(camera, filename);
+
+    if (frame_count) {
+      RCLCPP_INFO(
+        get_logger(), "Event %s, dumping %zu pre-trigger frames to %s",
+        event_name.c_str(), *frame_count, filename.c_str());
+    } else if (frame_count.error().code != VmbErrorBusy) {
+      RCLCPP_ERROR(
+        get_logger(), "Dumping the pre-trigger frames to %s failed with %d (%s)",
+        filename.c_str(), frame_count.error().code,
+        vmb_error_to_string(frame_count.error().code).data());
+    }
+  }
+
+  if (subscription.is_consumed_by(EventConsumer::TypedEvents)) {
+    vimbax_camera_msgs::msg::TypedEventData typed_data{};
+    typed_data.frame_id = data->frame_id;
+    typed_data.timestamp = data->timestamp;
+    typed_data.names.reserve(features.size());
+    typed_data.values.reserve(features.size());
+
+    for (std::size_t i = 0; i < features.size(); i++) {
+      if (!data->valid[i]) {
+        continue;
+      }
+
+      auto value = FeatureValue{};
+
+      std::visit(
+        [&](auto const & v) {
+          using value_type = std::decay_t<decltype(v)>;
+          if constexpr (std::is_same_v<value_type, int64_t>) {
+            value.set__type(FeatureValue::TYPE_INT).set__int_value(v);
+          } else if constexpr (std::is_same_v<value_type, _Float64>) {
+            value.set__type(FeatureValue::TYPE_FLOAT).set__float_value(v);
+          } else if constexpr (std::is_same_v<value_type, bool>) {
+            value.set__type(FeatureValue::TYPE_BOOL).set__bool_value(v);
+          } else {
+            value.set__type(
+              features[i].info->featureDataType == VmbFeatureDataEnum ?
+              FeatureValue::TYPE_ENUM : FeatureValue::TYPE_STRING).set__string_value(v);
+          }
+        }, data->values[i]);
+
+      typed_data.names.emplace_back(features[i].name);
+      typed_data.values.push_back(std::move(value));
+    }
+
+    typed_event_publisher_->publish_event(event_name, typed_data);
+  }
+
+  if (subscription.is_consumed_by(EventConsumer::Events)) {
+    vimbax_camera_msgs::msg::EventData untyped_data{};
+    untyped_data.entries.reserve(features.size());
+
+    for (std::size_t i = 0; i < features.size(); i++) {
+      if (!data->valid[i]) {
+        continue;
+      }
+
+      auto const value = std::visit(
+        [](auto const & v) -> std::string {
+          if constexpr (std::is_same_v<std::decay_t<decltype(v)>, std::string>) {
+            return v;
+          } else {
+            return std::to_string(v);
+          }
+        }, data->values[i]);
+
+      untyped_data.entries.push_back(
+        vimbax_camera_msgs::msg::EventDataEntry{}.set__name(features[i].name).set__value(value));
+    }
+
+    event_event_publisher_->publish_event(event_name, untyped_data);
+  }
+}
+
+bool VimbaXCameraNode::initialize_parameters()
+{
+  auto const cameraIdParamDesc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Id of camera to open").set__read_only(true);
+  node_->declare_parameter(parameter_camera_id, "", cameraIdParamDesc);
+
+  auto const settingsFileParamDesc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Settings file to load at startup").set__read_only(true);
+  node_->declare_parameter(parameter_settings_file, "", settingsFileParamDesc);
+
+  auto const bufferCountRange = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(3).set__step(1).set__to_value(1000);
+  auto const bufferCountParamDesc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Number of buffers used for streaming").set__integer_range({bufferCountRange});
+  node_->declare_parameter(parameter_buffer_count, 7, bufferCountParamDesc);
+
+  auto const autostartStreamParamDesc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description(
+    "Auto start/stop stream while subscribing/unsubscribing to image publisher").set__read_only(
+    false);
+  node_->declare_parameter(parameter_autostream, 1, autostartStreamParamDesc);
+
+  auto const command_feature_timeout_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Timeout for command features");
+  node_->declare_parameter(
+    parameter_command_feature_timeout, 0, command_feature_timeout_param_desc);
+
+  auto const use_ros_time_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Use ROS time instead of camera timestamp in image message header");
+  node_->declare_parameter(parameter_use_ros_time, false, use_ros_time_param_desc);
+
+  auto const stream_count_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(1).set__step(1).set__to_value(16);
+  auto const stream_count_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Number of camera stream channels to capture from")
+  .set__integer_range({stream_count_range}).set__read_only(true);
+  node_->declare_parameter(parameter_stream_count, 1, stream_count_param_desc);
+
+  auto const feature_value_cache_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Serve values of non volatile features from the driver side cache");
+  node_->declare_parameter(parameter_feature_value_cache, true, feature_value_cache_param_desc);
+
+  auto const fast_reconnect_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description(
+    "Reuse feature maps and frame buffers and replay feature writes when reconnecting");
+  node_->declare_parameter(parameter_fast_reconnect, true, fast_reconnect_param_desc);
+
+  auto const burst_max_size_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(1).set__step(1).set__to_value(65536);
+  auto const burst_max_size_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Maximum size of the frame buffers allocated for a burst capture in MiB")
+  .set__integer_range({burst_max_size_range});
+  node_->declare_parameter(parameter_burst_max_size, 1024, burst_max_size_param_desc);
+
+  auto const profiles_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Camera profiles as name=snapshot file entries").set__read_only(true);
+  node_->declare_parameter(parameter_profiles, std::vector<std::string>{}, profiles_param_desc);
+
+  auto const frame_correlation_events_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Events matched with the frames and published on frame_metadata")
+  .set__read_only(true);
+  node_->declare_parameter(
+    parameter_frame_correlation_events, std::vector<std::string>{},
+    frame_correlation_events_param_desc);
+
+  auto const frame_correlation_window_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(1).set__step(1).set__to_value(1024);
+  auto const frame_correlation_window_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Number of frames events are kept for until their frame arrives")
+  .set__integer_range({frame_correlation_window_range}).set__read_only(true);
+  node_->declare_parameter(
+    parameter_frame_correlation_window, 16, frame_correlation_window_param_desc);
+
+  auto const frame_correlation_timeout_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(0).set__step(1).set__to_value(1000);
+  auto const frame_correlation_timeout_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Time in ms a frame waits for its events before it is published")
+  .set__integer_range({frame_correlation_timeout_range}).set__read_only(true);
+  node_->declare_parameter(
+    parameter_frame_correlation_timeout, 10, frame_correlation_timeout_param_desc);
+
+  auto const stamp_exposure_midpoint_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Stamp images with the midpoint of the ExposureStart and ExposureEnd events");
+  node_->declare_parameter(
+    parameter_stamp_exposure_midpoint, false, stamp_exposure_midpoint_param_desc);
+
+  auto const pretrigger_duration_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Seconds of frames kept in the pre-trigger ring, 0 for no time limit")
+  .set__read_only(true);
+  node_->declare_parameter(parameter_pretrigger_duration, 0.0, pretrigger_duration_param_desc);
+
+  auto const pretrigger_max_size_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(0).set__step(1).set__to_value(65536);
+  auto const pretrigger_max_size_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Maximum size of the pre-trigger ring in MiB, 0 for no size limit")
+  .set__integer_range({pretrigger_max_size_range}).set__read_only(true);
+  node_->declare_parameter(parameter_pretrigger_max_size, 0, pretrigger_max_size_param_desc);
+
+  auto const pretrigger_compression_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(0).set__step(1).set__to_value(9);
+  auto const pretrigger_compression_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("zlib level of the frames in the pre-trigger ring, 0 disables compression")
+  .set__integer_range({pretrigger_compression_range}).set__read_only(true);
+  node_->declare_parameter(
+    parameter_pretrigger_compression, 0, pretrigger_compression_param_desc);
+
+  auto const pretrigger_events_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Events dumping the pre-trigger ring to pretrigger_directory")
+  .set__read_only(true);
+  node_->declare_parameter(
+    parameter_pretrigger_events, std::vector<std::string>{}, pretrigger_events_param_desc);
+
+  auto const pretrigger_directory_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Directory of the pre-trigger recordings dumped on events");
+  node_->declare_parameter(
+    parameter_pretrigger_directory, std::string{"/tmp"}, pretrigger_directory_param_desc);
+
+  auto const frame_set_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Name of the frame set shared with other cameras of this process")
+  .set__read_only(true);
+  node_->declare_parameter(parameter_frame_set, "", frame_set_param_desc);
+
+  auto const frame_set_members_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Node names of the cameras in the frame set, the first one publishes it")
+  .set__read_only(true);
+  node_->declare_parameter(
+    parameter_frame_set_members, std::vector<std::string>{}, frame_set_members_param_desc);
+
+  auto const frame_set_match_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Group the frames of a set by frame_id or by device timestamp")
+  .set__read_only(true);
+  node_->declare_parameter(parameter_frame_set_match, "timestamp", frame_set_match_param_desc);
+
+  auto const frame_set_tolerance_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Maximum timestamp difference in seconds of the frames of a set")
+  .set__read_only(true);
+  node_->declare_parameter(parameter_frame_set_tolerance, 0.001, frame_set_tolerance_param_desc);
+
+  auto const frame_set_max_pending_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(1).set__step(1).set__to_value(64);
+  auto const frame_set_max_pending_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Open frame sets before the oldest one is dropped as incomplete")
+  .set__integer_range({frame_set_max_pending_range}).set__read_only(true);
+  node_->declare_parameter(
+    parameter_frame_set_max_pending, 4, frame_set_max_pending_param_desc);
+
+  auto const ptp_sync_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Name of the PTP sync group shared with other cameras of this process")
+  .set__read_only(true);
+  node_->declare_parameter(parameter_ptp_sync, "", ptp_sync_param_desc);
+
+  auto const ptp_sync_members_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Node names of the cameras in the PTP sync group, the first one publishes")
+  .set__read_only(true);
+  node_->declare_parameter(
+    parameter_ptp_sync_members, std::vector<std::string>{}, ptp_sync_members_param_desc);
+
+  auto const ptp_sync_key_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(0).set__step(1).set__to_value(UINT32_MAX);
+  auto const ptp_sync_device_key_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Action device key of the cameras in the PTP sync group")
+  .set__integer_range({ptp_sync_key_range}).set__read_only(true);
+  node_->declare_parameter(parameter_ptp_sync_device_key, 1, ptp_sync_device_key_param_desc);
+
+  auto const ptp_sync_group_key_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Action group key of the cameras in the PTP sync group")
+  .set__integer_range({ptp_sync_key_range}).set__read_only(true);
+  node_->declare_parameter(parameter_ptp_sync_group_key, 1, ptp_sync_group_key_param_desc);
+
+  auto const ptp_sync_group_mask_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(1).set__step(1).set__to_value(UINT32_MAX);
+  auto const ptp_sync_group_mask_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Action group mask of the cameras in the PTP sync group")
+  .set__integer_range({ptp_sync_group_mask_range}).set__read_only(true);
+  node_->declare_parameter(parameter_ptp_sync_group_mask, 1, ptp_sync_group_mask_param_desc);
+
+  auto const ptp_sync_monitor_interval_range = rcl_interfaces::msg::FloatingPointRange{}
+  .set__from_value(0.0).set__to_value(60.0);
+  auto const ptp_sync_monitor_interval_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Interval in seconds of the PTP status of the group, 0 disables it")
+  .set__floating_point_range({ptp_sync_monitor_interval_range}).set__read_only(true);
+  node_->declare_parameter(
+    parameter_ptp_sync_monitor_interval, 1.0, ptp_sync_monitor_interval_param_desc);
+
+  auto const correction_file_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Pixel correction loaded on startup and written by correction/capture")
+  .set__read_only(true);
+  node_->declare_parameter(parameter_correction_file, "", correction_file_param_desc);
+
+  auto const correction_enable_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Apply the dark, gain and defective pixel correction to the images");
+  node_->declare_parameter(parameter_correction_enable, true, correction_enable_param_desc);
+
+  auto const correction_defect_threshold_range = rcl_interfaces::msg::FloatingPointRange{}
+  .set__from_value(0.0).set__to_value(1.0);
+  auto const correction_defect_threshold_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Relative deviation marking a pixel defective on correction capture")
+  .set__floating_point_range({correction_defect_threshold_range});
+  node_->declare_parameter(
+    parameter_correction_defect_threshold, 0.1, correction_defect_threshold_param_desc);
+
+  auto const feature_queue_latency_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(0).set__step(1).set__to_value(16);
+  auto const feature_queue_latency_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Frames still exposed with the previous settings after a queued change")
+  .set__integer_range({feature_queue_latency_range}).set__read_only(true);
+  node_->declare_parameter(
+    parameter_feature_queue_latency, 1, feature_queue_latency_param_desc);
+
+  auto const feature_queue_timeout_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(1).set__step(1).set__to_value(60000);
+  auto const feature_queue_timeout_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Time in ms after which a queued change not written yet is cancelled")
+  .set__integer_range({feature_queue_timeout_range});
+  node_->declare_parameter(
+    parameter_feature_queue_timeout, 5000, feature_queue_timeout_param_desc);
+
+  auto const shared_memory_slots_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(0).set__step(1).set__to_value(64);
+  auto const shared_memory_slots_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Number of shared memory frame slots for image_raw_shared, 0 disables it")
+  .set__integer_range({shared_memory_slots_range});
+  node_->declare_parameter(parameter_shared_memory_slots, 0, shared_memory_slots_param_desc);
+
+  auto const rois_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Regions of interest as name=x,y,width,height entries").set__read_only(true);
+  node_->declare_parameter(parameter_rois, std::vector<std::string>{}, rois_param_desc);
+
+  auto const rectify_thread_count_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(0).set__step(1).set__to_value(64);
+  auto const rectify_thread_count_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Threads rectifying the images for image_rect, 0 disables image_rect")
+  .set__integer_range({rectify_thread_count_range}).set__read_only(true);
+  node_->declare_parameter(parameter_rectify_thread_count, 2, rectify_thread_count_param_desc);
+
+  auto const statistics_interval_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(0).set__step(1).set__to_value(1000);
+  auto const statistics_interval_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Publish image statistics for every n-th frame, 0 disables them")
+  .set__integer_range({statistics_interval_range});
+  node_->declare_parameter(parameter_statistics_interval, 0, statistics_interval_param_desc);
+
+  auto const statistics_stride_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(1).set__step(1).set__to_value(64);
+  auto const statistics_stride_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Subsampling stride of the image statistics in pixels or Bayer cells")
+  .set__integer_range({statistics_stride_range});
+  node_->declare_parameter(parameter_statistics_stride, 4, statistics_stride_param_desc);
+
+  auto const auto_exposure_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Control ExposureTime and Gain by the driver, applied on stream start");
+  node_->declare_parameter(parameter_auto_exposure, false, auto_exposure_param_desc);
+
+  auto const auto_exposure_target_range = rcl_interfaces::msg::FloatingPointRange{}
+  .set__from_value(0.01).set__to_value(0.99);
+  auto const auto_exposure_target_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Target brightness relative to the full scale")
+  .set__floating_point_range({auto_exposure_target_range});
+  node_->declare_parameter(parameter_auto_exposure_target, 0.45, auto_exposure_target_param_desc);
+
+  auto const auto_exposure_tolerance_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Brightness deviation from the target considered converged");
+  node_->declare_parameter(
+    parameter_auto_exposure_tolerance, 0.02, auto_exposure_tolerance_param_desc);
+
+  auto const auto_exposure_kp_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Proportional gain of the auto exposure loop");
+  node_->declare_parameter(parameter_auto_exposure_kp, 0.2, auto_exposure_kp_param_desc);
+
+  auto const auto_exposure_ki_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Integral gain of the auto exposure loop");
+  node_->declare_parameter(parameter_auto_exposure_ki, 0.6, auto_exposure_ki_param_desc);
+
+  auto const auto_exposure_max_rate_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Maximum number of ExposureTime and Gain updates per second, 0 for no limit");
+  node_->declare_parameter(
+    parameter_auto_exposure_max_rate, 10.0, auto_exposure_max_rate_param_desc);
+
+  auto const auto_exposure_settle_frames_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(0).set__step(1).set__to_value(100);
+  auto const auto_exposure_settle_frames_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Frames ignored after an update until the new settings are active")
+  .set__integer_range({auto_exposure_settle_frames_range});
+  node_->declare_parameter(
+    parameter_auto_exposure_settle_frames, 2, auto_exposure_settle_frames_param_desc);
+
+  auto const auto_exposure_stride_range = rcl_interfaces::msg::IntegerRange{}
+  .set__from_value(1).set__step(1).set__to_value(64);
+  auto const auto_exposure_stride_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Subsampling stride of the brightness measurement")
+  .set__integer_range({auto_exposure_stride_range});
+  node_->declare_parameter(parameter_auto_exposure_stride, 8, auto_exposure_stride_param_desc);
+
+  auto const auto_exposure_regions_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Weighted measurement regions as x,y,width,height,weight entries");
+  node_->declare_parameter(
+    parameter_auto_exposure_regions, std::vector<std::string>{},
+    auto_exposure_regions_param_desc);
+
+  auto const auto_exposure_exposure_time_max_param_desc =
+    rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Maximum ExposureTime set by the auto exposure, negative for the camera limit");
+  node_->declare_parameter(
+    parameter_auto_exposure_exposure_time_max, -1.0, auto_exposure_exposure_time_max_param_desc);
+
+  auto const auto_exposure_gain_max_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Maximum Gain set by the auto exposure, negative for the camera limit");
+  node_->declare_parameter(
+    parameter_auto_exposure_gain_max, -1.0, auto_exposure_gain_max_param_desc);
+
+  parameter_callback_handle_ = node_->add_on_set_parameters_callback(
+    [this](
+      const std::vector<rclcpp::Parameter> & params) -> rcl_interfaces::msg::SetParametersResult {
+      for (auto const & param : params) {
+        if (param.get_name() == parameter_buffer_count) {
+          if (camera_->is_streaming()) {
+            return rcl_interfaces::msg::SetParametersResult{}
+            .set__successful(false)
+            .set__reason("Buffer count change not supported while streaming");
+          }
+        } else if (param.get_name() == parameter_feature_value_cache) {
+          std::shared_lock lock(camera_mutex_);
+          if (camera_) {
+            camera_->set_feature_value_cache_enabled(param.as_bool());
+          }
+        } else if (param.get_name() == parameter_correction_enable) {
+          std::shared_lock lock(camera_mutex_);
+          std::lock_guard correction_lock{pixel_correction_mutex_};
+          // The capture restores the correction when it is done
+          if (camera_ && !correction_capture_active_) {
+            camera_->set_pixel_correction(param.as_bool() ? pixel_correction_ : nullptr);
+          }
+        }
+      }
+
+      return rcl_interfaces::msg::SetParametersResult{}.set__successful(true);
+    });
+
+  return true;
+}
+
+bool VimbaXCameraNode::initialize_api()
+{
+  RCLCPP_INFO(get_logger(), "Initializing VimbaX API ...");
+  RCLCPP_INFO(get_logger(), "Starting VimbaX camera node ...");
+  RCLCPP_INFO(get_logger(), "Loading VimbaX api ...");
+  api_ = VmbCAPI::get_instance();
+  if (!api_) {
+    RCLCPP_FATAL(get_logger(), "VmbC loading failed!");
+    rclcpp::shutdown();
+    return false;
+  }
+
+  VmbVersionInfo_t versionInfo{};
+  if (api_->VersionQuery(&versionInfo, sizeof(versionInfo)) != VmbErrorSuccess) {
+    RCLCPP_WARN(get_logger(), "Reading VmbC version failed!");
+  }
+
+  RCLCPP_INFO(
+    get_logger(), "Successfully loaded VmbC API version %d.%d.%d",
+    versionInfo.major, versionInfo.minor, versionInfo.patch);
+
+  return true;
+}
+
+bool VimbaXCameraNode::initialize_publisher()
+{
+  RCLCPP_INFO(get_logger(), "Initializing publisher ...");
+
+  auto qos = rmw_qos_profile_default;
+  qos.depth = 10;
+
+  camera_publisher_ = image_transport::create_camera_publisher(node_.get(), "image_raw", qos);
+
+  if (!camera_publisher_) {
+    return false;
+  }
+
+  auto const stream_count = node_->get_parameter(parameter_stream_count).as_int();
+
+  if (stream_count > camera_->get_stream_count()) {
+    RCLCPP_WARN(
+      get_logger(), "Requested %ld streams, but camera only provides %u", stream_count,
+      camera_->get_stream_count());
+  }
+
+  for (uint32_t i = 1; i < std::min(uint32_t(stream_count), camera_->get_stream_count()); i++) {
+    auto publisher = image_transport::create_camera_publisher(
+      node_.get(), "stream" + std::to_string(i) + "/image_raw", qos);
+
+    if (!publisher) {
+      return false;
+    }
+
+    stream_publishers_.push_back(publisher);
+  }
+
+  shared_frame_publisher_ = node_->create_publisher<vimbax_camera_msgs::msg::SharedFrame>(
+    "image_raw_shared", rclcpp::QoS{10});
+
+  if (!shared_frame_publisher_) {
+    return false;
+  }
+
+  image_statistics_publisher_ =
+    node_->create_publisher<vimbax_camera_msgs::msg::ImageStatistics>(
+    "image_statistics", rclcpp::QoS{10});
+
+  if (!image_statistics_publisher_) {
+    return false;
+  }
+
+  frame_metadata_publisher_ =
+    node_->create_publisher<vimbax_camera_msgs::msg::FrameMetadata>(
+    "frame_metadata", rclcpp::QoS{10});
+
+  if (!frame_metadata_publisher_) {
+    return false;
+  }
+
+  auto_exposure_status_publisher_ =
+    node_->create_publisher<vimbax_camera_msgs::msg::AutoExposureStatus>(
+    "auto_exposure/status", rclcpp::QoS{10});
+
+  if (!auto_exposure_status_publisher_) {
+    return false;
+  }
+
+  auto const rectify_thread_count = node_->get_parameter(parameter_rectify_thread_count).as_int();
+
+  if (rectify_thread_count > 0) {
+    rect_publisher_ = image_transport::create_camera_publisher(node_.get(), "image_rect", qos);
+
+    if (!rect_publisher_) {
+      return false;
+    }
+
+    rectifier_ = std::make_unique<Rectifier>(uint32_t(rectify_thread_count));
+  }
+
+  return true;
+}
+
+bool VimbaXCameraNode::initialize_roi_publisher()
+{
+  auto const definitions = node_->get_parameter(parameter_rois).as_string_array();
+
+  if (definitions.empty()) {
+    return true;
+  }
+
+  RCLCPP_INFO(get_logger(), "Initializing roi publisher ...");
+
+  auto qos = rmw_qos_profile_default;
+  qos.depth = 10;
+
+  std::vector<Roi> rois;
+
+  for (auto const & definition : definitions) {
+    auto const roi = Roi::parse(definition);
+
+    if (!roi) {
+      RCLCPP_ERROR(
+        get_logger(), "Invalid roi definition '%s', expected name=x,y,width,height",
+        definition.c_str());
+      continue;
+    }
+
+    auto publisher = image_transport::create_camera_publisher(
+      node_.get(), "roi/" + roi->name + "/image_raw", qos);
+
+    if (!publisher) {
+      return false;
+    }
+
+    rois.push_back(*roi);
+    roi_publishers_.push_back(publisher);
+  }
+
+  roi_active_.assign(rois.size(), false);
+  roi_pipeline_ = std::make_unique<RoiPipeline>(
+    std::move(rois), [this](
+      std::size_t index, const sensor_msgs::msg::Image & image,
+      const sensor_msgs::msg::CameraInfo & camera_info) {
+      roi_publishers_[index].publish(image, camera_info);
+    });
+
+  return true;
+}
+
+bool VimbaXCameraNode::initialize_profiles()
+{
+  RCLCPP_INFO(get_logger(), "Initializing profiles ...");
+
+  for (auto const & definition : node_->get_parameter(parameter_profiles).as_string_array()) {
+    auto const separator = definition.find('=');
+
+    if (separator == std::string::npos || separator == 0) {
+      RCLCPP_ERROR(
+        get_logger(), "Invalid profile definition '%s', expected name=file", definition.c_str());
+      continue;
+    }
+
+    auto const name = definition.substr(0, separator);
+    auto const file_name = definition.substr(separator + 1);
+    auto snapshot = VimbaXCamera::FeatureSnapshot::load(file_name);
+
+    if (!snapshot) {
+      RCLCPP_ERROR(
+        get_logger(), "Loading profile %s from %s failed with error %d (%s)", name.c_str(),
+        file_name.c_str(), snapshot.error().code,
+        vmb_error_to_string(snapshot.error().code).data());
+      continue;
+    }
+
+    profile_snapshots_.emplace_back(name, std::move(*snapshot));
+  }
+
+  return true;
+}
+
+void VimbaXCameraNode::compile_profiles()
+{
+  profiles_.clear();
+
+  for (auto const & [name, snapshot] : profile_snapshots_) {
+    auto profile = camera_->feature_profile_compile(name, snapshot);
+
+    if (!profile) {
+      RCLCPP_ERROR(
+        get_logger(), "Profile %s is invalid for this camera (error %d)", name.c_str(),
+        profile.error().code);
+      continue;
+    }
+
+    profiles_.insert_or_assign(name, std::move(*profile));
+  }
+
+  if (!profile_snapshots_.empty()) {
+    RCLCPP_INFO(
+      get_logger(), "Compiled %zu of %zu profiles", profiles_.size(), profile_snapshots_.size());
+  }
+}
+
+bool VimbaXCameraNode::initialize_camera(bool reconnect /*= false*/)
+{
+  RCLCPP_INFO(get_logger(), "Initializing camera ...");
+
+  std::unique_lock lock(camera_mutex_);
+  auto const fast_reconnect = reconnect && node_->get_parameter(parameter_fast_reconnect).as_bool();
+
+  // The group must not use the camera while it is reopened
+  if (ptp_sync_) {
+    ptp_sync_->detach(ptp_sync_member_);
+  }
+
+  camera_ = VimbaXCamera::open(
+    api_, last_camera_id_.empty() ?
+    node_->get_parameter(parameter_camera_id).as_string() : last_camera_id_, camera_index_,
+    fast_reconnect ? reopen_resources_ : VimbaXCamera::ReopenResources{});
+
+  reopen_resources_ = {};
+
+  if (!camera_) {
+    if (reconnect) {
+      RCLCPP_WARN(get_logger(), "Failed to reopen camera");
+    } else {
+      RCLCPP_FATAL(get_logger(), "Failed to open camera");
+      rclcpp::shutdown();
+    }
+    return false;
+  }
+
+  auto const result = camera_->query_camera_info();
+  if (result) {
+    last_camera_id_ = (*result).cameraIdString;
+  }
+
+  camera_->set_feature_value_cache_enabled(
+    node_->get_parameter(parameter_feature_value_cache).as_bool());
+
+  if (node_->get_parameter(parameter_correction_enable).as_bool()) {
+    std::lock_guard correction_lock{pixel_correction_mutex_};
+    camera_->set_pixel_correction(pixel_correction_);
+  }
+
+  auto const settingsFile = [&] {
+      std::lock_guard journal_lock{feature_write_journal_mutex_};
+      return (fast_reconnect && !last_settings_file_.empty()) ?
+             last_settings_file_ : node_->get_parameter(parameter_settings_file).as_string();
+    }();
+
+  if (!settingsFile.empty()) {
+    auto const loadResult = camera_->settings_load(settingsFile);
+    if (!loadResult) {
+      RCLCPP_ERROR(
+        get_logger(), "Loading settings from file %s failed with error %d (%s)",
+        settingsFile.c_str(), loadResult.error().code,
+        (vmb_error_to_string(loadResult.error().code)).data());
+    }
+  }
+
+  if (fast_reconnect) {
+    feature_write_journal_replay();
+  }
+
+  compile_profiles();
+
+  if (reconnect) {
+    event_subscriptions_restore();
+  }
+
+  // The reopened camera starts with PTP and the action trigger disabled again
+  if (reconnect && ptp_sync_) {
+    auto const attach_result = ptp_sync_->attach(ptp_sync_member_, camera_);
+
+    if (!attach_result) {
+      RCLCPP_ERROR(
+        get_logger(), "Enabling PTP and action trigger failed with %d (%s)",
+        attach_result.error().code, vmb_error_to_string(attach_result.error().code).data());
+    }
+  }
+
+  auto const info_res = camera_->camera_info_get();
+
+  if (!info_res) {
+    return false;
+  }
+
+  if (!reconnect) {
+    auto const camera_frame_id_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+    .set__description("Frame id of published images").set__read_only(true);
+    node_->declare_parameter(
+      parameter_frame_id, "vimbax_camera_" + info_res->device_id, camera_frame_id_param_desc);
+
+
+    auto const camera_info_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+    .set__description("Url of camera info file").set__read_only(true);
+
+    node_->declare_parameter(parameter_camera_info_url, "", camera_info_param_desc);
+  }
+
+  camera_info_manager_ = std::make_shared<camera_info_manager::CameraInfoManager>(
+    node_.get(), info_res->device_id,
+    node_->get_parameter(parameter_camera_info_url).as_string());
+
+  is_available_ = true;
+
+  return true;
+}
+
+bool VimbaXCameraNode::initialize_camera_observer()
+{
+  RCLCPP_INFO(get_logger(), "Initializing camera observer...");
+
+  camera_index_ = std::make_shared<VimbaXCameraIndex>(api_);
+
+  auto const index_result = camera_index_->rebuild();
+
+  if (!index_result) {
+    RCLCPP_WARN(
+      get_logger(), "Building camera index failed with error %d (%s)", index_result.error().code,
+      (vmb_error_to_string(index_result.error().code)).data());
+  }
+
+  auto err = api_->FeatureEnumSet(
+    gVmbHandle, SFNCFeatures::EventSelector.data(), "CameraDiscovery");
+
+  if (err != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
+      (vmb_error_to_string(err)).data());
+    return false;
+  }
+
+  err = api_->FeatureEnumSet(
+    gVmbHandle, SFNCFeatures::EventNotification.data(), "On");
+
+  if (err != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
+      (vmb_error_to_string(err)).data());
+    return false;
+  }
+
+  err = api_->FeatureInvalidationRegister(
+    gVmbHandle, SFNCFeatures::EventCameraDiscovery.data(),
+    this->camera_discovery_callback, reinterpret_cast<void *>(this));
+
+  if (err != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
+      (vmb_error_to_string(err)).data());
+    return false;
+  }
+
+  return true;
+}
+
+bool VimbaXCameraNode::deinitialize_camera_observer()
+{
+  auto err = api_->FeatureEnumSet(
+    gVmbHandle, SFNCFeatures::EventSelector.data(), "CameraDiscovery");
+
+  if (err != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
+      (vmb_error_to_string(err)).data());
+    return false;
+  }
+
+  err = api_->FeatureEnumSet(gVmbHandle, SFNCFeatures::EventNotification.data(), "Off");
+
+  if (err != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
+      (vmb_error_to_string(err)).data());
+    return false;
+  }
+
+  err = api_->FeatureInvalidationUnregister(
+    gVmbHandle, SFNCFeatures::EventCameraDiscovery.data(),
+    this->camera_discovery_callback);
+
+  if (err != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "%s failed with error %d (%s)", __FUNCTION__, err,
+      (vmb_error_to_string(err)).data());
+    return false;
+  }
+
+  return true;
+}
+
+void VimbaXCameraNode::camera_discovery_callback(
+  const VmbHandle_t handle, const char * name, void * context)
+{
+  if (context) {
+    (reinterpret_cast<VimbaXCameraNode *>(context))->on_camera_discovery_callback(handle, name);
+  }
+}
+
+void VimbaXCameraNode::on_camera_discovery_callback(const VmbHandle_t handle, const char *)
+{
+  std::string camera_id;
+  VmbUint32_t count = 0;
+
+  auto err = api_->FeatureStringGet(
+    handle, SFNCFeatures::EventCameraDiscoveryCameraID.data(), nullptr, count, &count);
+
+  if (err == VmbErrorSuccess && count > 0) {
+    std::string str_id;
+    str_id.resize(count);
+    err = api_->FeatureStringGet(
+      handle, SFNCFeatures::EventCameraDiscoveryCameraID.data(), &str_id[0], count, &count);
+    if (err == VmbErrorSuccess) {
+      camera_id = &*str_id.begin();
+    }
+  }
+
+  if (err != VmbErrorSuccess) {
+    RCLCPP_ERROR(
+      get_logger(), "%s: Error while accessing EventCameraDiscoveryCameraID: %d (%s)", __FUNCTION__,
+      err, (vmb_error_to_string(err)).data());
+    return;
+  }
+
+  const char * reason = nullptr;
+
+  err = api_->FeatureEnumGet(handle, SFNCFeatures::EventCameraDiscoveryType.data(), &reason);
+  if (err != VmbErrorSuccess) {
+    return;
+  }
+
+  // Update the index first, so a reconnect finds the camera in it
+  if (camera_index_) {
+    if (std::strcmp(reason, "Missing") == 0) {
+      camera_index_->on_camera_missing(camera_id);
+    } else if (std::strcmp(reason, "Detected") == 0 || std::strcmp(reason, "Reachable") == 0 ||
+      std::strcmp(reason, "Unreachable") == 0)
+    {
+      camera_index_->on_camera_detected(camera_id);
+    }
+  }
+
+  std::shared_lock camera_lock(camera_mutex_);
+  auto const camera_connected = (camera_ != nullptr);
+  auto const last_camera_id = last_camera_id_;
+  camera_lock.unlock();
+
+  // When last_camera_id is empty no camera was ever connected so return here.
+  if (last_camera_id.empty()) {
+    return;
+  }
+
+  static bool stream_restart_required = false;
+
+  if (std::strcmp(reason, "Missing") == 0) {
+    if ((camera_id.find(last_camera_id) != std::string::npos) && camera_connected) {
+      RCLCPP_ERROR(
+        get_logger(), "%s: Camera '%s' disconnected. Waiting for reconnection...",
+        __FUNCTION__, last_camera_id.c_str());
+
+      stream_restart_required = camera_->is_streaming();
+      std::unique_lock lock{camera_mutex_};
+      is_available_ = false;
+
+      if (node_->get_parameter(parameter_fast_reconnect).as_bool()) {
+        reopen_resources_ = camera_->get_reopen_resources();
+      }
+
+      if (ptp_sync_) {
+        ptp_sync_->detach(ptp_sync_member_);
+      }
+
+      camera_.reset();
+    }
+  } else if (std::strcmp(reason, "Detected") == 0) {
+    if (camera_id.find(last_camera_id) != std::string::npos && !camera_connected) {
+      RCLCPP_INFO(
+        get_logger(), "%s: Camera '%s' reconnected.", __FUNCTION__, last_camera_id.c_str());
+
+      std::thread(
+        [this] {
+          if (initialize_camera(true)) {
+            // Notify graph context that a stream restart is required
+            stream_restart_required_ = stream_restart_required;
+            stream_restart_required = false;
+          }
+        }).detach();
+    }
+  }
+}
+
+bool VimbaXCameraNode::initialize_graph_notify()
+{
+  RCLCPP_INFO(get_logger(), "Initializing graph notify ...");
+  graph_notify_thread_ = std::make_unique<std::thread>(
+    [this] {
+      size_t last_num_subscribers = 0;
+      while (!stop_threads_.load(std::memory_order::memory_order_relaxed)) {
+        auto event = node_->get_graph_event();
+        node_->wait_for_graph_change(event, std::chrono::milliseconds(50));
+        auto current_num_subscribers = get_num_subscribers();
+
+        if (stream_restart_required_) {
+          start_streaming();
+          stream_restart_required_ = false;
+        }
+
+        event->check_and_clear();
+
+        if (is_available_ && !burst_capture_active_) {
+          auto const subscriber_change =
+          int64_t(current_num_subscribers) - int64_t(last_num_subscribers);
+
+          if (subscriber_change > 0) {
+            if (node_->get_parameter(parameter_autostream).as_int() == 1 &&
+            !is_streaming() &&
+            (!stream_stopped_by_service_ || current_num_subscribers > last_num_subscribers))
+            {
+              start_streaming();
+              stream_stopped_by_service_ = false;
+            }
+          } else if (subscriber_change < 0 && current_num_subscribers == 0) {
+            if (node_->get_parameter(parameter_autostream).as_int() == 1 &&
+            is_streaming())
+            {
+              stop_streaming();
+            }
+            stream_stopped_by_service_ = false;
+          }
+
+          last_num_subscribers = current_num_subscribers;
+        }
+      }
+    });
+
+  if (!graph_notify_thread_) {
+    return false;
+  }
+
+  return true;
+}
+
+bool VimbaXCameraNode::initialize_callback_groups()
+{
+  feature_callback_group_ = node_->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  if (!feature_callback_group_) {
+    return false;
+  }
+
+  settings_load_save_callback_group_ =
+    node_->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+
+  if (!settings_load_save_callback_group_) {
+    return false;
+  }
+
+  status_callback_group_ = node_->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+
+  if (!status_callback_group_) {
+    return false;
+  }
+
+  stream_start_stop_callback_group_ = node_->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive);
+
+  if (!stream_start_stop_callback_group_) {
+    return false;
+  }
+
+  return true;
+}
+
+bool VimbaXCameraNode::initialize_feature_services()
+{
+  RCLCPP_INFO(get_logger(), "Initializing feature services ...");
+
+  if (!initialize_int_feature_services()) {
+    return false;
+  }
+
+  if (!initialize_float_feature_services()) {
+    return false;
+  }
+
+  if (!initialize_bool_feature_services()) {
+    return false;
+  }
+
+  if (!initialize_command_feature_services()) {
+    return false;
+  }
+
+  if (!initialize_enum_feature_services()) {
+    return false;
+  }
+
+  if (!initialize_string_feature_services()) {
+    return false;
+  }
+
+  if (!initialize_raw_feature_services()) {
+    return false;
+  }
+
+  if (!initialize_generic_feature_services()) {
+    return false;
+  }
+
+  return true;
+}
+
+
+bool VimbaXCameraNode::initialize_int_feature_services()
+{
+  feature_int_get_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::FeatureIntGet>(
+    "features/int_get", [this](
+      const vimbax_camera_msgs::srv::FeatureIntGet::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::FeatureIntGet::Response::SharedPtr response)
+    {
+      std::shared_lock lock(camera_mutex_);
+      if (is_available_) {
+        auto const feature_module = map_module(request->feature_module);
+        if (feature_module) {
+          auto const result = camera_->feature_int_get(
+            request->feature_name, *feature_module, request->bypass_cache);
+          if (!result) {
+            response->set__error(result.error().to_error_msg());
+          } else {
+            response->value = *result;
+          }
+        } else {
+          response->set__error(error{VmbErrorBadParameter}.to_error_msg());
+        }
+      } else {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+      }
+    }, rmw_qos_profile_services_default, feature_callback_group_);
+
+  CHK_SVC(feature_int_get_service_);
+
+  feature_int_set_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::FeatureIntSet>(
+    "features/int_set", [this](
+      const vimbax_camera_msgs::srv::FeatureIntSet::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::FeatureIntSet::Response::SharedPtr response)
+    {
+      std::shared_lock lock(camera_mutex_);
+      if (is_available_) {
+        auto const feature_module = map_module(request->feature_module);
+        if (feature_module) {
+          auto const result = camera_->feature_int_set(
+            request->feature_name, request->value, *feature_module);
+          if (!result) {
+            response->set__error(result.error().to_error_msg());
+          } else {
+            feature_write_record(
+              request->feature_name, *feature_module,
+              vimbax_camera_msgs::msg::FeatureValue{}
+              .set__type(vimbax_camera_msgs::msg::FeatureValue::TYPE_INT)
+              .set__int_value(request->value));
+          }
+        } else {
+          response->set__error(error{VmbErrorBadParameter}.to_error_msg());
+        }
+      } else {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+      }
+    }, rmw_qos_profile_services_default, feature_callback_group_);
 
   CHK_SVC(feature_int_set_service_);
 
@@ -793,7 +2279,8 @@ bool VimbaXCameraNode::initialize_float_feature_services()
       if (is_available_) {
         auto const feature_module = map_module(request->feature_module);
         if (feature_module) {
-          auto const result = camera_->feature_float_get(request->feature_name, *feature_module);
+          auto const result = camera_->feature_float_get(
+            request->feature_name, *feature_module, request->bypass_cache);
 
           if (!result) {
             response->set__error(result.error().to_error_msg());
@@ -824,6 +2311,12 @@ bool VimbaXCameraNode::initialize_float_feature_services()
             request->feature_name, request->value, *feature_module);
           if (!result) {
             response->set__error(result.error().to_error_msg());
+          } else {
+            feature_write_record(
+              request->feature_name, *feature_module,
+              vimbax_camera_msgs::msg::FeatureValue{}
+              .set__type(vimbax_camera_msgs::msg::FeatureValue::TYPE_FLOAT)
+              .set__float_value(request->value));
           }
         } else {
           response->set__error(error{VmbErrorBadParameter}.to_error_msg());
@@ -880,7 +2373,8 @@ bool VimbaXCameraNode::initialize_string_feature_services()
       if (is_available_) {
         auto const feature_module = map_module(request->feature_module);
         if (feature_module) {
-          auto const result = camera_->feature_string_get(request->feature_name, *feature_module);
+          auto const result = camera_->feature_string_get(
+            request->feature_name, *feature_module, request->bypass_cache);
           if (!result) {
             response->set__error(result.error().to_error_msg());
           } else {
@@ -910,6 +2404,12 @@ bool VimbaXCameraNode::initialize_string_feature_services()
             request->feature_name, request->value, *feature_module);
           if (!result) {
             response->set__error(result.error().to_error_msg());
+          } else {
+            feature_write_record(
+              request->feature_name, *feature_module,
+              vimbax_camera_msgs::msg::FeatureValue{}
+              .set__type(vimbax_camera_msgs::msg::FeatureValue::TYPE_STRING)
+              .set__string_value(request->value));
           }
         } else {
           response->set__error(error{VmbErrorBadParameter}.to_error_msg());
@@ -963,7 +2463,8 @@ bool VimbaXCameraNode::initialize_bool_feature_services()
       if (is_available_) {
         auto const feature_module = map_module(request->feature_module);
         if (feature_module) {
-          auto const result = camera_->feature_bool_get(request->feature_name, *feature_module);
+          auto const result = camera_->feature_bool_get(
+            request->feature_name, *feature_module, request->bypass_cache);
           if (!result) {
             response->set__error(result.error().to_error_msg());
           } else {
@@ -993,6 +2494,12 @@ bool VimbaXCameraNode::initialize_bool_feature_services()
             request->feature_name, request->value, *feature_module);
           if (!result) {
             response->set__error(result.error().to_error_msg());
+          } else {
+            feature_write_record(
+              request->feature_name, *feature_module,
+              vimbax_camera_msgs::msg::FeatureValue{}
+              .set__type(vimbax_camera_msgs::msg::FeatureValue::TYPE_BOOL)
+              .set__bool_value(request->value));
           }
         } else {
           response->set__error(error{VmbErrorBadParameter}.to_error_msg());
@@ -1081,7 +2588,8 @@ bool VimbaXCameraNode::initialize_enum_feature_services()
       if (is_available_) {
         auto const feature_module = map_module(request->feature_module);
         if (feature_module) {
-          auto const result = camera_->feature_enum_get(request->feature_name, *feature_module);
+          auto const result = camera_->feature_enum_get(
+            request->feature_name, *feature_module, request->bypass_cache);
           if (!result) {
             response->set__error(result.error().to_error_msg());
           } else {
@@ -1111,6 +2619,12 @@ bool VimbaXCameraNode::initialize_enum_feature_services()
             request->feature_name, request->value, *feature_module);
           if (!result) {
             response->set__error(result.error().to_error_msg());
+          } else {
+            feature_write_record(
+              request->feature_name, *feature_module,
+              vimbax_camera_msgs::msg::FeatureValue{}
+              .set__type(vimbax_camera_msgs::msg::FeatureValue::TYPE_ENUM)
+              .set__string_value(request->value));
           }
         } else {
           response->set__error(error{VmbErrorBadParameter}.to_error_msg());
@@ -1323,97 +2837,560 @@ bool VimbaXCameraNode::initialize_generic_feature_services()
       }
     }, rmw_qos_profile_services_default, feature_callback_group_);
 
-  CHK_SVC(feature_access_mode_get_service_);
+  CHK_SVC(feature_access_mode_get_service_);
+
+  feature_info_query_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::FeatureInfoQuery>(
+    "feature_info_query", [this](
+      const vimbax_camera_msgs::srv::FeatureInfoQuery::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::FeatureInfoQuery::Response::SharedPtr response)
+    {
+      std::shared_lock lock(camera_mutex_);
+      if (is_available_) {
+        auto const feature_module = map_module(request->feature_module);
+        if (feature_module) {
+          std::vector<std::string> feature_names;
+
+          // If our list is empty we want to query infos for all features
+          if (request->feature_names.size() == 0) {
+            auto const result = camera_->features_list_get(*feature_module);
+            if (!result) {
+              response->set__error(result.error().to_error_msg());
+              return;
+            } else {
+              feature_names = *result;
+            }
+          } else {
+            feature_names = request->feature_names;
+          }
+
+          auto const result = camera_->feature_info_query_list(feature_names, *feature_module);
+          if (!result) {
+            response->set__error(result.error().to_error_msg());
+            return;
+          } else {
+            std::transform(
+              result->begin(), result->end(),
+              std::back_inserter(response->feature_info),
+              [](const feature_info & info) {
+                auto const flags = vimbax_camera_msgs::msg::FeatureFlags{}
+                .set__flag_none(info.flags.flag_none)
+                .set__flag_read(info.flags.flag_read)
+                .set__flag_write(info.flags.flag_write)
+                .set__flag_volatile(info.flags.flag_volatile)
+                .set__flag_modify_write(info.flags.flag_modify_write);
+
+                return vimbax_camera_msgs::msg::FeatureInfo{}
+                .set__name(info.name)
+                .set__category(info.category)
+                .set__display_name(info.display_name)
+                .set__sfnc_namespace(info.sfnc_namespace)
+                .set__unit(info.unit)
+                .set__data_type(info.data_type)
+                .set__flags(flags)
+                .set__polling_time(info.polling_time);
+              });
+          }
+        } else {
+          response->set__error(error{VmbErrorBadParameter}.to_error_msg());
+        }
+      } else {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+      }
+    }, rmw_qos_profile_services_default, feature_callback_group_);
+
+  CHK_SVC(feature_info_query_service_);
+
+  features_list_get_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::FeaturesListGet>(
+    "features/list_get", [this](
+      const vimbax_camera_msgs::srv::FeaturesListGet::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::FeaturesListGet::Response::SharedPtr response)
+    {
+      std::shared_lock lock(camera_mutex_);
+      if (is_available_) {
+        auto const feature_module = map_module(request->feature_module);
+        if (feature_module) {
+          auto const result = camera_->features_list_get(*feature_module);
+          if (!result) {
+            response->set__error(result.error().to_error_msg());
+          } else {
+            response->feature_list = *result;
+          }
+        } else {
+          response->set__error(error{VmbErrorBadParameter}.to_error_msg());
+        }
+      } else {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+      }
+    }, rmw_qos_profile_services_default, feature_callback_group_);
+
+  CHK_SVC(features_list_get_service_);
+
+  features_batch_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::FeaturesBatch>(
+    "features/batch", [this](
+      const vimbax_camera_msgs::srv::FeaturesBatch::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::FeaturesBatch::Response::SharedPtr response)
+    {
+      using vimbax_camera_msgs::msg::FeatureOperation;
+      using vimbax_camera_msgs::msg::FeatureOperationResult;
+      using vimbax_camera_msgs::msg::FeatureValue;
+
+      // Atomic batches exclude all other feature writes until they are done or rolled back
+      std::shared_lock shared_lock(camera_mutex_, std::defer_lock);
+      std::unique_lock unique_lock(camera_mutex_, std::defer_lock);
+
+      if (request->atomic) {
+        unique_lock.lock();
+      } else {
+        shared_lock.lock();
+      }
+
+      if (!is_available_) {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+        return;
+      }
+
+      // Index and value before the write of each set operation, used for the rollback in atomic
+      // mode
+      std::vector<std::pair<std::size_t, FeatureValue>> previous_values{};
+
+      response->results.resize(request->operations.size());
+
+      for (std::size_t index = 0; index < request->operations.size(); index++) {
+        auto const & operation = request->operations[index];
+        auto & operation_result = response->results[index];
+        auto const feature_module = map_module(operation.feature_module);
+
+        auto const operation_error = [&]() -> result<void> {
+            if (!feature_module) {
+              return error{VmbErrorBadParameter};
+            }
+
+            if (operation.operation == FeatureOperation::OPERATION_GET) {
+              auto const value =
+              feature_value_get(operation.feature_name, *feature_module, operation.value.type);
+              if (!value) {
+                return value.error();
+              }
+
+              operation_result.set__value(*value);
+              return {};
+            } else if (operation.operation == FeatureOperation::OPERATION_SET) {
+              std::optional<FeatureValue> previous_value{};
+
+              if (request->atomic) {
+                auto const value =
+                feature_value_get(operation.feature_name, *feature_module, operation.value.type);
+                if (!value) {
+                  return value.error();
+                }
+
+                previous_value = *value;
+              }
+
+              auto const set_result =
+              feature_value_set(operation.feature_name, *feature_module, operation.value);
+              if (!set_result) {
+                return set_result.error();
+              }
+
+              if (previous_value) {
+                previous_values.emplace_back(index, *previous_value);
+              }
+
+              operation_result.set__value(operation.value);
+              return {};
+            }
+
+            return error{VmbErrorBadParameter};
+          }();
+
+        if (operation_error) {
+          continue;
+        }
+
+        operation_result.set__error(operation_error.error().to_error_msg());
+
+        if (response->error.code == VmbErrorSuccess) {
+          response->set__error(operation_error.error().to_error_msg());
+        }
+
+        if (request->atomic) {
+          // Restore in reverse order so values behind a selector are restored while the
+          // selector still has the value they were written with. Restored and skipped
+          // operations are reported as incomplete.
+          for (auto it = previous_values.rbegin(); it != previous_values.rend(); it++) {
+            auto const & [previous_index, previous_value] = *it;
+            auto const & previous_operation = request->operations[previous_index];
+            auto const restore_result = feature_value_set(
+              previous_operation.feature_name,
+              *map_module(previous_operation.feature_module), previous_value);
+
+            if (!restore_result) {
+              RCLCPP_ERROR(
+                get_logger(), "Restoring feature %s failed with error %d (%s)",
+                previous_operation.feature_name.c_str(), restore_result.error().code,
+                vmb_error_to_string(restore_result.error().code).data());
+            }
+
+            response->results[previous_index].set__value(previous_value).set__error(
+              (restore_result ? error{VmbErrorIncomplete} : restore_result.error()).to_error_msg());
+          }
+
+          for (auto skipped = index + 1; skipped < request->operations.size(); skipped++) {
+            response->results[skipped].set__error(error{VmbErrorIncomplete}.to_error_msg());
+          }
+
+          return;
+        }
+      }
+    }, rmw_qos_profile_services_default, feature_callback_group_);
+
+  CHK_SVC(features_batch_service_);
+
+  feature_change_queue_ = std::make_unique<FeatureChangeQueue>(
+    uint32_t(node_->get_parameter(parameter_feature_queue_latency).as_int()));
+
+  features_queue_set_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::FeaturesQueueSet>(
+    "features/queue_set", [this](
+      const vimbax_camera_msgs::srv::FeaturesQueueSet::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::FeaturesQueueSet::Response::SharedPtr response)
+    {
+      using vimbax_camera_msgs::msg::FeatureOperation;
+
+      for (auto const & operation : request->operations) {
+        if (operation.operation != FeatureOperation::OPERATION_SET ||
+        !map_module(operation.feature_module))
+        {
+          response->set__error(error{VmbErrorBadParameter}.to_error_msg());
+          return;
+        }
+      }
+
+      // Filled by the frame callback when the change is applied
+      auto results =
+      std::make_shared<std::vector<vimbax_camera_msgs::msg::FeatureOperationResult>>();
+      auto error_msg = std::make_shared<vimbax_camera_msgs::msg::Error>();
+      std::future<bool> applied{};
+
+      {
+        std::shared_lock lock(camera_mutex_);
+        if (!is_available_) {
+          response->set__error(error{VmbErrorNotFound}.to_error_msg());
+          return;
+        }
+
+        auto [generation, future] = feature_change_queue_->push(
+          [this, request, results, error_msg] {
+            return feature_change_apply(request->operations, *results, *error_msg);
+          });
+
+        response->set__generation(generation);
+        applied = std::move(future);
+      }
+
+      auto const deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{
+        node_->get_parameter(parameter_feature_queue_timeout).as_int()};
+
+      // Without frames the change is applied here, the camera lock must not be held while
+      // waiting, as the frame callback might wait for it
+      while (applied.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready) {
+        // A change that is being written can't be cancelled, it is waited for then
+        if (std::chrono::steady_clock::now() >= deadline &&
+          feature_change_queue_->cancel(response->generation))
+        {
+          RCLCPP_WARN(
+            get_logger(), "Queued change %lu wasn't written in time, cancelled it",
+            response->generation);
+          response->set__error(error{VmbErrorTimeout}.to_error_msg());
+          return;
+        }
+
+        std::shared_lock lock(camera_mutex_);
+        if (!is_available_ || !camera_->is_streaming()) {
+          lock.unlock();
+          feature_change_queue_->apply(std::nullopt);
+        }
+      }
+
+      applied.get();
+      response->set__results(*results);
+      response->set__error(*error_msg);
+    }, rmw_qos_profile_services_default, feature_callback_group_);
+
+  CHK_SVC(features_queue_set_service_);
+
+  return true;
+}
+
+std::optional<bool> VimbaXCameraNode::feature_change_apply(
+  const std::vector<vimbax_camera_msgs::msg::FeatureOperation> & operations,
+  std::vector<vimbax_camera_msgs::msg::FeatureOperationResult> & results,
+  vimbax_camera_msgs::msg::Error & error_msg)
+{
+  using vimbax_camera_msgs::msg::FeatureValue;
+
+  // Runs on the frame thread of the first stream, which must not block a (re)connect or an
+  // atomic batch holding the lock exclusively. The change is deferred to the next frame then.
+  std::shared_lock lock(camera_mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return std::nullopt;
+  }
+
+  if (!is_available_) {
+    error_msg = error{VmbErrorNotFound}.to_error_msg();
+    return false;
+  }
+
+  std::vector<FeatureValue> previous_values{};
+  results.clear();
+
+  for (auto const & operation : operations) {
+    auto & operation_result = results.emplace_back();
+    auto const feature_module = *map_module(operation.feature_module);
+
+    auto const operation_error = [&]() -> result<void> {
+        auto const value =
+        feature_value_get(operation.feature_name, feature_module, operation.value.type);
+        if (!value) {
+          return value.error();
+        }
+
+        auto const set_result =
+        feature_value_set(operation.feature_name, feature_module, operation.value);
+        if (!set_result) {
+          return set_result.error();
+        }
+
+        previous_values.push_back(*value);
+        operation_result.set__value(operation.value);
+        return {};
+      }();
+
+    if (operation_error) {
+      continue;
+    }
+
+    operation_result.set__error(operation_error.error().to_error_msg());
+    error_msg = operation_error.error().to_error_msg();
+
+    // Restore in reverse order like the atomic batch, so selected features are restored
+    // while their selector still has the value they were written with
+    for (auto i = previous_values.size(); i > 0; i--) {
+      auto const & previous_operation = operations[i - 1];
+      auto const restore_result = feature_value_set(
+        previous_operation.feature_name, *map_module(previous_operation.feature_module),
+        previous_values[i - 1]);
+
+      if (!restore_result) {
+        RCLCPP_ERROR(
+          get_logger(), "Restoring feature %s failed with error %d (%s)",
+          previous_operation.feature_name.c_str(), restore_result.error().code,
+          vmb_error_to_string(restore_result.error().code).data());
+      }
+    }
+
+    return false;
+  }
+
+  return true;
+}
+
+result<vimbax_camera_msgs::msg::FeatureValue> VimbaXCameraNode::feature_value_get(
+  const std::string & name, VimbaXCamera::Module module, uint8_t type) const
+{
+  using vimbax_camera_msgs::msg::FeatureValue;
+
+  auto value = FeatureValue{}.set__type(type);
+
+  switch (type) {
+    case FeatureValue::TYPE_INT: {
+        auto const result = camera_->feature_int_get(name, module);
+        if (!result) {
+          return result.error();
+        }
+        value.set__int_value(*result);
+        break;
+      }
+    case FeatureValue::TYPE_FLOAT: {
+        auto const result = camera_->feature_float_get(name, module);
+        if (!result) {
+          return result.error();
+        }
+        value.set__float_value(*result);
+        break;
+      }
+    case FeatureValue::TYPE_STRING: {
+        auto const result = camera_->feature_string_get(name, module);
+        if (!result) {
+          return result.error();
+        }
+        value.set__string_value(*result);
+        break;
+      }
+    case FeatureValue::TYPE_BOOL: {
+        auto const result = camera_->feature_bool_get(name, module);
+        if (!result) {
+          return result.error();
+        }
+        value.set__bool_value(*result);
+        break;
+      }
+    case FeatureValue::TYPE_ENUM: {
+        auto const result = camera_->feature_enum_get(name, module);
+        if (!result) {
+          return result.error();
+        }
+        value.set__string_value(*result);
+        break;
+      }
+    default:
+      return error{VmbErrorBadParameter};
+  }
+
+  return value;
+}
+
+result<void> VimbaXCameraNode::feature_value_set(
+  const std::string & name, VimbaXCamera::Module module,
+  const vimbax_camera_msgs::msg::FeatureValue & value) const
+{
+  using vimbax_camera_msgs::msg::FeatureValue;
+
+  auto const set_result = [&]() -> result<void> {
+      switch (value.type) {
+        case FeatureValue::TYPE_INT:
+          return camera_->feature_int_set(name, value.int_value, module);
+        case FeatureValue::TYPE_FLOAT:
+          return camera_->feature_float_set(name, value.float_value, module);
+        case FeatureValue::TYPE_STRING:
+          return camera_->feature_string_set(name, value.string_value, module);
+        case FeatureValue::TYPE_BOOL:
+          return camera_->feature_bool_set(name, value.bool_value, module);
+        case FeatureValue::TYPE_ENUM:
+          return camera_->feature_enum_set(name, value.string_value, module);
+        default:
+          return error{VmbErrorBadParameter};
+      }
+    }();
+
+  if (set_result) {
+    feature_write_record(name, module, value);
+  }
+
+  return set_result;
+}
+
+void VimbaXCameraNode::feature_write_record(
+  const std::string & name, VimbaXCamera::Module module,
+  const vimbax_camera_msgs::msg::FeatureValue & value) const
+{
+  // The journal is only replayed by a fast reconnect
+  if (!node_->get_parameter(parameter_fast_reconnect).as_bool()) {
+    return;
+  }
+
+  auto const feature = camera_->feature_handle_get(name, module);
+  auto const is_selector = feature && feature->info && feature->info->hasSelectedFeatures;
+
+  std::lock_guard lock{feature_write_journal_mutex_};
+  feature_write_journal_.record({name, module, value, is_selector});
+}
+
+void VimbaXCameraNode::feature_snapshot_record(
+  const VimbaXCamera::FeatureSnapshot & snapshot,
+  const VimbaXCamera::FeatureSnapshotApplyResult & apply_result) const
+{
+  using vimbax_camera_msgs::msg::FeatureValue;
 
-  feature_info_query_service_ =
-    node_->create_service<vimbax_camera_msgs::srv::FeatureInfoQuery>(
-    "feature_info_query", [this](
-      const vimbax_camera_msgs::srv::FeatureInfoQuery::Request::ConstSharedPtr request,
-      const vimbax_camera_msgs::srv::FeatureInfoQuery::Response::SharedPtr response)
-    {
-      std::shared_lock lock(camera_mutex_);
-      if (is_available_) {
-        auto const feature_module = map_module(request->feature_module);
-        if (feature_module) {
-          std::vector<std::string> feature_names;
+  // Unchanged entries are not journaled, except for the selectors the written entries were
+  // written behind. Failed entries are matched by index, as the same name may appear with
+  // several selector values or in several modules.
+  std::vector<bool> recorded(snapshot.entries.size(), false);
+  std::vector<bool> failed(snapshot.entries.size(), false);
 
-          // If our list is empty we want to query infos for all features
-          if (request->feature_names.size() == 0) {
-            auto const result = camera_->features_list_get(*feature_module);
-            if (!result) {
-              response->set__error(result.error().to_error_msg());
-              return;
-            } else {
-              feature_names = *result;
-            }
-          } else {
-            feature_names = request->feature_names;
-          }
+  for (auto const index : apply_result.failed_entries) {
+    failed[index] = true;
+  }
 
-          auto const result = camera_->feature_info_query_list(feature_names, *feature_module);
-          if (!result) {
-            response->set__error(result.error().to_error_msg());
-            return;
-          } else {
-            std::transform(
-              result->begin(), result->end(),
-              std::back_inserter(response->feature_info),
-              [](const feature_info & info) {
-                auto const flags = vimbax_camera_msgs::msg::FeatureFlags{}
-                .set__flag_none(info.flags.flag_none)
-                .set__flag_read(info.flags.flag_read)
-                .set__flag_write(info.flags.flag_write)
-                .set__flag_volatile(info.flags.flag_volatile)
-                .set__flag_modify_write(info.flags.flag_modify_write);
+  for (auto index : apply_result.written_entries) {
+    while (!recorded[index]) {
+      recorded[index] = true;
 
-                return vimbax_camera_msgs::msg::FeatureInfo{}
-                .set__name(info.name)
-                .set__category(info.category)
-                .set__display_name(info.display_name)
-                .set__sfnc_namespace(info.sfnc_namespace)
-                .set__unit(info.unit)
-                .set__data_type(info.data_type)
-                .set__flags(flags)
-                .set__polling_time(info.polling_time);
-              });
-          }
-        } else {
-          response->set__error(error{VmbErrorBadParameter}.to_error_msg());
-        }
-      } else {
-        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+      auto const & selector_index = snapshot.entries[index].selector_index;
+      if (!selector_index) {
+        break;
       }
-    }, rmw_qos_profile_services_default, feature_callback_group_);
 
-  CHK_SVC(feature_info_query_service_);
+      index = *selector_index;
+    }
+  }
 
-  features_list_get_service_ =
-    node_->create_service<vimbax_camera_msgs::srv::FeaturesListGet>(
-    "features/list_get", [this](
-      const vimbax_camera_msgs::srv::FeaturesListGet::Request::ConstSharedPtr request,
-      const vimbax_camera_msgs::srv::FeaturesListGet::Response::SharedPtr response)
-    {
-      std::shared_lock lock(camera_mutex_);
-      if (is_available_) {
-        auto const feature_module = map_module(request->feature_module);
-        if (feature_module) {
-          auto const result = camera_->features_list_get(*feature_module);
-          if (!result) {
-            response->set__error(result.error().to_error_msg());
-          } else {
-            response->feature_list = *result;
-          }
-        } else {
-          response->set__error(error{VmbErrorBadParameter}.to_error_msg());
-        }
-      } else {
-        response->set__error(error{VmbErrorNotFound}.to_error_msg());
-      }
-    }, rmw_qos_profile_services_default, feature_callback_group_);
+  for (size_t i = 0; i < snapshot.entries.size(); i++) {
+    if (!recorded[i] || failed[i]) {
+      continue;
+    }
 
-  CHK_SVC(features_list_get_service_);
+    auto const & entry = snapshot.entries[i];
+    auto value = FeatureValue{};
+
+    switch (entry.type) {
+      case VmbFeatureDataInt:
+        value.set__type(FeatureValue::TYPE_INT).set__int_value(std::get<int64_t>(entry.value));
+        break;
+      case VmbFeatureDataFloat:
+        value.set__type(FeatureValue::TYPE_FLOAT)
+        .set__float_value(std::get<_Float64>(entry.value));
+        break;
+      case VmbFeatureDataBool:
+        value.set__type(FeatureValue::TYPE_BOOL).set__bool_value(std::get<bool>(entry.value));
+        break;
+      case VmbFeatureDataEnum:
+        value.set__type(FeatureValue::TYPE_ENUM)
+        .set__string_value(std::get<std::string>(entry.value));
+        break;
+      default:
+        value.set__type(FeatureValue::TYPE_STRING)
+        .set__string_value(std::get<std::string>(entry.value));
+        break;
+    }
 
-  return true;
+    feature_write_record(entry.name, entry.module, value);
+  }
+}
+
+void VimbaXCameraNode::feature_write_journal_replay()
+{
+  auto const journal = [this] {
+      std::lock_guard lock{feature_write_journal_mutex_};
+      return feature_write_journal_.take();
+    }();
+
+  if (journal.empty()) {
+    return;
+  }
+
+  auto const start_tp = std::chrono::steady_clock::now();
+
+  // Successful writes are recorded again, so the journal is rebuilt in the original order
+  for (auto const & write : journal) {
+    auto const result = feature_value_set(write.name, write.module, write.value);
+
+    if (!result) {
+      RCLCPP_WARN(
+        get_logger(), "Replaying write of feature %s failed with error %d (%s)",
+        write.name.c_str(), result.error().code,
+        vmb_error_to_string(result.error().code).data());
+    }
+  }
+
+  RCLCPP_INFO(
+    get_logger(), "Replayed %zu feature writes in %ld ms", journal.size(),
+    std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_tp).count());
 }
 
 bool VimbaXCameraNode::initialize_settings_services()
@@ -1450,6 +3427,11 @@ bool VimbaXCameraNode::initialize_settings_services()
         auto const result = camera_->settings_load(request->filename);
         if (!result) {
           response->set__error(result.error().to_error_msg());
+        } else {
+          // The file now defines the camera state, earlier writes must not be replayed on top
+          std::lock_guard journal_lock{feature_write_journal_mutex_};
+          feature_write_journal_.clear();
+          last_settings_file_ = request->filename;
         }
       } else {
         response->set__error(error{VmbErrorNotFound}.to_error_msg());
@@ -1458,6 +3440,186 @@ bool VimbaXCameraNode::initialize_settings_services()
 
   CHK_SVC(settings_load_service_);
 
+  settings_snapshot_save_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::SettingsLoadSave>(
+    "settings/snapshot_save", [this](
+      const vimbax_camera_msgs::srv::SettingsLoadSave::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::SettingsLoadSave::Response::SharedPtr response)
+    {
+      std::shared_lock lock(camera_mutex_);
+      if (!is_available_) {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+        return;
+      }
+
+      auto const snapshot = camera_->feature_snapshot_create();
+      if (!snapshot) {
+        response->set__error(snapshot.error().to_error_msg());
+        return;
+      }
+
+      auto const result = snapshot->save(request->filename);
+      if (!result) {
+        response->set__error(result.error().to_error_msg());
+      }
+    }, rmw_qos_profile_services_default, settings_load_save_callback_group_);
+
+  CHK_SVC(settings_snapshot_save_service_);
+
+  settings_snapshot_load_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::SettingsSnapshotLoad>(
+    "settings/snapshot_load", [this](
+      const vimbax_camera_msgs::srv::SettingsSnapshotLoad::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::SettingsSnapshotLoad::Response::SharedPtr response)
+    {
+      std::shared_lock lock(camera_mutex_);
+      if (!is_available_) {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+        return;
+      }
+
+      auto const snapshot = VimbaXCamera::FeatureSnapshot::load(request->filename);
+      if (!snapshot) {
+        response->set__error(snapshot.error().to_error_msg());
+        return;
+      }
+
+      auto const result = camera_->feature_snapshot_apply(*snapshot);
+      if (!result) {
+        response->set__error(result.error().to_error_msg());
+        return;
+      }
+
+      response->written = result->written;
+      response->unchanged = result->unchanged;
+      for (auto const index : result->failed_entries) {
+        response->failed_features.push_back(snapshot->entries[index].name);
+      }
+
+      // The snapshot values are journaled like single writes, so they survive a reconnect
+      feature_snapshot_record(*snapshot, *result);
+    }, rmw_qos_profile_services_default, settings_load_save_callback_group_);
+
+  CHK_SVC(settings_snapshot_load_service_);
+
+  return true;
+}
+
+bool VimbaXCameraNode::initialize_profile_services()
+{
+  RCLCPP_INFO(get_logger(), "Initializing profile services ...");
+
+  profiles_list_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::ProfilesList>(
+    "profiles/list", [this](
+      const vimbax_camera_msgs::srv::ProfilesList::Request::ConstSharedPtr,
+      const vimbax_camera_msgs::srv::ProfilesList::Response::SharedPtr response)
+    {
+      std::shared_lock lock(camera_mutex_);
+      if (!is_available_) {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+        return;
+      }
+
+      for (auto const & [name, snapshot] : profile_snapshots_) {
+        if (profiles_.count(name)) {
+          response->profiles.push_back(name);
+        }
+      }
+
+      std::lock_guard active_profile_lock{active_profile_mutex_};
+      response->active_profile = active_profile_;
+    }, rmw_qos_profile_services_default, status_callback_group_);
+
+  CHK_SVC(profiles_list_service_);
+
+  profile_switch_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::ProfileSwitch>(
+    "profiles/switch", [this](
+      const vimbax_camera_msgs::srv::ProfileSwitch::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::ProfileSwitch::Response::SharedPtr response)
+    {
+      auto const start_tp = std::chrono::steady_clock::now();
+
+      std::shared_lock lock(camera_mutex_);
+      if (!is_available_) {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+        return;
+      }
+
+      auto const profile_it = profiles_.find(request->profile);
+      if (profile_it == profiles_.end()) {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+        return;
+      }
+
+      auto const & profile = profile_it->second;
+
+      auto const changes = camera_->feature_profile_changes_get(profile);
+      if (!changes) {
+        response->set__error(changes.error().to_error_msg());
+        return;
+      }
+
+      // Changes of the image format need new frame buffers, all other features are written
+      // while the stream keeps running
+      auto const requires_restart = camera_->is_streaming() && std::any_of(
+        changes->begin(), changes->end(), [&](auto const index) {
+          auto const & name = profile.snapshot.entries[index].name;
+          return name == SFNCFeatures::Width || name == SFNCFeatures::Height ||
+          name == SFNCFeatures::PixelFormat;
+        });
+
+      if (requires_restart) {
+        auto const stop_result = stop_streaming();
+        if (!stop_result) {
+          response->set__error(stop_result.error().to_error_msg());
+          return;
+        }
+      }
+
+      auto const result = camera_->feature_profile_apply(profile);
+      std::optional<error> restart_error{};
+
+      if (requires_restart) {
+        auto const start_result = start_streaming();
+        if (!start_result) {
+          RCLCPP_ERROR(
+            get_logger(), "Restarting stream after profile switch failed with error %d (%s)",
+            start_result.error().code, vmb_error_to_string(start_result.error().code).data());
+          restart_error = start_result.error();
+        }
+      }
+
+      if (!result) {
+        response->set__error(result.error().to_error_msg());
+        return;
+      }
+
+      feature_snapshot_record(profile.snapshot, *result);
+
+      {
+        std::lock_guard active_profile_lock{active_profile_mutex_};
+        active_profile_ = profile.name;
+      }
+
+      response->written = result->written;
+      response->acquisition_restarted = requires_restart && !restart_error;
+
+      // The profile is active, but the caller must know that the stream is down
+      if (restart_error) {
+        response->set__error(restart_error->to_error_msg());
+      }
+      response->latency_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_tp).count();
+
+      RCLCPP_INFO(
+        get_logger(), "Switched to profile %s in %.3f ms (%u features written)",
+        profile.name.c_str(), response->latency_ms, result->written);
+    }, rmw_qos_profile_services_default, settings_load_save_callback_group_);
+
+  CHK_SVC(profile_switch_service_);
+
   return true;
 }
 
@@ -1528,6 +3690,38 @@ bool VimbaXCameraNode::initialize_status_services()
 
   CHK_SVC(connection_status_service_);
 
+  cameras_list_service_ = node_->create_service<vimbax_camera_msgs::srv::CamerasList>(
+    "cameras/list", [this](
+      const vimbax_camera_msgs::srv::CamerasList::Request::ConstSharedPtr,
+      const vimbax_camera_msgs::srv::CamerasList::Response::SharedPtr response)
+    {
+      if (!camera_index_) {
+        response->set__error(error{VmbErrorNotAvailable}.to_error_msg());
+        return;
+      }
+
+      for (auto const & entry : camera_index_->list()) {
+        auto & camera = response->cameras.emplace_back();
+        camera.set__camera_id(entry.camera_id)
+        .set__extended_id(entry.extended_id)
+        .set__display_name(entry.display_name)
+        .set__model_name(entry.model_name)
+        .set__serial_number(entry.serial_number)
+        .set__interface_id(entry.interface_id)
+        .set__available((entry.permitted_access & VmbAccessModeExclusive) != 0);
+
+        if (entry.ip_address) {
+          camera.set__ip_address(ip_addr_to_string(*entry.ip_address));
+        }
+
+        if (entry.mac_address) {
+          camera.set__mac_address(mac_addr_to_string(*entry.mac_address));
+        }
+      }
+    }, rmw_qos_profile_services_default, status_callback_group_);
+
+  CHK_SVC(cameras_list_service_);
+
   return true;
 }
 
@@ -1571,9 +3765,139 @@ bool VimbaXCameraNode::initialize_stream_services()
       } else {
         response->set__error(error{VmbErrorNotFound}.to_error_msg());
       }
-    }, rmw_qos_profile_services_default, stream_start_stop_callback_group_);
+    }, rmw_qos_profile_services_default, stream_start_stop_callback_group_);
+
+  CHK_SVC(stream_stop_service_);
+
+  return true;
+}
+
+bool VimbaXCameraNode::initialize_recording_services()
+{
+  RCLCPP_INFO(get_logger(), "Initializing recording services ...");
+
+  recording_start_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::RecordingStart>(
+    "recording/start", [this](
+      const vimbax_camera_msgs::srv::RecordingStart::Request::ConstSharedPtr request,
+      const vimbax_camera_msgs::srv::RecordingStart::Response::SharedPtr response)
+    {
+      std::shared_lock lock(camera_mutex_);
+      if (!is_available_) {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+        return;
+      }
+
+      auto const metadata = recording_metadata_get(*camera_);
+
+      std::lock_guard recorder_lock{recorder_mutex_};
+
+      if (recorder_) {
+        response->set__error(error{VmbErrorBusy}.to_error_msg());
+        return;
+      }
+
+      auto const recorder = FrameRecorder::create(request->filename, metadata);
+
+      if (!recorder) {
+        response->set__error(recorder.error().to_error_msg());
+        return;
+      }
+
+      recorder_ = *recorder;
+
+      RCLCPP_INFO(get_logger(), "Recording to %s", request->filename.c_str());
+    }, rmw_qos_profile_services_default, stream_start_stop_callback_group_);
+
+  CHK_SVC(recording_start_service_);
+
+  recording_stop_service_ =
+    node_->create_service<vimbax_camera_msgs::srv::RecordingStop>(
+    "recording/stop", [this](
+      const vimbax_camera_msgs::srv::RecordingStop::Request::ConstSharedPtr,
+      const vimbax_camera_msgs::srv::RecordingStop::Response::SharedPtr response)
+    {
+      auto const recorder = [this] {
+          std::lock_guard recorder_lock{recorder_mutex_};
+          return std::exchange(recorder_, nullptr);
+        }();
+
+      if (!recorder) {
+        response->set__error(error{VmbErrorNotFound}.to_error_msg());
+        return;
+      }
+
+      // Flushing the remaining chunks and the index doesn't block the frame callback
+      auto const statistics = recorder->close();
+
+      if (!statistics) {
+        response->set__error(statistics.error().to_error_msg());
+        return;
+      }
+
+      response->frames_written = statistics->frames_written;
+      response->frames_dropped = statistics->frames_dropped;
+      response->bytes_written = statistics->bytes_written;
+
+      RCLCPP_INFO(
+        get_logger(), "Recording stopped, %lu frames written, %lu dropped",
+        statistics->frames_written, statistics->frames_dropped);
+    }, rmw_qos_profile_services_default, stream_start_stop_callback_group_);
+
+  CHK_SVC(recording_stop_service_);
+
+  return true;
+}
+
+bool VimbaXCameraNode::initialize_burst_capture_action()
+{
+  using vimbax_camera_msgs::action::BurstCapture;
+
+  RCLCPP_INFO(get_logger(), "Initializing burst capture action ...");
+
+  burst_capture_action_server_ = rclcpp_action::create_server<BurstCapture>(
+    node_, "burst_capture",
+    [this](const rclcpp_action::GoalUUID &, std::shared_ptr<const BurstCapture::Goal> goal) {
+      if (goal->frame_count == 0) {
+        RCLCPP_ERROR(get_logger(), "Burst capture rejected, frame count must not be 0");
+        return rclcpp_action::GoalResponse::REJECT;
+      }
+
+      // Checked again when arming, the payload size may change until then
+      std::shared_lock lock(camera_mutex_);
+      if (is_available_) {
+        auto const size_result = burst_capture_size_check(*camera_, goal->frame_count);
+        if (!size_result) {
+          RCLCPP_ERROR(
+            get_logger(), "Burst capture of %u frames rejected, exceeds %s", goal->frame_count,
+            parameter_burst_max_size.c_str());
+          return rclcpp_action::GoalResponse::REJECT;
+        }
+      }
 
-  CHK_SVC(stream_stop_service_);
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    },
+    [](const std::shared_ptr<BurstCaptureGoalHandle>) {
+      return rclcpp_action::CancelResponse::ACCEPT;
+    },
+    [this](const std::shared_ptr<BurstCaptureGoalHandle> goal_handle) {
+      {
+        std::lock_guard lock{burst_capture_mutex_};
+        burst_capture_threads_++;
+      }
+
+      std::thread{[this, goal_handle] {
+          execute_burst_capture(goal_handle);
+
+          std::lock_guard lock{burst_capture_mutex_};
+          burst_capture_threads_--;
+          burst_capture_cv_.notify_all();
+        }}.detach();
+    }, rcl_action_server_get_default_options(), stream_start_stop_callback_group_);
+
+  if (!burst_capture_action_server_) {
+    return false;
+  }
 
   return true;
 }
@@ -1584,43 +3908,103 @@ result<void> VimbaXCameraNode::start_streaming()
     return error{VmbErrorNotFound};
   }
 
+
   auto const buffer_count = node_->get_parameter(parameter_buffer_count).as_int();
 
   std::unique_lock stream_state_lock(stream_state_mutex_, std::defer_lock);
   std::shared_lock camera_lock(camera_mutex_, std::defer_lock);
   std::lock(stream_state_lock, camera_lock);
 
+  if (burst_capture_active_) {
+    return error{VmbErrorBusy};
+  }
+
+  auto const stream_count = uint32_t(stream_publishers_.size() + 1);
+
+  last_frame_id_.assign(stream_count, std::nullopt);
+
+  if (frame_event_correlator_) {
+    frame_event_correlator_->clear();
+  }
+
+  feature_change_queue_->restart();
+
+  if (!camera_->is_streaming()) {
+    auto const ring_result = create_shared_frame_ring();
+
+    if (!ring_result) {
+      RCLCPP_ERROR(
+        get_logger(), "Creating the shared memory frame ring failed with %d (%s)",
+        ring_result.error().code, vmb_error_to_string(ring_result.error().code).data());
+    }
+
+    auto const auto_exposure_result = create_auto_exposure_controller();
+
+    if (!auto_exposure_result) {
+      RCLCPP_ERROR(
+        get_logger(), "Starting the auto exposure failed with %d (%s)",
+        auto_exposure_result.error().code,
+        vmb_error_to_string(auto_exposure_result.error().code).data());
+    }
+  }
+
   auto result = camera_->start_streaming(
     buffer_count,
     [this](std::shared_ptr<VimbaXCamera::Frame> frame) {
-      if (last_frame_id_) {
-        auto const diff = frame->get_frame_id() - *last_frame_id_;
+      auto const stream_index = frame->get_stream_index();
+      auto & last_frame_id = last_frame_id_[stream_index];
+
+      if (last_frame_id) {
+        auto const diff = frame->get_frame_id() - *last_frame_id;
 
         if (diff > 1) {
-          RCLCPP_WARN(get_logger(), "%ld frames missing", diff - 1);
+          RCLCPP_WARN(get_logger(), "%ld frames missing on stream %u", diff - 1, stream_index);
         }
       }
-      last_frame_id_ = frame->get_frame_id();
+      last_frame_id = frame->get_frame_id();
 
-      frame->header.set__frame_id(node_->get_parameter(parameter_frame_id).as_string());
+      // Queued feature changes are written as early as possible after a frame arrived, so
+      // they are active for the next exposures
+      if (stream_index == 0 && feature_change_queue_->pending()) {
+        feature_change_queue_->apply(frame->get_frame_id());
+      }
 
+      set_frame_header(*frame);
 
-      if (node_->get_parameter(parameter_use_ros_time).as_bool()) {
-        frame->header.stamp = node_->now();
-      } else {
-        std::chrono::nanoseconds vmbTimeStamp{frame->get_timestamp_ns()};
-        auto const seconds = std::chrono::floor<std::chrono::seconds>(vmbTimeStamp);
-        auto const nanoseconds =
-        std::chrono::duration_cast<std::chrono::nanoseconds>(vmbTimeStamp - seconds);
+      if (stream_index == 0) {
+        publish_frame_metadata(*frame);
+      }
 
-        frame->header.stamp.sec = int32_t(seconds.count());
-        frame->header.stamp.nanosec = nanoseconds.count();
+      if (stream_index == 0) {
+        std::lock_guard recorder_lock{recorder_mutex_};
+        if (recorder_) {
+          recorder_->write(*frame, frame->get_frame_id(), frame->get_timestamp_ns());
+        }
+      }
+
+      if (stream_index == 0 && correction_capture_active_) {
+        pixel_correction_add_frame(*frame);
+      }
+
+      if (stream_index == 0 && pretrigger_ring_) {
+        pretrigger_ring_->push(*frame, frame->get_frame_id(), frame->get_timestamp_ns());
+      }
+
+      if (stream_index == 0) {
+        publish_shared_frame(*frame);
+        publish_image_statistics(*frame);
+
+        if (auto_exposure_controller_) {
+          auto_exposure_controller_->process(*frame);
+        }
       }
 
       auto const camera_info = [&] {
         auto const loaded_info = camera_info_manager_->getCameraInfo();
 
-        if (loaded_info.width != frame->width || loaded_info.height != frame->height) {
+        if (stream_index != 0 ||
+        loaded_info.width != frame->width || loaded_info.height != frame->height)
+        {
           return sensor_msgs::msg::CameraInfo{}.set__width(frame->width).set__height(frame->height);
         }
 
@@ -1628,7 +4012,57 @@ result<void> VimbaXCameraNode::start_streaming()
       }().set__header(frame->header);
 
 
-      camera_publisher_.publish(*frame, camera_info);
+      // The regions are cut while the full image is published and must be done before the
+      // frame is requeued
+      auto roi_pipeline_active = false;
+
+      if (stream_index == 0 && roi_pipeline_) {
+        for (std::size_t i = 0; i < roi_publishers_.size(); i++) {
+          roi_active_[i] = roi_publishers_[i].getNumSubscribers() > 0;
+          roi_pipeline_active = roi_pipeline_active || roi_active_[i];
+        }
+      }
+
+      if (roi_pipeline_active) {
+        roi_pipeline_->process(*frame, camera_info, roi_active_);
+      }
+
+      if (stream_index == 0 && ptp_sync_) {
+        ptp_sync_->add_timestamp(ptp_sync_member_, frame->get_timestamp_ns());
+      }
+
+      if (stream_index == 0 && rectifier_ && rect_publisher_.getNumSubscribers() > 0) {
+        publish_rectified(*frame, camera_info);
+      }
+
+      if (stream_index == 0) {
+        camera_publisher_.publish(*frame, camera_info);
+      } else {
+        stream_publishers_[stream_index - 1].publish(*frame, camera_info);
+      }
+
+      if (roi_pipeline_active) {
+        roi_pipeline_->wait();
+      }
+
+      // Added last, since a complete set may be released and requeue this frame right away
+      if (stream_index == 0 && frame_set_) {
+        auto const held = frame_set_->images_wanted();
+
+        // The set holds the frame instead of a copy, it is requeued once the set is published
+        // or dropped. Requeueing fails expectedly if the stream was stopped in between. The
+        // image pointer is cast so the holder doesn't take part in shared_from_this.
+        auto const image = static_cast<sensor_msgs::msg::Image *>(frame.get());
+        frame_set_->add(
+          frame_set_member_, FrameSetAggregator::Frame{
+            held ? std::shared_ptr<sensor_msgs::msg::Image>(
+              image, [frame](sensor_msgs::msg::Image *) {frame->queue();}) : nullptr,
+            camera_info, uint64_t(frame->get_frame_id()), frame->get_timestamp_ns()});
+
+        if (held) {
+          return;
+        }
+      }
 
       auto const queue_error = frame->queue();
       if (queue_error != VmbErrorSuccess) {
@@ -1636,10 +4070,12 @@ result<void> VimbaXCameraNode::start_streaming()
           get_logger(), "Frame requeue failed with %d (%s)", queue_error,
           (vmb_error_to_string(queue_error)).data());
       }
-    });
+    }, true, stream_count);
 
   if (result) {
-    RCLCPP_INFO(get_logger(), "Stream started using %ld buffers", buffer_count);
+    RCLCPP_INFO(
+      get_logger(), "Stream started using %ld buffers on %u stream(s)", buffer_count,
+      stream_count);
   }
   return result;
 }
@@ -1654,9 +4090,15 @@ result<void> VimbaXCameraNode::stop_streaming()
   std::shared_lock camera_lock(camera_mutex_, std::defer_lock);
   std::lock(stream_state_lock, camera_lock);
 
+  if (burst_capture_active_) {
+    return error{VmbErrorBusy};
+  }
+
   auto error = camera_->stop_streaming();
 
-  last_frame_id_ = std::nullopt;
+  auto_exposure_controller_.reset();
+
+  last_frame_id_.clear();
 
   RCLCPP_INFO(get_logger(), "Stream stopped");
   return error;
@@ -1668,6 +4110,558 @@ bool VimbaXCameraNode::is_streaming()
   return (!camera_) ? false : camera_->is_streaming();
 }
 
+size_t VimbaXCameraNode::get_num_subscribers() const
+{
+  auto num_subscribers = camera_publisher_.getNumSubscribers();
+
+  for (auto const & publisher : stream_publishers_) {
+    num_subscribers += publisher.getNumSubscribers();
+  }
+
+  for (auto const & publisher : roi_publishers_) {
+    num_subscribers += publisher.getNumSubscribers();
+  }
+
+  if (shared_frame_publisher_) {
+    num_subscribers += shared_frame_publisher_->get_subscription_count();
+  }
+
+  if (image_statistics_publisher_) {
+    num_subscribers += image_statistics_publisher_->get_subscription_count();
+  }
+
+  return num_subscribers;
+}
+
+result<void> VimbaXCameraNode::create_shared_frame_ring()
+{
+  auto const slot_count = node_->get_parameter(parameter_shared_memory_slots).as_int();
+
+  std::lock_guard lock{shared_frame_ring_mutex_};
+
+  // Clients keep the mapping of the previous ring until they released its frames
+  shared_frame_ring_.reset();
+
+  if (slot_count == 0) {
+    return {};
+  }
+
+  auto const payload_size = camera_->get_payload_size(0);
+
+  if (!payload_size) {
+    return payload_size.error();
+  }
+
+  // Every ring gets a new name, so clients notice the change from the descriptors
+  auto const name = "/vimbax_camera_" + std::to_string(::getpid()) + "_" +
+    std::to_string(shared_frame_ring_count_++);
+
+  auto const ring = SharedFrameRing::create(name, *payload_size, uint32_t(slot_count));
+
+  if (!ring) {
+    return ring.error();
+  }
+
+  shared_frame_ring_ = *ring;
+
+  RCLCPP_INFO(
+    get_logger(), "Publishing frames in shared memory %s using %ld slots of %u bytes",
+    name.c_str(), slot_count, *payload_size);
+
+  return {};
+}
+
+result<void> VimbaXCameraNode::create_auto_exposure_controller()
+{
+  auto_exposure_controller_.reset();
+
+  if (!node_->get_parameter(parameter_auto_exposure).as_bool()) {
+    return {};
+  }
+
+  std::vector<AutoExposureRegion> regions;
+
+  for (auto const & definition :
+    node_->get_parameter(parameter_auto_exposure_regions).as_string_array())
+  {
+    auto const region = AutoExposureRegion::parse(definition);
+
+    if (!region) {
+      RCLCPP_ERROR(
+        get_logger(), "Invalid auto exposure region '%s', expected x,y,width,height,weight",
+        definition.c_str());
+      continue;
+    }
+
+    regions.push_back(*region);
+  }
+
+  auto const settings = AutoExposureController::Settings{
+    node_->get_parameter(parameter_auto_exposure_target).as_double(),
+    node_->get_parameter(parameter_auto_exposure_tolerance).as_double(),
+    node_->get_parameter(parameter_auto_exposure_kp).as_double(),
+    node_->get_parameter(parameter_auto_exposure_ki).as_double(),
+    node_->get_parameter(parameter_auto_exposure_max_rate).as_double(),
+    uint32_t(node_->get_parameter(parameter_auto_exposure_settle_frames).as_int()),
+    uint32_t(node_->get_parameter(parameter_auto_exposure_stride).as_int()),
+    regions,
+    node_->get_parameter(parameter_auto_exposure_exposure_time_max).as_double(),
+    node_->get_parameter(parameter_auto_exposure_gain_max).as_double()};
+
+  auto const controller = AutoExposureController::create(
+    camera_, settings, [this, target = settings.target](
+      const AutoExposureController::Status & status) {
+      auto_exposure_status_publisher_->publish(
+        vimbax_camera_msgs::msg::AutoExposureStatus{}
+        .set__header(std_msgs::msg::Header{}.set__stamp(node_->now()))
+        .set__brightness(status.brightness)
+        .set__target(target)
+        .set__exposure_time(status.exposure_time)
+        .set__gain(status.gain)
+        .set__converged(status.converged)
+        .set__converged_updates(status.converged_updates)
+        .set__settling_updates(status.settling_updates)
+        .set__update_count(status.update_count));
+    }, feature_change_queue_.get());
+
+  if (!controller) {
+    return controller.error();
+  }
+
+  auto_exposure_controller_ = *controller;
+
+  RCLCPP_INFO(
+    get_logger(), "Auto exposure started with target %f", settings.target);
+
+  return {};
+}
+
+void VimbaXCameraNode::publish_rectified(
+  const VimbaXCamera::Frame & frame, const sensor_msgs::msg::CameraInfo & camera_info)
+{
+  auto const rectify_result = rectifier_->process(frame, camera_info, rect_image_);
+
+  // Reported once per cause, as the calibration can be set or fixed at runtime
+  if (!rectify_result) {
+    if (rectify_result.error().code != rectify_error_) {
+      RCLCPP_WARN(
+        get_logger(), "Rectifying %ux%u %s images failed with %d (%s)", frame.width, frame.height,
+        frame.encoding.c_str(), rectify_result.error().code,
+        vmb_error_to_string(rectify_result.error().code).data());
+    }
+
+    rectify_error_ = rectify_result.error().code;
+    return;
+  }
+
+  rectify_error_ = VmbErrorSuccess;
+  rect_publisher_.publish(rect_image_, camera_info);
+}
+
+void VimbaXCameraNode::publish_image_statistics(const VimbaXCamera::Frame & frame)
+{
+  auto const interval = node_->get_parameter(parameter_statistics_interval).as_int();
+
+  if (interval == 0 || image_statistics_frame_count_++ % uint64_t(interval) != 0 ||
+    image_statistics_publisher_->get_subscription_count() == 0)
+  {
+    return;
+  }
+
+  auto const stride = node_->get_parameter(parameter_statistics_stride).as_int();
+  auto const statistics = ImageStatistics::compute(frame, frame.get_bit_depth(), uint32_t(stride));
+
+  if (!statistics) {
+    RCLCPP_WARN_ONCE(
+      get_logger(), "Image statistics are not supported for %s images", frame.encoding.c_str());
+    return;
+  }
+
+  auto message = vimbax_camera_msgs::msg::ImageStatistics{}
+  .set__header(frame.header)
+  .set__frame_id(frame.get_frame_id())
+  .set__bit_depth(frame.get_bit_depth())
+  .set__stride(uint32_t(stride))
+  .set__sample_count(statistics->sample_count)
+  .set__mean(statistics->mean)
+  .set__mean_red(statistics->channel_means[0])
+  .set__mean_green(statistics->channel_means[1])
+  .set__mean_blue(statistics->channel_means[2])
+  .set__saturation_ratio(statistics->saturation_ratio)
+  .set__sharpness(statistics->sharpness);
+
+  message.histogram.assign(statistics->histogram.begin(), statistics->histogram.end());
+
+  image_statistics_publisher_->publish(message);
+}
+
+void VimbaXCameraNode::publish_shared_frame(const VimbaXCamera::Frame & frame)
+{
+  std::lock_guard lock{shared_frame_ring_mutex_};
+
+  if (!shared_frame_ring_ || shared_frame_publisher_->get_subscription_count() == 0) {
+    return;
+  }
+
+  auto const slot = shared_frame_ring_->write(frame);
+
+  if (!slot) {
+    shared_frames_dropped_++;
+    // Clients holding every slot usually do so for many frames in a row
+    RCLCPP_WARN_THROTTLE(
+      get_logger(), *node_->get_clock(), 1000, "No free shared memory slot, %lu frames dropped",
+      shared_frames_dropped_);
+    return;
+  }
+
+  shared_frame_publisher_->publish(
+    vimbax_camera_msgs::msg::SharedFrame{}
+    .set__header(frame.header)
+    .set__segment(shared_frame_ring_->name())
+    .set__slot(slot->index)
+    .set__generation(slot->generation));
+}
+
+void VimbaXCameraNode::set_frame_header(VimbaXCamera::Frame & frame) const
+{
+  frame.header.set__frame_id(node_->get_parameter(parameter_frame_id).as_string());
+
+
+  if (node_->get_parameter(parameter_use_ros_time).as_bool()) {
+    frame.header.stamp = node_->now();
+  } else {
+    set_frame_stamp(frame, frame.get_timestamp_ns());
+  }
+}
+
+void VimbaXCameraNode::set_frame_stamp(VimbaXCamera::Frame & frame, uint64_t timestamp_ns) const
+{
+  std::chrono::nanoseconds vmbTimeStamp{timestamp_ns};
+  auto const seconds = std::chrono::floor<std::chrono::seconds>(vmbTimeStamp);
+  auto const nanoseconds =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(vmbTimeStamp - seconds);
+
+  frame.header.stamp.sec = int32_t(seconds.count());
+  frame.header.stamp.nanosec = nanoseconds.count();
+}
+
+void VimbaXCameraNode::publish_frame_metadata(VimbaXCamera::Frame & frame)
+{
+  // Called for every frame, as the generation lookup expects ascending frame ids
+  auto const settings_generation = feature_change_queue_->generation(frame.get_frame_id());
+
+  if (!frame_event_correlator_) {
+    publish_frame_metadata(
+      frame.header, settings_generation,
+      FrameEventCorrelator::FrameEvents{frame.get_frame_id(), std::nullopt, std::nullopt, {}});
+    return;
+  }
+
+  // The midpoint is a device timestamp, so it is only used if the images aren't stamped
+  // with the ROS time. Only events that arrived before the frame are used for its stamp.
+  if (node_->get_parameter(parameter_stamp_exposure_midpoint).as_bool() &&
+    !node_->get_parameter(parameter_use_ros_time).as_bool())
+  {
+    auto const midpoint = frame_event_correlator_->exposure_midpoint_ns(frame.get_frame_id());
+
+    if (midpoint) {
+      set_frame_stamp(frame, *midpoint);
+    }
+  }
+
+  // The event worker usually delivers the events after their frame, so the correlator waits
+  // for them on its own thread instead of holding the frame
+  frame_event_correlator_->take_async(
+    frame.get_frame_id(), frame_correlation_timeout_,
+    [this, correlator = frame_event_correlator_.get(), header = frame.header,
+    settings_generation](FrameEventCorrelator::FrameEvents && frame_events) {
+      auto const dropped = correlator->dropped_count();
+      if (dropped != frame_correlation_dropped_) {
+        RCLCPP_WARN(
+          get_logger(), "%lu events couldn't be matched with a frame",
+          dropped - frame_correlation_dropped_);
+        frame_correlation_dropped_ = dropped;
+      }
+
+      // The frame id based generation is only an estimate, the exposure start tells which
+      // changes were written before the exposure
+      auto const confirmed_generation = frame_events.exposure_start_ns ?
+      feature_change_queue_->generation_at(*frame_events.exposure_start_ns) : std::nullopt;
+
+      publish_frame_metadata(
+        header, confirmed_generation.value_or(settings_generation), frame_events);
+    });
+}
+
+void VimbaXCameraNode::publish_frame_metadata(
+  const std_msgs::msg::Header & header, uint64_t settings_generation,
+  const FrameEventCorrelator::FrameEvents & frame_events)
+{
+  if (frame_metadata_publisher_->get_subscription_count() == 0) {
+    return;
+  }
+
+  auto metadata = vimbax_camera_msgs::msg::FrameMetadata{}
+  .set__header(header).set__frame_id(frame_events.frame_id)
+  .set__exposure_start(frame_events.exposure_start_ns.value_or(0))
+  .set__exposure_end(frame_events.exposure_end_ns.value_or(0))
+  .set__settings_generation(settings_generation);
+
+  metadata.event_names.reserve(frame_events.events.size());
+  metadata.event_timestamps.reserve(frame_events.events.size());
+
+  for (auto const & event : frame_events.events) {
+    metadata.event_names.push_back(event.name);
+    metadata.event_timestamps.push_back(event.timestamp_ns);
+  }
+
+  frame_metadata_publisher_->publish(metadata);
+}
+
+result<void> VimbaXCameraNode::burst_capture_size_check(
+  const VimbaXCamera & camera, uint32_t frame_count) const
+{
+  // Each frame of the burst gets its own preallocated full payload buffer
+  if (frame_count > uint32_t(std::numeric_limits<int>::max())) {
+    return error{VmbErrorResources};
+  }
+
+  auto const payload_size = camera.get_payload_size(0);
+  if (!payload_size) {
+    return payload_size.error();
+  }
+
+  auto const max_size =
+    uint64_t(node_->get_parameter(parameter_burst_max_size).as_int()) * 1024 * 1024;
+
+  if (uint64_t(*payload_size) * frame_count > max_size) {
+    return error{VmbErrorResources};
+  }
+
+  return {};
+}
+
+void VimbaXCameraNode::execute_burst_capture(
+  std::shared_ptr<BurstCaptureGoalHandle> goal_handle)
+{
+  using vimbax_camera_msgs::action::BurstCapture;
+
+  auto const goal = goal_handle->get_goal();
+  auto const burst_result = std::make_shared<BurstCapture::Result>();
+
+  // Shared with the frame callback, which may still be called if stopping the stream fails
+  struct ReceivedFrames
+  {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::shared_ptr<VimbaXCamera::Frame>> frames;
+  };
+
+  auto const received = std::make_shared<ReceivedFrames>();
+
+  std::shared_ptr<VimbaXCamera> camera;
+  std::future<result<void>> trigger_result;
+  bool stream_was_active = false;
+
+  // Arm the acquisition with exactly frame_count buffers. Frames are never requeued, so the
+  // camera delivers at full speed until the preallocated ring is used up.
+  auto const arm_result = [&]() -> result<void> {
+      std::unique_lock stream_state_lock(stream_state_mutex_, std::defer_lock);
+      std::shared_lock camera_lock(camera_mutex_, std::defer_lock);
+      std::lock(stream_state_lock, camera_lock);
+
+      if (!is_available_) {
+        return error{VmbErrorNotFound};
+      }
+
+      if (burst_capture_active_.exchange(true)) {
+        return error{VmbErrorBusy};
+      }
+
+      auto const size_result = burst_capture_size_check(*camera_, goal->frame_count);
+      if (!size_result) {
+        burst_capture_active_ = false;
+        return size_result.error();
+      }
+
+      camera = camera_;
+      stream_was_active = camera->is_streaming();
+
+      if (stream_was_active) {
+        auto const stop_result = camera->stop_streaming();
+        last_frame_id_.clear();
+
+        if (!stop_result) {
+          burst_capture_active_ = false;
+          return stop_result.error();
+        }
+      }
+
+      auto const start_result = camera->start_streaming(
+        int(goal->frame_count),
+        [this, received](std::shared_ptr<VimbaXCamera::Frame> frame) {
+          set_frame_header(*frame);
+
+          {
+            std::lock_guard lock{received->mutex};
+            received->frames.push_back(frame);
+          }
+
+          received->cv.notify_one();
+        });
+
+      if (!start_result) {
+        camera->stop_streaming();
+        burst_capture_active_ = false;
+        return start_result.error();
+      }
+
+      // The trigger completion is checked while collecting, the first frames may already
+      // arrive before the command reports done.
+      if (goal->software_trigger) {
+        auto const timeout = node_->get_parameter(parameter_command_feature_timeout).as_int();
+        trigger_result = camera->feature_command_run_async(
+          SFNCFeatures::TriggerSoftware,
+          timeout > 0 ? std::optional{std::chrono::milliseconds{timeout}} : std::nullopt);
+      }
+
+      return {};
+    }();
+
+  if (!arm_result) {
+    RCLCPP_ERROR(
+      get_logger(), "Burst capture failed to start with error %d (%s)", arm_result.error().code,
+      vmb_error_to_string(arm_result.error().code).data());
+    burst_result->set__error(arm_result.error().to_error_msg());
+    goal_handle->abort(burst_result);
+    return;
+  }
+
+  RCLCPP_INFO(get_logger(), "Burst capture of %u frames armed", goal->frame_count);
+
+  auto const deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{goal->timeout};
+  size_t frames_delivered = 0;
+  std::optional<error> burst_error{};
+  bool canceled = false;
+
+  while (true) {
+    std::vector<std::shared_ptr<VimbaXCamera::Frame>> chunk;
+    bool complete = false;
+
+    {
+      std::unique_lock lock{received->mutex};
+      auto const & frames = received->frames;
+      received->cv.wait_for(
+        lock, std::chrono::milliseconds(50), [&] {
+          return frames.size() >= goal->frame_count ||
+          (goal->chunk_size > 0 && frames.size() - frames_delivered >= goal->chunk_size);
+        });
+
+      complete = frames.size() >= goal->frame_count;
+
+      if (goal->chunk_size > 0 && frames.size() - frames_delivered >= goal->chunk_size) {
+        chunk.assign(
+          frames.begin() + frames_delivered,
+          frames.begin() + frames_delivered + goal->chunk_size);
+      }
+    }
+
+    // Feedback is sent from here and not from the frame callback to keep the acquisition
+    // independent of the message serialization.
+    if (!chunk.empty()) {
+      auto feedback = std::make_shared<BurstCapture::Feedback>();
+      feedback->images.reserve(chunk.size());
+
+      for (auto const & frame : chunk) {
+        feedback->images.push_back(*frame);
+      }
+
+      frames_delivered += chunk.size();
+      feedback->set__frames_received(uint32_t(frames_delivered));
+      goal_handle->publish_feedback(feedback);
+      continue;
+    }
+
+    if (complete) {
+      break;
+    }
+
+    if (goal_handle->is_canceling()) {
+      canceled = true;
+      break;
+    }
+
+    if (trigger_result.valid() &&
+      trigger_result.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+      auto const trigger_error = trigger_result.get();
+      if (!trigger_error) {
+        burst_error = trigger_error.error();
+        break;
+      }
+    }
+
+    if (!is_available_) {
+      burst_error = error{VmbErrorNotFound};
+      break;
+    }
+
+    if (stop_threads_.load(std::memory_order::memory_order_relaxed)) {
+      burst_error = error{VmbErrorNotAvailable};
+      break;
+    }
+
+    if (goal->timeout > 0 && std::chrono::steady_clock::now() >= deadline) {
+      burst_error = error{VmbErrorTimeout};
+      break;
+    }
+  }
+
+  if (trigger_result.valid()) {
+    trigger_result.wait();
+  }
+
+  {
+    std::lock_guard stream_state_lock{stream_state_mutex_};
+    camera->stop_streaming();
+    burst_capture_active_ = false;
+  }
+
+  auto const frames = [&] {
+      std::lock_guard lock{received->mutex};
+      return received->frames;
+    }();
+
+  if (stream_was_active ||
+    (node_->get_parameter(parameter_autostream).as_int() == 1 && get_num_subscribers() > 0 &&
+    !stream_stopped_by_service_))
+  {
+    stream_restart_required_ = true;
+  }
+
+  // All frames not already sent as feedback are returned with the result. The stream is
+  // stopped at this point, so the image data can be moved out of the frames.
+  burst_result->images.reserve(frames.size() - frames_delivered);
+  for (auto it = frames.begin() + frames_delivered; it != frames.end(); it++) {
+    burst_result->images.push_back(std::move(static_cast<sensor_msgs::msg::Image &>(**it)));
+  }
+
+  if (canceled) {
+    RCLCPP_INFO(
+      get_logger(), "Burst capture canceled after %zu frames", frames.size());
+    goal_handle->canceled(burst_result);
+  } else if (burst_error) {
+    RCLCPP_ERROR(
+      get_logger(), "Burst capture failed after %zu frames with error %d (%s)", frames.size(),
+      burst_error->code, vmb_error_to_string(burst_error->code).data());
+    burst_result->set__error(burst_error->to_error_msg());
+    goal_handle->abort(burst_result);
+  } else {
+    RCLCPP_INFO(get_logger(), "Burst capture of %zu frames done", frames.size());
+    goal_handle->succeed(burst_result);
+  }
+}
+
 std::string VimbaXCameraNode::get_node_name()
 {
   auto const pidString = [] {
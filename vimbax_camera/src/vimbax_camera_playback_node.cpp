@@ -0,0 +1,219 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+#include <rclcpp_components/register_node_macro.hpp>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_playback_node.hpp>
+
+namespace vimbax_camera
+{
+using helper::get_logger;
+
+VimbaXCameraPlaybackNode::VimbaXCameraPlaybackNode(const rclcpp::NodeOptions & options)
+{
+  if (!initialize(options)) {
+    rclcpp::shutdown();
+  }
+}
+
+bool VimbaXCameraPlaybackNode::initialize(const rclcpp::NodeOptions & options)
+{
+  node_ = helper::create_node("vimbax_camera_playback", options);
+
+  if (!node_) {
+    return false;
+  }
+
+  if (!initialize_parameters()) {
+    return false;
+  }
+
+  if (!initialize_reader()) {
+    return false;
+  }
+
+  if (!initialize_publisher()) {
+    return false;
+  }
+
+  playback_thread_ = std::make_unique<std::thread>([this] {playback_thread_func();});
+
+  RCLCPP_INFO(get_logger(), "Initialization done!");
+  return true;
+}
+
+VimbaXCameraPlaybackNode::~VimbaXCameraPlaybackNode()
+{
+  {
+    std::lock_guard lock{stop_mutex_};
+    stop_threads_.store(true, std::memory_order::memory_order_relaxed);
+    stop_cv_.notify_all();
+  }
+
+  if (playback_thread_) {
+    playback_thread_->join();
+  }
+}
+
+bool VimbaXCameraPlaybackNode::initialize_parameters()
+{
+  auto const filename_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Recording file to play back").set__read_only(true);
+  node_->declare_parameter(parameter_filename, "", filename_param_desc);
+
+  auto const rate_range = rcl_interfaces::msg::FloatingPointRange{}
+  .set__from_value(0.0).set__to_value(1000.0);
+  auto const rate_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Playback speed relative to the recorded timing, 0 publishes without pacing")
+  .set__floating_point_range({rate_range});
+  node_->declare_parameter(parameter_rate, 1.0, rate_param_desc);
+
+  auto const loop_param_desc = rcl_interfaces::msg::ParameterDescriptor{}
+  .set__description("Restart the playback after the last frame");
+  node_->declare_parameter(parameter_loop, false, loop_param_desc);
+
+  return true;
+}
+
+bool VimbaXCameraPlaybackNode::initialize_reader()
+{
+  auto const filename = node_->get_parameter(parameter_filename).as_string();
+
+  auto reader = RecordingReader::open(filename);
+
+  if (!reader) {
+    RCLCPP_FATAL(
+      get_logger(), "Failed to open recording %s with error %d", filename.c_str(),
+      reader.error().code);
+    return false;
+  }
+
+  reader_ = *reader;
+
+  RCLCPP_INFO(
+    get_logger(), "Opened recording of %s (%s) with %zu frames",
+    reader_->metadata().camera_model.c_str(), reader_->metadata().camera_id.c_str(),
+    reader_->frame_count());
+
+  return true;
+}
+
+bool VimbaXCameraPlaybackNode::initialize_publisher()
+{
+  auto const qos = rmw_qos_profile_default;
+
+  image_publisher_ = image_transport::create_publisher(node_.get(), "image_raw", qos);
+
+  if (!image_publisher_) {
+    return false;
+  }
+
+  return true;
+}
+
+void VimbaXCameraPlaybackNode::playback_thread_func()
+{
+  using clock = std::chrono::steady_clock;
+
+  auto const frame_id = reader_->metadata().frame_id;
+
+  do {
+    auto const start = clock::now();
+    auto first_timestamp = std::optional<uint64_t>{};
+
+    for (std::size_t i = 0; i < reader_->frame_count(); i++) {
+      if (stop_threads_.load(std::memory_order::memory_order_relaxed)) {
+        return;
+      }
+
+      auto const frame = reader_->frame(i);
+
+      if (!frame) {
+        RCLCPP_ERROR(get_logger(), "Failed to read frame %zu with %d", i, frame.error().code);
+        return;
+      }
+
+      if (!first_timestamp) {
+        first_timestamp = frame->timestamp_ns;
+      }
+
+      // Read the rate on every frame so it can be changed during the playback
+      auto const rate = node_->get_parameter(parameter_rate).as_double();
+
+      if (rate > 0.0) {
+        // Frames older than the first one of a non monotonic recording are published at once
+        auto const elapsed_ns = int64_t(frame->timestamp_ns) - int64_t(*first_timestamp);
+        auto const offset = std::chrono::nanoseconds{
+          std::max<int64_t>(int64_t(double(elapsed_ns) / rate), 0)};
+
+        std::unique_lock lock{stop_mutex_};
+        if (stop_cv_.wait_until(
+            lock, start + offset,
+            [this] {return stop_threads_.load(std::memory_order::memory_order_relaxed);}))
+        {
+          return;
+        }
+      }
+
+      // The image is copied out of the mapping, publishing a loaned view is not
+      // supported by image_transport
+      auto image = sensor_msgs::msg::Image{};
+      image.header.frame_id = frame_id;
+      image.header.stamp.sec = int32_t(frame->timestamp_ns / 1'000'000'000);
+      image.header.stamp.nanosec = uint32_t(frame->timestamp_ns % 1'000'000'000);
+      image.width = frame->width;
+      image.height = frame->height;
+      image.step = frame->step;
+      image.is_bigendian = frame->is_bigendian;
+      image.encoding = std::string{frame->encoding};
+      image.data.assign(frame->data, frame->data + frame->size);
+
+      image_publisher_.publish(image);
+    }
+  } while (node_->get_parameter(parameter_loop).as_bool() &&
+  !stop_threads_.load(std::memory_order::memory_order_relaxed));
+
+  RCLCPP_INFO(get_logger(), "Playback finished");
+}
+
+VimbaXCameraPlaybackNode::NodeBaseInterface::SharedPtr
+VimbaXCameraPlaybackNode::get_node_base_interface() const
+{
+  return node_->get_node_base_interface();
+}
+
+}  // namespace vimbax_camera
+
+
+RCLCPP_COMPONENTS_REGISTER_NODE(vimbax_camera::VimbaXCameraPlaybackNode)
@@ -0,0 +1,318 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <zlib.h>
+
+#include <algorithm>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_pretrigger.hpp>
+
+namespace vimbax_camera
+{
+
+using helper::get_logger;
+
+result<std::shared_ptr<PreTriggerRing>> PreTriggerRing::create(const Settings & settings)
+{
+  RCLCPP_DEBUG(get_logger(), "%s", __FUNCTION__);
+
+  if ((settings.duration_ns == 0 && settings.max_bytes == 0) ||
+    settings.compression_level < 0 || settings.compression_level > Z_BEST_COMPRESSION)
+  {
+    return error{VmbErrorBadParameter};
+  }
+
+  std::shared_ptr<PreTriggerRing> ring{new PreTriggerRing(settings)};
+
+  if (settings.compression_level > 0) {
+    ring->compressor_thread_ = std::thread(&PreTriggerRing::compressor_run, ring.get());
+  }
+
+  return ring;
+}
+
+PreTriggerRing::PreTriggerRing(const Settings & settings)
+: settings_{settings}
+{
+}
+
+PreTriggerRing::~PreTriggerRing()
+{
+  {
+    std::lock_guard lock{mutex_};
+    stop_ = true;
+  }
+
+  compressor_cv_.notify_all();
+
+  if (compressor_thread_.joinable()) {
+    compressor_thread_.join();
+  }
+
+  std::lock_guard dump_lock{dump_mutex_};
+
+  if (dump_thread_.joinable()) {
+    dump_thread_.join();
+  }
+}
+
+void PreTriggerRing::push(
+  const sensor_msgs::msg::Image & image, int64_t frame_id, uint64_t timestamp_ns)
+{
+  auto const frame = std::make_shared<Frame>();
+  frame->frame_id = frame_id;
+  frame->timestamp_ns = timestamp_ns;
+  frame->size = image.data.size();
+  frame->compressed = false;
+  frame->image.header = image.header;
+  frame->image.height = image.height;
+  frame->image.width = image.width;
+  frame->image.encoding = image.encoding;
+  frame->image.is_bigendian = image.is_bigendian;
+  frame->image.step = image.step;
+  frame->image.data = take_buffer(image.data.size());
+  // Assigning reuses the capacity of the pooled buffer without zeroing it first
+  frame->image.data.assign(image.data.begin(), image.data.end());
+
+  {
+    std::lock_guard lock{mutex_};
+    entries_.push_back(Entry{next_sequence_++, frame});
+    byte_count_ += frame->image.data.size();
+    evict();
+  }
+
+  compressor_cv_.notify_one();
+}
+
+PreTriggerRing::Frames PreTriggerRing::snapshot() const
+{
+  std::lock_guard lock{mutex_};
+
+  Frames frames{};
+  frames.reserve(entries_.size());
+
+  for (auto const & entry : entries_) {
+    frames.push_back(entry.frame);
+  }
+
+  return frames;
+}
+
+result<std::size_t> PreTriggerRing::dump(Consumer consumer)
+{
+  std::lock_guard dump_lock{dump_mutex_};
+
+  if (dumping_) {
+    return error{VmbErrorBusy};
+  }
+
+  if (dump_thread_.joinable()) {
+    dump_thread_.join();
+  }
+
+  auto frames = snapshot();
+  auto const frame_count = frames.size();
+
+  dumping_ = true;
+  dump_thread_ = std::thread(
+    [this, consumer = std::move(consumer), frames = std::move(frames)] {
+      consumer(frames);
+      dumping_ = false;
+    });
+
+  return frame_count;
+}
+
+bool PreTriggerRing::is_dumping() const
+{
+  return dumping_;
+}
+
+result<void> PreTriggerRing::decode(const Frame & frame, sensor_msgs::msg::Image & image)
+{
+  image.header = frame.image.header;
+  image.height = frame.image.height;
+  image.width = frame.image.width;
+  image.encoding = frame.image.encoding;
+  image.is_bigendian = frame.image.is_bigendian;
+  image.step = frame.image.step;
+
+  if (!frame.compressed) {
+    image.data.assign(frame.image.data.begin(), frame.image.data.end());
+    return {};
+  }
+
+  image.data.resize(frame.size);
+  auto size = uLongf(frame.size);
+  auto const res = uncompress(
+    image.data.data(), &size, frame.image.data.data(), uLong(frame.image.data.size()));
+
+  if (res != Z_OK || size != frame.size) {
+    return error{VmbErrorInvalidValue};
+  }
+
+  return {};
+}
+
+std::size_t PreTriggerRing::byte_count() const
+{
+  std::lock_guard lock{mutex_};
+  return byte_count_;
+}
+
+std::vector<uint8_t> PreTriggerRing::take_buffer(std::size_t size)
+{
+  std::lock_guard lock{mutex_};
+
+  auto const it = std::find_if(
+    pool_.begin(), pool_.end(), [size](auto const & buffer) {return buffer.capacity() >= size;});
+
+  if (it == pool_.end()) {
+    return {};
+  }
+
+  auto buffer = std::move(*it);
+  pool_.erase(it);
+  buffer.clear();
+
+  return buffer;
+}
+
+void PreTriggerRing::recycle(std::shared_ptr<Frame> && frame)
+{
+  // Must be called with mutex_ held
+  if (frame.use_count() != 1) {
+    return;
+  }
+
+  if (pool_.size() >= pool_size) {
+    // Keep the largest buffers, as they fit any frame
+    auto const smallest = std::min_element(
+      pool_.begin(), pool_.end(),
+      [](auto const & a, auto const & b) {return a.capacity() < b.capacity();});
+
+    if (smallest->capacity() >= frame->image.data.capacity()) {
+      return;
+    }
+
+    pool_.erase(smallest);
+  }
+
+  pool_.push_back(std::move(frame->image.data));
+}
+
+void PreTriggerRing::evict()
+{
+  // Must be called with mutex_ held, the newest frame is always kept
+  while (entries_.size() > 1) {
+    auto const & oldest = *entries_.front().frame;
+    auto const & newest = *entries_.back().frame;
+
+    auto const too_large = settings_.max_bytes > 0 && byte_count_ > settings_.max_bytes;
+    auto const too_old = settings_.duration_ns > 0 &&
+      newest.timestamp_ns > oldest.timestamp_ns &&
+      newest.timestamp_ns - oldest.timestamp_ns > settings_.duration_ns;
+
+    if (!too_large && !too_old) {
+      return;
+    }
+
+    byte_count_ -= oldest.image.data.size();
+    auto frame = std::move(entries_.front().frame);
+    entries_.pop_front();
+    recycle(std::move(frame));
+  }
+}
+
+void PreTriggerRing::compressor_run()
+{
+  std::vector<uint8_t> buffer{};
+
+  for (;; ) {
+    std::shared_ptr<Frame> source{};
+    uint64_t sequence{};
+
+    {
+      std::unique_lock lock{mutex_};
+      compressor_cv_.wait(
+        lock, [this] {return stop_ || compress_sequence_ < next_sequence_;});
+
+      if (stop_) {
+        return;
+      }
+
+      // Frames evicted before they were compressed are skipped
+      compress_sequence_ = std::max(compress_sequence_, entries_.front().sequence);
+      sequence = compress_sequence_++;
+      source = entries_[sequence - entries_.front().sequence].frame;
+    }
+
+    auto size = compressBound(uLong(source->image.data.size()));
+    buffer.resize(size);
+
+    auto const res = compress2(
+      buffer.data(), &size, source->image.data.data(), uLong(source->image.data.size()),
+      settings_.compression_level);
+
+    if (res != Z_OK || size >= source->image.data.size()) {
+      // Incompressible data is kept as is
+      continue;
+    }
+
+    auto const frame = std::make_shared<Frame>();
+    frame->frame_id = source->frame_id;
+    frame->timestamp_ns = source->timestamp_ns;
+    frame->size = source->size;
+    frame->compressed = true;
+    frame->image.header = source->image.header;
+    frame->image.height = source->image.height;
+    frame->image.width = source->image.width;
+    frame->image.encoding = source->image.encoding;
+    frame->image.is_bigendian = source->image.is_bigendian;
+    frame->image.step = source->image.step;
+    frame->image.data.assign(buffer.begin(), buffer.begin() + size);
+
+    std::lock_guard lock{mutex_};
+
+    if (entries_.empty() || sequence < entries_.front().sequence) {
+      continue;
+    }
+
+    auto & entry = entries_[sequence - entries_.front().sequence];
+    byte_count_ -= entry.frame->image.data.size();
+    byte_count_ += frame->image.data.size();
+    source.reset();
+    recycle(std::exchange(entry.frame, frame));
+  }
+}
+
+}  // namespace vimbax_camera
@@ -0,0 +1,559 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_recorder.hpp>
+
+namespace vimbax_camera
+{
+
+using helper::get_logger;
+
+namespace
+{
+constexpr uint32_t file_magic = 0x43525856;  // "VXRC"
+constexpr uint32_t record_magic = 0x52465856;  // "VXFR"
+constexpr uint32_t index_magic = 0x49525856;  // "VXRI"
+constexpr std::size_t record_header_size = 80;
+constexpr std::size_t encoding_size = 32;
+constexpr std::size_t index_entry_size = 24;
+constexpr std::size_t footer_size = 24;
+
+template<typename T>
+void put_le(uint8_t * dst, T value)
+{
+  for (std::size_t i = 0; i < sizeof(T); i++) {
+    dst[i] = uint8_t(uint64_t(value) >> (8 * i));
+  }
+}
+
+template<typename T>
+T get_le(const uint8_t * src)
+{
+  uint64_t value{};
+  for (std::size_t i = 0; i < sizeof(T); i++) {
+    value |= uint64_t(src[i]) << (8 * i);
+  }
+  return T(value);
+}
+
+constexpr std::size_t align_up(std::size_t value, std::size_t alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+void FrameRecorder::AlignedFree::operator()(uint8_t * ptr) const
+{
+  std::free(ptr);
+}
+
+FrameRecorder::Chunk FrameRecorder::allocate_chunk(std::size_t size)
+{
+  return Chunk{static_cast<uint8_t *>(std::aligned_alloc(recording::block_size, size))};
+}
+
+result<std::shared_ptr<FrameRecorder>> FrameRecorder::create(
+  const std::string & filename, const recording::Metadata & metadata,
+  std::size_t chunk_size, std::size_t chunk_count)
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, filename.c_str());
+
+  auto fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+
+  if (fd < 0 && errno == EINVAL) {
+    // The file system doesn't support direct IO
+    fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  }
+
+  if (fd < 0) {
+    RCLCPP_ERROR(
+      get_logger(), "Failed to open recording %s: %s", filename.c_str(), std::strerror(errno));
+    return error{VmbErrorIO};
+  }
+
+  std::shared_ptr<FrameRecorder> recorder{
+    new FrameRecorder(fd, align_up(std::max<std::size_t>(chunk_size, 1), recording::block_size))};
+
+  for (std::size_t i = 0; i < std::max<std::size_t>(chunk_count, 2); i++) {
+    auto chunk = allocate_chunk(recorder->chunk_size_);
+
+    if (!chunk) {
+      return error{VmbErrorResources};
+    }
+
+    recorder->free_chunks_.push_back(std::move(chunk));
+    recorder->chunk_count_++;
+  }
+
+  auto header = allocate_chunk(recording::block_size);
+
+  if (!header) {
+    return error{VmbErrorResources};
+  }
+
+  std::memset(header.get(), 0, recording::block_size);
+
+  auto position = header.get();
+  auto const put_string = [&](const std::string & str) {
+      auto const size = std::min<std::size_t>(str.size(), 1024);
+      put_le<uint32_t>(position, uint32_t(size));
+      std::memcpy(position + 4, str.data(), size);
+      position += 4 + size;
+    };
+
+  put_le<uint32_t>(position, file_magic);
+  put_le<uint32_t>(position + 4, recording::version);
+  put_le<uint32_t>(position + 8, uint32_t(recording::block_size));
+  put_le<uint64_t>(position + 12, metadata.created_ns);
+  position += 20;
+  put_string(metadata.camera_model);
+  put_string(metadata.camera_id);
+  put_string(metadata.frame_id);
+
+  auto const header_result = recorder->write_block(header.get(), recording::block_size, 0);
+
+  if (!header_result) {
+    return header_result.error();
+  }
+
+  recorder->writer_thread_ = std::thread{[recorder = recorder.get()] {recorder->writer_run();}};
+
+  return recorder;
+}
+
+FrameRecorder::FrameRecorder(int fd, std::size_t chunk_size)
+: fd_{fd}, chunk_size_{chunk_size}
+{
+}
+
+FrameRecorder::~FrameRecorder()
+{
+  if (writer_thread_.joinable()) {
+    close();
+  }
+
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+bool FrameRecorder::write(
+  const sensor_msgs::msg::Image & image, int64_t frame_id, uint64_t timestamp_ns, bool wait)
+{
+  if (closed_) {
+    return false;
+  }
+
+  auto const data_size = image.data.size();
+  auto const record_size = align_up(record_header_size + data_size, 8);
+
+  {
+    // Chunks are only added to the free list concurrently, so the frame is guaranteed to fit
+    std::unique_lock lock{chunks_mutex_};
+    auto const available = [this] {
+        return (current_chunk_ ? chunk_size_ - current_used_ : 0) +
+               free_chunks_.size() * chunk_size_;
+      };
+
+    // Once all submitted chunks are written, the current and the free chunks are all there is
+    auto const capacity = chunk_count_ * chunk_size_ - (current_chunk_ ? current_used_ : 0);
+
+    if (wait && record_size <= capacity) {
+      chunks_cv_.wait(
+        lock, [&] {return writer_error_ || available() >= record_size;});
+    }
+
+    if (writer_error_ || available() < record_size) {
+      frames_dropped_++;
+      return false;
+    }
+  }
+
+  uint8_t header[record_header_size]{};
+  put_le<uint32_t>(header, record_magic);
+  put_le<uint32_t>(header + 4, uint32_t(record_header_size));
+  put_le<int64_t>(header + 8, frame_id);
+  put_le<uint64_t>(header + 16, timestamp_ns);
+  put_le<uint32_t>(header + 24, image.width);
+  put_le<uint32_t>(header + 28, image.height);
+  put_le<uint32_t>(header + 32, image.step);
+  header[36] = image.is_bigendian;
+  std::memcpy(header + 40, image.encoding.data(), std::min(image.encoding.size(), encoding_size));
+  put_le<uint64_t>(header + 72, data_size);
+
+  append(header, record_header_size);
+  append(image.data.data(), data_size);
+  append_padding(record_size - record_header_size - data_size);
+
+  index_.push_back(IndexEntry{frame_id, timestamp_ns, stream_offset_});
+  stream_offset_ += record_size;
+
+  frames_written_++;
+  bytes_written_ += record_size;
+
+  return true;
+}
+
+result<FrameRecorder::Statistics> FrameRecorder::close()
+{
+  if (!closed_) {
+    closed_ = true;
+
+    auto const index_offset = stream_offset_;
+
+    for (auto const & entry : index_) {
+      uint8_t index_entry[index_entry_size]{};
+      put_le<int64_t>(index_entry, entry.frame_id);
+      put_le<uint64_t>(index_entry + 8, entry.timestamp_ns);
+      put_le<uint64_t>(index_entry + 16, entry.offset);
+      append(index_entry, index_entry_size);
+    }
+
+    // The footer ends exactly at a block boundary, so it is found at the end of the file
+    auto const index_end = index_offset + index_.size() * index_entry_size;
+    append_padding(align_up(index_end + footer_size, recording::block_size) - footer_size -
+      index_end);
+
+    uint8_t footer[footer_size]{};
+    put_le<uint64_t>(footer, index_offset);
+    put_le<uint64_t>(footer + 8, index_.size());
+    put_le<uint32_t>(footer + 16, index_magic);
+    put_le<uint32_t>(footer + 20, recording::version);
+    append(footer, footer_size);
+
+    if (current_chunk_) {
+      submit_chunk(current_used_);
+    }
+
+    {
+      std::lock_guard lock{chunks_mutex_};
+      writer_stop_ = true;
+      chunks_cv_.notify_all();
+    }
+
+    writer_thread_.join();
+
+    ::fsync(fd_);
+  }
+
+  std::lock_guard lock{chunks_mutex_};
+
+  if (writer_error_) {
+    return *writer_error_;
+  }
+
+  return statistics();
+}
+
+FrameRecorder::Statistics FrameRecorder::statistics() const
+{
+  return {frames_written_, frames_dropped_, bytes_written_};
+}
+
+void FrameRecorder::append(const void * data, std::size_t size)
+{
+  auto source = static_cast<const uint8_t *>(data);
+
+  while (size > 0) {
+    if (!current_chunk_) {
+      std::unique_lock lock{chunks_mutex_};
+      chunks_cv_.wait(lock, [this] {return !free_chunks_.empty();});
+      current_chunk_ = std::move(free_chunks_.back());
+      free_chunks_.pop_back();
+      current_used_ = 0;
+    }
+
+    auto const count = std::min(size, chunk_size_ - current_used_);
+
+    if (source != nullptr) {
+      std::memcpy(current_chunk_.get() + current_used_, source, count);
+      source += count;
+    } else {
+      std::memset(current_chunk_.get() + current_used_, 0, count);
+    }
+
+    current_used_ += count;
+    size -= count;
+
+    if (current_used_ == chunk_size_) {
+      submit_chunk(chunk_size_);
+    }
+  }
+}
+
+void FrameRecorder::append_padding(std::size_t size)
+{
+  append(nullptr, size);
+}
+
+void FrameRecorder::submit_chunk(std::size_t used)
+{
+  std::lock_guard lock{chunks_mutex_};
+  full_chunks_.emplace_back(std::move(current_chunk_), used);
+  current_used_ = 0;
+  chunks_cv_.notify_all();
+}
+
+result<void> FrameRecorder::write_block(const uint8_t * data, std::size_t size, uint64_t offset)
+{
+  while (size > 0) {
+    auto const written = ::pwrite(fd_, data, size, off_t(offset));
+
+    if (written < 0) {
+      auto const flags = ::fcntl(fd_, F_GETFL);
+
+      if (errno == EINVAL && (flags & O_DIRECT)) {
+        // Direct IO isn't supported for this file after all
+        ::fcntl(fd_, F_SETFL, flags & ~O_DIRECT);
+        continue;
+      }
+
+      if (errno == EINTR) {
+        continue;
+      }
+
+      RCLCPP_ERROR(get_logger(), "Writing recording failed: %s", std::strerror(errno));
+      return error{VmbErrorIO};
+    }
+
+    data += written;
+    size -= std::size_t(written);
+    offset += uint64_t(written);
+  }
+
+  return {};
+}
+
+void FrameRecorder::writer_run()
+{
+  uint64_t file_offset = recording::block_size;
+
+  for (;; ) {
+    std::unique_lock lock{chunks_mutex_};
+    chunks_cv_.wait(lock, [this] {return writer_stop_ || !full_chunks_.empty();});
+
+    if (full_chunks_.empty()) {
+      return;
+    }
+
+    auto [chunk, used] = std::move(full_chunks_.front());
+    full_chunks_.pop_front();
+    lock.unlock();
+
+    auto const write_result = writer_error_ ?
+      result<void>{} : write_block(chunk.get(), used, file_offset);
+    file_offset += used;
+
+    lock.lock();
+
+    if (!write_result) {
+      writer_error_ = write_result.error();
+    }
+
+    free_chunks_.push_back(std::move(chunk));
+    chunks_cv_.notify_all();
+  }
+}
+
+result<std::shared_ptr<RecordingReader>> RecordingReader::open(const std::string & filename)
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, filename.c_str());
+
+  auto const fd = ::open(filename.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    return error{VmbErrorNotFound};
+  }
+
+  struct stat file_stat{};
+
+  if (::fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    ::close(fd);
+    return error{VmbErrorInvalidValue};
+  }
+
+  auto const size = std::size_t(file_stat.st_size);
+  auto const mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (mapping == MAP_FAILED) {
+    return error{VmbErrorIO};
+  }
+
+  ::madvise(mapping, size, MADV_SEQUENTIAL);
+
+  std::shared_ptr<RecordingReader> reader{
+    new RecordingReader(static_cast<const uint8_t *>(mapping), size)};
+
+  auto const parse_result = reader->parse();
+
+  if (!parse_result) {
+    return parse_result.error();
+  }
+
+  return reader;
+}
+
+RecordingReader::RecordingReader(const uint8_t * data, std::size_t size)
+: data_{data}, size_{size}
+{
+}
+
+RecordingReader::~RecordingReader()
+{
+  ::munmap(const_cast<uint8_t *>(data_), size_);
+}
+
+result<void> RecordingReader::parse()
+{
+  if (size_ < recording::block_size + footer_size ||
+    get_le<uint32_t>(data_) != file_magic ||
+    get_le<uint32_t>(data_ + 4) != recording::version)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  metadata_.created_ns = get_le<uint64_t>(data_ + 12);
+
+  std::size_t position = 20;
+  auto const get_string = [&](std::string & str) {
+      if (position + 4 > recording::block_size) {
+        return false;
+      }
+
+      auto const length = get_le<uint32_t>(data_ + position);
+
+      if (position + 4 + length > recording::block_size) {
+        return false;
+      }
+
+      str.assign(reinterpret_cast<const char *>(data_ + position + 4), length);
+      position += 4 + length;
+      return true;
+    };
+
+  if (!get_string(metadata_.camera_model) || !get_string(metadata_.camera_id) ||
+    !get_string(metadata_.frame_id))
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  auto const footer = data_ + size_ - footer_size;
+
+  if (get_le<uint32_t>(footer + 16) != index_magic) {
+    // The recording wasn't closed
+    return error{VmbErrorInvalidValue};
+  }
+
+  auto const index_offset = get_le<uint64_t>(footer);
+  auto const frame_count = get_le<uint64_t>(footer + 8);
+
+  if (index_offset < recording::block_size ||
+    index_offset > size_ - footer_size ||
+    frame_count > (size_ - footer_size - index_offset) / index_entry_size)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  record_offsets_.reserve(frame_count);
+
+  for (uint64_t i = 0; i < frame_count; i++) {
+    auto const offset = get_le<uint64_t>(data_ + index_offset + i * index_entry_size + 16);
+
+    if (offset < recording::block_size || offset + record_header_size > index_offset) {
+      return error{VmbErrorInvalidValue};
+    }
+
+    record_offsets_.push_back(offset);
+  }
+
+  return {};
+}
+
+const recording::Metadata & RecordingReader::metadata() const
+{
+  return metadata_;
+}
+
+std::size_t RecordingReader::frame_count() const
+{
+  return record_offsets_.size();
+}
+
+result<RecordingReader::FrameView> RecordingReader::frame(std::size_t index) const
+{
+  if (index >= record_offsets_.size()) {
+    return error{VmbErrorBadParameter};
+  }
+
+  auto const offset = record_offsets_[index];
+  auto const header = data_ + offset;
+
+  if (get_le<uint32_t>(header) != record_magic) {
+    return error{VmbErrorInvalidValue};
+  }
+
+  auto const header_size = get_le<uint32_t>(header + 4);
+  auto const data_size = get_le<uint64_t>(header + 72);
+
+  if (header_size < record_header_size || header_size > size_ - offset ||
+    data_size > size_ - offset - header_size)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  auto const encoding = reinterpret_cast<const char *>(header + 40);
+
+  return FrameView{
+    get_le<int64_t>(header + 8),
+    get_le<uint64_t>(header + 16),
+    get_le<uint32_t>(header + 24),
+    get_le<uint32_t>(header + 28),
+    get_le<uint32_t>(header + 32),
+    header[36] != 0,
+    std::string_view{encoding, strnlen(encoding, encoding_size)},
+    header + header_size,
+    std::size_t(data_size),
+  };
+}
+
+}  // namespace vimbax_camera
@@ -0,0 +1,395 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_rectify.hpp>
+
+namespace vimbax_camera
+{
+
+using helper::get_logger;
+
+namespace
+{
+constexpr uint32_t fraction_one = 1 << RectifyMap::fraction_bits;
+
+// Scalar bilinear interpolation for the formats without a SIMD kernel
+template<typename T, uint32_t Channels>
+void remap_row(
+  T * dst, const uint8_t * src, uint32_t step, const int32_t * offsets,
+  const uint16_t * fractions, uint32_t width)
+{
+  constexpr auto round = 1u << (2 * RectifyMap::fraction_bits - 1);
+
+  for (uint32_t x = 0; x < width; x++, dst += Channels) {
+    if (offsets[x] < 0) {
+      std::fill(dst, dst + Channels, T{0});
+      continue;
+    }
+
+    auto const top = reinterpret_cast<const T *>(src + offsets[x]);
+    auto const bottom = reinterpret_cast<const T *>(src + offsets[x] + step);
+    uint32_t const fx = fractions[x] & 0xFF;
+    uint32_t const fy = fractions[x] >> 8;
+
+    for (uint32_t c = 0; c < Channels; c++) {
+      auto const top_value = top[c] * (fraction_one - fx) + top[c + Channels] * fx;
+      auto const bottom_value = bottom[c] * (fraction_one - fx) + bottom[c + Channels] * fx;
+
+      dst[c] = T(
+        (top_value * (fraction_one - fy) + bottom_value * fy + round) >>
+        (2 * RectifyMap::fraction_bits));
+    }
+  }
+}
+
+// Fixed point position of a source coordinate, kept one pixel inside the image so the
+// interpolation never reads past the last row or column
+std::pair<uint32_t, uint32_t> fixed_point(double position, uint32_t size)
+{
+  position = std::clamp(position, 0.0, double(size - 1));
+  auto const integer = std::min(uint32_t(position), size - 2);
+  auto const fraction = uint32_t(std::lround((position - integer) * fraction_one));
+
+  return {integer, std::min(fraction, fraction_one)};
+}
+}  // namespace
+
+result<std::shared_ptr<const RectifyMap>> RectifyMap::create(
+  const sensor_msgs::msg::CameraInfo & camera_info, const sensor_msgs::msg::Image & image)
+{
+  uint32_t channels{0};
+  uint32_t bytes_per_channel{0};
+
+  if (image.encoding == "mono8") {
+    channels = 1;
+    bytes_per_channel = 1;
+  } else if (image.encoding == "mono16") {
+    channels = 1;
+    bytes_per_channel = 2;
+  } else if (image.encoding == "rgb8" || image.encoding == "bgr8") {
+    channels = 3;
+    bytes_per_channel = 1;
+  } else {
+    return error{VmbErrorNotSupported};
+  }
+
+  auto const & model = camera_info.distortion_model;
+  auto const is_equidistant = model == "equidistant";
+
+  if (!is_equidistant && model != "plumb_bob" && model != "rational_polynomial" &&
+    !(model.empty() && camera_info.d.empty()))
+  {
+    return error{VmbErrorNotSupported};
+  }
+
+  auto const width = image.width;
+  auto const height = image.height;
+
+  if (width < 2 || height < 2 || camera_info.width != width || camera_info.height != height ||
+    camera_info.k[0] == 0.0 || camera_info.k[4] == 0.0 ||
+    image.step < width * channels * bytes_per_channel ||
+    image.data.size() < std::size_t(image.step) * height ||
+    std::size_t(image.step) * height > INT32_MAX)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  auto const & k = camera_info.k;
+  auto const r = std::all_of(camera_info.r.begin(), camera_info.r.end(), [](double v) {
+        return v == 0.0;
+      }) ? std::array<double, 9>{1, 0, 0, 0, 1, 0, 0, 0, 1} : camera_info.r;
+  // An uncalibrated projection keeps the camera matrix
+  auto const p = camera_info.p[0] == 0.0 ?
+    std::array<double, 9>{k[0], k[1], k[2], k[3], k[4], k[5], k[6], k[7], k[8]} :
+    std::array<double, 9>{camera_info.p[0], camera_info.p[1], camera_info.p[2],
+    camera_info.p[4], camera_info.p[5], camera_info.p[6],
+    camera_info.p[8], camera_info.p[9], camera_info.p[10]};
+
+  // Rectified pixel to ray in the camera frame, the inverse of P * R
+  double m[9]{};
+  for (std::size_t row = 0; row < 3; row++) {
+    for (std::size_t col = 0; col < 3; col++) {
+      for (std::size_t i = 0; i < 3; i++) {
+        m[row * 3 + col] += p[row * 3 + i] * r[i * 3 + col];
+      }
+    }
+  }
+
+  auto const determinant = m[0] * (m[4] * m[8] - m[5] * m[7]) -
+    m[1] * (m[3] * m[8] - m[5] * m[6]) + m[2] * (m[3] * m[7] - m[4] * m[6]);
+
+  if (std::abs(determinant) < 1e-12) {
+    return error{VmbErrorInvalidValue};
+  }
+
+  double const inverse[9]{
+    (m[4] * m[8] - m[5] * m[7]) / determinant, (m[2] * m[7] - m[1] * m[8]) / determinant,
+    (m[1] * m[5] - m[2] * m[4]) / determinant, (m[5] * m[6] - m[3] * m[8]) / determinant,
+    (m[0] * m[8] - m[2] * m[6]) / determinant, (m[2] * m[3] - m[0] * m[5]) / determinant,
+    (m[3] * m[7] - m[4] * m[6]) / determinant, (m[1] * m[6] - m[0] * m[7]) / determinant,
+    (m[0] * m[4] - m[1] * m[3]) / determinant};
+
+  double d[8]{};
+  std::copy_n(camera_info.d.begin(), std::min<std::size_t>(camera_info.d.size(), 8), d);
+
+  std::shared_ptr<RectifyMap> map{new RectifyMap()};
+  map->camera_info_ = camera_info;
+  map->encoding_ = image.encoding;
+  map->step_ = image.step;
+  map->channels_ = channels;
+  map->bytes_per_channel_ = bytes_per_channel;
+  map->offsets_.resize(std::size_t(width) * height);
+  map->fractions_.resize(std::size_t(width) * height);
+
+  for (uint32_t v = 0; v < height; v++) {
+    for (uint32_t u = 0; u < width; u++) {
+      auto const index = std::size_t(v) * width + u;
+      auto const w = inverse[6] * u + inverse[7] * v + inverse[8];
+
+      map->offsets_[index] = -1;
+      map->fractions_[index] = 0;
+
+      if (w <= 0.0) {
+        continue;
+      }
+
+      auto const x = (inverse[0] * u + inverse[1] * v + inverse[2]) / w;
+      auto const y = (inverse[3] * u + inverse[4] * v + inverse[5]) / w;
+      auto const r2 = x * x + y * y;
+      double xd{};
+      double yd{};
+
+      if (is_equidistant) {
+        auto const radius = std::sqrt(r2);
+        auto const theta = std::atan(radius);
+        auto const t2 = theta * theta;
+        auto const theta_d = theta * (1 + t2 * (d[0] + t2 * (d[1] + t2 * (d[2] + t2 * d[3]))));
+        auto const scale = radius > 1e-8 ? theta_d / radius : 1.0;
+
+        xd = x * scale;
+        yd = y * scale;
+      } else {
+        auto const radial = (1 + r2 * (d[0] + r2 * (d[1] + r2 * d[4]))) /
+          (1 + r2 * (d[5] + r2 * (d[6] + r2 * d[7])));
+
+        xd = x * radial + 2 * d[2] * x * y + d[3] * (r2 + 2 * x * x);
+        yd = y * radial + d[2] * (r2 + 2 * y * y) + 2 * d[3] * x * y;
+      }
+
+      auto const source_x = k[0] * xd + k[1] * yd + k[2];
+      auto const source_y = k[4] * yd + k[5];
+
+      // The tolerance keeps the border of an identity mapping despite rounding errors
+      if (!(source_x > -1e-6 && source_y > -1e-6 && source_x < width - 1 + 1e-6 &&
+        source_y < height - 1 + 1e-6))
+      {
+        continue;
+      }
+
+      auto const [x0, fx] = fixed_point(source_x, width);
+      auto const [y0, fy] = fixed_point(source_y, height);
+
+      map->offsets_[index] = int32_t(y0 * image.step + x0 * channels * bytes_per_channel);
+      map->fractions_[index] = uint16_t(fx | (fy << 8));
+    }
+  }
+
+  RCLCPP_INFO(
+    get_logger(), "Created %ux%u %s rectification map", width, height, image.encoding.c_str());
+
+  return std::shared_ptr<const RectifyMap>{map};
+}
+
+bool RectifyMap::matches(
+  const sensor_msgs::msg::CameraInfo & camera_info, const sensor_msgs::msg::Image & image) const
+{
+  return image.width == camera_info_.width && image.height == camera_info_.height &&
+         image.step == step_ && image.encoding == encoding_ &&
+         camera_info.width == camera_info_.width && camera_info.height == camera_info_.height &&
+         camera_info.distortion_model == camera_info_.distortion_model &&
+         camera_info.d == camera_info_.d && camera_info.k == camera_info_.k &&
+         camera_info.r == camera_info_.r && camera_info.p == camera_info_.p;
+}
+
+void RectifyMap::remap(
+  const sensor_msgs::msg::Image & image, sensor_msgs::msg::Image & rectified, uint32_t x,
+  uint32_t y, uint32_t width, uint32_t height) const
+{
+  auto const pixel_size = bytes_per_pixel();
+
+  for (auto row = y; row < y + height; row++) {
+    auto const dst = rectified.data.data() + std::size_t(row) * rectified.step + x * pixel_size;
+    auto const index = std::size_t(row) * camera_info_.width + x;
+    auto const offsets = offsets_.data() + index;
+    auto const fractions = fractions_.data() + index;
+
+    if (bytes_per_channel_ == 2) {
+      remap_row<uint16_t, 1>(
+        reinterpret_cast<uint16_t *>(dst), image.data.data(), step_, offsets, fractions, width);
+    } else if (channels_ == 3) {
+      remap_row<uint8_t, 3>(dst, image.data.data(), step_, offsets, fractions, width);
+    } else {
+      helper::remap_row8(
+        dst, image.data.data(), image.data.size(), step_, offsets, fractions, width);
+    }
+  }
+}
+
+uint32_t RectifyMap::width() const
+{
+  return camera_info_.width;
+}
+
+uint32_t RectifyMap::height() const
+{
+  return camera_info_.height;
+}
+
+uint32_t RectifyMap::bytes_per_pixel() const
+{
+  return channels_ * bytes_per_channel_;
+}
+
+Rectifier::Rectifier(uint32_t thread_count)
+{
+  for (uint32_t i = 1; i < thread_count; i++) {
+    workers_.emplace_back([this] {worker_run();});
+  }
+}
+
+Rectifier::~Rectifier()
+{
+  {
+    std::lock_guard lock{mutex_};
+    stop_ = true;
+  }
+
+  job_cv_.notify_all();
+
+  for (auto & worker : workers_) {
+    worker.join();
+  }
+}
+
+result<void> Rectifier::process(
+  const sensor_msgs::msg::Image & image, const sensor_msgs::msg::CameraInfo & camera_info,
+  sensor_msgs::msg::Image & rectified)
+{
+  if (!map_ || !map_->matches(camera_info, image)) {
+    map_.reset();
+
+    auto const map = RectifyMap::create(camera_info, image);
+
+    if (!map) {
+      return map.error();
+    }
+
+    map_ = *map;
+  }
+
+  rectified.header = image.header;
+  rectified.width = image.width;
+  rectified.height = image.height;
+  rectified.encoding = image.encoding;
+  rectified.is_bigendian = image.is_bigendian;
+  rectified.step = image.width * map_->bytes_per_pixel();
+  rectified.data.resize(std::size_t(rectified.step) * rectified.height);
+
+  {
+    std::lock_guard lock{mutex_};
+    image_ = &image;
+    rectified_ = &rectified;
+    tile_columns_ = (image.width + tile_width - 1) / tile_width;
+    tile_count_ = tile_columns_ * ((image.height + tile_height - 1) / tile_height);
+    next_tile_ = 0;
+    pending_ = workers_.size();
+    job_++;
+  }
+
+  job_cv_.notify_all();
+
+  run_tiles();
+
+  std::unique_lock lock{mutex_};
+  done_cv_.wait(lock, [this] {return pending_ == 0;});
+  image_ = nullptr;
+  rectified_ = nullptr;
+
+  return {};
+}
+
+void Rectifier::worker_run()
+{
+  uint64_t last_job{0};
+
+  while (true) {
+    {
+      std::unique_lock lock{mutex_};
+      job_cv_.wait(lock, [&] {return stop_ || job_ != last_job;});
+
+      if (stop_) {
+        return;
+      }
+
+      last_job = job_;
+    }
+
+    run_tiles();
+
+    {
+      std::lock_guard lock{mutex_};
+      pending_--;
+    }
+
+    done_cv_.notify_all();
+  }
+}
+
+void Rectifier::run_tiles()
+{
+  // The image, the rectified image and the map stay valid until all workers are done
+  for (auto tile = next_tile_++; tile < tile_count_; tile = next_tile_++) {
+    auto const x = (tile % tile_columns_) * tile_width;
+    auto const y = (tile / tile_columns_) * tile_height;
+
+    map_->remap(
+      *image_, *rectified_, x, y, std::min(tile_width, image_->width - x),
+      std::min(tile_height, image_->height - y));
+  }
+}
+
+}  // namespace vimbax_camera
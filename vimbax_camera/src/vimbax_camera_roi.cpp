@@ -0,0 +1,225 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstring>
+#include <sstream>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_roi.hpp>
+
+namespace vimbax_camera
+{
+
+using helper::get_logger;
+
+result<Roi> Roi::parse(const std::string & definition)
+{
+  auto const separator = definition.find('=');
+
+  if (separator == std::string::npos || separator == 0) {
+    return error{VmbErrorBadParameter};
+  }
+
+  std::istringstream stream{definition.substr(separator + 1)};
+  int64_t values[4]{};
+  char comma{};
+
+  stream >> values[0];
+  for (std::size_t i = 1; i < 4; i++) {
+    stream >> comma >> values[i];
+
+    if (comma != ',') {
+      return error{VmbErrorBadParameter};
+    }
+  }
+
+  if (stream.fail() || !(stream >> std::ws).eof()) {
+    return error{VmbErrorBadParameter};
+  }
+
+  if (values[0] < 0 || values[1] < 0 || values[2] <= 0 || values[3] <= 0 ||
+    values[0] + values[2] > UINT32_MAX || values[1] + values[3] > UINT32_MAX)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  return Roi{definition.substr(0, separator), uint32_t(values[0]), uint32_t(values[1]),
+    uint32_t(values[2]), uint32_t(values[3])};
+}
+
+result<sensor_msgs::msg::RegionOfInterest> Roi::crop(
+  const sensor_msgs::msg::Image & image, sensor_msgs::msg::Image & roi_image) const
+{
+  if (image.width == 0 || image.step % image.width != 0 ||
+    x + width > image.width || y + height > image.height)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  auto const bytes_per_pixel = image.step / image.width;
+  auto const is_bayer = image.encoding.rfind("bayer", 0) == 0;
+  auto const is_yuv = image.encoding.rfind("yuv", 0) == 0;
+  auto const offset_x = (is_bayer || is_yuv) ? x & ~1u : x;
+  auto const offset_y = is_bayer ? y & ~1u : y;
+
+  roi_image.header = image.header;
+  roi_image.encoding = image.encoding;
+  roi_image.is_bigendian = image.is_bigendian;
+  roi_image.width = width;
+  roi_image.height = height;
+  roi_image.step = width * bytes_per_pixel;
+  roi_image.data.resize(std::size_t(roi_image.step) * height);
+
+  auto source = image.data.data() + std::size_t(offset_y) * image.step +
+    std::size_t(offset_x) * bytes_per_pixel;
+  auto destination = roi_image.data.data();
+
+  for (uint32_t row = 0; row < height; row++) {
+    std::memcpy(destination, source, roi_image.step);
+    source += image.step;
+    destination += roi_image.step;
+  }
+
+  return sensor_msgs::msg::RegionOfInterest{}
+         .set__x_offset(offset_x).set__y_offset(offset_y)
+         .set__width(width).set__height(height).set__do_rectify(false);
+}
+
+RoiPipeline::RoiPipeline(std::vector<Roi> rois, PublishFunction publish)
+: rois_{std::move(rois)}, publish_{std::move(publish)}, active_(rois_.size(), false)
+{
+  for (std::size_t i = 0; i < rois_.size(); i++) {
+    workers_.emplace_back([this, i] {worker_run(i);});
+  }
+}
+
+RoiPipeline::~RoiPipeline()
+{
+  {
+    std::lock_guard lock{mutex_};
+    stop_ = true;
+  }
+
+  job_cv_.notify_all();
+
+  for (auto & worker : workers_) {
+    worker.join();
+  }
+}
+
+const std::vector<Roi> & RoiPipeline::rois() const
+{
+  return rois_;
+}
+
+void RoiPipeline::process(
+  const sensor_msgs::msg::Image & image, const sensor_msgs::msg::CameraInfo & camera_info,
+  const std::vector<bool> & active)
+{
+  {
+    std::lock_guard lock{mutex_};
+    image_ = &image;
+    camera_info_ = &camera_info;
+    pending_ = 0;
+
+    for (std::size_t i = 0; i < rois_.size(); i++) {
+      active_[i] = i < active.size() && active[i];
+      pending_ += active_[i] ? 1 : 0;
+    }
+
+    if (pending_ == 0) {
+      return;
+    }
+
+    job_++;
+  }
+
+  job_cv_.notify_all();
+}
+
+void RoiPipeline::wait()
+{
+  std::unique_lock lock{mutex_};
+  done_cv_.wait(lock, [this] {return pending_ == 0;});
+  image_ = nullptr;
+  camera_info_ = nullptr;
+}
+
+void RoiPipeline::worker_run(std::size_t index)
+{
+  auto const & roi = rois_[index];
+  uint64_t last_job{0};
+  bool outside_reported{false};
+  // Reused for every frame, so the buffer is only allocated once
+  sensor_msgs::msg::Image roi_image{};
+  sensor_msgs::msg::CameraInfo roi_camera_info{};
+
+  while (true) {
+    {
+      std::unique_lock lock{mutex_};
+      job_cv_.wait(lock, [&] {return stop_ || job_ != last_job;});
+
+      if (stop_) {
+        return;
+      }
+
+      last_job = job_;
+
+      if (!active_[index]) {
+        continue;
+      }
+    }
+
+    // The image and camera info stay valid until this region is marked as done
+    auto const crop_result = roi.crop(*image_, roi_image);
+
+    if (crop_result) {
+      roi_camera_info = *camera_info_;
+      roi_camera_info.roi = *crop_result;
+
+      publish_(index, roi_image, roi_camera_info);
+    } else if (!outside_reported) {
+      RCLCPP_WARN(
+        get_logger(), "Region %s is outside of the %ux%u image", roi.name.c_str(),
+        image_->width, image_->height);
+      outside_reported = true;
+    }
+
+    {
+      std::lock_guard lock{mutex_};
+      pending_--;
+    }
+
+    done_cv_.notify_all();
+  }
+}
+
+}  // namespace vimbax_camera
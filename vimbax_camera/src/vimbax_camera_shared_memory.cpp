@@ -0,0 +1,424 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_shared_memory.hpp>
+
+namespace vimbax_camera
+{
+
+using helper::get_logger;
+
+namespace shared_memory
+{
+constexpr uint32_t segment_magic = 0x4d535856;  // "VXSM"
+constexpr std::size_t encoding_size = 32;
+
+struct alignas(alignment) SegmentHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t reserved;
+  uint64_t slot_size;
+  uint64_t slot_stride;
+};
+
+struct alignas(alignment) SlotHeader
+{
+  std::atomic_uint64_t generation;
+  // PIDs of the clients holding a frame of the slot, 0 for free entries
+  std::atomic_int32_t reader_pids[max_slot_readers];
+  uint32_t width;
+  uint32_t height;
+  uint32_t step;
+  uint64_t size;
+  uint8_t is_bigendian;
+  char encoding[encoding_size];
+};
+
+static_assert(std::atomic_uint64_t::is_always_lock_free);
+static_assert(std::atomic_int32_t::is_always_lock_free);
+static_assert(sizeof(pid_t) == sizeof(int32_t));
+}  // namespace shared_memory
+
+namespace
+{
+using shared_memory::SegmentHeader;
+using shared_memory::SlotHeader;
+
+constexpr std::size_t align_up(std::size_t value, std::size_t alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+constexpr std::size_t slot_stride(std::size_t slot_size)
+{
+  return sizeof(SlotHeader) + align_up(slot_size, shared_memory::alignment);
+}
+
+// Releases the leases of processes that don't exist anymore, returns true if none is left
+bool reclaim_leases(SlotHeader & slot)
+{
+  auto held = false;
+
+  for (auto & reader_pid : slot.reader_pids) {
+    auto pid = reader_pid.load();
+
+    if (pid == 0) {
+      continue;
+    }
+
+    // EPERM means the process exists, but belongs to another user
+    if (::kill(pid, 0) != 0 && errno == ESRCH) {
+      if (reader_pid.compare_exchange_strong(pid, 0)) {
+        RCLCPP_WARN(
+          get_logger(), "Released shared memory slot held by exited process %d", int(pid));
+      }
+      continue;
+    }
+
+    held = true;
+  }
+
+  return !held;
+}
+}  // namespace
+
+struct SharedFrameClient::Mapping
+{
+  std::string name;
+  uint8_t * data;
+  std::size_t size;
+
+  ~Mapping()
+  {
+    ::munmap(data, size);
+  }
+
+  const SegmentHeader & header() const
+  {
+    return *reinterpret_cast<const SegmentHeader *>(data);
+  }
+
+  SlotHeader * slot(uint32_t index) const
+  {
+    return reinterpret_cast<SlotHeader *>(
+      data + sizeof(SegmentHeader) + index * header().slot_stride);
+  }
+};
+
+result<std::shared_ptr<SharedFrameRing>> SharedFrameRing::create(
+  const std::string & name, std::size_t slot_size, uint32_t slot_count)
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, name.c_str());
+
+  if (slot_count == 0 || slot_size == 0) {
+    return error{VmbErrorBadParameter};
+  }
+
+  auto const size = sizeof(SegmentHeader) + slot_count * slot_stride(slot_size);
+
+  // A segment left behind by a crashed node with the same name is replaced
+  ::shm_unlink(name.c_str());
+
+  auto const fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+
+  if (fd < 0) {
+    RCLCPP_ERROR(
+      get_logger(), "Failed to create shared memory %s: %s", name.c_str(), std::strerror(errno));
+    return error{VmbErrorResources};
+  }
+
+  if (::ftruncate(fd, off_t(size)) != 0) {
+    RCLCPP_ERROR(
+      get_logger(), "Failed to resize shared memory %s: %s", name.c_str(), std::strerror(errno));
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    return error{VmbErrorResources};
+  }
+
+  auto const data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (data == MAP_FAILED) {
+    RCLCPP_ERROR(
+      get_logger(), "Failed to map shared memory %s: %s", name.c_str(), std::strerror(errno));
+    ::shm_unlink(name.c_str());
+    return error{VmbErrorResources};
+  }
+
+  std::shared_ptr<SharedFrameRing> ring{
+    new SharedFrameRing(name, static_cast<uint8_t *>(data), size, slot_size, slot_count)};
+
+  // The new segment is zero filled, so every slot starts with generation 0 and no readers
+  auto const header = new(ring->data_) SegmentHeader{};
+  header->version = shared_memory::version;
+  header->slot_count = slot_count;
+  header->slot_size = slot_size;
+  header->slot_stride = slot_stride(slot_size);
+
+  for (uint32_t i = 0; i < slot_count; i++) {
+    new(ring->slot_header(i)) SlotHeader{};
+  }
+
+  // Clients check the magic last, so they never see a partially initialized segment
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = shared_memory::segment_magic;
+
+  return ring;
+}
+
+SharedFrameRing::SharedFrameRing(
+  std::string name, uint8_t * data, std::size_t size, std::size_t slot_size, uint32_t slot_count)
+: name_{std::move(name)}, data_{data}, size_{size}, slot_size_{slot_size},
+  slot_count_{slot_count}
+{
+}
+
+SharedFrameRing::~SharedFrameRing()
+{
+  // Clients keep their mapping of the unlinked segment until they release it
+  ::munmap(data_, size_);
+  ::shm_unlink(name_.c_str());
+}
+
+shared_memory::SlotHeader * SharedFrameRing::slot_header(uint32_t index) const
+{
+  return reinterpret_cast<SlotHeader *>(
+    data_ + sizeof(SegmentHeader) + index * slot_stride(slot_size_));
+}
+
+std::optional<SharedFrameRing::Slot> SharedFrameRing::write(const sensor_msgs::msg::Image & image)
+{
+  if (image.data.size() > slot_size_) {
+    return std::nullopt;
+  }
+
+  for (uint32_t i = 0; i < slot_count_; i++) {
+    auto const index = (next_slot_ + i) % slot_count_;
+    auto const slot = slot_header(index);
+    auto const generation = slot->generation.load();
+
+    // Marking the slot as written before checking the readers pairs with the client
+    // registering as reader before checking the generation, so one of both backs off
+    slot->generation.store(generation + 1);
+
+    if (!reclaim_leases(*slot)) {
+      slot->generation.store(generation);
+      continue;
+    }
+
+    slot->width = image.width;
+    slot->height = image.height;
+    slot->step = image.step;
+    slot->size = image.data.size();
+    slot->is_bigendian = image.is_bigendian;
+    std::memset(slot->encoding, 0, sizeof(slot->encoding));
+    std::memcpy(
+      slot->encoding, image.encoding.data(),
+      std::min(image.encoding.size(), sizeof(slot->encoding) - 1));
+    std::memcpy(
+      reinterpret_cast<uint8_t *>(slot) + sizeof(SlotHeader), image.data.data(),
+      image.data.size());
+
+    slot->generation.store(generation + 2);
+    next_slot_ = (index + 1) % slot_count_;
+
+    return Slot{index, generation + 2};
+  }
+
+  return std::nullopt;
+}
+
+const std::string & SharedFrameRing::name() const
+{
+  return name_;
+}
+
+std::size_t SharedFrameRing::slot_size() const
+{
+  return slot_size_;
+}
+
+uint32_t SharedFrameRing::slot_count() const
+{
+  return slot_count_;
+}
+
+result<void> SharedFrameClient::map(const std::string & name)
+{
+  auto const fd = ::shm_open(name.c_str(), O_RDWR, 0);
+
+  if (fd < 0) {
+    return error{VmbErrorNotFound};
+  }
+
+  struct stat file_stat{};
+
+  if (::fstat(fd, &file_stat) != 0 || std::size_t(file_stat.st_size) < sizeof(SegmentHeader)) {
+    ::close(fd);
+    return error{VmbErrorInvalidValue};
+  }
+
+  auto const size = std::size_t(file_stat.st_size);
+  auto const data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (data == MAP_FAILED) {
+    return error{VmbErrorResources};
+  }
+
+  std::shared_ptr<Mapping> mapping{new Mapping{name, static_cast<uint8_t *>(data), size}};
+  auto const & header = mapping->header();
+
+  if (header.magic != shared_memory::segment_magic) {
+    return error{VmbErrorInvalidValue};
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  if (header.version != shared_memory::version ||
+    header.slot_stride != slot_stride(header.slot_size) ||
+    sizeof(SegmentHeader) + header.slot_count * header.slot_stride > size)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  mapping_ = std::move(mapping);
+
+  return {};
+}
+
+result<std::shared_ptr<const SharedFrameClient::Frame>> SharedFrameClient::acquire(
+  const vimbax_camera_msgs::msg::SharedFrame & descriptor)
+{
+  if (!mapping_ || mapping_->name != descriptor.segment) {
+    auto const map_result = map(descriptor.segment);
+
+    if (!map_result) {
+      return map_result.error();
+    }
+  }
+
+  // Generation 0 is never written and odd generations are incomplete
+  if (descriptor.slot >= mapping_->header().slot_count ||
+    descriptor.generation == 0 || descriptor.generation % 2 != 0)
+  {
+    return error{VmbErrorBadParameter};
+  }
+
+  auto const slot = mapping_->slot(descriptor.slot);
+  auto const pid = int32_t(::getpid());
+
+  auto lease = std::size_t{0};
+  for (; lease < shared_memory::max_slot_readers; lease++) {
+    auto expected = int32_t{0};
+    if (slot->reader_pids[lease].compare_exchange_strong(expected, pid)) {
+      break;
+    }
+  }
+
+  if (lease == shared_memory::max_slot_readers) {
+    return error{VmbErrorBusy};
+  }
+
+  if (slot->generation.load() != descriptor.generation) {
+    slot->reader_pids[lease].store(0);
+    return error{VmbErrorNotAvailable};
+  }
+
+  if (slot->size > mapping_->header().slot_size) {
+    slot->reader_pids[lease].store(0);
+    return error{VmbErrorInvalidValue};
+  }
+
+  return std::shared_ptr<const Frame>{new Frame(mapping_, slot, lease)};
+}
+
+SharedFrameClient::Frame::Frame(
+  std::shared_ptr<Mapping> mapping, shared_memory::SlotHeader * slot, std::size_t lease)
+: mapping_{std::move(mapping)}, slot_{slot}, lease_{lease}
+{
+}
+
+SharedFrameClient::Frame::~Frame()
+{
+  slot_->reader_pids[lease_].store(0);
+}
+
+uint32_t SharedFrameClient::Frame::width() const
+{
+  return slot_->width;
+}
+
+uint32_t SharedFrameClient::Frame::height() const
+{
+  return slot_->height;
+}
+
+uint32_t SharedFrameClient::Frame::step() const
+{
+  return slot_->step;
+}
+
+bool SharedFrameClient::Frame::is_bigendian() const
+{
+  return slot_->is_bigendian != 0;
+}
+
+std::string_view SharedFrameClient::Frame::encoding() const
+{
+  return std::string_view{slot_->encoding, strnlen(slot_->encoding, sizeof(slot_->encoding))};
+}
+
+const uint8_t * SharedFrameClient::Frame::data() const
+{
+  return reinterpret_cast<const uint8_t *>(slot_) + sizeof(SlotHeader);
+}
+
+std::size_t SharedFrameClient::Frame::size() const
+{
+  return slot_->size;
+}
+
+}  // namespace vimbax_camera
@@ -0,0 +1,756 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <unordered_set>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <vimbax_camera/vimbax_camera.hpp>
+
+namespace fs = std::filesystem;
+
+namespace vimbax_camera
+{
+using helper::get_logger;
+using helper::vmb_error_to_string;
+
+namespace
+{
+// Layout (all values little endian):
+//   magic "VXFS", u16 version, string model name, u32 entry count, entries
+// Entry:
+//   u8 module, u8 feature data type, u32 selector index (0xFFFFFFFF for none), string name,
+//   value (i64, f64 bits as u64, u8 bool or string for enum and string features)
+// Strings are stored as u32 length followed by the characters without terminator.
+constexpr std::array<uint8_t, 4> snapshot_magic{'V', 'X', 'F', 'S'};
+constexpr uint16_t snapshot_version = 1;
+constexpr uint32_t snapshot_no_selector = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t snapshot_apply_max_iterations = 10;
+// Relative difference up to which float values without increment are considered equal
+constexpr double snapshot_float_tolerance = 1e-4;
+
+class SnapshotWriter
+{
+public:
+  template<typename T>
+  void put(T value)
+  {
+    for (size_t i = 0; i < sizeof(T); i++) {
+      data_.push_back(uint8_t(uint64_t(value) >> (8 * i)));
+    }
+  }
+
+  void put_string(const std::string_view & str)
+  {
+    put(uint32_t(str.size()));
+    data_.insert(data_.end(), str.begin(), str.end());
+  }
+
+  std::vector<uint8_t> take()
+  {
+    return std::move(data_);
+  }
+
+private:
+  std::vector<uint8_t> data_{};
+};
+
+class SnapshotReader
+{
+public:
+  explicit SnapshotReader(const std::vector<uint8_t> & data)
+  : data_{data}
+  {
+  }
+
+  template<typename T>
+  std::optional<T> get()
+  {
+    if (data_.size() - pos_ < sizeof(T)) {
+      return std::nullopt;
+    }
+
+    uint64_t value{0};
+    for (size_t i = 0; i < sizeof(T); i++) {
+      value |= uint64_t(data_[pos_++]) << (8 * i);
+    }
+
+    return T(value);
+  }
+
+  std::optional<std::string> get_string()
+  {
+    auto const size = get<uint32_t>();
+
+    if (!size || data_.size() - pos_ < *size) {
+      return std::nullopt;
+    }
+
+    std::string str(data_.begin() + pos_, data_.begin() + pos_ + *size);
+    pos_ += *size;
+
+    return str;
+  }
+
+  bool at_end() const
+  {
+    return pos_ == data_.size();
+  }
+
+private:
+  const std::vector<uint8_t> & data_;
+  size_t pos_{0};
+};
+
+bool is_snapshot_data_type(VmbFeatureData_t type)
+{
+  switch (type) {
+    case VmbFeatureDataInt:
+    case VmbFeatureDataFloat:
+    case VmbFeatureDataEnum:
+    case VmbFeatureDataString:
+    case VmbFeatureDataBool:
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::vector<std::string> selected_features_get(
+  const VmbCAPI & api, VmbHandle_t handle, const char * name)
+{
+  VmbUint32_t selected_count{};
+
+  auto const err =
+    api.FeatureListSelected(handle, name, nullptr, 0, &selected_count, sizeof(VmbFeatureInfo_t));
+
+  if (err != VmbErrorSuccess || selected_count == 0) {
+    return {};
+  }
+
+  std::vector<VmbFeatureInfo_t> selected_infos(selected_count);
+
+  api.FeatureListSelected(
+    handle, name, selected_infos.data(), selected_infos.size(), &selected_count,
+    sizeof(VmbFeatureInfo_t));
+
+  selected_infos.resize(std::min<size_t>(selected_count, selected_infos.size()));
+
+  std::vector<std::string> selected_names{};
+
+  for (auto const & info : selected_infos) {
+    if (info.name != nullptr) {
+      selected_names.emplace_back(info.name);
+    }
+  }
+
+  return selected_names;
+}
+}  // namespace
+
+std::vector<uint8_t> VimbaXCamera::FeatureSnapshot::serialize() const
+{
+  SnapshotWriter writer{};
+
+  for (auto const byte : snapshot_magic) {
+    writer.put(byte);
+  }
+
+  writer.put(snapshot_version);
+  writer.put_string(model_name);
+  writer.put(uint32_t(entries.size()));
+
+  for (auto const & entry : entries) {
+    writer.put(uint8_t(entry.module));
+    writer.put(uint8_t(entry.type));
+    writer.put(entry.selector_index.value_or(snapshot_no_selector));
+    writer.put_string(entry.name);
+
+    switch (entry.type) {
+      case VmbFeatureDataInt:
+        writer.put(std::get<int64_t>(entry.value));
+        break;
+      case VmbFeatureDataFloat: {
+          uint64_t bits{};
+          auto const value = std::get<_Float64>(entry.value);
+          std::memcpy(&bits, &value, sizeof(bits));
+          writer.put(bits);
+          break;
+        }
+      case VmbFeatureDataBool:
+        writer.put(uint8_t(std::get<bool>(entry.value)));
+        break;
+      default:
+        writer.put_string(std::get<std::string>(entry.value));
+        break;
+    }
+  }
+
+  return writer.take();
+}
+
+result<VimbaXCamera::FeatureSnapshot> VimbaXCamera::FeatureSnapshot::deserialize(
+  const std::vector<uint8_t> & data)
+{
+  SnapshotReader reader{data};
+
+  for (auto const byte : snapshot_magic) {
+    if (reader.get<uint8_t>() != byte) {
+      return error{VmbErrorInvalidValue};
+    }
+  }
+
+  if (reader.get<uint16_t>() != snapshot_version) {
+    RCLCPP_ERROR(get_logger(), "Unsupported feature snapshot version");
+    return error{VmbErrorNotSupported};
+  }
+
+  FeatureSnapshot snapshot{};
+
+  auto model_name = reader.get_string();
+  auto const entry_count = reader.get<uint32_t>();
+
+  if (!model_name || !entry_count) {
+    return error{VmbErrorInvalidValue};
+  }
+
+  snapshot.model_name = std::move(*model_name);
+
+  for (uint32_t i = 0; i < *entry_count; i++) {
+    auto const module = reader.get<uint8_t>();
+    auto const type = reader.get<uint8_t>();
+    auto const selector_index = reader.get<uint32_t>();
+    auto name = reader.get_string();
+
+    if (!module || !type || !selector_index || !name ||
+      *module >= uint8_t(Module::ModuleMax) || !is_snapshot_data_type(*type) ||
+      (*selector_index != snapshot_no_selector && *selector_index >= i))
+    {
+      return error{VmbErrorInvalidValue};
+    }
+
+    auto & entry = snapshot.entries.emplace_back();
+    entry.module = Module(*module);
+    entry.type = *type;
+    entry.name = std::move(*name);
+
+    if (*selector_index != snapshot_no_selector) {
+      entry.selector_index = *selector_index;
+    }
+
+    switch (entry.type) {
+      case VmbFeatureDataInt: {
+          auto const value = reader.get<int64_t>();
+          if (!value) {
+            return error{VmbErrorInvalidValue};
+          }
+          entry.value = *value;
+          break;
+        }
+      case VmbFeatureDataFloat: {
+          auto const bits = reader.get<uint64_t>();
+          if (!bits) {
+            return error{VmbErrorInvalidValue};
+          }
+          _Float64 value{};
+          std::memcpy(&value, &*bits, sizeof(value));
+          entry.value = value;
+          break;
+        }
+      case VmbFeatureDataBool: {
+          auto const value = reader.get<uint8_t>();
+          if (!value) {
+            return error{VmbErrorInvalidValue};
+          }
+          entry.value = *value != 0;
+          break;
+        }
+      default: {
+          auto value = reader.get_string();
+          if (!value) {
+            return error{VmbErrorInvalidValue};
+          }
+          entry.value = std::move(*value);
+          break;
+        }
+    }
+  }
+
+  if (!reader.at_end()) {
+    return error{VmbErrorInvalidValue};
+  }
+
+  return snapshot;
+}
+
+result<void> VimbaXCamera::FeatureSnapshot::save(const std::string_view & file_name) const
+{
+  fs::path snapshot_file_path{file_name};
+
+  if (!fs::exists(fs::absolute(snapshot_file_path).parent_path())) {
+    return error{VmbErrorNotFound};
+  }
+
+  auto const data = serialize();
+
+  std::ofstream file{snapshot_file_path, std::ios::binary | std::ios::trunc};
+  file.write(reinterpret_cast<const char *>(data.data()), std::streamsize(data.size()));
+
+  if (!file) {
+    return error{VmbErrorIO};
+  }
+
+  return {};
+}
+
+result<VimbaXCamera::FeatureSnapshot> VimbaXCamera::FeatureSnapshot::load(
+  const std::string_view & file_name)
+{
+  fs::path snapshot_file_path{file_name};
+
+  if (!fs::exists(snapshot_file_path)) {
+    return error{VmbErrorNotFound};
+  }
+
+  std::ifstream file{snapshot_file_path, std::ios::binary};
+  std::vector<uint8_t> const data{
+    std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+  if (file.bad()) {
+    return error{VmbErrorIO};
+  }
+
+  return deserialize(data);
+}
+
+result<VimbaXCamera::FeatureSnapshot> VimbaXCamera::feature_snapshot_create() const
+{
+  RCLCPP_DEBUG(get_logger(), "%s", __FUNCTION__);
+
+  FeatureSnapshot snapshot{};
+  snapshot.model_name = camera_info_.modelName ? camera_info_.modelName : "";
+
+  for (auto const module : {Module::LocalDevice, Module::RemoteDevice, Module::Stream}) {
+    auto const & info_map = feature_info_map(module);
+    auto const & order = feature_metadata_->feature_order[std::size_t(module)];
+
+    // Selected features are only valid for the current selector value, so they are stored
+    // right after their selector instead of their own position
+    std::unordered_map<std::string_view, std::vector<std::string_view>> selected_by_selector{};
+    std::unordered_set<std::string_view> selected{};
+
+    for (auto const & name : order) {
+      auto const selector = feature_handle_get(name, module);
+
+      if (!selector || !selector->info->hasSelectedFeatures) {
+        continue;
+      }
+
+      for (auto const & selected_name :
+        selected_features_get(*api_, selector->module_handle, selector->name))
+      {
+        auto const it = info_map.find(selected_name);
+
+        if (it != info_map.end() && selected.insert(it->first).second) {
+          selected_by_selector[name].push_back(it->first);
+        }
+      }
+    }
+
+    std::function<void(std::string_view, std::optional<uint32_t>)> add_entry =
+      [&](std::string_view name, std::optional<uint32_t> selector_index) {
+        auto const entry = feature_snapshot_entry_read(module, info_map.at(name));
+        std::optional<uint32_t> entry_index{};
+
+        if (entry) {
+          snapshot.entries.push_back(*entry);
+          snapshot.entries.back().selector_index = selector_index;
+          entry_index = uint32_t(snapshot.entries.size() - 1);
+        }
+
+        auto const selected_it = selected_by_selector.find(name);
+
+        if (selected_it != selected_by_selector.end()) {
+          for (auto const & selected_name : selected_it->second) {
+            add_entry(selected_name, entry_index);
+          }
+        }
+      };
+
+    for (auto const & name : order) {
+      if (!selected.count(name)) {
+        add_entry(name, std::nullopt);
+      }
+    }
+  }
+
+  RCLCPP_INFO(
+    get_logger(), "Created feature snapshot with %zu features", snapshot.entries.size());
+
+  return snapshot;
+}
+
+result<VimbaXCamera::FeatureSnapshotApplyResult> VimbaXCamera::feature_snapshot_apply(
+  const FeatureSnapshot & snapshot) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s", __FUNCTION__);
+
+  if (snapshot.model_name != (camera_info_.modelName ? camera_info_.modelName : "")) {
+    RCLCPP_ERROR(
+      get_logger(), "Feature snapshot of model %s doesn't match the camera",
+      snapshot.model_name.c_str());
+    return error{VmbErrorInvalidValue};
+  }
+
+  std::vector<FeatureHandle> features{};
+  features.reserve(snapshot.entries.size());
+
+  // Features unknown to this camera are reported as failed instead of failing the snapshot
+  for (auto const & entry : snapshot.entries) {
+    auto const feature = feature_handle_get(entry.name, entry.module);
+    features.push_back(
+      feature ? *feature :
+      FeatureHandle{entry.module, nullptr, entry.name.c_str(), nullptr, nullptr});
+  }
+
+  return feature_snapshot_entries_apply(snapshot, features, false);
+}
+
+result<VimbaXCamera::FeatureProfile> VimbaXCamera::feature_profile_compile(
+  const std::string & name, FeatureSnapshot snapshot) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, name.c_str());
+
+  if (snapshot.model_name != (camera_info_.modelName ? camera_info_.modelName : "")) {
+    RCLCPP_ERROR(
+      get_logger(), "Profile %s was created for model %s", name.c_str(),
+      snapshot.model_name.c_str());
+    return error{VmbErrorInvalidValue};
+  }
+
+  FeatureProfile profile{name, std::move(snapshot), {}};
+  profile.features.reserve(profile.snapshot.entries.size());
+
+  for (auto const & entry : profile.snapshot.entries) {
+    auto const feature = feature_handle_get(entry.name, entry.module);
+
+    if (!feature) {
+      RCLCPP_ERROR(
+        get_logger(), "Feature %s of profile %s not found", entry.name.c_str(), name.c_str());
+      return feature.error();
+    }
+
+    if ((feature->info->featureFlags & VmbFeatureFlagsWrite) == 0 ||
+      feature->info->featureDataType != entry.type)
+    {
+      RCLCPP_ERROR(
+        get_logger(), "Feature %s of profile %s can't be written", entry.name.c_str(),
+        name.c_str());
+      return error{VmbErrorInvalidAccess};
+    }
+
+    profile.features.push_back(*feature);
+  }
+
+  return profile;
+}
+
+result<std::vector<uint32_t>> VimbaXCamera::feature_profile_changes_get(
+  const FeatureProfile & profile) const
+{
+  std::vector<uint32_t> changes{};
+
+  for (uint32_t i = 0; i < profile.snapshot.entries.size(); i++) {
+    auto const & entry = profile.snapshot.entries[i];
+    auto const value = feature_snapshot_value_get(profile.features[i], entry.type);
+
+    if (!value ||
+      !feature_snapshot_value_matches(profile.features[i], entry.type, *value, entry.value))
+    {
+      changes.push_back(i);
+    }
+  }
+
+  return changes;
+}
+
+result<VimbaXCamera::FeatureSnapshotApplyResult> VimbaXCamera::feature_profile_apply(
+  const FeatureProfile & profile) const
+{
+  RCLCPP_DEBUG(get_logger(), "%s('%s')", __FUNCTION__, profile.name.c_str());
+
+  return feature_snapshot_entries_apply(profile.snapshot, profile.features, true);
+}
+
+result<VimbaXCamera::FeatureSnapshotApplyResult> VimbaXCamera::feature_snapshot_entries_apply(
+  const FeatureSnapshot & snapshot, const std::vector<FeatureHandle> & features,
+  bool atomic) const
+{
+  enum class EntryState
+  {
+    kUnchanged,
+    kWritten,
+    kFailed,
+  };
+
+  std::vector<EntryState> states(snapshot.entries.size(), EntryState::kUnchanged);
+  // Values before the first write of each entry, restored in atomic mode
+  std::vector<std::pair<uint32_t, FeatureSnapshot::Value>> previous_values{};
+  std::optional<error> last_error{};
+
+  // Only features whose value differs are written, so applying a snapshot close to the current
+  // configuration costs little more than reading the (mostly cached) values
+  auto const apply_entry = [&](uint32_t index) -> bool {
+      auto const & entry = snapshot.entries[index];
+      auto const & feature = features[index];
+
+      if (feature.info == nullptr) {
+        states[index] = EntryState::kFailed;
+        last_error = error{VmbErrorNotFound};
+        return false;
+      }
+
+      auto const current_value = feature_snapshot_value_get(feature, entry.type);
+
+      if (current_value &&
+        feature_snapshot_value_matches(feature, entry.type, *current_value, entry.value))
+      {
+        if (states[index] == EntryState::kFailed) {
+          states[index] = EntryState::kUnchanged;
+        }
+        return true;
+      }
+
+      auto const write_result = feature_snapshot_value_set(feature, entry.type, entry.value);
+
+      if (!write_result) {
+        states[index] = EntryState::kFailed;
+        last_error = write_result.error();
+        return false;
+      }
+
+      if (atomic && current_value && states[index] != EntryState::kWritten) {
+        previous_values.emplace_back(index, *current_value);
+      }
+
+      states[index] = EntryState::kWritten;
+      return true;
+    };
+
+  std::vector<uint32_t> pending{};
+
+  for (uint32_t i = 0; i < snapshot.entries.size(); i++) {
+    if (!apply_entry(i)) {
+      pending.push_back(i);
+    }
+  }
+
+  // Features locked by features written later are retried, like VmbSettingsLoad does
+  for (uint32_t iteration = 1; iteration < snapshot_apply_max_iterations && !pending.empty();
+    iteration++)
+  {
+    std::vector<uint32_t> still_pending{};
+
+    for (auto const index : pending) {
+      auto const & selector_index = snapshot.entries[index].selector_index;
+
+      if (selector_index) {
+        apply_entry(*selector_index);
+      }
+
+      if (!apply_entry(index)) {
+        still_pending.push_back(index);
+      }
+    }
+
+    if (still_pending.size() == pending.size()) {
+      break;
+    }
+
+    pending = std::move(still_pending);
+  }
+
+  if (atomic && !pending.empty()) {
+    // Restore in reverse order so values behind a selector are restored while the selector
+    // still has the value they were written with
+    for (auto it = previous_values.rbegin(); it != previous_values.rend(); it++) {
+      auto const & [index, value] = *it;
+      auto const & entry = snapshot.entries[index];
+
+      if (!feature_snapshot_value_set(features[index], entry.type, value)) {
+        RCLCPP_ERROR(get_logger(), "Restoring feature %s failed", entry.name.c_str());
+      }
+    }
+
+    RCLCPP_ERROR(
+      get_logger(), "Writing feature %s failed, changes were reverted",
+      snapshot.entries[pending.front()].name.c_str());
+
+    return last_error.value_or(error{VmbErrorUnknown});
+  }
+
+  FeatureSnapshotApplyResult apply_result{};
+
+  for (uint32_t i = 0; i < snapshot.entries.size(); i++) {
+    switch (states[i]) {
+      case EntryState::kUnchanged:
+        apply_result.unchanged++;
+        break;
+      case EntryState::kWritten:
+        apply_result.written++;
+        apply_result.written_entries.push_back(i);
+        break;
+      case EntryState::kFailed:
+        apply_result.failed_entries.push_back(i);
+        break;
+    }
+  }
+
+  RCLCPP_INFO(
+    get_logger(), "Applied feature snapshot, %u written, %u unchanged, %zu failed",
+    apply_result.written, apply_result.unchanged, apply_result.failed_entries.size());
+
+  return apply_result;
+}
+
+result<VimbaXCamera::FeatureSnapshot::Entry> VimbaXCamera::feature_snapshot_entry_read(
+  Module module, const VmbFeatureInfo & info) const
+{
+  auto constexpr read_write = VmbFeatureFlagsRead | VmbFeatureFlagsWrite;
+
+  if (!info.isStreamable || (info.featureFlags & read_write) != read_write ||
+    !is_snapshot_data_type(info.featureDataType))
+  {
+    return error{VmbErrorNotSupported};
+  }
+
+  auto const feature = feature_handle_get(info.name, module);
+
+  if (!feature) {
+    return feature.error();
+  }
+
+  VmbBool_t readable{}, writeable{};
+  auto const access_error =
+    api_->FeatureAccessQuery(feature->module_handle, feature->name, &readable, &writeable);
+
+  if (access_error != VmbErrorSuccess || !readable || !writeable) {
+    return error{VmbErrorInvalidAccess};
+  }
+
+  auto const value = feature_snapshot_value_get(*feature, info.featureDataType);
+
+  if (!value) {
+    return value.error();
+  }
+
+  return FeatureSnapshot::Entry{module, info.name, info.featureDataType, *value, std::nullopt};
+}
+
+result<VimbaXCamera::FeatureSnapshot::Value> VimbaXCamera::feature_snapshot_value_get(
+  const FeatureHandle & feature, VmbFeatureData_t type) const
+{
+  auto const to_value = [](auto const & value) -> result<FeatureSnapshot::Value> {
+      if (!value) {
+        return value.error();
+      }
+
+      return FeatureSnapshot::Value{*value};
+    };
+
+  switch (type) {
+    case VmbFeatureDataInt:
+      return to_value(feature_int_get(feature));
+    case VmbFeatureDataFloat:
+      return to_value(feature_float_get(feature));
+    case VmbFeatureDataBool:
+      return to_value(feature_bool_get(feature));
+    case VmbFeatureDataEnum:
+      return to_value(feature_enum_get(feature));
+    default:
+      return to_value(feature_string_get(feature));
+  }
+}
+
+result<void> VimbaXCamera::feature_snapshot_value_set(
+  const FeatureHandle & feature, VmbFeatureData_t type,
+  const FeatureSnapshot::Value & value) const
+{
+  switch (type) {
+    case VmbFeatureDataInt:
+      return feature_int_set(feature, std::get<int64_t>(value));
+    case VmbFeatureDataFloat:
+      return feature_float_set(feature, std::get<_Float64>(value));
+    case VmbFeatureDataBool:
+      return feature_bool_set(feature, std::get<bool>(value));
+    case VmbFeatureDataEnum:
+      return feature_enum_set(feature, std::get<std::string>(value));
+    default:
+      return feature_string_set(feature, std::get<std::string>(value));
+  }
+}
+
+bool VimbaXCamera::feature_snapshot_value_matches(
+  const FeatureHandle & feature, VmbFeatureData_t type,
+  const FeatureSnapshot::Value & current_value, const FeatureSnapshot::Value & value) const
+{
+  if (current_value == value) {
+    return true;
+  }
+
+  if (type != VmbFeatureDataFloat) {
+    return false;
+  }
+
+  // Float features may quantize the written value, so the value read back differs from the
+  // snapshot by up to the increment
+  auto const current_float = std::get<_Float64>(current_value);
+  auto const float_value = std::get<_Float64>(value);
+
+  VmbBool_t has_increment{};
+  double increment{};
+  auto const err = api_->FeatureFloatIncrementQuery(
+    feature.module_handle, feature.name, &has_increment, &increment);
+
+  auto const tolerance = (err == VmbErrorSuccess && has_increment) ?
+    increment :
+    snapshot_float_tolerance * std::max(std::abs(current_float), std::abs(float_value));
+
+  return std::abs(current_float - float_value) <= tolerance;
+}
+
+}  // namespace vimbax_camera
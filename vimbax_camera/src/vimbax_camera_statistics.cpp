@@ -0,0 +1,215 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_statistics.hpp>
+
+namespace vimbax_camera
+{
+
+namespace
+{
+struct RowSamples
+{
+  helper::row_statistics statistics;
+  uint64_t count[2];
+  uint64_t gradient_count;
+};
+
+// Samples every step-th pixel pair starting at the even column, so both columns of a Bayer
+// cell are taken
+template<typename T>
+void sample_row(
+  RowSamples & samples, std::array<uint32_t, ImageStatistics::histogram_bins> & histogram,
+  const uint8_t * data, std::size_t width, std::size_t step, std::size_t cell, T saturation)
+{
+  constexpr auto histogram_shift = sizeof(T) * 8 - 8;
+
+  for (std::size_t x = 0; x + cell <= width; x += step) {
+    for (std::size_t dx = 0; dx < cell; dx++) {
+      T value;
+      std::memcpy(&value, data + (x + dx) * sizeof(T), sizeof(T));
+
+      samples.statistics.sum[dx & 1] += value;
+      samples.statistics.saturated[dx & 1] += value >= saturation ? 1 : 0;
+      samples.count[dx & 1]++;
+      histogram[value >> histogram_shift]++;
+
+      if (x + dx + 2 < width) {
+        T next;
+        std::memcpy(&next, data + (x + dx + 2) * sizeof(T), sizeof(T));
+        auto const diff = int64_t(next) - int64_t(value);
+        samples.statistics.gradient += uint64_t(diff * diff);
+        samples.gradient_count++;
+      }
+    }
+  }
+}
+
+void contiguous_row8(
+  RowSamples & samples, std::array<uint32_t, ImageStatistics::histogram_bins> & histogram,
+  const uint8_t * data, std::size_t width, uint8_t saturation)
+{
+  helper::accumulate_row8(samples.statistics, data, width, saturation);
+
+  samples.count[0] += (width + 1) / 2;
+  samples.count[1] += width / 2;
+  samples.gradient_count += width > 2 ? width - 2 : 0;
+
+  for (std::size_t x = 0; x < width; x++) {
+    histogram[data[x]]++;
+  }
+}
+}  // namespace
+
+result<ImageStatistics> ImageStatistics::compute(
+  const sensor_msgs::msg::Image & image, uint32_t bit_depth, uint32_t stride,
+  const sensor_msgs::msg::RegionOfInterest & region)
+{
+  std::string_view const encoding{image.encoding};
+  auto const is_bayer = encoding.rfind("bayer_", 0) == 0 && encoding.size() > 10;
+
+  auto const bytes_per_pixel = [&]() -> std::size_t {
+      if (encoding == "mono8" || (is_bayer && encoding.substr(10) == "8")) {
+        return 1;
+      } else if (encoding == "mono16" || (is_bayer && encoding.substr(10) == "16")) {
+        return 2;
+      }
+      return 0;
+    }();
+
+  if (bytes_per_pixel == 0) {
+    return error{VmbErrorNotSupported};
+  }
+
+  auto const container_bits = uint32_t(bytes_per_pixel * 8);
+  bit_depth = (bit_depth == 0 || bit_depth > container_bits) ? container_bits : bit_depth;
+
+  auto const full_scale = double((uint64_t(1) << container_bits) - 1);
+  auto const saturation =
+    ((uint64_t(1) << bit_depth) - 1) << (container_bits - bit_depth);
+
+  auto x_offset = std::size_t(region.x_offset);
+  auto y_offset = std::size_t(region.y_offset);
+  auto width = std::size_t(region.width != 0 ? region.width : image.width);
+  auto height = std::size_t(region.height != 0 ? region.height : image.height);
+
+  if (x_offset + width > image.width || y_offset + height > image.height ||
+    image.step < image.width * bytes_per_pixel ||
+    image.data.size() < std::size_t(image.step) * image.height)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  std::size_t const cell = is_bayer ? 2 : 1;
+
+  if (is_bayer) {
+    // Whole cells only, so the color of a sample is given by its position in the cell
+    x_offset &= ~std::size_t(1);
+    y_offset &= ~std::size_t(1);
+    width &= ~std::size_t(1);
+    height &= ~std::size_t(1);
+  }
+
+  // Color of the cell rows and columns, red 0, green 1 and blue 2
+  std::array<std::size_t, 4> channels{1, 1, 1, 1};
+  if (is_bayer) {
+    for (std::size_t i = 0; i < 4; i++) {
+      auto const color = encoding[6 + i];
+      channels[i] = color == 'r' ? 0 : (color == 'g' ? 1 : 2);
+    }
+  }
+
+  ImageStatistics statistics{};
+  std::array<uint64_t, 3> channel_sums{};
+  std::array<uint64_t, 3> channel_counts{};
+  uint64_t saturated{0};
+  uint64_t gradient{0};
+  uint64_t gradient_count{0};
+
+  auto const sample_step = cell * std::max<std::size_t>(stride, 1);
+
+  for (std::size_t y = 0; y + cell <= height; y += sample_step) {
+    for (std::size_t dy = 0; dy < cell; dy++) {
+      auto const row = image.data.data() + (y_offset + y + dy) * image.step +
+        x_offset * bytes_per_pixel;
+      RowSamples samples{};
+
+      if (bytes_per_pixel == 1 && sample_step == cell) {
+        contiguous_row8(samples, statistics.histogram, row, width, uint8_t(saturation));
+      } else if (bytes_per_pixel == 1) {
+        sample_row<uint8_t>(
+          samples, statistics.histogram, row, width, sample_step, cell, uint8_t(saturation));
+      } else {
+        sample_row<uint16_t>(
+          samples, statistics.histogram, row, width, sample_step, cell, uint16_t(saturation));
+      }
+
+      for (std::size_t parity = 0; parity < 2; parity++) {
+        auto const channel = channels[dy * 2 + parity];
+        channel_sums[channel] += samples.statistics.sum[parity];
+        channel_counts[channel] += samples.count[parity];
+        saturated += samples.statistics.saturated[parity];
+      }
+
+      gradient += samples.statistics.gradient;
+      gradient_count += samples.gradient_count;
+    }
+  }
+
+  for (std::size_t i = 0; i < 3; i++) {
+    statistics.sample_count += channel_counts[i];
+  }
+
+  if (statistics.sample_count == 0) {
+    return error{VmbErrorInvalidValue};
+  }
+
+  statistics.mean =
+    double(channel_sums[0] + channel_sums[1] + channel_sums[2]) /
+    double(statistics.sample_count) / full_scale;
+
+  for (std::size_t i = 0; i < 3; i++) {
+    statistics.channel_means[i] = is_bayer && channel_counts[i] != 0 ?
+      double(channel_sums[i]) / double(channel_counts[i]) / full_scale :
+      statistics.mean;
+  }
+
+  statistics.saturation_ratio = double(saturated) / double(statistics.sample_count);
+  statistics.sharpness = gradient_count != 0 ?
+    double(gradient) / double(gradient_count) / (full_scale * full_scale) : 0.0;
+
+  return statistics;
+}
+
+}  // namespace vimbax_camera
@@ -0,0 +1,465 @@
+// Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_sync.hpp>
+
+namespace vimbax_camera
+{
+
+using helper::get_logger;
+using helper::vmb_error_to_string;
+
+namespace
+{
+// Groups are shared by name between the nodes of one process
+std::mutex registry_mutex{};
+std::unordered_map<std::string, std::weak_ptr<PtpSyncGroup>> registry{};
+
+constexpr std::string_view trigger_selector_frame_start = "FrameStart";
+constexpr std::string_view trigger_source_action = "Action0";
+
+result<void> log_error(result<void> && write_result, const std::string_view & feature)
+{
+  if (!write_result) {
+    RCLCPP_ERROR(
+      get_logger(), "Writing %s failed with %d (%s)", feature.data(), write_result.error().code,
+      vmb_error_to_string(write_result.error().code).data());
+  }
+
+  return std::move(write_result);
+}
+}  // namespace
+
+bool PtpSyncGroup::Settings::operator==(const Settings & other) const
+{
+  return members == other.members && device_key == other.device_key &&
+         group_key == other.group_key && group_mask == other.group_mask &&
+         monitor_interval == other.monitor_interval;
+}
+
+result<std::shared_ptr<PtpSyncGroup>> PtpSyncGroup::join(
+  const std::string & name, const Settings & settings)
+{
+  std::unordered_set<std::string> const unique{settings.members.begin(), settings.members.end()};
+
+  if (name.empty() || settings.members.empty() || unique.size() != settings.members.size() ||
+    settings.group_mask == 0 || settings.monitor_interval.count() < 0)
+  {
+    return error{VmbErrorInvalidValue};
+  }
+
+  std::lock_guard lock{registry_mutex};
+
+  if (auto const existing = registry[name].lock()) {
+    if (!(existing->settings_ == settings)) {
+      RCLCPP_ERROR(get_logger(), "PTP sync group %s joined with different settings", name.c_str());
+      return error{VmbErrorInvalidValue};
+    }
+
+    return existing;
+  }
+
+  std::shared_ptr<PtpSyncGroup> group{new PtpSyncGroup(name, settings)};
+  registry[name] = group;
+
+  if (settings.monitor_interval.count() > 0) {
+    group->thread_ = std::thread{[group = group.get()] {group->run();}};
+  }
+
+  return group;
+}
+
+PtpSyncGroup::PtpSyncGroup(std::string name, Settings settings)
+: name_{std::move(name)}, settings_{std::move(settings)}
+{
+  cameras_.resize(settings_.members.size());
+}
+
+PtpSyncGroup::~PtpSyncGroup()
+{
+  {
+    std::lock_guard lock{mutex_};
+    stop_ = true;
+  }
+
+  cv_.notify_all();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  std::lock_guard lock{registry_mutex};
+
+  // A new group of the same name may already be registered
+  auto const it = registry.find(name_);
+  if (it != registry.end() && it->second.expired()) {
+    registry.erase(it);
+  }
+}
+
+std::optional<std::size_t> PtpSyncGroup::member_index(const std::string & member) const
+{
+  auto const it = std::find(settings_.members.begin(), settings_.members.end(), member);
+
+  if (it == settings_.members.end()) {
+    return std::nullopt;
+  }
+
+  return std::size_t(it - settings_.members.begin());
+}
+
+result<void> PtpSyncGroup::attach(
+  std::size_t member, const std::shared_ptr<VimbaXCamera> & camera)
+{
+  if (member >= settings_.members.size() || !camera) {
+    return error{VmbErrorBadParameter};
+  }
+
+  // Cameras implement either the current SFNC PtpEnable, the older Allied Vision PtpMode or
+  // the GigE Vision 1.2 GevIEEE1588
+  auto const enable_result = [&]() -> result<void> {
+      if (camera->has_feature(SFNCFeatures::PtpEnable)) {
+        return log_error(
+          camera->feature_bool_set(SFNCFeatures::PtpEnable, true), SFNCFeatures::PtpEnable);
+      } else if (camera->has_feature(SFNCFeatures::PtpMode)) {
+        return log_error(
+          camera->feature_enum_set(SFNCFeatures::PtpMode, "Auto"), SFNCFeatures::PtpMode);
+      } else if (camera->has_feature(SFNCFeatures::GevIEEE1588)) {
+        return log_error(
+          camera->feature_bool_set(SFNCFeatures::GevIEEE1588, true), SFNCFeatures::GevIEEE1588);
+      }
+
+      RCLCPP_ERROR(
+        get_logger(), "Camera of %s doesn't support PTP", settings_.members[member].c_str());
+      return error{VmbErrorNotSupported};
+    }();
+
+  if (!enable_result) {
+    return enable_result;
+  }
+
+  for (auto const & [feature, value] : {
+      std::pair{SFNCFeatures::TriggerSelector, trigger_selector_frame_start},
+      std::pair{SFNCFeatures::TriggerSource, trigger_source_action},
+      std::pair{SFNCFeatures::TriggerMode, std::string_view{"On"}}})
+  {
+    auto const trigger_result = log_error(camera->feature_enum_set(feature, value), feature);
+
+    if (!trigger_result) {
+      return trigger_result;
+    }
+  }
+
+  if (camera->has_feature(SFNCFeatures::ActionSelector)) {
+    auto const selector_result = log_error(
+      camera->feature_int_set(SFNCFeatures::ActionSelector, 0), SFNCFeatures::ActionSelector);
+
+    if (!selector_result) {
+      return selector_result;
+    }
+  }
+
+  for (auto const & [feature, value] : {
+      std::pair{SFNCFeatures::ActionDeviceKey, settings_.device_key},
+      std::pair{SFNCFeatures::ActionGroupKey, settings_.group_key},
+      std::pair{SFNCFeatures::ActionGroupMask, settings_.group_mask}})
+  {
+    auto const key_result = log_error(camera->feature_int_set(feature, value), feature);
+
+    if (!key_result) {
+      return key_result;
+    }
+  }
+
+  std::lock_guard lock{mutex_};
+  cameras_[member] = camera;
+
+  return {};
+}
+
+void PtpSyncGroup::detach(std::size_t member)
+{
+  std::lock_guard access_lock{access_mutex_};
+  std::lock_guard lock{mutex_};
+
+  if (member < cameras_.size()) {
+    cameras_[member].reset();
+  }
+}
+
+void PtpSyncGroup::set_status_callback(StatusFunction callback)
+{
+  std::lock_guard lock{callback_mutex_};
+  status_callback_ = std::move(callback);
+}
+
+void PtpSyncGroup::set_skew_callback(SkewFunction callback)
+{
+  std::lock_guard lock{callback_mutex_};
+  skew_callback_ = std::move(callback);
+}
+
+std::vector<std::shared_ptr<VimbaXCamera>> PtpSyncGroup::cameras() const
+{
+  std::lock_guard lock{mutex_};
+  std::vector<std::shared_ptr<VimbaXCamera>> cameras{};
+
+  for (auto const & camera : cameras_) {
+    cameras.push_back(camera.lock());
+  }
+
+  return cameras;
+}
+
+PtpSyncGroup::CameraStatus PtpSyncGroup::camera_status(const VimbaXCamera & camera)
+{
+  CameraStatus status{true, {}, std::nullopt, false};
+
+  // The data set latch copies the PTP state of the camera into the readable features
+  if (camera.has_feature(SFNCFeatures::PtpDataSetLatch)) {
+    if (!camera.feature_command_run(SFNCFeatures::PtpDataSetLatch)) {
+      return status;
+    }
+  }
+
+  auto const ptp_status = camera.feature_enum_get(SFNCFeatures::PtpStatus);
+
+  if (ptp_status) {
+    status.status = *ptp_status;
+    // Slaves report Uncalibrated until their clock follows the master
+    status.locked = status.status == "Slave" || status.status == "Master";
+  }
+
+  if (camera.has_feature(SFNCFeatures::PtpOffsetFromMaster)) {
+    auto const offset = camera.feature_int_get(SFNCFeatures::PtpOffsetFromMaster);
+
+    if (offset) {
+      status.offset_from_master_ns = *offset;
+    }
+  }
+
+  return status;
+}
+
+PtpSyncGroup::Status PtpSyncGroup::status() const
+{
+  Status status{{}, true};
+  std::lock_guard access_lock{access_mutex_};
+
+  for (auto const & camera : cameras()) {
+    auto camera_status = camera ?
+      PtpSyncGroup::camera_status(*camera) : CameraStatus{false, {}, std::nullopt, false};
+    status.locked = status.locked && camera_status.locked;
+    status.cameras.push_back(std::move(camera_status));
+  }
+
+  return status;
+}
+
+result<uint64_t> PtpSyncGroup::schedule(std::chrono::nanoseconds delay)
+{
+  if (delay.count() < 0) {
+    return error{VmbErrorBadParameter};
+  }
+
+  // Declared before the cameras, so the references are dropped before it is released
+  std::lock_guard access_lock{access_mutex_};
+  auto const cameras = this->cameras();
+  auto const reference = std::find_if(
+    cameras.begin(), cameras.end(), [](auto const & camera) {return bool(camera);});
+
+  if (reference == cameras.end()) {
+    return error{VmbErrorNotFound};
+  }
+
+  auto & camera = **reference;
+
+  // The timestamps of PTP enabled cameras are the PTP time in ns
+  auto const now = camera.device_timestamp_latch();
+
+  if (!now) {
+    RCLCPP_ERROR(
+      get_logger(), "Reading the PTP time failed with %d (%s)", now.error().code,
+      vmb_error_to_string(now.error().code).data());
+    return now.error();
+  }
+
+  auto const action_time = *now + uint64_t(delay.count());
+
+  // The action command is sent by the transport layer to all cameras on its interfaces
+  auto const enable_result = log_error(
+    camera.feature_bool_set(
+      SFNCFeatures::ActionScheduledTimeEnable, true, VimbaXCamera::Module::System),
+    SFNCFeatures::ActionScheduledTimeEnable);
+
+  if (!enable_result) {
+    return enable_result.error();
+  }
+
+  for (auto const & [feature, value] : {
+      std::pair{SFNCFeatures::ActionDeviceKey, int64_t(settings_.device_key)},
+      std::pair{SFNCFeatures::ActionGroupKey, int64_t(settings_.group_key)},
+      std::pair{SFNCFeatures::ActionGroupMask, int64_t(settings_.group_mask)},
+      std::pair{SFNCFeatures::ActionScheduledTime, int64_t(action_time)}})
+  {
+    auto const set_result = log_error(
+      camera.feature_int_set(feature, value, VimbaXCamera::Module::System), feature);
+
+    if (!set_result) {
+      return set_result.error();
+    }
+  }
+
+  std::optional<PendingAction> previous{};
+
+  {
+    std::lock_guard lock{mutex_};
+    PendingAction pending{action_time, {}, {}};
+
+    for (auto const & member : cameras_) {
+      pending.expected.push_back(!member.expired());
+    }
+
+    pending.timestamps.resize(cameras_.size());
+    previous = std::exchange(pending_, std::move(pending));
+  }
+
+  if (previous) {
+    std::lock_guard lock{callback_mutex_};
+
+    if (skew_callback_) {
+      skew_callback_(release(std::move(*previous)));
+    }
+  }
+
+  auto const run_result = camera.feature_command_run(
+    SFNCFeatures::ActionCommand, std::nullopt, VimbaXCamera::Module::System);
+
+  if (!run_result) {
+    RCLCPP_ERROR(
+      get_logger(), "Sending the action command failed with %d (%s)", run_result.error().code,
+      vmb_error_to_string(run_result.error().code).data());
+
+    std::lock_guard lock{mutex_};
+
+    if (pending_ && pending_->action_time_ns == action_time) {
+      pending_.reset();
+    }
+
+    return run_result.error();
+  }
+
+  return action_time;
+}
+
+void PtpSyncGroup::add_timestamp(std::size_t member, uint64_t timestamp_ns)
+{
+  std::optional<PendingAction> completed{};
+
+  {
+    std::lock_guard lock{mutex_};
+
+    if (!pending_ || member >= pending_->timestamps.size() || pending_->timestamps[member] ||
+      timestamp_ns < pending_->action_time_ns)
+    {
+      return;
+    }
+
+    pending_->timestamps[member] = timestamp_ns;
+
+    for (std::size_t i = 0; i < pending_->expected.size(); i++) {
+      if (pending_->expected[i] && !pending_->timestamps[i]) {
+        return;
+      }
+    }
+
+    completed = std::exchange(pending_, std::nullopt);
+  }
+
+  std::lock_guard lock{callback_mutex_};
+
+  if (skew_callback_) {
+    skew_callback_(release(std::move(*completed)));
+  }
+}
+
+PtpSyncGroup::Skew PtpSyncGroup::release(PendingAction && pending)
+{
+  Skew skew{pending.action_time_ns, {}, 0, true};
+  uint64_t first{UINT64_MAX};
+  uint64_t last{0};
+
+  for (std::size_t i = 0; i < pending.timestamps.size(); i++) {
+    auto const & timestamp = pending.timestamps[i];
+
+    if (timestamp) {
+      first = std::min(first, *timestamp);
+      last = std::max(last, *timestamp);
+      skew.latency_ns.push_back(int64_t(*timestamp - pending.action_time_ns));
+    } else {
+      skew.latency_ns.push_back(std::nullopt);
+      skew.complete = skew.complete && !pending.expected[i];
+    }
+  }
+
+  skew.skew_ns = last > first ? last - first : 0;
+
+  return skew;
+}
+
+void PtpSyncGroup::run()
+{
+  while (true) {
+    {
+      std::unique_lock lock{mutex_};
+
+      if (cv_.wait_for(lock, settings_.monitor_interval, [this] {return stop_;})) {
+        return;
+      }
+    }
+
+    // Holds no camera references anymore, so the cameras are never destroyed by this thread
+    auto const status = this->status();
+
+    std::lock_guard lock{callback_mutex_};
+
+    if (status_callback_) {
+      status_callback_(status);
+    }
+  }
+}
+
+}  // namespace vimbax_camera
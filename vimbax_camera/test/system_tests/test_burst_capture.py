@@ -0,0 +1,93 @@
+# Copyright (c) 2024 Allied Vision Technologies GmbH. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+#    * Redistributions of source code must retain the above copyright
+#      notice, this list of conditions and the following disclaimer.
+#
+#    * Redistributions in binary form must reproduce the above copyright
+#      notice, this list of conditions and the following disclaimer in the
+#      documentation and/or other materials provided with the distribution.
+#
+#    * Neither the name of the Allied Vision Technologies GmbH nor the names of its
+#      contributors may be used to endorse or promote products derived from
+#      this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+
+import pytest
+
+import threading
+
+from rclpy.action import ActionClient
+
+from vimbax_camera_msgs.action import BurstCapture
+
+from conftest import vimbax_camera_node, TestNode
+
+from test_helper import check_error
+
+
+def run_burst_capture(test_node: TestNode, goal: BurstCapture.Goal, feedback_callback=None):
+    client = ActionClient(
+        test_node, BurstCapture, f"/{test_node.camera_node_name()}/burst_capture"
+    )
+    assert client.wait_for_server(10)
+
+    event = threading.Event()
+
+    def unblock(future):
+        nonlocal event
+        event.set()
+
+    goal_future = client.send_goal_async(goal, feedback_callback=feedback_callback)
+    goal_future.add_done_callback(unblock)
+    event.wait(10)
+    assert goal_future.done()
+
+    goal_handle = goal_future.result()
+    assert goal_handle.accepted
+
+    event.clear()
+    result_future = goal_handle.get_result_async()
+    result_future.add_done_callback(unblock)
+    event.wait(30)
+    assert result_future.done()
+
+    return result_future.result().result
+
+
+@pytest.mark.launch(fixture=vimbax_camera_node)
+def test_burst_capture(test_node: TestNode, launch_context):
+    result = run_burst_capture(test_node, BurstCapture.Goal(frame_count=10, timeout=10000))
+
+    check_error(result.error)
+    assert len(result.images) == 10
+
+
+@pytest.mark.launch(fixture=vimbax_camera_node)
+def test_burst_capture_chunked(test_node: TestNode, launch_context):
+    feedback_images = []
+
+    def on_feedback(feedback):
+        feedback_images.extend(feedback.feedback.images)
+
+    result = run_burst_capture(
+        test_node, BurstCapture.Goal(frame_count=10, chunk_size=4, timeout=10000), on_feedback
+    )
+
+    check_error(result.error)
+    assert len(feedback_images) == 8
+    assert len(result.images) == 2
@@ -35,14 +35,18 @@ from vimbax_camera_msgs.srv import FeatureEnumInfoGet
 from vimbax_camera_msgs.srv import FeatureCommandRun
 
 from vimbax_camera_msgs.msg import EventData
+from vimbax_camera_msgs.msg import TypedEventData
 
 from vimbax_camera_events.event_subscriber import EventSubscriber
 
 from conftest import vimbax_camera_node, TestNode
 
 
+@pytest.mark.parametrize(
+    "message_type,topic", [(EventData, "events"), (TypedEventData, "typed_events")]
+)
 @pytest.mark.launch(fixture=vimbax_camera_node)
-def test_genicam_events(test_node: TestNode, launch_context):
+def test_genicam_events(test_node: TestNode, launch_context, message_type, topic):
     enum_info_service = test_node.create_client(
         FeatureEnumInfoGet, f"{test_node.camera_node_name()}/features/enum_info_get"
     )
@@ -57,7 +61,9 @@ def test_genicam_events(test_node: TestNode, launch_context):
     if "Test" not in enum_info_response.available_values:
         pytest.skip("Test event not supported")
 
-    subscriber = EventSubscriber(EventData, test_node, f"{test_node.camera_node_name()}/events")
+    subscriber = EventSubscriber(
+        message_type, test_node, f"{test_node.camera_node_name()}/{topic}"
+    )
 
     on_event_event = Event()
     on_subscription_ready = Event()
@@ -60,7 +60,10 @@ from vimbax_camera_msgs.srv import FeatureStringGet
 from vimbax_camera_msgs.srv import FeatureStringSet
 
 from vimbax_camera_msgs.srv import FeatureRawGet
+from vimbax_camera_msgs.srv import FeaturesBatch
 from vimbax_camera_msgs.msg import FeatureModule
+from vimbax_camera_msgs.msg import FeatureOperation
+from vimbax_camera_msgs.msg import FeatureValue
 
 from conftest import vimbax_camera_node, TestNode
 
@@ -936,3 +939,85 @@ def test_feature_raw_get(test_node: TestNode, launch_context, module: FeatureMod
         check_error(response.error)
         assert len(response.buffer) > 0
         assert len(response.buffer) == response.buffer_size
+
+
+@pytest.mark.launch(fixture=vimbax_camera_node)
+def test_features_batch_get(test_node: TestNode, launch_context):
+    features_batch_service = test_node.create_client(
+        FeaturesBatch, f"/{test_node.camera_node_name()}/features/batch"
+    )
+    assert features_batch_service.wait_for_service(10)
+    feature_int_get_service = test_node.create_client(
+        FeatureIntGet, f"/{test_node.camera_node_name()}/features/int_get"
+    )
+    assert feature_int_get_service.wait_for_service(10)
+
+    feature_names = ["Width", "Height"]
+    request = FeaturesBatch.Request(atomic=False)
+    for name in feature_names:
+        request.operations.append(FeatureOperation(
+            operation=FeatureOperation.OPERATION_GET,
+            feature_name=name,
+            value=FeatureValue(type=FeatureValue.TYPE_INT)
+        ))
+
+    response = test_node.call_service_sync(features_batch_service, request)
+    check_error(response.error)
+    assert len(response.results) == len(feature_names)
+
+    for name, result in zip(feature_names, response.results):
+        check_error(result.error)
+        int_get_response = test_node.call_service_sync(
+            feature_int_get_service, FeatureIntGet.Request(feature_name=name)
+        )
+        check_error(int_get_response.error)
+        assert result.value.int_value == int_get_response.value
+
+
+@pytest.mark.launch(fixture=vimbax_camera_node)
+def test_features_batch_atomic_rollback(test_node: TestNode, launch_context):
+    features_batch_service = test_node.create_client(
+        FeaturesBatch, f"/{test_node.camera_node_name()}/features/batch"
+    )
+    assert features_batch_service.wait_for_service(10)
+    feature_int_get_service = test_node.create_client(
+        FeatureIntGet, f"/{test_node.camera_node_name()}/features/int_get"
+    )
+    assert feature_int_get_service.wait_for_service(10)
+    feature_int_info_service = test_node.create_client(
+        FeatureIntInfoGet, f"/{test_node.camera_node_name()}/features/int_info_get"
+    )
+    assert feature_int_info_service.wait_for_service(10)
+
+    width_response = test_node.call_service_sync(
+        feature_int_get_service, FeatureIntGet.Request(feature_name="Width")
+    )
+    check_error(width_response.error)
+    width_info_response = test_node.call_service_sync(
+        feature_int_info_service, FeatureIntInfoGet.Request(feature_name="Width")
+    )
+    check_error(width_info_response.error)
+
+    request = FeaturesBatch.Request(atomic=True)
+    request.operations.append(FeatureOperation(
+        operation=FeatureOperation.OPERATION_SET,
+        feature_name="Width",
+        value=FeatureValue(type=FeatureValue.TYPE_INT, int_value=width_info_response.min)
+    ))
+    request.operations.append(FeatureOperation(
+        operation=FeatureOperation.OPERATION_SET,
+        feature_name="NonExistingFeature",
+        value=FeatureValue(type=FeatureValue.TYPE_INT, int_value=0)
+    ))
+
+    response = test_node.call_service_sync(features_batch_service, request)
+    assert response.error.code != 0
+    assert len(response.results) == 2
+    check_error(response.results[0].error)
+    assert response.results[1].error.code != 0
+
+    width_after_response = test_node.call_service_sync(
+        feature_int_get_service, FeatureIntGet.Request(feature_name="Width")
+    )
+    check_error(width_after_response.error)
+    assert width_after_response.value == width_response.value
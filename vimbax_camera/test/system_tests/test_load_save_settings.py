@@ -43,6 +43,7 @@ from vimbax_camera_msgs.srv import FeatureInfoQuery
 from vimbax_camera_msgs.srv import FeatureAccessModeGet
 
 from vimbax_camera_msgs.srv import SettingsLoadSave
+from vimbax_camera_msgs.srv import SettingsSnapshotLoad
 
 from vimbax_camera_msgs.srv import FeatureFloatGet
 from vimbax_camera_msgs.srv import FeatureFloatSet
@@ -90,6 +91,31 @@ def test_settings_save_load(test_node: TestNode, launch_context):
     os.remove(test_file_name)
 
 
+@pytest.mark.launch(fixture=vimbax_camera_node)
+def test_settings_snapshot_save_load(test_node: TestNode, launch_context):
+    snapshot_save_service = test_node.create_client(
+        SettingsLoadSave, f"{test_node.camera_node_name()}/settings/snapshot_save")
+    assert snapshot_save_service.wait_for_service(10)
+    snapshot_load_service = test_node.create_client(
+        SettingsSnapshotLoad, f"{test_node.camera_node_name()}/settings/snapshot_load")
+    assert snapshot_load_service.wait_for_service(10)
+
+    test_file_name = tempfile.mktemp(suffix=".vxs")
+
+    save_response = snapshot_save_service.call(SettingsLoadSave.Request(filename=test_file_name))
+    check_error(save_response.error)
+    assert Path(test_file_name).exists()
+
+    # Nothing changed since the snapshot was taken, so applying it must not write anything
+    load_response = snapshot_load_service.call(
+        SettingsSnapshotLoad.Request(filename=test_file_name))
+    check_error(load_response.error)
+    assert load_response.written == 0
+    assert load_response.unchanged > 0
+
+    os.remove(test_file_name)
+
+
 @pytest.mark.launch(fixture=vimbax_camera_node)
 def test_settings_save_load_float_value_change(test_node: TestNode, launch_context):
     feature_info_query_service = test_node.create_client(
@@ -28,16 +28,40 @@
 
 #include <vimbax_camera/vimbax_camera.hpp>
 #include <vimbax_camera/vimbax_camera_helper.hpp>
+#include <vimbax_camera/vimbax_camera_event_queue.hpp>
+#include <vimbax_camera/vimbax_camera_frame_correlator.hpp>
+#include <vimbax_camera/vimbax_camera_recorder.hpp>
+#include <vimbax_camera/vimbax_camera_roi.hpp>
+#include <vimbax_camera/vimbax_camera_shared_memory.hpp>
+#include <vimbax_camera/vimbax_camera_statistics.hpp>
+#include <vimbax_camera/vimbax_camera_auto_exposure.hpp>
+#include <vimbax_camera/vimbax_camera_feature_queue.hpp>
+#include <vimbax_camera/vimbax_camera_feature_journal.hpp>
+#include <vimbax_camera/vimbax_camera_pretrigger.hpp>
+#include <vimbax_camera/vimbax_camera_correction.hpp>
+#include <vimbax_camera/vimbax_camera_rectify.hpp>
+#include <vimbax_camera/vimbax_camera_frame_set.hpp>
+#include <vimbax_camera/vimbax_camera_sync.hpp>
 
 #include <gmock/gmock.h>
 
 #include <filesystem>
 #include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <future>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "mocks/library_loader_mock.hpp"
 
 using ::vimbax_camera::VmbCAPI;
 using ::vimbax_camera::VimbaXCamera;
+using ::vimbax_camera::VimbaXCameraIndex;
 using ::vimbax_camera::SFNCFeatures;
 
 using ::testing::_;
@@ -45,6 +69,7 @@ using ::testing::AtLeast;
 using ::testing::Return;
 using ::testing::ByMove;
 using ::testing::Eq;
+using ::testing::InSequence;
 
 
 class VimbaXCameraTest : public testing::Test
@@ -141,6 +166,19 @@ protected:
         return VmbErrorSuccess;
       });
 
+    EXPECT_CALL(*api_mock_, FeaturesList).Times(AtLeast(0));
+    EXPECT_CALL(*api_mock_, FeaturesList(&dummy_handle_, _, _, _, _))
+    .Times(AtLeast(0)).WillRepeatedly(
+      [&](auto, VmbFeatureInfo_t * list, auto listLength, VmbUint32_t * numFound, auto) {
+        *numFound = VmbUint32_t(remote_features_.size());
+        if (list != nullptr) {
+          std::copy_n(
+            remote_features_.begin(), std::min<size_t>(listLength, remote_features_.size()),
+            list);
+        }
+        return VmbErrorSuccess;
+      });
+
     camera_ = VimbaXCamera::open(api_, cameraIdStr);
 
     EXPECT_CALL(
@@ -207,6 +245,182 @@ protected:
   int64_t test_size_ = test_line_ * test_height_;
 
   uint64_t dummy_handle_{};
+  std::vector<VmbFeatureInfo_t> remote_features_{};
+};
+
+class VimbaXCameraFeatureCacheTest : public VimbaXCameraOpenedTest
+{
+protected:
+  void SetUp() override
+  {
+    VmbFeatureInfo_t cached_feature{};
+    cached_feature.name = "CachedInt";
+    VmbFeatureInfo_t volatile_feature{};
+    volatile_feature.name = "VolatileInt";
+    volatile_feature.featureFlags = VmbFeatureFlagsVolatile;
+    VmbFeatureInfo_t selector_feature{};
+    selector_feature.name = "TestSelector";
+    selector_feature.hasSelectedFeatures = true;
+
+    remote_features_ = {cached_feature, volatile_feature, selector_feature};
+
+    for (auto & feature : remote_features_) {
+      feature.category = "/Test";
+    }
+
+    VimbaXCameraOpenedTest::SetUp();
+  }
+
+  void expect_int_get(const std::string_view & name, int times)
+  {
+    EXPECT_CALL(*api_mock_, FeatureIntGet(_, Eq(name), _)).Times(times)
+    .WillRepeatedly(
+      [](auto, auto, VmbInt64_t * value) -> VmbError_t {
+        *value = 42;
+        return VmbErrorSuccess;
+      });
+  }
+};
+
+class VimbaXCameraSnapshotTest : public VimbaXCameraOpenedTest
+{
+protected:
+  void SetUp() override
+  {
+    VmbFeatureInfo_t selected_feature{};
+    selected_feature.name = "SelectedInt";
+    selected_feature.featureDataType = VmbFeatureDataInt;
+    VmbFeatureInfo_t selector_feature{};
+    selector_feature.name = "TestSelector";
+    selector_feature.featureDataType = VmbFeatureDataEnum;
+    selector_feature.hasSelectedFeatures = true;
+    VmbFeatureInfo_t float_feature{};
+    float_feature.name = "TestFloat";
+    float_feature.featureDataType = VmbFeatureDataFloat;
+    VmbFeatureInfo_t not_persisted_feature{};
+    not_persisted_feature.name = "NotPersisted";
+    not_persisted_feature.featureDataType = VmbFeatureDataInt;
+
+    remote_features_ = {selected_feature, selector_feature, float_feature, not_persisted_feature};
+
+    for (auto & feature : remote_features_) {
+      feature.category = "/Test";
+      feature.featureFlags = VmbFeatureFlagsRead | VmbFeatureFlagsWrite;
+      feature.isStreamable = (feature.name != std::string{"NotPersisted"});
+    }
+
+    VimbaXCameraOpenedTest::SetUp();
+
+    camera_->set_feature_value_cache_enabled(false);
+
+    EXPECT_CALL(*api_mock_, FeatureListSelected(_, Eq(std::string{"TestSelector"}), _, _, _, _))
+    .Times(AtLeast(0)).WillRepeatedly(
+      [&](auto, auto, VmbFeatureInfo_t * list, auto listLength, VmbUint32_t * numFound, auto) {
+        *numFound = 1;
+        if (list != nullptr && listLength > 0) {
+          list[0] = remote_features_[0];
+        }
+        return VmbErrorSuccess;
+      });
+
+    EXPECT_CALL(*api_mock_, FeatureAccessQuery).Times(AtLeast(0)).WillRepeatedly(
+      [](auto, auto, VmbBool_t * readable, VmbBool_t * writeable) {
+        *readable = true;
+        *writeable = true;
+        return VmbErrorSuccess;
+      });
+
+    EXPECT_CALL(*api_mock_, FeatureIntGet(_, Eq(std::string{"SelectedInt"}), _))
+    .Times(AtLeast(0)).WillRepeatedly(
+      [](auto, auto, VmbInt64_t * value) {
+        *value = 42;
+        return VmbErrorSuccess;
+      });
+
+    EXPECT_CALL(*api_mock_, FeatureEnumGet(_, Eq(std::string{"TestSelector"}), _))
+    .Times(AtLeast(0)).WillRepeatedly(
+      [](auto, auto, const char ** value) {
+        *value = "Selector1";
+        return VmbErrorSuccess;
+      });
+
+    EXPECT_CALL(*api_mock_, FeatureFloatGet(_, Eq(std::string{"TestFloat"}), _))
+    .Times(AtLeast(0)).WillRepeatedly(
+      [](auto, auto, double * value) {
+        *value = 1.5;
+        return VmbErrorSuccess;
+      });
+  }
+
+  VimbaXCamera::FeatureSnapshot test_snapshot() const
+  {
+    using Entry = VimbaXCamera::FeatureSnapshot::Entry;
+    auto constexpr module = VimbaXCamera::Module::RemoteDevice;
+
+    return {
+      "TestCamera",
+      {
+        Entry{module, "TestSelector", VmbFeatureDataEnum, std::string{"Selector1"}, std::nullopt},
+        Entry{module, "SelectedInt", VmbFeatureDataInt, int64_t{42}, 0},
+        Entry{module, "TestFloat", VmbFeatureDataFloat, 1.5, std::nullopt},
+      }
+    };
+  }
+};
+
+class VimbaXCameraEventTest : public VimbaXCameraOpenedTest
+{
+protected:
+  void SetUp() override
+  {
+    VmbFeatureInfo_t frame_id_feature{};
+    frame_id_feature.name = "EventExposureEndFrameID";
+    frame_id_feature.featureDataType = VmbFeatureDataInt;
+    VmbFeatureInfo_t timestamp_feature{};
+    timestamp_feature.name = "EventExposureEndTimestamp";
+    timestamp_feature.featureDataType = VmbFeatureDataInt;
+    VmbFeatureInfo_t exposure_feature{};
+    exposure_feature.name = "EventExposureEndExposureTime";
+    exposure_feature.featureDataType = VmbFeatureDataFloat;
+    VmbFeatureInfo_t command_feature{};
+    command_feature.name = "EventExposureEndCommand";
+    command_feature.featureDataType = VmbFeatureDataCommand;
+
+    remote_features_ = {frame_id_feature, timestamp_feature, exposure_feature, command_feature};
+
+    for (auto & feature : remote_features_) {
+      feature.category = "/EventControl/EventsData/EventExposureEndData";
+      feature.featureFlags = VmbFeatureFlagsRead | VmbFeatureFlagsVolatile;
+    }
+
+    VimbaXCameraOpenedTest::SetUp();
+  }
+};
+
+class VimbaXCameraPtpSyncTest : public VimbaXCameraOpenedTest
+{
+protected:
+  void SetUp() override
+  {
+    for (auto const & [name, type, is_volatile] : {
+        std::tuple{"PtpEnable", VmbFeatureDataBool, false},
+        std::tuple{"PtpDataSetLatch", VmbFeatureDataCommand, false},
+        std::tuple{"PtpStatus", VmbFeatureDataEnum, true},
+        std::tuple{"PtpOffsetFromMaster", VmbFeatureDataInt, true},
+        std::tuple{"TimestampLatch", VmbFeatureDataCommand, false},
+        std::tuple{"TimestampLatchValue", VmbFeatureDataInt, true},
+        std::tuple{"ActionSelector", VmbFeatureDataInt, false}})
+    {
+      VmbFeatureInfo_t feature{};
+      feature.name = name;
+      feature.featureDataType = type;
+      feature.featureFlags = VmbFeatureFlagsRead | VmbFeatureFlagsWrite |
+        (is_volatile ? VmbFeatureFlagsVolatile : 0);
+      remote_features_.push_back(feature);
+    }
+
+    VimbaXCameraOpenedTest::SetUp();
+  }
 };
 
 TEST_F(VimbaXCameraTest, open_first_camera)
@@ -728,190 +942,2702 @@ TEST_F(VimbaXCameraTest, open_by_serial)
   EXPECT_TRUE(camera);
 }
 
-TEST_F(VimbaXCameraOpenedTest, frame_create_announce_fail)
+TEST_F(VimbaXCameraTest, camera_index_find)
 {
-  auto const announceError = VmbErrorMoreData;
-
-  EXPECT_CALL(*api_mock_, FrameAnnounce).Times(1).WillOnce(Return(announceError));
+  std::array<VmbCameraInfo, 2> availableCameras = {
+    VmbCameraInfo{
+      "testCam1Id",
+      "testCam1ExtId",
+      "Test Camera 1",
+      "Test Camera",
+      "1234",
+      nullptr,
+      nullptr,
+      nullptr,
+      stream_handles_.data(),
+      uint32_t(stream_handles_.size()),
+      VmbAccessModeRead | VmbAccessModeFull | VmbAccessModeExclusive
+    },
+    VmbCameraInfo{
+      "testCam2Id",
+      "testCam2ExtId",
+      "Test Camera 2",
+      "Test Camera",
+      "5678",
+      nullptr,
+      nullptr,
+      nullptr,
+      stream_handles_.data(),
+      uint32_t(stream_handles_.size()),
+      VmbAccessModeRead | VmbAccessModeFull | VmbAccessModeExclusive
+    }
+  };
 
-  auto const frameRes = VimbaXCamera::Frame::create(camera_, test_size_);
+  int cameras_list_calls{0};
+  EXPECT_CALL(*api_mock_, CamerasList).Times(AtLeast(1))
+  .WillRepeatedly(
+    [&](
+      VmbCameraInfo_t * cameraInfo,
+      VmbUint32_t listLength,
+      VmbUint32_t * numFound,
+      VmbUint32_t) -> VmbError_t {
+      cameras_list_calls++;
+      *numFound = availableCameras.size();
 
-  EXPECT_FALSE(frameRes);
-  EXPECT_EQ(frameRes.error().code, announceError);
-}
+      if (cameraInfo != nullptr) {
+        if (listLength < availableCameras.size()) {
+          return VmbErrorMoreData;
+        }
 
-TEST_F(VimbaXCameraOpenedTest, frame_create_format_info_fail)
-{
-  auto const infoError = VmbErrorMoreData;
+        std::copy(availableCameras.begin(), availableCameras.end(), cameraInfo);
+      }
 
-  EXPECT_CALL(*api_mock_, FeatureInfoQuery(_, Eq(SFNCFeatures::PixelFormat), _, _))
-  .Times(1).WillOnce(Return(infoError));
+      return VmbErrorSuccess;
+    });
 
-  EXPECT_CALL(*api_mock_, FrameAnnounce).Times(0);
+  VimbaXCameraIndex index{api_};
+  ASSERT_TRUE(index.rebuild());
 
-  auto const frameRes = VimbaXCamera::Frame::create(camera_, test_size_);
+  for (auto const & key : {"testCam2Id", "testCam2ExtId", "5678"}) {
+    auto const entry = index.find(key);
+    ASSERT_TRUE(entry) << key;
+    EXPECT_EQ(entry->camera_id, "testCam2Id");
+    EXPECT_EQ(entry->serial_number, "5678");
+  }
 
-  EXPECT_FALSE(frameRes);
-  EXPECT_EQ(frameRes.error().code, infoError);
+  EXPECT_FALSE(index.find("testCam3Id"));
+  EXPECT_EQ(index.list().size(), availableCameras.size());
 }
 
-TEST_F(VimbaXCameraOpenedTest, frame_create_success_by_announce)
+TEST_F(VimbaXCameraTest, camera_index_discovery_events)
 {
-  EXPECT_CALL(*api_mock_, FrameAnnounce).Times(1)
-  .WillOnce(
-    [&](auto, const VmbFrame * frame, auto frameSize) -> int32_t {
-      EXPECT_EQ(frameSize, sizeof(VmbFrame));
-
-      EXPECT_EQ(frame->bufferSize, test_size_);
-      EXPECT_NE(frame->buffer, nullptr);
+  std::array<VmbCameraInfo, 2> availableCameras = {
+    VmbCameraInfo{
+      "testCam1Id",
+      "testCam1ExtId",
+      "Test Camera 1",
+      "Test Camera",
+      "1234",
+      nullptr,
+      nullptr,
+      nullptr,
+      stream_handles_.data(),
+      uint32_t(stream_handles_.size()),
+      VmbAccessModeRead | VmbAccessModeFull | VmbAccessModeExclusive
+    },
+    VmbCameraInfo{
+      "testCam2Id",
+      "testCam2ExtId",
+      "Test Camera 2",
+      "Test Camera",
+      "5678",
+      nullptr,
+      nullptr,
+      nullptr,
+      stream_handles_.data(),
+      uint32_t(stream_handles_.size()),
+      VmbAccessModeRead | VmbAccessModeFull | VmbAccessModeExclusive
+    }
+  };
 
-      return VmbErrorSuccess;
-    });
+  int cameras_list_calls{0};
+  EXPECT_CALL(*api_mock_, CamerasList).Times(AtLeast(1))
+  .WillRepeatedly(
+    [&](
+      VmbCameraInfo_t * cameraInfo,
+      VmbUint32_t listLength,
+      VmbUint32_t * numFound,
+      VmbUint32_t) -> VmbError_t {
+      cameras_list_calls++;
+      *numFound = availableCameras.size();
 
-  auto const frameRes = VimbaXCamera::Frame::create(camera_, test_size_);
+      if (cameraInfo != nullptr) {
+        if (listLength < availableCameras.size()) {
+          return VmbErrorMoreData;
+        }
 
-  EXPECT_TRUE(frameRes);
-  EXPECT_NE(frameRes->get(), nullptr);
-}
+        std::copy(availableCameras.begin(), availableCameras.end(), cameraInfo);
+      }
 
-TEST_F(VimbaXCameraOpenedTest, frame_create_success_by_alloc_and_announce)
-{
-  auto const size = test_size_ + 128;
+      return VmbErrorSuccess;
+    });
 
-  EXPECT_CALL(*api_mock_, FrameAnnounce).Times(1)
+  EXPECT_CALL(*api_mock_, CameraInfoQuery(Eq(std::string{"testCam1Id"}), _, _)).Times(1)
   .WillOnce(
-    [&](auto, const VmbFrame * frame, auto frameSize) -> int32_t {
-      EXPECT_EQ(frameSize, sizeof(VmbFrame));
-
-      EXPECT_EQ(frame->bufferSize, size);
-      EXPECT_EQ(frame->buffer, nullptr);
-
+    [&](auto, VmbCameraInfo_t * info, auto) -> VmbError_t {
+      *info = availableCameras[0];
       return VmbErrorSuccess;
     });
 
-  auto const frameRes = VimbaXCamera::Frame::create(camera_, size);
-
-  EXPECT_TRUE(frameRes);
-  EXPECT_NE(frameRes->get(), nullptr);
-}
-
-TEST_F(VimbaXCameraOpenedTest, settings_save_invalid_directory)
-{
-  auto const temp_path = std::filesystem::temp_directory_path();
-  auto const test_xml_path = temp_path / "invalid" / "invalid.xml";
+  VimbaXCameraIndex index{api_};
+  ASSERT_TRUE(index.rebuild());
 
-  auto const result = camera_->settings_save(test_xml_path.string());
+  index.on_camera_missing("testCam1ExtId");
+  EXPECT_FALSE(index.find("testCam1Id"));
+  EXPECT_FALSE(index.find("1234"));
+  EXPECT_TRUE(index.find("testCam2Id"));
 
-  ASSERT_FALSE(result);
-  EXPECT_EQ(result.error().code, VmbErrorNotFound);
+  index.on_camera_detected("testCam1Id");
+  EXPECT_TRUE(index.find("1234"));
+  EXPECT_EQ(cameras_list_calls, 2);
 }
 
-TEST_F(VimbaXCameraOpenedTest, settings_save_invalid_file_name)
+TEST_F(VimbaXCameraTest, camera_index_list_queries_access)
 {
-  auto const temp_path = std::filesystem::temp_directory_path();
-  auto const test_xml_path = temp_path / "invalid" / "invalid.json";
-
-  auto const result = camera_->settings_save(test_xml_path.string());
-
-  ASSERT_FALSE(result);
-  EXPECT_EQ(result.error().code, VmbErrorInvalidValue);
-}
+  std::array<VmbCameraInfo, 1> availableCameras = {
+    VmbCameraInfo{
+      "testCam1Id",
+      "testCam1ExtId",
+      "Test Camera 1",
+      "Test Camera",
+      "1234",
+      nullptr,
+      nullptr,
+      nullptr,
+      stream_handles_.data(),
+      uint32_t(stream_handles_.size()),
+      VmbAccessModeRead | VmbAccessModeFull | VmbAccessModeExclusive
+    }
+  };
 
-TEST_F(VimbaXCameraOpenedTest, settings_save_valid_error)
-{
-  auto const error = VmbErrorCustom;
-  auto const temp_path = std::filesystem::temp_directory_path();
-  auto const test_xml_path = temp_path / "valid.xml";
+  EXPECT_CALL(*api_mock_, CamerasList).Times(AtLeast(1))
+  .WillRepeatedly(
+    [&](
+      VmbCameraInfo_t * cameraInfo,
+      VmbUint32_t,
+      VmbUint32_t * numFound,
+      VmbUint32_t) -> VmbError_t {
+      *numFound = availableCameras.size();
 
-  if (std::filesystem::exists(test_xml_path)) {
-    std::filesystem::remove(test_xml_path);
-  }
+      if (cameraInfo != nullptr) {
+        std::copy(availableCameras.begin(), availableCameras.end(), cameraInfo);
+      }
 
-  std::ofstream stream{test_xml_path};
-  stream.close();
+      return VmbErrorSuccess;
+    });
 
-  EXPECT_CALL(*api_mock_, SettingsSave(_, Eq(test_xml_path.string()), _, _)).Times(1)
-  .WillOnce(Return(error));
+  // Opened by another process after the index was built
+  EXPECT_CALL(*api_mock_, CameraInfoQuery(Eq(std::string{"testCam1Id"}), _, _)).Times(1)
+  .WillOnce(
+    [&](auto, VmbCameraInfo_t * info, auto) -> VmbError_t {
+      *info = availableCameras[0];
+      info->permittedAccess = VmbAccessModeRead;
+      return VmbErrorSuccess;
+    });
 
-  auto const result = camera_->settings_save(test_xml_path.string());
+  VimbaXCameraIndex index{api_};
+  ASSERT_TRUE(index.rebuild());
 
-  ASSERT_FALSE(result);
-  EXPECT_EQ(result.error().code, error);
+  auto const entries = index.list();
+  ASSERT_EQ(entries.size(), 1);
+  EXPECT_EQ(entries[0].permitted_access, VmbAccessModeRead);
 }
 
-
-TEST_F(VimbaXCameraOpenedTest, settings_save_valid_ok)
+TEST_F(VimbaXCameraTest, open_from_camera_index)
 {
-  auto const temp_path = std::filesystem::temp_directory_path();
+  uint64_t dummyHandle{};
+
+  std::array<VmbCameraInfo, 2> availableCameras = {
+    VmbCameraInfo{
+      "testCam1Id",
+      "testCam1ExtId",
+      "Test Camera 1",
+      "Test Camera",
+      "1234",
+      nullptr,
+      nullptr,
+      nullptr,
+      stream_handles_.data(),
+      uint32_t(stream_handles_.size()),
+      VmbAccessModeRead | VmbAccessModeFull | VmbAccessModeExclusive
+    },
+    VmbCameraInfo{
+      "testCam2Id",
+      "testCam2ExtId",
+      "Test Camera 2",
+      "Test Camera",
+      "5678",
+      nullptr,
+      nullptr,
+      nullptr,
+      stream_handles_.data(),
+      uint32_t(stream_handles_.size()),
+      VmbAccessModeRead | VmbAccessModeFull | VmbAccessModeExclusive
+    }
+  };
+
+  int cameras_list_calls{0};
+  EXPECT_CALL(*api_mock_, CamerasList).Times(AtLeast(1))
+  .WillRepeatedly(
+    [&](
+      VmbCameraInfo_t * cameraInfo,
+      VmbUint32_t listLength,
+      VmbUint32_t * numFound,
+      VmbUint32_t) -> VmbError_t {
+      cameras_list_calls++;
+      *numFound = availableCameras.size();
+
+      if (cameraInfo != nullptr) {
+        if (listLength < availableCameras.size()) {
+          return VmbErrorMoreData;
+        }
+
+        std::copy(availableCameras.begin(), availableCameras.end(), cameraInfo);
+      }
+
+      return VmbErrorSuccess;
+    });
+
+  auto const index = std::make_shared<VimbaXCameraIndex>(api_);
+  ASSERT_TRUE(index->rebuild());
+
+  EXPECT_CALL(*api_mock_, CameraOpen(Eq(std::string{"testCam2ExtId"}), _, _)).Times(1)
+  .WillOnce(
+    [&](auto, auto, auto cameraHandle) -> VmbError_t {
+      *cameraHandle = reinterpret_cast<VmbHandle_t>(&dummyHandle);
+      return VmbErrorSuccess;
+    });
+
+  EXPECT_CALL(*api_mock_, CameraInfoQueryByHandle(&dummyHandle, _, _))
+  .Times(AtLeast(1)).WillRepeatedly(
+    [&](auto, auto infoPtr, auto) -> VmbError_t {
+      *infoPtr = availableCameras[1];
+      return VmbErrorSuccess;
+    });
+
+  EXPECT_CALL(*api_mock_, CameraClose(&dummyHandle)).Times(1);
+
+  auto const calls_after_rebuild = cameras_list_calls;
+  auto camera = VimbaXCamera::open(api_, "5678", index);
+
+  EXPECT_TRUE(camera);
+  EXPECT_EQ(cameras_list_calls, calls_after_rebuild);
+}
+
+class VimbaXCameraFeatureMapTest : public VimbaXCameraTest
+{
+protected:
+  void SetUp() override
+  {
+    VimbaXCameraTest::SetUp();
+
+    camera_info_ = VmbCameraInfo{
+      "testCam1Id",
+      "testCam1ExtId",
+      "Test Camera 1",
+      "Test Camera",
+      "1234",
+      nullptr,
+      nullptr,
+      nullptr,
+      stream_handles_.data(),
+      uint32_t(stream_handles_.size()),
+      VmbAccessModeRead | VmbAccessModeFull | VmbAccessModeExclusive
+    };
+
+    feature_.name = "TestFeature";
+    feature_.category = "/Test";
+
+    EXPECT_CALL(*api_mock_, CamerasList).Times(AtLeast(0))
+    .WillRepeatedly(
+      [&](VmbCameraInfo_t * cameraInfo, auto, VmbUint32_t * numFound, auto) -> VmbError_t {
+        *numFound = 1;
+
+        if (cameraInfo != nullptr) {
+          *cameraInfo = camera_info_;
+        }
+
+        return VmbErrorSuccess;
+      });
+
+    EXPECT_CALL(*api_mock_, CameraOpen(Eq(std::string{"testCam1ExtId"}), _, _))
+    .Times(AtLeast(1)).WillRepeatedly(
+      [&](auto, auto, auto cameraHandle) -> VmbError_t {
+        *cameraHandle = reinterpret_cast<VmbHandle_t>(&dummy_handle_);
+        return VmbErrorSuccess;
+      });
+
+    EXPECT_CALL(*api_mock_, CameraInfoQueryByHandle(&dummy_handle_, _, _))
+    .Times(AtLeast(1)).WillRepeatedly(
+      [&](auto, auto infoPtr, auto) -> VmbError_t {
+        *infoPtr = camera_info_;
+        return VmbErrorSuccess;
+      });
+
+    EXPECT_CALL(
+      *api_mock_,
+      FeatureStringGet(&dummy_handle_, Eq(SFNCFeatures::DeviceFirmwareVersion), _, _, _))
+    .Times(AtLeast(1)).WillRepeatedly(
+      [](auto, auto, char * buffer, auto, VmbUint32_t * sizeFilled) -> VmbError_t {
+        std::string const firmwareVersion = "1.0";
+        *sizeFilled = uint32_t(firmwareVersion.size() + 1);
+        if (buffer != nullptr) {
+          std::copy_n(firmwareVersion.c_str(), firmwareVersion.size() + 1, buffer);
+        }
+        return VmbErrorSuccess;
+      });
+
+    EXPECT_CALL(*api_mock_, CameraClose(&dummy_handle_)).Times(AtLeast(1));
+    EXPECT_CALL(*api_mock_, FeaturesList).Times(AtLeast(0));
+  }
+
+  uint64_t dummy_handle_{};
+  VmbCameraInfo camera_info_{};
+  VmbFeatureInfo_t feature_{};
+};
+
+TEST_F(VimbaXCameraFeatureMapTest, concurrent_first_lookups)
+{
+  std::atomic<int> features_list_calls{0};
+  std::atomic<int> concurrent_calls{0};
+  std::atomic<int> max_concurrent_calls{0};
+
+  EXPECT_CALL(*api_mock_, FeaturesList(&dummy_handle_, _, _, _, _))
+  .Times(2).WillRepeatedly(
+    [&](auto, VmbFeatureInfo_t * list, auto listLength, VmbUint32_t * numFound, auto) {
+      features_list_calls++;
+      max_concurrent_calls = std::max(max_concurrent_calls.load(), ++concurrent_calls);
+      // Keeps the build running while the lookups start
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      *numFound = 1;
+      if (list != nullptr && listLength > 0) {
+        *list = feature_;
+      }
+      concurrent_calls--;
+      return VmbErrorSuccess;
+    });
+
+  auto const camera = VimbaXCamera::open(api_, "1234");
+  ASSERT_TRUE(camera);
+
+  std::vector<std::future<bool>> lookups{};
+
+  for (int i = 0; i < 8; i++) {
+    lookups.push_back(
+      std::async(
+        std::launch::async, [&camera] {
+          return camera->has_feature("TestFeature") && !camera->has_feature("Missing");
+        }));
+  }
+
+  for (auto & lookup : lookups) {
+    EXPECT_TRUE(lookup.get());
+  }
+
+  // The remote device map is listed once, the size query and the list never overlap
+  EXPECT_EQ(features_list_calls, 2);
+  EXPECT_EQ(max_concurrent_calls, 1);
+}
+
+TEST_F(VimbaXCameraFeatureMapTest, failed_build_is_not_reused)
+{
+  int features_list_calls{0};
+
+  EXPECT_CALL(*api_mock_, FeaturesList(&dummy_handle_, _, _, _, _))
+  .Times(AtLeast(1)).WillRepeatedly(
+    [&](auto, VmbFeatureInfo_t * list, auto listLength, VmbUint32_t * numFound, auto) {
+      // The first open fails to list the features
+      if (features_list_calls++ == 0) {
+        return VmbErrorInternalFault;
+      }
+
+      *numFound = 1;
+      if (list != nullptr && listLength > 0) {
+        *list = feature_;
+      }
+      return VmbErrorSuccess;
+    });
+
+  auto camera = VimbaXCamera::open(api_, "1234");
+  ASSERT_TRUE(camera);
+  EXPECT_FALSE(camera->has_feature("TestFeature"));
+
+  auto const feature = camera->feature_handle_get("TestFeature");
+  ASSERT_FALSE(feature);
+  EXPECT_EQ(feature.error().code, VmbErrorNotFound);
+
+  auto const reopen_resources = camera->get_reopen_resources();
+  camera.reset();
+
+  EXPECT_EQ(features_list_calls, 1);
+
+  // The incomplete maps are rebuilt instead of reused
+  camera = VimbaXCamera::open(api_, "1234", nullptr, reopen_resources);
+  ASSERT_TRUE(camera);
+
+  EXPECT_TRUE(camera->has_feature("TestFeature"));
+  EXPECT_EQ(features_list_calls, 3);
+}
+
+TEST_F(VimbaXCameraTest, reopen_reuses_feature_metadata)
+{
+  uint64_t dummyHandle{};
+  std::string const firmwareVersion = "1.0";
+
+  std::array<VmbCameraInfo, 1> availableCameras = {
+    VmbCameraInfo{
+      "testCam1Id",
+      "testCam1ExtId",
+      "Test Camera 1",
+      "Test Camera",
+      "1234",
+      nullptr,
+      nullptr,
+      nullptr,
+      stream_handles_.data(),
+      uint32_t(stream_handles_.size()),
+      VmbAccessModeRead | VmbAccessModeFull | VmbAccessModeExclusive
+    }
+  };
+
+  VmbFeatureInfo_t feature{};
+  feature.name = "TestFeature";
+  feature.category = "/Test";
+
+  EXPECT_CALL(*api_mock_, CamerasList).Times(AtLeast(1))
+  .WillRepeatedly(
+    [&](
+      VmbCameraInfo_t * cameraInfo,
+      VmbUint32_t listLength,
+      VmbUint32_t * numFound,
+      VmbUint32_t) -> VmbError_t {
+      *numFound = availableCameras.size();
+
+      if (cameraInfo != nullptr) {
+        if (listLength < availableCameras.size()) {
+          return VmbErrorMoreData;
+        }
+
+        std::copy(availableCameras.begin(), availableCameras.end(), cameraInfo);
+      }
+
+      return VmbErrorSuccess;
+    });
+
+  EXPECT_CALL(*api_mock_, CameraOpen(Eq(std::string{"testCam1ExtId"}), _, _)).Times(2)
+  .WillRepeatedly(
+    [&](auto, auto, auto cameraHandle) -> VmbError_t {
+      *cameraHandle = reinterpret_cast<VmbHandle_t>(&dummyHandle);
+      return VmbErrorSuccess;
+    });
+
+  EXPECT_CALL(*api_mock_, CameraInfoQueryByHandle(&dummyHandle, _, _))
+  .Times(AtLeast(1)).WillRepeatedly(
+    [&](auto, auto infoPtr, auto) -> VmbError_t {
+      *infoPtr = availableCameras[0];
+      return VmbErrorSuccess;
+    });
+
+  EXPECT_CALL(
+    *api_mock_, FeatureStringGet(&dummyHandle, Eq(SFNCFeatures::DeviceFirmwareVersion), _, _, _))
+  .Times(AtLeast(1)).WillRepeatedly(
+    [&](auto, auto, char * buffer, auto, VmbUint32_t * sizeFilled) -> VmbError_t {
+      *sizeFilled = uint32_t(firmwareVersion.size() + 1);
+      if (buffer != nullptr) {
+        std::copy_n(firmwareVersion.c_str(), firmwareVersion.size() + 1, buffer);
+      }
+      return VmbErrorSuccess;
+    });
+
+  int features_list_calls{0};
+  EXPECT_CALL(*api_mock_, FeaturesList).Times(AtLeast(0));
+  EXPECT_CALL(*api_mock_, FeaturesList(&dummyHandle, _, _, _, _))
+  .Times(AtLeast(1)).WillRepeatedly(
+    [&](auto, VmbFeatureInfo_t * list, auto listLength, VmbUint32_t * numFound, auto) {
+      features_list_calls++;
+      *numFound = 1;
+      if (list != nullptr && listLength > 0) {
+        *list = feature;
+      }
+      return VmbErrorSuccess;
+    });
+
+  EXPECT_CALL(*api_mock_, CameraClose(&dummyHandle)).Times(2);
+
+  auto camera = VimbaXCamera::open(api_, "1234");
+  ASSERT_TRUE(camera);
+
+  auto const reopen_resources = camera->get_reopen_resources();
+  camera.reset();
+
+  auto const calls_after_first_open = features_list_calls;
+  EXPECT_GT(calls_after_first_open, 0);
+
+  camera = VimbaXCamera::open(api_, "1234", nullptr, reopen_resources);
+  ASSERT_TRUE(camera);
+
+  EXPECT_TRUE(camera->has_feature("TestFeature"));
+  EXPECT_EQ(features_list_calls, calls_after_first_open);
+}
+
+TEST_F(VimbaXCameraOpenedTest, frame_create_announce_fail)
+{
+  auto const announceError = VmbErrorMoreData;
+
+  EXPECT_CALL(*api_mock_, FrameAnnounce).Times(1).WillOnce(Return(announceError));
+
+  auto const frameRes = VimbaXCamera::Frame::create(camera_, test_size_);
+
+  EXPECT_FALSE(frameRes);
+  EXPECT_EQ(frameRes.error().code, announceError);
+}
+
+TEST_F(VimbaXCameraOpenedTest, frame_create_format_info_fail)
+{
+  auto const infoError = VmbErrorMoreData;
+
+  EXPECT_CALL(*api_mock_, FeatureInfoQuery(_, Eq(SFNCFeatures::PixelFormat), _, _))
+  .Times(1).WillOnce(Return(infoError));
+
+  EXPECT_CALL(*api_mock_, FrameAnnounce).Times(0);
+
+  auto const frameRes = VimbaXCamera::Frame::create(camera_, test_size_);
+
+  EXPECT_FALSE(frameRes);
+  EXPECT_EQ(frameRes.error().code, infoError);
+}
+
+TEST_F(VimbaXCameraOpenedTest, frame_create_success_by_announce)
+{
+  EXPECT_CALL(*api_mock_, FrameAnnounce).Times(1)
+  .WillOnce(
+    [&](auto, const VmbFrame * frame, auto frameSize) -> int32_t {
+      EXPECT_EQ(frameSize, sizeof(VmbFrame));
+
+      EXPECT_EQ(frame->bufferSize, test_size_);
+      EXPECT_NE(frame->buffer, nullptr);
+
+      return VmbErrorSuccess;
+    });
+
+  auto const frameRes = VimbaXCamera::Frame::create(camera_, test_size_);
+
+  EXPECT_TRUE(frameRes);
+  EXPECT_NE(frameRes->get(), nullptr);
+}
+
+TEST_F(VimbaXCameraOpenedTest, frame_create_success_by_alloc_and_announce)
+{
+  auto const size = test_size_ + 128;
+
+  EXPECT_CALL(*api_mock_, FrameAnnounce).Times(1)
+  .WillOnce(
+    [&](auto, const VmbFrame * frame, auto frameSize) -> int32_t {
+      EXPECT_EQ(frameSize, sizeof(VmbFrame));
+
+      EXPECT_EQ(frame->bufferSize, size);
+      EXPECT_EQ(frame->buffer, nullptr);
+
+      return VmbErrorSuccess;
+    });
+
+  auto const frameRes = VimbaXCamera::Frame::create(camera_, size);
+
+  EXPECT_TRUE(frameRes);
+  EXPECT_NE(frameRes->get(), nullptr);
+}
+
+TEST_F(VimbaXCameraOpenedTest, frame_buffer_reused)
+{
+  EXPECT_CALL(*api_mock_, FrameAnnounce).Times(2);
+
+  auto const buffer = [&]() -> const uint8_t * {
+      auto const frameRes = VimbaXCamera::Frame::create(camera_, test_size_);
+      return frameRes ? (*frameRes)->data.data() : nullptr;
+    }();
+
+  ASSERT_NE(buffer, nullptr);
+
+  auto const frameRes = VimbaXCamera::Frame::create(camera_, test_size_);
+  ASSERT_TRUE(frameRes);
+
+  EXPECT_EQ((*frameRes)->data.data(), buffer);
+}
+
+TEST_F(VimbaXCameraOpenedTest, frame_create_invalid_stream_index)
+{
+  EXPECT_CALL(*api_mock_, FrameAnnounce).Times(0);
+
+  auto const frameRes =
+    VimbaXCamera::Frame::create(camera_, test_size_, 1, uint32_t(stream_handles_.size()));
+
+  EXPECT_FALSE(frameRes);
+  EXPECT_EQ(frameRes.error().code, VmbErrorBadParameter);
+}
+
+TEST_F(VimbaXCameraOpenedTest, start_streaming_invalid_stream_count)
+{
+  EXPECT_CALL(*api_mock_, CaptureStart).Times(0);
+
+  auto const startRes = camera_->start_streaming(
+    3, [](auto) {}, true, uint32_t(stream_handles_.size() + 1));
+
+  EXPECT_FALSE(startRes);
+  EXPECT_EQ(startRes.error().code, VmbErrorBadParameter);
+  EXPECT_FALSE(camera_->is_streaming());
+}
+
+TEST_F(VimbaXCameraOpenedTest, start_streaming_failure_stops_started_streams)
+{
+  EXPECT_CALL(*api_mock_, PayloadSizeGet).Times(2).WillRepeatedly(
+    [&](auto, VmbUint32_t * payload_size) {
+      *payload_size = VmbUint32_t(test_size_);
+      return VmbErrorSuccess;
+    });
+  EXPECT_CALL(*api_mock_, FrameAnnounce).Times(AtLeast(1));
+  EXPECT_CALL(*api_mock_, CaptureStart).Times(2);
+  EXPECT_CALL(*api_mock_, CaptureFrameQueue).Times(AtLeast(1));
+  EXPECT_CALL(*api_mock_, FeatureCommandRun(_, Eq(SFNCFeatures::AcquisitionStart))).Times(2)
+  .WillRepeatedly(Return(VmbErrorTimeout));
+
+  // The streams started before the acquisition failed are stopped again
+  EXPECT_CALL(*api_mock_, CaptureEnd).Times(2);
+  EXPECT_CALL(*api_mock_, CaptureQueueFlush).Times(2);
+  EXPECT_CALL(*api_mock_, FrameRevokeAll).Times(2);
+
+  for (int i = 0; i < 2; i++) {
+    auto const startRes = camera_->start_streaming(2, [](auto) {});
+
+    ASSERT_FALSE(startRes);
+    EXPECT_EQ(startRes.error().code, VmbErrorTimeout);
+    EXPECT_FALSE(camera_->is_streaming());
+  }
+}
+
+TEST_F(VimbaXCameraOpenedTest, feature_command_run_done_immediately)
+{
+  std::string_view const command = "TestCommand";
+
+  EXPECT_CALL(*api_mock_, FeatureCommandRun(_, Eq(command))).Times(1);
+  EXPECT_CALL(*api_mock_, FeatureCommandIsDone(_, Eq(command), _)).Times(1)
+  .WillOnce(
+    [](auto, auto, bool * done) -> VmbError_t {
+      *done = true;
+      return VmbErrorSuccess;
+    });
+
+  auto const start = std::chrono::steady_clock::now();
+  auto const runRes = camera_->feature_command_run(command);
+  auto const duration = std::chrono::steady_clock::now() - start;
+
+  EXPECT_TRUE(runRes);
+  EXPECT_LT(duration, std::chrono::milliseconds(50));
+}
+
+TEST_F(VimbaXCameraOpenedTest, feature_command_run_timeout)
+{
+  std::string_view const command = "TestCommand";
+  auto const timeout = std::chrono::milliseconds(20);
+
+  EXPECT_CALL(*api_mock_, FeatureCommandRun(_, Eq(command))).Times(1);
+  EXPECT_CALL(*api_mock_, FeatureCommandIsDone(_, Eq(command), _)).Times(AtLeast(2))
+  .WillRepeatedly(
+    [](auto, auto, bool * done) -> VmbError_t {
+      *done = false;
+      return VmbErrorSuccess;
+    });
+
+  auto const start = std::chrono::steady_clock::now();
+  auto const runRes = camera_->feature_command_run(command, timeout);
+  auto const duration = std::chrono::steady_clock::now() - start;
+
+  EXPECT_FALSE(runRes);
+  EXPECT_EQ(runRes.error().code, VmbErrorTimeout);
+  EXPECT_GE(duration, timeout);
+  EXPECT_LT(duration, std::chrono::milliseconds(500));
+}
+
+TEST_F(VimbaXCameraOpenedTest, feature_command_run_async)
+{
+  std::string_view const command = "TestCommand";
+  int polls = 0;
+
+  EXPECT_CALL(*api_mock_, FeatureCommandRun(_, Eq(command))).Times(1);
+  EXPECT_CALL(*api_mock_, FeatureCommandIsDone(_, Eq(command), _)).Times(3)
+  .WillRepeatedly(
+    [&](auto, auto, bool * done) -> VmbError_t {
+      *done = ++polls == 3;
+      return VmbErrorSuccess;
+    });
+
+  auto runFuture = camera_->feature_command_run_async(command);
+
+  ASSERT_EQ(runFuture.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  EXPECT_TRUE(runFuture.get());
+}
+
+TEST_F(VimbaXCameraOpenedTest, unknown_feature_name_is_null_terminated)
+{
+  // A view into a longer string must not pass the remaining characters to VmbC
+  std::string_view const name = std::string_view{"UnknownFeatureSuffix"}.substr(0, 14);
+
+  EXPECT_CALL(*api_mock_, FeatureIntGet(_, Eq(std::string{"UnknownFeature"}), _)).Times(1)
+  .WillOnce(
+    [](auto, auto, VmbInt64_t * value) {
+      *value = 3;
+      return VmbErrorSuccess;
+    });
+
+  auto const value = camera_->feature_int_get(name);
+
+  ASSERT_TRUE(value);
+  EXPECT_EQ(*value, 3);
+}
+
+TEST_F(VimbaXCameraFeatureCacheTest, non_volatile_feature_read_once)
+{
+  expect_int_get("CachedInt", 1);
+
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+}
+
+TEST_F(VimbaXCameraFeatureCacheTest, volatile_feature_always_read)
+{
+  expect_int_get("VolatileInt", 2);
+
+  EXPECT_EQ(*camera_->feature_int_get("VolatileInt"), 42);
+  EXPECT_EQ(*camera_->feature_int_get("VolatileInt"), 42);
+}
+
+TEST_F(VimbaXCameraFeatureCacheTest, cache_disabled)
+{
+  expect_int_get("CachedInt", 2);
+
+  camera_->set_feature_value_cache_enabled(false);
+
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+}
+
+TEST_F(VimbaXCameraFeatureCacheTest, bypass_cache)
+{
+  expect_int_get("CachedInt", 2);
+
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt", VimbaXCamera::Module::RemoteDevice, true), 42);
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+}
+
+TEST_F(VimbaXCameraFeatureCacheTest, only_configuration_commands_clear_cache)
+{
+  expect_int_get("CachedInt", 2);
+
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+  EXPECT_TRUE(camera_->feature_command_run("TriggerSoftware"));
+  EXPECT_TRUE(camera_->feature_command_run("PtpDataSetLatch"));
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+  EXPECT_TRUE(camera_->feature_command_run("UserSetLoad"));
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+}
+
+TEST_F(VimbaXCameraFeatureCacheTest, invalidation_callback)
+{
+  VmbInvalidationCallback callback{};
+  void * context{};
+
+  EXPECT_CALL(*api_mock_, FeatureInvalidationRegister(_, Eq(std::string{"CachedInt"}), _, _))
+  .Times(1).WillOnce(
+    [&](auto, auto, auto cb, auto ctx) -> VmbError_t {
+      callback = cb;
+      context = ctx;
+      return VmbErrorSuccess;
+    });
+  EXPECT_CALL(*api_mock_, FeatureInvalidationUnregister(_, Eq(std::string{"CachedInt"}), _))
+  .Times(1);
+
+  expect_int_get("CachedInt", 2);
+
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+  ASSERT_NE(callback, nullptr);
+  callback(&dummy_handle_, "CachedInt", context);
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+}
+
+TEST_F(VimbaXCameraFeatureCacheTest, selector_change_invalidates_selected)
+{
+  EXPECT_CALL(*api_mock_, FeatureListSelected(_, Eq(std::string{"TestSelector"}), _, _, _, _))
+  .Times(AtLeast(1)).WillRepeatedly(
+    [&](auto, auto, VmbFeatureInfo_t * list, auto listLength, VmbUint32_t * numFound, auto) {
+      *numFound = 1;
+      if (list != nullptr && listLength > 0) {
+        list[0] = remote_features_[0];
+      }
+      return VmbErrorSuccess;
+    });
+
+  expect_int_get("CachedInt", 2);
+
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+  EXPECT_TRUE(camera_->feature_enum_set("TestSelector", "Selector1"));
+  EXPECT_EQ(*camera_->feature_int_get("CachedInt"), 42);
+}
+
+TEST_F(VimbaXCameraFeatureCacheTest, feature_handle_get_unknown)
+{
+  auto const feature = camera_->feature_handle_get("UnknownFeature");
+
+  ASSERT_FALSE(feature);
+  EXPECT_EQ(feature.error().code, VmbErrorNotFound);
+}
+
+TEST_F(VimbaXCameraFeatureCacheTest, feature_handle_access)
+{
+  std::string const name{"CachedIntSuffix", 9};
+
+  auto const feature = camera_->feature_handle_get(name);
+  ASSERT_TRUE(feature);
+  EXPECT_STREQ(feature->name, "CachedInt");
+  EXPECT_EQ(feature->module, VimbaXCamera::Module::RemoteDevice);
+  ASSERT_NE(feature->info, nullptr);
+
+  expect_int_get("CachedInt", 2);
+  EXPECT_CALL(*api_mock_, FeatureIntSet(_, Eq(std::string{"CachedInt"}), 7)).Times(1);
+  // Only selectors are queried for selected features
+  EXPECT_CALL(*api_mock_, FeatureListSelected(_, Eq(std::string{"CachedInt"}), _, _, _, _))
+  .Times(0);
+
+  EXPECT_EQ(*camera_->feature_int_get(*feature), 42);
+  EXPECT_EQ(*camera_->feature_int_get(*feature), 42);
+  EXPECT_TRUE(camera_->feature_int_set(*feature, 7));
+  EXPECT_EQ(*camera_->feature_int_get(*feature), 42);
+}
+
+TEST_F(VimbaXCameraOpenedTest, settings_save_invalid_directory)
+{
+  auto const temp_path = std::filesystem::temp_directory_path();
+  auto const test_xml_path = temp_path / "invalid" / "invalid.xml";
+
+  auto const result = camera_->settings_save(test_xml_path.string());
+
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().code, VmbErrorNotFound);
+}
+
+TEST_F(VimbaXCameraOpenedTest, settings_save_invalid_file_name)
+{
+  auto const temp_path = std::filesystem::temp_directory_path();
+  auto const test_xml_path = temp_path / "invalid" / "invalid.json";
+
+  auto const result = camera_->settings_save(test_xml_path.string());
+
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().code, VmbErrorInvalidValue);
+}
+
+TEST_F(VimbaXCameraOpenedTest, settings_save_valid_error)
+{
+  auto const error = VmbErrorCustom;
+  auto const temp_path = std::filesystem::temp_directory_path();
+  auto const test_xml_path = temp_path / "valid.xml";
+
+  if (std::filesystem::exists(test_xml_path)) {
+    std::filesystem::remove(test_xml_path);
+  }
+
+  std::ofstream stream{test_xml_path};
+  stream.close();
+
+  EXPECT_CALL(*api_mock_, SettingsSave(_, Eq(test_xml_path.string()), _, _)).Times(1)
+  .WillOnce(Return(error));
+
+  auto const result = camera_->settings_save(test_xml_path.string());
+
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().code, error);
+}
+
+
+TEST_F(VimbaXCameraOpenedTest, settings_save_valid_ok)
+{
+  auto const temp_path = std::filesystem::temp_directory_path();
+  auto const test_xml_path = temp_path / "valid.xml";
+
+  if (std::filesystem::exists(test_xml_path)) {
+    std::filesystem::remove(test_xml_path);
+  }
+
+  std::ofstream stream{test_xml_path};
+  stream.close();
+
+  EXPECT_CALL(*api_mock_, SettingsSave(_, Eq(test_xml_path.string()), _, _)).Times(1)
+  .WillOnce(Return(VmbErrorSuccess));
+
+  auto const result = camera_->settings_save(test_xml_path.string());
+
+  ASSERT_TRUE(result);
+}
+
+TEST_F(VimbaXCameraOpenedTest, settings_load_invalid)
+{
+  auto const temp_path = std::filesystem::temp_directory_path();
+  auto const test_xml_path = temp_path / "invalid" / "invalid.xml";
+
+  auto const result = camera_->settings_load(test_xml_path.string());
+
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().code, VmbErrorNotFound);
+}
+
+TEST_F(VimbaXCameraOpenedTest, settings_load_valid_error)
+{
+  auto const error = VmbErrorCustom;
+  auto const temp_path = std::filesystem::temp_directory_path();
+  auto const test_xml_path = temp_path / "valid.xml";
+
+  if (std::filesystem::exists(test_xml_path)) {
+    std::filesystem::remove(test_xml_path);
+  }
+
+  std::ofstream stream{test_xml_path};
+  stream.close();
+
+  EXPECT_CALL(*api_mock_, SettingsLoad(_, Eq(test_xml_path.string()), _, _)).Times(1)
+  .WillOnce(Return(error));
+
+  auto const result = camera_->settings_load(test_xml_path.string());
+
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().code, error);
+}
+
+
+TEST_F(VimbaXCameraOpenedTest, settings_load_valid_ok)
+{
+  auto const temp_path = std::filesystem::temp_directory_path();
   auto const test_xml_path = temp_path / "valid.xml";
 
-  if (std::filesystem::exists(test_xml_path)) {
-    std::filesystem::remove(test_xml_path);
+  if (std::filesystem::exists(test_xml_path)) {
+    std::filesystem::remove(test_xml_path);
+  }
+
+  std::ofstream stream{test_xml_path};
+  stream.close();
+
+  EXPECT_CALL(*api_mock_, SettingsLoad(_, Eq(test_xml_path.string()), _, _)).Times(1)
+  .WillOnce(Return(VmbErrorSuccess));
+
+  auto const result = camera_->settings_load(test_xml_path.string());
+
+  ASSERT_TRUE(result);
+}
+
+TEST_F(VimbaXCameraSnapshotTest, snapshot_create)
+{
+  auto const snapshot = camera_->feature_snapshot_create();
+
+  ASSERT_TRUE(snapshot);
+  EXPECT_EQ(snapshot->model_name, "TestCamera");
+  ASSERT_EQ(snapshot->entries.size(), 3);
+
+  // The selected feature is moved behind its selector, the not persisted one is skipped
+  EXPECT_EQ(snapshot->entries[0].name, "TestSelector");
+  EXPECT_EQ(std::get<std::string>(snapshot->entries[0].value), "Selector1");
+  EXPECT_EQ(snapshot->entries[1].name, "SelectedInt");
+  EXPECT_EQ(std::get<int64_t>(snapshot->entries[1].value), 42);
+  EXPECT_EQ(snapshot->entries[1].selector_index, 0);
+  EXPECT_EQ(snapshot->entries[2].name, "TestFloat");
+  EXPECT_EQ(std::get<_Float64>(snapshot->entries[2].value), 1.5);
+}
+
+TEST_F(VimbaXCameraSnapshotTest, snapshot_serialize_round_trip)
+{
+  auto const snapshot = test_snapshot();
+  auto const data = snapshot.serialize();
+
+  auto const restored = VimbaXCamera::FeatureSnapshot::deserialize(data);
+
+  ASSERT_TRUE(restored);
+  EXPECT_EQ(restored->model_name, snapshot.model_name);
+  ASSERT_EQ(restored->entries.size(), snapshot.entries.size());
+
+  for (size_t i = 0; i < snapshot.entries.size(); i++) {
+    EXPECT_EQ(restored->entries[i].module, snapshot.entries[i].module);
+    EXPECT_EQ(restored->entries[i].name, snapshot.entries[i].name);
+    EXPECT_EQ(restored->entries[i].type, snapshot.entries[i].type);
+    EXPECT_EQ(restored->entries[i].value, snapshot.entries[i].value);
+    EXPECT_EQ(restored->entries[i].selector_index, snapshot.entries[i].selector_index);
+  }
+
+  auto truncated = data;
+  truncated.pop_back();
+
+  auto const truncated_result = VimbaXCamera::FeatureSnapshot::deserialize(truncated);
+  ASSERT_FALSE(truncated_result);
+  EXPECT_EQ(truncated_result.error().code, VmbErrorInvalidValue);
+
+  auto corrupted = data;
+  corrupted[0] = 0;
+
+  EXPECT_FALSE(VimbaXCamera::FeatureSnapshot::deserialize(corrupted));
+}
+
+TEST_F(VimbaXCameraSnapshotTest, snapshot_apply_writes_changed_only)
+{
+  auto snapshot = test_snapshot();
+  snapshot.entries[2].value = 2.5;
+
+  EXPECT_CALL(*api_mock_, FeatureEnumSet).Times(0);
+  EXPECT_CALL(*api_mock_, FeatureIntSet).Times(0);
+  EXPECT_CALL(*api_mock_, FeatureFloatSet(_, Eq(std::string{"TestFloat"}), 2.5)).Times(1)
+  .WillOnce(Return(VmbErrorSuccess));
+
+  auto const result = camera_->feature_snapshot_apply(snapshot);
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->written, 1);
+  EXPECT_EQ(result->unchanged, 2);
+  EXPECT_TRUE(result->failed_entries.empty());
+  EXPECT_EQ(result->written_entries, std::vector<uint32_t>{2});
+}
+
+TEST_F(VimbaXCameraSnapshotTest, snapshot_apply_float_within_increment)
+{
+  auto snapshot = test_snapshot();
+  snapshot.entries[2].value = 1.52;
+
+  // The camera quantizes the value to its increment, so 1.5 is read back after writing 1.52
+  EXPECT_CALL(*api_mock_, FeatureFloatIncrementQuery(_, Eq(std::string{"TestFloat"}), _, _))
+  .WillOnce(
+    [](auto, auto, VmbBool_t * has_increment, double * increment) {
+      *has_increment = true;
+      *increment = 0.05;
+      return VmbErrorSuccess;
+    })
+  .WillOnce(
+    [](auto, auto, VmbBool_t * has_increment, auto) {
+      *has_increment = false;
+      return VmbErrorSuccess;
+    });
+  EXPECT_CALL(*api_mock_, FeatureFloatSet).Times(0);
+
+  auto const result = camera_->feature_snapshot_apply(snapshot);
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->written, 0);
+  EXPECT_EQ(result->unchanged, 3);
+
+  // Without increment only a small relative difference is tolerated
+  snapshot.entries[2].value = 1.5 * (1.0 + 1e-6);
+
+  auto const relative_result = camera_->feature_snapshot_apply(snapshot);
+
+  ASSERT_TRUE(relative_result);
+  EXPECT_EQ(relative_result->written, 0);
+}
+
+TEST_F(VimbaXCameraSnapshotTest, snapshot_apply_other_model)
+{
+  auto snapshot = test_snapshot();
+  snapshot.model_name = "OtherCamera";
+
+  auto const result = camera_->feature_snapshot_apply(snapshot);
+
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().code, VmbErrorInvalidValue);
+}
+
+TEST_F(VimbaXCameraSnapshotTest, profile_changes_get)
+{
+  auto snapshot = test_snapshot();
+  snapshot.entries[2].value = 2.5;
+
+  auto const profile = camera_->feature_profile_compile("test", snapshot);
+  ASSERT_TRUE(profile);
+  EXPECT_EQ(profile->name, "test");
+
+  auto const changes = camera_->feature_profile_changes_get(*profile);
+  ASSERT_TRUE(changes);
+  ASSERT_EQ(changes->size(), 1);
+  EXPECT_EQ(profile->snapshot.entries[changes->at(0)].name, "TestFloat");
+}
+
+TEST_F(VimbaXCameraSnapshotTest, profile_compile_unknown_feature)
+{
+  auto snapshot = test_snapshot();
+  snapshot.entries[2].name = "UnknownFeature";
+
+  auto const profile = camera_->feature_profile_compile("test", snapshot);
+
+  ASSERT_FALSE(profile);
+  EXPECT_EQ(profile.error().code, VmbErrorNotFound);
+}
+
+TEST_F(VimbaXCameraSnapshotTest, profile_apply_rolls_back)
+{
+  auto snapshot = test_snapshot();
+  snapshot.entries[0].value = std::string{"Selector2"};
+  snapshot.entries[2].value = 2.5;
+
+  auto const profile = camera_->feature_profile_compile("test", snapshot);
+  ASSERT_TRUE(profile);
+
+  {
+    InSequence seq;
+
+    EXPECT_CALL(
+      *api_mock_,
+      FeatureEnumSet(_, Eq(std::string{"TestSelector"}), Eq(std::string{"Selector2"})))
+    .WillOnce(Return(VmbErrorSuccess));
+    EXPECT_CALL(*api_mock_, FeatureFloatSet(_, Eq(std::string{"TestFloat"}), 2.5))
+    .WillRepeatedly(Return(VmbErrorInvalidValue));
+    EXPECT_CALL(
+      *api_mock_,
+      FeatureEnumSet(_, Eq(std::string{"TestSelector"}), Eq(std::string{"Selector1"})))
+    .WillOnce(Return(VmbErrorSuccess));
+  }
+
+  auto const result = camera_->feature_profile_apply(*profile);
+
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error().code, VmbErrorInvalidValue);
+}
+
+TEST_F(VimbaXCameraEventTest, event_meta_data_read)
+{
+  auto const layout = camera_->event_meta_data_layout_get("ExposureEnd");
+
+  ASSERT_TRUE(layout);
+  EXPECT_EQ(layout->event_name, "ExposureEnd");
+  ASSERT_EQ(layout->features.size(), 3);
+  ASSERT_TRUE(layout->frame_id_index);
+  ASSERT_TRUE(layout->timestamp_index);
+  EXPECT_EQ(
+    std::string{layout->features[*layout->frame_id_index].name}, "EventExposureEndFrameID");
+
+  EXPECT_CALL(*api_mock_, FeatureIntGet(_, Eq(std::string{"EventExposureEndFrameID"}), _))
+  .Times(2).WillRepeatedly(
+    [](auto, auto, VmbInt64_t * value) {
+      *value = 17;
+      return VmbErrorSuccess;
+    });
+  EXPECT_CALL(*api_mock_, FeatureIntGet(_, Eq(std::string{"EventExposureEndTimestamp"}), _))
+  .Times(2).WillRepeatedly(
+    [](auto, auto, VmbInt64_t * value) {
+      *value = 123456789;
+      return VmbErrorSuccess;
+    });
+  EXPECT_CALL(*api_mock_, FeatureFloatGet(_, Eq(std::string{"EventExposureEndExposureTime"}), _))
+  .Times(2).WillRepeatedly(
+    [](auto, auto, double * value) {
+      *value = 250.0;
+      return VmbErrorSuccess;
+    });
+
+  // Reading the data must not look up the features again
+  EXPECT_CALL(*api_mock_, FeatureInfoQuery).Times(0);
+
+  for (int i = 0; i < 2; i++) {
+    auto const data = camera_->event_meta_data_read(*layout);
+
+    ASSERT_TRUE(data);
+    EXPECT_EQ(data->frame_id, 17);
+    EXPECT_EQ(data->timestamp, 123456789);
+    ASSERT_EQ(data->values.size(), 3);
+
+    for (std::size_t j = 0; j < layout->features.size(); j++) {
+      if (std::string{layout->features[j].name} == "EventExposureEndExposureTime") {
+        EXPECT_EQ(std::get<_Float64>(data->values[j]), 250.0);
+      }
+    }
+  }
+}
+
+TEST_F(VimbaXCameraEventTest, event_meta_data_read_failure_is_omitted)
+{
+  EXPECT_CALL(*api_mock_, FeatureIntGet(_, Eq(std::string{"EventExposureEndFrameID"}), _))
+  .Times(2).WillRepeatedly(
+    [](auto, auto, VmbInt64_t * value) {
+      *value = 17;
+      return VmbErrorSuccess;
+    });
+  EXPECT_CALL(*api_mock_, FeatureIntGet(_, Eq(std::string{"EventExposureEndTimestamp"}), _))
+  .Times(2).WillRepeatedly(Return(VmbErrorInvalidAccess));
+  EXPECT_CALL(*api_mock_, FeatureFloatGet(_, Eq(std::string{"EventExposureEndExposureTime"}), _))
+  .Times(2).WillRepeatedly(
+    [](auto, auto, double * value) {
+      *value = 250.0;
+      return VmbErrorSuccess;
+    });
+
+  auto const layout = camera_->event_meta_data_layout_get("ExposureEnd");
+  ASSERT_TRUE(layout);
+
+  auto const data = camera_->event_meta_data_read(*layout);
+  ASSERT_TRUE(data);
+  ASSERT_EQ(data->valid.size(), 3);
+  EXPECT_FALSE(data->valid[*layout->timestamp_index]);
+  EXPECT_TRUE(data->valid[*layout->frame_id_index]);
+  EXPECT_EQ(data->timestamp, 0);
+
+  auto const meta_data = camera_->get_event_meta_data("ExposureEnd");
+  ASSERT_TRUE(meta_data);
+  ASSERT_EQ(meta_data->size(), 2);
+
+  for (auto const & [name, value] : *meta_data) {
+    EXPECT_NE(name, "EventExposureEndTimestamp");
+  }
+}
+
+TEST(EventQueueTest, multiple_producers)
+{
+  constexpr int producer_count = 4;
+  constexpr int values_per_producer = 10000;
+
+  vimbax_camera::EventQueue<int> queue{64};
+  EXPECT_EQ(queue.capacity(), 64);
+
+  std::vector<std::thread> producers{};
+
+  for (int producer = 0; producer < producer_count; producer++) {
+    producers.emplace_back(
+      [&queue, producer] {
+        for (int i = 0; i < values_per_producer; i++) {
+          while (!queue.try_push(producer * values_per_producer + i)) {
+            std::this_thread::yield();
+          }
+        }
+      });
+  }
+
+  std::vector<int> last_values(producer_count, -1);
+  int value{};
+
+  for (int received = 0; received < producer_count * values_per_producer; ) {
+    if (!queue.try_pop(value)) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    // Values of each producer keep their order
+    auto const producer = value / values_per_producer;
+    EXPECT_GT(value % values_per_producer, last_values[producer]);
+    last_values[producer] = value % values_per_producer;
+    received++;
+  }
+
+  for (auto & producer : producers) {
+    producer.join();
+  }
+
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(EventQueueTest, full_queue_rejects)
+{
+  vimbax_camera::EventQueue<std::string> queue{2};
+
+  EXPECT_TRUE(queue.try_push("a"));
+  EXPECT_TRUE(queue.try_push("b"));
+  EXPECT_FALSE(queue.try_push("c"));
+
+  std::string value{};
+  EXPECT_TRUE(queue.try_pop(value));
+  EXPECT_EQ(value, "a");
+  EXPECT_TRUE(queue.try_push("c"));
+}
+
+TEST_F(VimbaXCameraOpenedTest, invalidation_listeners)
+{
+  VmbInvalidationCallback callback{};
+  void * context{};
+
+  EXPECT_CALL(*api_mock_, FeatureInvalidationRegister(_, Eq(std::string{"TestEvent"}), _, _))
+  .Times(1).WillOnce(
+    [&](auto, auto, auto cb, auto ctx) -> VmbError_t {
+      callback = cb;
+      context = ctx;
+      return VmbErrorSuccess;
+    });
+  EXPECT_CALL(*api_mock_, FeatureInvalidationUnregister(_, Eq(std::string{"TestEvent"}), _))
+  .Times(1);
+
+  std::promise<std::thread::id> first_called{};
+  std::promise<void> second_called{};
+
+  auto const first_id = camera_->feature_invalidation_register(
+    "TestEvent", [&](auto) {
+      first_called.set_value(std::this_thread::get_id());
+    });
+  ASSERT_TRUE(first_id);
+
+  auto const second_id = camera_->feature_invalidation_register(
+    "TestEvent", [&](auto) {
+      // Registering from a callback must not block
+      camera_->feature_invalidation_register("TestEvent", [](auto) {});
+      second_called.set_value();
+    });
+  ASSERT_TRUE(second_id);
+  EXPECT_NE(*first_id, *second_id);
+
+  ASSERT_NE(callback, nullptr);
+  callback(&dummy_handle_, "TestEvent", context);
+
+  auto first_future = first_called.get_future();
+  auto second_future = second_called.get_future();
+  ASSERT_EQ(first_future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  ASSERT_EQ(second_future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  EXPECT_NE(first_future.get(), std::this_thread::get_id());
+
+  EXPECT_TRUE(camera_->feature_invalidation_unregister("TestEvent", *first_id));
+  EXPECT_FALSE(camera_->feature_invalidation_unregister("TestEvent", *first_id));
+}
+
+TEST_F(VimbaXCameraOpenedTest, invalidation_queue_overflow_is_counted)
+{
+  VmbInvalidationCallback callback{};
+  void * context{};
+
+  EXPECT_CALL(*api_mock_, FeatureInvalidationRegister(_, Eq(std::string{"TestEvent"}), _, _))
+  .Times(1).WillOnce(
+    [&](auto, auto, auto cb, auto ctx) -> VmbError_t {
+      callback = cb;
+      context = ctx;
+      return VmbErrorSuccess;
+    });
+  EXPECT_CALL(*api_mock_, FeatureInvalidationUnregister(_, Eq(std::string{"TestEvent"}), _))
+  .Times(AtLeast(0));
+
+  std::promise<void> blocked{};
+  std::promise<void> release{};
+  auto release_future = release.get_future().share();
+  std::atomic<int> dispatched{0};
+
+  auto const id = camera_->feature_invalidation_register(
+    "TestEvent", [&, release_future](auto) {
+      // The first invalidation blocks the worker until the queue overflowed
+      if (dispatched++ == 0) {
+        blocked.set_value();
+        release_future.wait();
+      }
+    });
+  ASSERT_TRUE(id);
+  ASSERT_NE(callback, nullptr);
+
+  callback(&dummy_handle_, "TestEvent", context);
+  ASSERT_EQ(
+    blocked.get_future().wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+  constexpr int queued_count = 1024;
+  constexpr int dropped_count = 10;
+
+  for (int i = 0; i < queued_count + dropped_count; i++) {
+    callback(&dummy_handle_, "TestEvent", context);
+  }
+
+  EXPECT_EQ(camera_->get_invalidations_dropped(), dropped_count);
+
+  release.set_value();
+
+  auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (dispatched < queued_count + 1 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  EXPECT_EQ(dispatched, queued_count + 1);
+  EXPECT_TRUE(camera_->feature_invalidation_unregister("TestEvent", *id));
+}
+
+TEST(FrameEventCorrelatorTest, match_events_with_frames)
+{
+  vimbax_camera::FrameEventCorrelator correlator{4, {}};
+
+  correlator.add_event("ExposureStart", 1, 1000);
+  correlator.add_event("ExposureStart", 2, 2000);
+  correlator.add_event("ExposureEnd", 1, 1500);
+  correlator.add_event("Line0RisingEdge", 1200);
+
+  auto const first = correlator.take(1);
+  EXPECT_EQ(first.frame_id, 1);
+  EXPECT_EQ(first.exposure_start_ns, 1000);
+  EXPECT_EQ(first.exposure_end_ns, 1500);
+  EXPECT_EQ(first.exposure_midpoint_ns(), 1250);
+  ASSERT_EQ(first.events.size(), 3);
+  EXPECT_EQ(first.events[2].name, "Line0RisingEdge");
+
+  // Events of frames already taken are dropped
+  correlator.add_event("ExposureEnd", 1, 1600);
+  EXPECT_EQ(correlator.dropped_count(), 1);
+
+  auto const second = correlator.take(2);
+  EXPECT_EQ(second.exposure_start_ns, 2000);
+  EXPECT_FALSE(second.exposure_midpoint_ns());
+  EXPECT_EQ(second.events.size(), 1);
+
+  auto const third = correlator.take(3);
+  EXPECT_TRUE(third.events.empty());
+}
+
+TEST(FrameEventCorrelatorTest, window_is_bounded)
+{
+  vimbax_camera::FrameEventCorrelator correlator{2, {}};
+
+  correlator.add_event("ExposureStart", 1, 1000);
+  correlator.add_event("ExposureStart", 2, 2000);
+  correlator.add_event("ExposureStart", 3, 3000);
+  EXPECT_EQ(correlator.dropped_count(), 1);
+
+  EXPECT_TRUE(correlator.take(1).events.empty());
+  EXPECT_EQ(correlator.take(3).exposure_start_ns, 3000);
+  // Frame 2 was skipped
+  EXPECT_EQ(correlator.dropped_count(), 2);
+
+  correlator.clear();
+  correlator.add_event("ExposureStart", 1, 4000);
+  EXPECT_EQ(correlator.take(1).exposure_start_ns, 4000);
+}
+
+TEST(FrameEventCorrelatorTest, events_after_frame)
+{
+  vimbax_camera::FrameEventCorrelator correlator{4, {"ExposureStart", "ExposureEnd"}};
+
+  // The expected events are waited for once they were added with a frame id, other events
+  // never hold a frame
+  correlator.add_event("ExposureStart", 1, 1000);
+  correlator.add_event("ExposureEnd", 1, 1500);
+  correlator.add_event("FrameTriggerReady", 1, 1700);
+  EXPECT_EQ(correlator.take(1).exposure_midpoint_ns(), 1250);
+
+  // The frame arrives before its events, as with the asynchronous event worker
+  auto events = std::async(
+    std::launch::async, [&correlator] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      correlator.add_event("ExposureStart", 2, 2000);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      correlator.add_event("ExposureEnd", 2, 2500);
+    });
+
+  auto const second = correlator.take(2, std::chrono::seconds(5));
+  events.wait();
+
+  EXPECT_EQ(second.exposure_start_ns, 2000);
+  EXPECT_EQ(second.exposure_end_ns, 2500);
+  EXPECT_EQ(correlator.dropped_count(), 0);
+
+  // Without its events the frame is only held for the timeout
+  auto const start = std::chrono::steady_clock::now();
+  auto const third = correlator.take(3, std::chrono::milliseconds(20));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+  EXPECT_FALSE(third.exposure_start_ns);
+
+  correlator.add_event("ExposureEnd", 3, 3500);
+  EXPECT_EQ(correlator.dropped_count(), 1);
+
+  // Clearing wakes up a waiting take
+  auto waiting = std::async(
+    std::launch::async, [&correlator] {
+      return correlator.take(4, std::chrono::seconds(30));
+    });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  correlator.clear();
+  EXPECT_EQ(waiting.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+
+  // The expected events are learned again after a clear
+  auto const start_after_clear = std::chrono::steady_clock::now();
+  correlator.take(1, std::chrono::seconds(30));
+  EXPECT_LT(std::chrono::steady_clock::now() - start_after_clear, std::chrono::seconds(5));
+}
+
+TEST(FrameEventCorrelatorTest, take_async)
+{
+  using vimbax_camera::FrameEventCorrelator;
+
+  FrameEventCorrelator correlator{2, {"ExposureStart", "ExposureEnd"}};
+
+  std::mutex mutex{};
+  std::condition_variable cv{};
+  std::vector<FrameEventCorrelator::FrameEvents> completed{};
+
+  auto const complete = [&](FrameEventCorrelator::FrameEvents && frame_events) {
+      std::lock_guard lock{mutex};
+      completed.push_back(std::move(frame_events));
+      cv.notify_all();
+    };
+
+  auto const wait_completed = [&](std::size_t count) {
+      std::unique_lock lock{mutex};
+      return cv.wait_for(lock, std::chrono::seconds(5), [&] {return completed.size() >= count;});
+    };
+
+  correlator.add_event("ExposureStart", 1, 1000);
+  correlator.add_event("ExposureEnd", 1, 1500);
+  EXPECT_EQ(correlator.exposure_midpoint_ns(1), 1250);
+
+  // Taking a frame returns immediately, its events are still matched when they arrive later
+  correlator.take_async(1, std::chrono::seconds(30), complete);
+  correlator.take_async(2, std::chrono::seconds(30), complete);
+  correlator.add_event("ExposureStart", 2, 2000);
+  correlator.add_event("ExposureEnd", 2, 2500);
+  ASSERT_TRUE(wait_completed(2));
+  EXPECT_EQ(completed[0].exposure_midpoint_ns(), 1250);
+  EXPECT_EQ(completed[1].exposure_midpoint_ns(), 2250);
+
+  // A missing event only delays the metadata, and more than window queued frames don't wait
+  auto const start = std::chrono::steady_clock::now();
+  for (int64_t frame_id = 3; frame_id < 6; frame_id++) {
+    correlator.take_async(frame_id, std::chrono::seconds(30), complete);
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  ASSERT_TRUE(wait_completed(3));
+  EXPECT_EQ(completed[2].frame_id, 3);
+
+  // Frames queued before a clear don't take the events of the restarted stream
+  correlator.clear();
+  ASSERT_TRUE(wait_completed(5));
+  EXPECT_EQ(completed[4].frame_id, 5);
+  correlator.add_event("ExposureStart", 1, 4000);
+  EXPECT_EQ(correlator.take(1).exposure_start_ns, 4000);
+}
+
+TEST(FrameRecorderTest, write_read_round_trip)
+{
+  auto const filename =
+    (std::filesystem::temp_directory_path() / "vimbax_camera_recorder_test.vxrc").string();
+
+  vimbax_camera::recording::Metadata const metadata{"TestCamera", "DEV_1234", "camera", 42};
+
+  {
+    // Small chunks, so the records span several chunks
+    auto const recorder = vimbax_camera::FrameRecorder::create(filename, metadata, 4096, 4);
+    ASSERT_TRUE(recorder);
+
+    for (int i = 0; i < 20; i++) {
+      sensor_msgs::msg::Image image{};
+      image.width = 30;
+      image.height = 10 + i;
+      image.step = 30;
+      image.encoding = "mono8";
+      image.data.assign(image.step * image.height, uint8_t(i));
+
+      while (!(*recorder)->write(image, 100 + i, 1000 * i)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+
+    auto const statistics = (*recorder)->close();
+    ASSERT_TRUE(statistics);
+    EXPECT_EQ(statistics->frames_written, 20);
   }
 
-  std::ofstream stream{test_xml_path};
-  stream.close();
+  EXPECT_EQ(std::filesystem::file_size(filename) % vimbax_camera::recording::block_size, 0);
+
+  auto const reader = vimbax_camera::RecordingReader::open(filename);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ((*reader)->metadata().camera_model, "TestCamera");
+  EXPECT_EQ((*reader)->metadata().camera_id, "DEV_1234");
+  EXPECT_EQ((*reader)->metadata().frame_id, "camera");
+  EXPECT_EQ((*reader)->metadata().created_ns, 42);
+  ASSERT_EQ((*reader)->frame_count(), 20);
+
+  for (int i = 0; i < 20; i++) {
+    auto const frame = (*reader)->frame(i);
+    ASSERT_TRUE(frame);
+    EXPECT_EQ(frame->frame_id, 100 + i);
+    EXPECT_EQ(frame->timestamp_ns, uint64_t(1000 * i));
+    EXPECT_EQ(frame->height, uint32_t(10 + i));
+    EXPECT_EQ(frame->encoding, "mono8");
+    ASSERT_EQ(frame->size, std::size_t(30 * (10 + i)));
+    EXPECT_TRUE(
+      std::all_of(
+        frame->data, frame->data + frame->size, [i](auto value) {return value == i;}));
+  }
 
-  EXPECT_CALL(*api_mock_, SettingsSave(_, Eq(test_xml_path.string()), _, _)).Times(1)
-  .WillOnce(Return(VmbErrorSuccess));
+  EXPECT_FALSE((*reader)->frame(20));
 
-  auto const result = camera_->settings_save(test_xml_path.string());
+  std::filesystem::remove(filename);
+}
 
-  ASSERT_TRUE(result);
+TEST(FrameRecorderTest, unclosed_recording_is_rejected)
+{
+  auto const filename =
+    (std::filesystem::temp_directory_path() / "vimbax_camera_recorder_invalid.vxrc").string();
+
+  {
+    std::ofstream file{filename, std::ios::binary};
+    std::vector<char> data(3 * vimbax_camera::recording::block_size, 0);
+    file.write(data.data(), data.size());
+  }
+
+  auto const reader = vimbax_camera::RecordingReader::open(filename);
+  ASSERT_FALSE(reader);
+  EXPECT_EQ(reader.error().code, VmbErrorInvalidValue);
+
+  std::filesystem::remove(filename);
 }
 
-TEST_F(VimbaXCameraOpenedTest, settings_load_invalid)
+TEST(SharedFrameRingTest, acquired_slots_are_not_overwritten)
 {
-  auto const temp_path = std::filesystem::temp_directory_path();
-  auto const test_xml_path = temp_path / "invalid" / "invalid.xml";
+  auto const name = "/vimbax_camera_test_" + std::to_string(getpid());
+  auto const ring = vimbax_camera::SharedFrameRing::create(name, 100, 2);
+  ASSERT_TRUE(ring);
+
+  sensor_msgs::msg::Image image{};
+  image.width = 10;
+  image.height = 10;
+  image.step = 10;
+  image.encoding = "mono8";
+  image.data.assign(100, 7);
+
+  auto const first = (*ring)->write(image);
+  ASSERT_TRUE(first);
+
+  auto const descriptor = vimbax_camera_msgs::msg::SharedFrame{}
+  .set__segment(name).set__slot(first->index).set__generation(first->generation);
+
+  vimbax_camera::SharedFrameClient client{};
+  auto frame = client.acquire(descriptor);
+  ASSERT_TRUE(frame);
+  EXPECT_EQ((*frame)->width(), 10);
+  EXPECT_EQ((*frame)->encoding(), "mono8");
+  ASSERT_EQ((*frame)->size(), 100);
+  EXPECT_EQ((*frame)->data()[99], 7);
+
+  // The held slot is skipped
+  image.data.assign(100, 8);
+  for (int i = 0; i < 3; i++) {
+    auto const slot = (*ring)->write(image);
+    ASSERT_TRUE(slot);
+    EXPECT_NE(slot->index, first->index);
+  }
+  EXPECT_EQ((*frame)->data()[99], 7);
 
-  auto const result = camera_->settings_load(test_xml_path.string());
+  frame = vimbax_camera::error{VmbErrorSuccess};
 
-  ASSERT_FALSE(result);
-  EXPECT_EQ(result.error().code, VmbErrorNotFound);
+  auto const overwritten = (*ring)->write(image);
+  ASSERT_TRUE(overwritten);
+  EXPECT_EQ(overwritten->index, first->index);
+
+  auto const stale = client.acquire(descriptor);
+  ASSERT_FALSE(stale);
+  EXPECT_EQ(stale.error().code, VmbErrorNotAvailable);
 }
 
-TEST_F(VimbaXCameraOpenedTest, settings_load_valid_error)
+TEST(SharedFrameRingTest, slots_of_exited_clients_are_released)
 {
-  auto const error = VmbErrorCustom;
-  auto const temp_path = std::filesystem::temp_directory_path();
-  auto const test_xml_path = temp_path / "valid.xml";
+  auto const name = "/vimbax_camera_test_exited_" + std::to_string(getpid());
+  auto const ring = vimbax_camera::SharedFrameRing::create(name, 100, 1);
+  ASSERT_TRUE(ring);
 
-  if (std::filesystem::exists(test_xml_path)) {
-    std::filesystem::remove(test_xml_path);
+  sensor_msgs::msg::Image image{};
+  image.data.assign(100, 7);
+
+  auto const first = (*ring)->write(image);
+  ASSERT_TRUE(first);
+
+  auto const descriptor = vimbax_camera_msgs::msg::SharedFrame{}
+  .set__segment(name).set__slot(first->index).set__generation(first->generation);
+
+  // The child exits while holding the frame, like a crashed client
+  auto const child = fork();
+  ASSERT_GE(child, 0);
+
+  if (child == 0) {
+    // _exit skips the destructors, so the frame is never released
+    vimbax_camera::SharedFrameClient client{};
+    auto const frame = client.acquire(descriptor);
+    _exit(frame ? 0 : 1);
   }
 
-  std::ofstream stream{test_xml_path};
-  stream.close();
+  int status{};
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
 
-  EXPECT_CALL(*api_mock_, SettingsLoad(_, Eq(test_xml_path.string()), _, _)).Times(1)
-  .WillOnce(Return(error));
+  EXPECT_TRUE((*ring)->write(image));
+}
 
-  auto const result = camera_->settings_load(test_xml_path.string());
+TEST(SharedFrameRingTest, oversized_image_is_rejected)
+{
+  auto const name = "/vimbax_camera_test_oversized_" + std::to_string(getpid());
+  auto const ring = vimbax_camera::SharedFrameRing::create(name, 16, 1);
+  ASSERT_TRUE(ring);
 
-  ASSERT_FALSE(result);
-  EXPECT_EQ(result.error().code, error);
+  sensor_msgs::msg::Image image{};
+  image.data.assign(17, 0);
+
+  EXPECT_FALSE((*ring)->write(image));
 }
 
+TEST(RoiTest, parse)
+{
+  auto const roi = vimbax_camera::Roi::parse("barcode=10,20,300,40");
+  ASSERT_TRUE(roi);
+  EXPECT_EQ(roi->name, "barcode");
+  EXPECT_EQ(roi->x, 10);
+  EXPECT_EQ(roi->y, 20);
+  EXPECT_EQ(roi->width, 300);
+  EXPECT_EQ(roi->height, 40);
+
+  EXPECT_FALSE(vimbax_camera::Roi::parse("barcode"));
+  EXPECT_FALSE(vimbax_camera::Roi::parse("=10,20,300,40"));
+  EXPECT_FALSE(vimbax_camera::Roi::parse("barcode=10,20,300"));
+  EXPECT_FALSE(vimbax_camera::Roi::parse("barcode=10,20,300,40,1"));
+  EXPECT_FALSE(vimbax_camera::Roi::parse("barcode=10,20,0,40"));
+  EXPECT_FALSE(vimbax_camera::Roi::parse("barcode=-1,20,300,40"));
+}
 
-TEST_F(VimbaXCameraOpenedTest, settings_load_valid_ok)
+TEST(RoiTest, crop)
 {
-  auto const temp_path = std::filesystem::temp_directory_path();
-  auto const test_xml_path = temp_path / "valid.xml";
+  sensor_msgs::msg::Image image{};
+  image.width = 8;
+  image.height = 6;
+  image.step = 16;
+  image.encoding = "mono16";
+  for (uint8_t i = 0; i < 96; i++) {
+    image.data.push_back(i);
+  }
 
-  if (std::filesystem::exists(test_xml_path)) {
-    std::filesystem::remove(test_xml_path);
+  vimbax_camera::Roi const roi{"gauge", 1, 3, 3, 2};
+  sensor_msgs::msg::Image roi_image{};
+
+  auto const region = roi.crop(image, roi_image);
+  ASSERT_TRUE(region);
+  EXPECT_EQ(region->x_offset, 1);
+  EXPECT_EQ(region->y_offset, 3);
+  EXPECT_EQ(roi_image.width, 3);
+  EXPECT_EQ(roi_image.height, 2);
+  EXPECT_EQ(roi_image.step, 6);
+  EXPECT_EQ(roi_image.encoding, "mono16");
+  EXPECT_THAT(
+    roi_image.data, testing::ElementsAre(50, 51, 52, 53, 54, 55, 66, 67, 68, 69, 70, 71));
+
+  // Bayer offsets are rounded down to keep the color pattern
+  image.encoding = "bayer_rggb16";
+  auto const bayer_region = roi.crop(image, roi_image);
+  ASSERT_TRUE(bayer_region);
+  EXPECT_EQ(bayer_region->x_offset, 0);
+  EXPECT_EQ(bayer_region->y_offset, 2);
+
+  EXPECT_FALSE((vimbax_camera::Roi{"outside", 6, 0, 3, 1}.crop(image, roi_image)));
+}
+
+TEST(ImageStatisticsTest, bayer_channels)
+{
+  // Red saturated, green at 100 and blue black
+  sensor_msgs::msg::Image image{};
+  image.width = 64;
+  image.height = 4;
+  image.step = 64;
+  image.encoding = "bayer_rggb8";
+  for (uint32_t y = 0; y < image.height; y++) {
+    for (uint32_t x = 0; x < image.width; x++) {
+      auto const red = y % 2 == 0 && x % 2 == 0;
+      auto const blue = y % 2 == 1 && x % 2 == 1;
+      image.data.push_back(red ? 255 : (blue ? 0 : 100));
+    }
   }
 
-  std::ofstream stream{test_xml_path};
-  stream.close();
+  for (uint32_t stride : {1, 3}) {
+    auto const statistics = vimbax_camera::ImageStatistics::compute(image, 8, stride);
+    ASSERT_TRUE(statistics);
+    EXPECT_DOUBLE_EQ(statistics->channel_means[0], 1.0);
+    EXPECT_DOUBLE_EQ(statistics->channel_means[1], 100.0 / 255.0);
+    EXPECT_DOUBLE_EQ(statistics->channel_means[2], 0.0);
+    EXPECT_DOUBLE_EQ(statistics->saturation_ratio, 0.25);
+    // Pixels of the same color are equal
+    EXPECT_DOUBLE_EQ(statistics->sharpness, 0.0);
+    EXPECT_EQ(statistics->histogram[255], statistics->sample_count / 4);
+    EXPECT_EQ(statistics->histogram[100], statistics->sample_count / 2);
+  }
 
-  EXPECT_CALL(*api_mock_, SettingsLoad(_, Eq(test_xml_path.string()), _, _)).Times(1)
-  .WillOnce(Return(VmbErrorSuccess));
+  EXPECT_EQ(vimbax_camera::ImageStatistics::compute(image, 8, 1)->sample_count, 256);
+}
 
-  auto const result = camera_->settings_load(test_xml_path.string());
+TEST(ImageStatisticsTest, bit_depth)
+{
+  // 10 bit data shifted to the most significant bits
+  sensor_msgs::msg::Image image{};
+  image.width = 40;
+  image.height = 2;
+  image.step = 80;
+  image.encoding = "mono16";
+  image.data.resize(160);
+  for (std::size_t i = 0; i < 80; i++) {
+    uint16_t const value = (i % 2 == 0 ? 1023 : 512) << 6;
+    std::memcpy(&image.data[i * 2], &value, sizeof(value));
+  }
 
-  ASSERT_TRUE(result);
+  auto const statistics = vimbax_camera::ImageStatistics::compute(image, 10);
+  ASSERT_TRUE(statistics);
+  EXPECT_EQ(statistics->sample_count, 80);
+  EXPECT_DOUBLE_EQ(statistics->saturation_ratio, 0.5);
+  EXPECT_DOUBLE_EQ(statistics->channel_means[0], statistics->mean);
+  EXPECT_EQ(statistics->histogram[255], 40);
+  EXPECT_EQ(statistics->histogram[128], 40);
+
+  image.encoding = "rgb8";
+  auto const unsupported = vimbax_camera::ImageStatistics::compute(image, 8);
+  ASSERT_FALSE(unsupported);
+  EXPECT_EQ(unsupported.error().code, VmbErrorNotSupported);
+}
+
+TEST(ImageStatisticsTest, sharpness)
+{
+  sensor_msgs::msg::Image image{};
+  image.width = 100;
+  image.height = 1;
+  image.step = 100;
+  image.encoding = "mono8";
+  for (uint32_t x = 0; x < image.width; x++) {
+    image.data.push_back((x / 2) % 2 == 0 ? 0 : 255);
+  }
+
+  // Every pixel differs from the one two columns apart by the full scale
+  auto const statistics = vimbax_camera::ImageStatistics::compute(image, 8);
+  ASSERT_TRUE(statistics);
+  EXPECT_DOUBLE_EQ(statistics->sharpness, 1.0);
+}
+
+TEST(AutoExposureTest, loop_converges)
+{
+  auto const limits = vimbax_camera::AutoExposureLoop::Limits{10.0, 100000.0, 0.0, 24.0};
+  vimbax_camera::AutoExposureLoop loop{0.5, 0.2, 0.6, limits};
+
+  // Brightness proportional to the exposure time and the linear gain
+  double sensitivity = 1e-5;
+  auto const plant = [&](std::pair<double, double> settings) {
+      return std::min(1.0, sensitivity * settings.first * std::pow(10.0, settings.second / 20.0));
+    };
+
+  auto settings = std::make_pair(1000.0, 0.0);
+  loop.reset(settings.first, settings.second);
+  for (int i = 0; i < 50; i++) {
+    settings = loop.update(plant(settings));
+  }
+
+  EXPECT_NEAR(plant(settings), 0.5, 0.01);
+  EXPECT_DOUBLE_EQ(settings.second, 0.0);
+
+  // Too dark to reach the target, exposure time and gain saturate at the limits
+  sensitivity = 1e-9;
+  for (int i = 0; i < 50; i++) {
+    settings = loop.update(plant(settings));
+  }
+
+  EXPECT_DOUBLE_EQ(settings.first, limits.exposure_time_max);
+  EXPECT_NEAR(settings.second, limits.gain_max, 1e-9);
+
+  // Without windup the loop recovers quickly once the scene is bright again
+  sensitivity = 1e-5;
+  for (int i = 0; i < 20; i++) {
+    settings = loop.update(plant(settings));
+  }
+
+  EXPECT_NEAR(plant(settings), 0.5, 0.01);
+}
+
+TEST(AutoExposureTest, region_parse)
+{
+  auto const region = vimbax_camera::AutoExposureRegion::parse("10, 20, 30, 40, 2.5");
+  ASSERT_TRUE(region);
+  EXPECT_EQ(region->region.x_offset, 10);
+  EXPECT_EQ(region->region.y_offset, 20);
+  EXPECT_EQ(region->region.width, 30);
+  EXPECT_EQ(region->region.height, 40);
+  EXPECT_DOUBLE_EQ(region->weight, 2.5);
+
+  EXPECT_FALSE(vimbax_camera::AutoExposureRegion::parse("10,20,30,40"));
+  EXPECT_FALSE(vimbax_camera::AutoExposureRegion::parse("10,20,0,40,1"));
+  EXPECT_FALSE(vimbax_camera::AutoExposureRegion::parse("10,20,30,40,0"));
+  EXPECT_FALSE(vimbax_camera::AutoExposureRegion::parse("10,20,30,40,1,2"));
+}
+
+TEST(AutoExposureTest, weighted_regions)
+{
+  sensor_msgs::msg::Image image{};
+  image.width = 4;
+  image.height = 2;
+  image.step = 4;
+  image.encoding = "mono8";
+  image.data = {0, 0, 255, 255, 0, 0, 255, 255};
+
+  auto const regions = std::vector<vimbax_camera::AutoExposureRegion>{
+    *vimbax_camera::AutoExposureRegion::parse("0,0,2,2,1"),
+    *vimbax_camera::AutoExposureRegion::parse("2,0,2,2,3"),
+    *vimbax_camera::AutoExposureRegion::parse("10,10,2,2,5")};
+
+  auto const brightness = vimbax_camera::AutoExposureController::measure(image, 8, 1, regions);
+  ASSERT_TRUE(brightness);
+  EXPECT_DOUBLE_EQ(*brightness, 0.75);
+
+  auto const whole = vimbax_camera::AutoExposureController::measure(image, 8, 1, {});
+  ASSERT_TRUE(whole);
+  EXPECT_DOUBLE_EQ(*whole, 0.5);
+
+  auto const outside = vimbax_camera::AutoExposureController::measure(
+    image, 8, 1, {regions[2]});
+  ASSERT_FALSE(outside);
+}
+
+TEST(FeatureChangeQueueTest, generations)
+{
+  vimbax_camera::FeatureChangeQueue queue{1};
+  EXPECT_EQ(queue.generation(0), 0);
+
+  auto [first_generation, first_applied] = queue.push([] {return true;});
+  auto [failed_generation, failed_applied] = queue.push([] {return false;});
+  EXPECT_EQ(first_generation, 1);
+  EXPECT_EQ(failed_generation, 2);
+  EXPECT_TRUE(queue.pending());
+
+  // Applied after frame 5, frame 6 is still in flight with the previous settings
+  queue.apply(5);
+  EXPECT_FALSE(queue.pending());
+  EXPECT_TRUE(first_applied.get());
+  EXPECT_FALSE(failed_applied.get());
+  EXPECT_EQ(queue.generation(6), 0);
+  EXPECT_EQ(queue.generation(7), 1);
+  EXPECT_EQ(queue.generation(8), 1);
+
+  // Frame ids start over on restart, changes applied before are active from the first frame
+  auto [restart_generation, restart_applied] = queue.push([] {return true;});
+  queue.apply(10);
+  queue.restart();
+  EXPECT_EQ(queue.generation(0), restart_generation);
+
+  // Changes applied while stopped are active for all following frames
+  auto [stopped_generation, stopped_applied] = queue.push([] {return true;});
+  queue.apply(std::nullopt);
+  EXPECT_TRUE(stopped_applied.get());
+  EXPECT_EQ(queue.generation(1), stopped_generation);
+}
+
+TEST(FeatureChangeQueueTest, write_timestamps)
+{
+  vimbax_camera::FeatureChangeQueue queue{1};
+  uint64_t device_time{1000};
+  queue.set_write_timestamp([&device_time]() -> std::optional<uint64_t> {return device_time;});
+
+  // Nothing recorded yet, the frame id based generation is used
+  EXPECT_FALSE(queue.generation_at(500));
+
+  auto [first_generation, first_applied] = queue.push([] {return true;});
+  queue.apply(5);
+  device_time = 2000;
+  auto [second_generation, second_applied] = queue.push([] {return true;});
+  queue.apply(3);
+
+  EXPECT_EQ(queue.generation_at(500), 0);
+  EXPECT_EQ(queue.generation_at(1000), first_generation);
+  EXPECT_EQ(queue.generation_at(1999), first_generation);
+  EXPECT_EQ(queue.generation_at(2500), second_generation);
+
+  // Applied after an older frame by another thread, still active after the first change
+  EXPECT_EQ(queue.generation(6), 0);
+  EXPECT_EQ(queue.generation(7), second_generation);
+}
+
+TEST(FeatureChangeQueueTest, deferred_and_cancelled_changes)
+{
+  vimbax_camera::FeatureChangeQueue queue{0};
+
+  auto deferred = true;
+  std::vector<uint64_t> order{};
+
+  auto [first_generation, first_applied] = queue.push(
+    [&]() -> std::optional<bool> {
+      if (deferred) {
+        return std::nullopt;
+      }
+      order.push_back(1);
+      return true;
+    });
+  auto [second_generation, second_applied] = queue.push(
+    [&] {
+      order.push_back(2);
+      return true;
+    });
+
+  // A deferred change keeps the changes queued after it pending
+  queue.apply(5);
+  EXPECT_TRUE(queue.pending());
+  EXPECT_TRUE(order.empty());
+  EXPECT_EQ(queue.generation(6), 0);
+
+  auto [cancelled_generation, cancelled_applied] = queue.push([] {return true;});
+  EXPECT_TRUE(queue.cancel(cancelled_generation));
+  EXPECT_FALSE(queue.cancel(cancelled_generation));
+  EXPECT_FALSE(cancelled_applied.get());
+
+  deferred = false;
+  queue.apply(6);
+  EXPECT_FALSE(queue.pending());
+  EXPECT_TRUE(first_applied.get());
+  EXPECT_TRUE(second_applied.get());
+  EXPECT_EQ(order, (std::vector<uint64_t>{1, 2}));
+  EXPECT_EQ(queue.generation(7), second_generation);
+
+  // Applied changes can't be cancelled anymore
+  EXPECT_FALSE(queue.cancel(first_generation));
+}
+
+TEST(FeatureWriteJournalTest, replaces_writes_with_same_selector_values)
+{
+  using vimbax_camera::FeatureWriteJournal;
+  using vimbax_camera_msgs::msg::FeatureValue;
+
+  auto const int_value = [](int64_t value) {
+      return FeatureValue{}.set__type(FeatureValue::TYPE_INT).set__int_value(value);
+    };
+  auto const enum_value = [](const std::string & value) {
+      return FeatureValue{}.set__type(FeatureValue::TYPE_ENUM).set__string_value(value);
+    };
+  auto constexpr module = VimbaXCamera::Module::RemoteDevice;
+
+  FeatureWriteJournal journal{};
+  journal.record({"Selector", module, enum_value("A"), true});
+  journal.record({"Value", module, int_value(1), false});
+  journal.record({"Selector", module, enum_value("B"), true});
+  journal.record({"Value", module, int_value(2), false});
+  journal.record({"Other", module, int_value(3), false});
+  // Overwritten before any other feature was written
+  journal.record({"Selector", module, enum_value("B"), true});
+  journal.record({"Selector", module, enum_value("A"), true});
+  journal.record({"Value", module, int_value(4), false});
+  // Same name in another module
+  journal.record({"Value", VimbaXCamera::Module::Stream, int_value(5), false});
+
+  auto const writes = journal.take();
+  EXPECT_EQ(journal.size(), 0);
+
+  std::vector<std::string> replayed{};
+  for (auto const & write : writes) {
+    replayed.push_back(
+      write.name + "=" + (write.is_selector ? write.value.string_value :
+      std::to_string(write.value.int_value)));
+  }
+
+  // The first write of Value was replaced, so the selector write before it was dropped too
+  EXPECT_THAT(
+    replayed, ::testing::ElementsAre(
+      "Selector=B", "Value=2", "Other=3", "Selector=A", "Value=4", "Value=5"));
+  EXPECT_EQ(writes.back().module, VimbaXCamera::Module::Stream);
+}
+
+TEST(PreTriggerRingTest, eviction)
+{
+  sensor_msgs::msg::Image image{};
+  image.width = 100;
+  image.height = 10;
+  image.step = 100;
+  image.encoding = "mono8";
+  image.data.assign(1000, 7);
+
+  auto const by_duration = vimbax_camera::PreTriggerRing::create({1000, 0, 0});
+  ASSERT_TRUE(by_duration);
+  for (int64_t i = 0; i < 20; i++) {
+    (*by_duration)->push(image, i, uint64_t(i) * 100);
+  }
+
+  auto const frames = (*by_duration)->snapshot();
+  ASSERT_EQ(frames.size(), 11);
+  EXPECT_EQ(frames.front()->frame_id, 9);
+  EXPECT_EQ(frames.back()->frame_id, 19);
+
+  auto const by_size = vimbax_camera::PreTriggerRing::create({0, 4500, 0});
+  ASSERT_TRUE(by_size);
+  for (int64_t i = 0; i < 20; i++) {
+    (*by_size)->push(image, i, uint64_t(i) * 100);
+  }
+
+  EXPECT_EQ((*by_size)->snapshot().size(), 4);
+  EXPECT_EQ((*by_size)->byte_count(), 4000);
+
+  EXPECT_FALSE(vimbax_camera::PreTriggerRing::create({0, 0, 0}));
+}
+
+TEST(PreTriggerRingTest, compressed_dump)
+{
+  auto const ring = vimbax_camera::PreTriggerRing::create({0, 1024 * 1024, 1});
+  ASSERT_TRUE(ring);
+
+  sensor_msgs::msg::Image image{};
+  image.width = 100;
+  image.height = 10;
+  image.step = 100;
+  image.encoding = "mono8";
+  image.data.assign(1000, 7);
+
+  for (int64_t i = 0; i < 10; i++) {
+    image.data[0] = uint8_t(i);
+    (*ring)->push(image, i, uint64_t(i) * 100);
+  }
+
+  // The compression runs on its own thread
+  auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while ((*ring)->byte_count() == 10000 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  std::promise<vimbax_camera::PreTriggerRing::Frames> dumped{};
+  auto const frame_count = (*ring)->dump(
+    [&dumped](const vimbax_camera::PreTriggerRing::Frames & frames) {
+      dumped.set_value(frames);
+    });
+  ASSERT_TRUE(frame_count);
+  EXPECT_EQ(*frame_count, 10);
+
+  auto const frames = dumped.get_future().get();
+  ASSERT_EQ(frames.size(), 10);
+
+  auto compressed = false;
+  for (std::size_t i = 0; i < frames.size(); i++) {
+    compressed = compressed || frames[i]->compressed;
+
+    sensor_msgs::msg::Image decoded{};
+    ASSERT_TRUE(vimbax_camera::PreTriggerRing::decode(*frames[i], decoded));
+    ASSERT_EQ(decoded.data.size(), 1000);
+    EXPECT_EQ(decoded.data[0], i);
+    EXPECT_EQ(decoded.data[999], 7);
+    EXPECT_EQ(decoded.encoding, "mono8");
+  }
+
+  EXPECT_TRUE(compressed);
+}
+
+TEST(PixelCorrectionTest, correct_row)
+{
+  // Odd width, so the vector and the scalar part of the kernels are used
+  constexpr std::size_t width = 75;
+
+  std::vector<uint16_t> dark(width);
+  std::vector<uint16_t> gain(width);
+  std::vector<uint8_t> row8(width);
+  std::vector<uint16_t> row16(width);
+
+  for (std::size_t x = 0; x < width; x++) {
+    dark[x] = uint16_t(x % 7);
+    gain[x] = uint16_t(2048 + x * 97);
+    row8[x] = uint8_t(x * 13);
+    row16[x] = uint16_t(x * 3011);
+  }
+
+  auto const expected8 = row8;
+  auto const expected16 = row16;
+
+  vimbax_camera::helper::correct_row8(row8.data(), dark.data(), gain.data(), width);
+  vimbax_camera::helper::correct_row16(row16.data(), dark.data(), gain.data(), width);
+
+  for (std::size_t x = 0; x < width; x++) {
+    auto const value8 = expected8[x] > dark[x] ? uint32_t(expected8[x] - dark[x]) : 0u;
+    auto const value16 = expected16[x] > dark[x] ? uint32_t(expected16[x] - dark[x]) : 0u;
+    EXPECT_EQ(row8[x], std::min<uint32_t>((value8 * gain[x]) >> 12, 0xFF)) << x;
+    EXPECT_EQ(row16[x], std::min<uint32_t>((value16 * gain[x]) >> 12, 0xFFFF)) << x;
+  }
+}
+
+TEST(PixelCorrectionTest, dark_and_flat)
+{
+  sensor_msgs::msg::Image image{};
+  image.width = 8;
+  image.height = 4;
+  image.step = 8;
+  image.encoding = "bayer_rggb8";
+  image.data.assign(32, 10);
+  image.data[9] = 200;
+
+  vimbax_camera::FrameAverage dark{2};
+  ASSERT_TRUE(dark.add(image));
+  ASSERT_TRUE(dark.add(image));
+  EXPECT_TRUE(dark.complete());
+
+  auto const dark_correction = vimbax_camera::PixelCorrection::from_dark(dark, 0.1, nullptr);
+  ASSERT_TRUE(dark_correction);
+  EXPECT_EQ((*dark_correction)->defects(), std::vector<uint32_t>{9});
+
+  // Red and blue respond with 50, green with 100 above the dark level, one pixel is too bright
+  for (std::size_t i = 0; i < image.data.size(); i++) {
+    image.data[i] = ((i / 8) + i) % 2 ? 110 : 60;
+  }
+  image.data[20] = 85;
+
+  vimbax_camera::FrameAverage flat{1};
+  ASSERT_TRUE(flat.add(image));
+
+  auto const correction =
+    vimbax_camera::PixelCorrection::from_flat(flat, 0.1, dark_correction->get());
+  ASSERT_TRUE(correction);
+  EXPECT_EQ((*correction)->dark(), (*dark_correction)->dark());
+  EXPECT_EQ((*correction)->defects(), (std::vector<uint32_t>{9, 20}));
+
+  ASSERT_TRUE((*correction)->apply(image));
+  for (std::size_t i = 0; i < image.data.size(); i++) {
+    EXPECT_EQ(image.data[i], ((i / 8) + i) % 2 ? 100 : 50) << i;
+  }
+
+  image.encoding = "rgb8";
+  EXPECT_FALSE((*correction)->apply(image));
+  EXPECT_FALSE(vimbax_camera::FrameAverage{1}.add(image));
+}
+
+TEST(PixelCorrectionTest, average_of_saturated_frames)
+{
+  sensor_msgs::msg::Image image{};
+  image.width = 2;
+  image.height = 1;
+  image.step = 4;
+  image.encoding = "mono16";
+  image.data.assign(4, 0xff);
+
+  // More frames than the sums can hold are clamped
+  vimbax_camera::FrameAverage average{UINT32_MAX};
+
+  while (!average.complete()) {
+    ASSERT_TRUE(average.add(image));
+  }
+
+  EXPECT_EQ(average.count(), vimbax_camera::FrameAverage::max_frame_count);
+  EXPECT_EQ(average.mean(), (std::vector<uint16_t>{UINT16_MAX, UINT16_MAX}));
+}
+
+TEST(PixelCorrectionTest, save_load_round_trip)
+{
+  auto const filename =
+    (std::filesystem::temp_directory_path() / "vimbax_camera_correction_test.vxpc").string();
+
+  auto const correction = vimbax_camera::PixelCorrection::create(
+    3, 2, 2, {1, 2, 3, 4, 5, 6}, {4096, 4000, 4200, 8191, 1, 65535}, {5, 0});
+  ASSERT_TRUE(correction);
+  ASSERT_TRUE((*correction)->save(filename));
+
+  auto const loaded = vimbax_camera::PixelCorrection::load(filename);
+  std::filesystem::remove(filename);
+
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ((*loaded)->width(), 3);
+  EXPECT_EQ((*loaded)->height(), 2);
+  EXPECT_EQ((*loaded)->bytes_per_pixel(), 2);
+  EXPECT_EQ((*loaded)->dark(), (*correction)->dark());
+  EXPECT_EQ((*loaded)->gain(), (*correction)->gain());
+  EXPECT_EQ((*loaded)->defects(), (std::vector<uint32_t>{0, 5}));
+
+  EXPECT_EQ(vimbax_camera::PixelCorrection::load(filename).error().code, VmbErrorNotFound);
+  EXPECT_FALSE(vimbax_camera::PixelCorrection::create(3, 2, 2, {1, 2}, {4096, 4096}, {}));
+}
+
+TEST(RectifyTest, remap_row8)
+{
+  constexpr std::size_t width = 37;
+  constexpr std::size_t step = 38;
+
+  std::vector<uint8_t> image(step * 2);
+  for (std::size_t i = 0; i < image.size(); i++) {
+    image[i] = uint8_t(i * 37);
+  }
+
+  std::vector<int32_t> offsets(width);
+  std::vector<uint16_t> fractions(width);
+  for (std::size_t x = 0; x < width; x++) {
+    // The gathers of the last pixels would read past the image and fall back to scalar
+    offsets[x] = x % 9 == 0 ? -1 : int32_t(std::min(x, width - 2));
+    fractions[x] = uint16_t(((x * 5) % 129) | (((x * 11) % 129) << 8));
+  }
+
+  std::vector<uint8_t> rectified(width);
+  vimbax_camera::helper::remap_row8(
+    rectified.data(), image.data(), image.size(), step, offsets.data(), fractions.data(), width);
+
+  for (std::size_t x = 0; x < width; x++) {
+    if (offsets[x] < 0) {
+      EXPECT_EQ(rectified[x], 0);
+      continue;
+    }
+
+    auto const top = image.data() + offsets[x];
+    auto const bottom = top + step;
+    uint32_t const fx = fractions[x] & 0xFF;
+    uint32_t const fy = fractions[x] >> 8;
+    auto const top_value = top[0] * (128 - fx) + top[1] * fx;
+    auto const bottom_value = bottom[0] * (128 - fx) + bottom[1] * fx;
+
+    EXPECT_EQ(rectified[x], (top_value * (128 - fy) + bottom_value * fy + 8192) >> 14) << x;
+  }
+}
+
+TEST(RectifyTest, shifted_projection)
+{
+  sensor_msgs::msg::CameraInfo camera_info{};
+  camera_info.width = 300;
+  camera_info.height = 200;
+  camera_info.distortion_model = "plumb_bob";
+  camera_info.d = {0.0, 0.0, 0.0, 0.0, 0.0};
+  camera_info.k = {400, 0, 150, 0, 400, 100, 0, 0, 1};
+  camera_info.r = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+  camera_info.p = {400, 0, 150, 0, 0, 400, 100, 0, 0, 0, 1, 0};
+
+  sensor_msgs::msg::Image image{};
+  image.width = 300;
+  image.height = 200;
+  image.step = 304;
+  image.encoding = "mono8";
+  image.data.resize(304 * 200);
+  for (std::size_t i = 0; i < image.data.size(); i++) {
+    image.data[i] = uint8_t(i * 7);
+  }
+
+  vimbax_camera::Rectifier rectifier{3};
+  sensor_msgs::msg::Image rectified{};
+
+  // Without distortion the image is copied, including the last row and column
+  ASSERT_TRUE(rectifier.process(image, camera_info, rectified));
+  EXPECT_EQ(rectified.step, 300);
+  for (uint32_t y = 0; y < 200; y++) {
+    ASSERT_EQ(
+      std::memcmp(rectified.data.data() + y * 300, image.data.data() + y * 304, 300), 0) << y;
+  }
+
+  // Moving the principal point of the projection moves the image, uncovered pixels are black
+  camera_info.p[2] = 160;
+  ASSERT_TRUE(rectifier.process(image, camera_info, rectified));
+  EXPECT_EQ(rectified.data[50 * 300 + 5], 0);
+  EXPECT_EQ(rectified.data[50 * 300 + 60], image.data[50 * 304 + 50]);
+
+  image.encoding = "bayer_rggb8";
+  EXPECT_EQ(
+    rectifier.process(image, camera_info, rectified).error().code, VmbErrorNotSupported);
+
+  image.encoding = "mono8";
+  camera_info.k = {};
+  EXPECT_EQ(rectifier.process(image, camera_info, rectified).error().code, VmbErrorInvalidValue);
+}
+
+TEST(FrameSetTest, timestamp_tolerance)
+{
+  using vimbax_camera::FrameSetAggregator;
+
+  FrameSetAggregator::Settings const settings{
+    {"left", "right", "center"}, FrameSetAggregator::Match::Timestamp, 1000, 2};
+
+  auto const aggregator = FrameSetAggregator::join("timestamp_tolerance", settings);
+  ASSERT_TRUE(aggregator);
+  EXPECT_EQ(*FrameSetAggregator::join("timestamp_tolerance", settings), *aggregator);
+  EXPECT_FALSE(
+    FrameSetAggregator::join(
+      "timestamp_tolerance", {{"left"}, FrameSetAggregator::Match::Timestamp, 1000, 2}));
+  EXPECT_EQ((*aggregator)->member_index("center"), 2);
+  EXPECT_FALSE((*aggregator)->member_index("rear"));
+
+  std::vector<FrameSetAggregator::Set> sets{};
+  FrameSetAggregator::Statistics statistics{};
+  (*aggregator)->set_release_callback(
+    [&](FrameSetAggregator::Set && set, const FrameSetAggregator::Statistics & current) {
+      sets.push_back(std::move(set));
+      statistics = current;
+    });
+
+  auto const frame = [](uint64_t frame_id, uint64_t timestamp_ns) {
+      return FrameSetAggregator::Frame{
+        std::make_shared<sensor_msgs::msg::Image>(), {}, frame_id, timestamp_ns};
+    };
+
+  (*aggregator)->add(0, frame(1, 10000));
+  (*aggregator)->add(1, frame(7, 10500));
+  EXPECT_TRUE(sets.empty());
+  (*aggregator)->add(2, frame(3, 9400));
+
+  ASSERT_EQ(sets.size(), 1);
+  EXPECT_TRUE(sets[0].complete());
+  EXPECT_EQ(sets[0].skew_ns, 1100);
+  EXPECT_EQ(sets[0].frames[1]->frame_id, 7);
+
+  // Frames outside of the tolerance open new sets, the oldest is dropped after two
+  (*aggregator)->add(0, frame(2, 20000));
+  (*aggregator)->add(1, frame(8, 22000));
+  (*aggregator)->add(2, frame(4, 30000));
+
+  ASSERT_EQ(sets.size(), 2);
+  EXPECT_FALSE(sets[1].complete());
+  EXPECT_EQ(statistics.complete_count, 1);
+  EXPECT_EQ(statistics.incomplete_count, 1);
+  EXPECT_EQ(statistics.missing_count, (std::vector<uint64_t>{0, 1, 1}));
+  EXPECT_EQ(statistics.max_skew_ns, 1100);
+}
+
+TEST(FrameSetTest, frame_id)
+{
+  using vimbax_camera::FrameSetAggregator;
+
+  auto const aggregator = FrameSetAggregator::join(
+    "frame_id", {{"left", "right"}, FrameSetAggregator::Match::FrameId, 0, 4});
+  ASSERT_TRUE(aggregator);
+
+  std::vector<FrameSetAggregator::Set> sets{};
+  (*aggregator)->set_release_callback(
+    [&](FrameSetAggregator::Set && set, const FrameSetAggregator::Statistics &) {
+      sets.push_back(std::move(set));
+    });
+
+  for (uint64_t frame_id : {1, 2}) {
+    (*aggregator)->add(
+      0, {std::make_shared<sensor_msgs::msg::Image>(), {}, frame_id, frame_id * 100});
+  }
+  for (uint64_t frame_id : {2, 1}) {
+    (*aggregator)->add(
+      1, {std::make_shared<sensor_msgs::msg::Image>(), {}, frame_id, frame_id * 100 + 5});
+  }
+
+  ASSERT_EQ(sets.size(), 2);
+  for (auto const & set : sets) {
+    ASSERT_TRUE(set.complete());
+    EXPECT_EQ(set.frames[0]->frame_id, set.frames[1]->frame_id);
+    EXPECT_EQ(set.skew_ns, 5);
+  }
+}
+
+TEST(FrameSetTest, held_images_released_with_set)
+{
+  using vimbax_camera::FrameSetAggregator;
+
+  auto const aggregator = FrameSetAggregator::join(
+    "held_images", {{"left", "right"}, FrameSetAggregator::Match::FrameId, 0, 1});
+  ASSERT_TRUE(aggregator);
+
+  std::vector<uint64_t> set_ids{};
+  (*aggregator)->set_release_callback(
+    [&](FrameSetAggregator::Set && set, const FrameSetAggregator::Statistics &) {
+      set_ids.push_back(set.id);
+    });
+
+  // Like the node, the images are the held frames and requeued once the set is gone
+  sensor_msgs::msg::Image image{};
+  std::vector<uint64_t> requeued{};
+  auto const frame = [&](uint64_t frame_id) {
+      return FrameSetAggregator::Frame{
+        std::shared_ptr<sensor_msgs::msg::Image>(
+          &image, [&requeued, frame_id](sensor_msgs::msg::Image *) {
+            requeued.push_back(frame_id);
+          }), {}, frame_id, 0};
+    };
+
+  (*aggregator)->add(0, frame(1));
+  EXPECT_TRUE(requeued.empty());
+  (*aggregator)->add(1, frame(1));
+  ASSERT_EQ(set_ids.size(), 1);
+  EXPECT_EQ(requeued, (std::vector<uint64_t>{1, 1}));
+
+  // Incomplete sets pushed out of the pending window release their frames too
+  (*aggregator)->add(0, frame(2));
+  EXPECT_EQ(set_ids.size(), 1);
+  (*aggregator)->add(0, frame(3));
+  EXPECT_EQ(set_ids.size(), 2);
+  EXPECT_EQ(requeued, (std::vector<uint64_t>{1, 1, 2}));
+
+  (*aggregator)->add(1, frame(3));
+  EXPECT_EQ(set_ids.size(), 3);
+  EXPECT_EQ(requeued, (std::vector<uint64_t>{1, 1, 2, 3, 3}));
+
+  (*aggregator)->set_release_callback(nullptr);
+}
+
+TEST(FrameSetTest, concurrent_release)
+{
+  using vimbax_camera::FrameSetAggregator;
+
+  auto const aggregator = FrameSetAggregator::join(
+    "concurrent_release", {{"left", "right"}, FrameSetAggregator::Match::FrameId, 0, 1000});
+  ASSERT_TRUE(aggregator);
+  EXPECT_FALSE((*aggregator)->images_wanted());
+
+  std::vector<uint64_t> ids{};
+  std::atomic_bool in_callback{false};
+  (*aggregator)->set_release_callback(
+    [&](FrameSetAggregator::Set && set, const FrameSetAggregator::Statistics &) {
+      EXPECT_FALSE(in_callback.exchange(true));
+      ids.push_back(set.id);
+      in_callback = false;
+    });
+
+  auto const add = [&](std::size_t member) {
+      for (uint64_t frame_id = 0; frame_id < 500; frame_id++) {
+        (*aggregator)->add(member, {nullptr, {}, frame_id, 0});
+      }
+    };
+
+  std::thread left{add, 0};
+  std::thread right{add, 1};
+  left.join();
+  right.join();
+
+  // Set ids are released in order even if the frames completing them race
+  ASSERT_EQ(ids.size(), 500);
+  EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+
+  (*aggregator)->set_release_callback(nullptr);
+  (*aggregator)->add(0, {nullptr, {}, 500, 0});
+  (*aggregator)->add(1, {nullptr, {}, 500, 0});
+  EXPECT_EQ(ids.size(), 500);
+}
+
+TEST_F(VimbaXCameraPtpSyncTest, attach_enables_ptp_and_action_trigger)
+{
+  using vimbax_camera::PtpSyncGroup;
+
+  auto const group = PtpSyncGroup::join(
+    "attach", {{"left", "right"}, 1, 2, 4, std::chrono::milliseconds{0}});
+  ASSERT_TRUE(group);
+
+  EXPECT_CALL(*api_mock_, FeatureBoolSet(&dummy_handle_, Eq(std::string{"PtpEnable"}), true))
+  .Times(1);
+  EXPECT_CALL(
+    *api_mock_, FeatureEnumSet(
+      &dummy_handle_, Eq(SFNCFeatures::TriggerSelector), Eq(std::string{"FrameStart"})))
+  .Times(1);
+  EXPECT_CALL(
+    *api_mock_, FeatureEnumSet(
+      &dummy_handle_, Eq(SFNCFeatures::TriggerSource), Eq(std::string{"Action0"})))
+  .Times(1);
+  EXPECT_CALL(
+    *api_mock_, FeatureEnumSet(
+      &dummy_handle_, Eq(SFNCFeatures::TriggerMode), Eq(std::string{"On"})))
+  .Times(1);
+  EXPECT_CALL(*api_mock_, FeatureIntSet(&dummy_handle_, Eq(std::string{"ActionSelector"}), 0))
+  .Times(1);
+  EXPECT_CALL(*api_mock_, FeatureIntSet(&dummy_handle_, Eq(std::string{"ActionDeviceKey"}), 1))
+  .Times(1);
+  EXPECT_CALL(*api_mock_, FeatureIntSet(&dummy_handle_, Eq(std::string{"ActionGroupKey"}), 2))
+  .Times(1);
+  EXPECT_CALL(*api_mock_, FeatureIntSet(&dummy_handle_, Eq(std::string{"ActionGroupMask"}), 4))
+  .Times(1);
+
+  EXPECT_TRUE((*group)->attach(1, camera_));
+  EXPECT_FALSE((*group)->attach(2, camera_));
+
+  // Joining with other keys is rejected
+  EXPECT_FALSE(
+    PtpSyncGroup::join("attach", {{"left", "right"}, 1, 2, 8, std::chrono::milliseconds{0}}));
+}
+
+TEST_F(VimbaXCameraPtpSyncTest, status_and_scheduled_action)
+{
+  using vimbax_camera::PtpSyncGroup;
+
+  auto const group = PtpSyncGroup::join(
+    "schedule", {{"left", "right"}, 1, 2, 4, std::chrono::milliseconds{0}});
+  ASSERT_TRUE(group);
+  ASSERT_TRUE((*group)->attach(0, camera_));
+
+  EXPECT_CALL(*api_mock_, FeatureCommandRun(_, Eq(std::string{"PtpDataSetLatch"}))).Times(1);
+  EXPECT_CALL(*api_mock_, FeatureEnumGet(_, Eq(std::string{"PtpStatus"}), _)).Times(1)
+  .WillOnce(
+    [](auto, auto, const char ** value) {
+      *value = "Slave";
+      return VmbErrorSuccess;
+    });
+  EXPECT_CALL(*api_mock_, FeatureIntGet(_, Eq(std::string{"PtpOffsetFromMaster"}), _)).Times(1)
+  .WillOnce(
+    [](auto, auto, VmbInt64_t * value) {
+      *value = -42;
+      return VmbErrorSuccess;
+    });
+
+  auto const status = (*group)->status();
+
+  ASSERT_EQ(status.cameras.size(), 2);
+  EXPECT_TRUE(status.cameras[0].locked);
+  EXPECT_EQ(status.cameras[0].status, "Slave");
+  EXPECT_EQ(status.cameras[0].offset_from_master_ns, -42);
+  EXPECT_FALSE(status.cameras[1].attached);
+  EXPECT_FALSE(status.locked);
+
+  // The action is scheduled relative to the PTP time of the camera and sent by the transport
+  // layer
+  {
+    InSequence sequence{};
+    EXPECT_CALL(*api_mock_, FeatureCommandRun(_, Eq(std::string{"TimestampLatch"}))).Times(1);
+    EXPECT_CALL(*api_mock_, FeatureIntGet(_, Eq(std::string{"TimestampLatchValue"}), _))
+    .Times(1).WillOnce(
+      [](auto, auto, VmbInt64_t * value) {
+        *value = 1'000'000'000;
+        return VmbErrorSuccess;
+      });
+    EXPECT_CALL(
+      *api_mock_, FeatureBoolSet(_, Eq(std::string{"ActionScheduledTimeEnable"}), true))
+    .Times(1);
+    EXPECT_CALL(*api_mock_, FeatureIntSet(_, Eq(std::string{"ActionDeviceKey"}), 1)).Times(1);
+    EXPECT_CALL(*api_mock_, FeatureIntSet(_, Eq(std::string{"ActionGroupKey"}), 2)).Times(1);
+    EXPECT_CALL(*api_mock_, FeatureIntSet(_, Eq(std::string{"ActionGroupMask"}), 4)).Times(1);
+    EXPECT_CALL(
+      *api_mock_, FeatureIntSet(_, Eq(std::string{"ActionScheduledTime"}), 1'100'000'000))
+    .Times(1);
+    EXPECT_CALL(*api_mock_, FeatureCommandRun(_, Eq(std::string{"ActionCommand"}))).Times(1);
+  }
+
+  std::vector<PtpSyncGroup::Skew> skews{};
+  (*group)->set_skew_callback([&](const PtpSyncGroup::Skew & skew) {skews.push_back(skew);});
+
+  auto const action_time = (*group)->schedule(std::chrono::milliseconds{100});
+  ASSERT_TRUE(action_time);
+  EXPECT_EQ(*action_time, 1'100'000'000);
+
+  // Frames exposed before the action and of detached members are ignored
+  (*group)->add_timestamp(0, 1'099'000'000);
+  (*group)->add_timestamp(0, 1'100'000'750);
+
+  ASSERT_EQ(skews.size(), 1);
+  EXPECT_TRUE(skews[0].complete);
+  EXPECT_EQ(skews[0].action_time_ns, 1'100'000'000);
+  EXPECT_EQ(skews[0].latency_ns[0], 750);
+  EXPECT_FALSE(skews[0].latency_ns[1]);
+  EXPECT_EQ(skews[0].skew_ns, 0);
+}
+
+TEST_F(VimbaXCameraPtpSyncTest, detach_waits_for_status)
+{
+  using vimbax_camera::PtpSyncGroup;
+
+  auto const group = PtpSyncGroup::join(
+    "detach", {{"left"}, 1, 2, 4, std::chrono::milliseconds{0}});
+  ASSERT_TRUE(group);
+  ASSERT_TRUE((*group)->attach(0, camera_));
+
+  std::promise<void> entered{};
+  std::promise<void> proceed{};
+  auto proceed_future = proceed.get_future().share();
+
+  EXPECT_CALL(*api_mock_, FeatureEnumGet(_, Eq(std::string{"PtpStatus"}), _)).Times(1)
+  .WillOnce(
+    [&](auto, auto, const char ** value) {
+      entered.set_value();
+      proceed_future.wait();
+      *value = "Master";
+      return VmbErrorSuccess;
+    });
+
+  EXPECT_CALL(*api_mock_, FeatureIntGet(_, Eq(std::string{"PtpOffsetFromMaster"}), _))
+  .Times(1);
+
+  auto status = std::async(std::launch::async, [&] {return (*group)->status();});
+  entered.get_future().wait();
+
+  auto detached = std::async(std::launch::async, [&] {(*group)->detach(0);});
+  EXPECT_EQ(detached.wait_for(std::chrono::milliseconds{50}), std::future_status::timeout);
+
+  proceed.set_value();
+  detached.wait();
+
+  // Once detached the group holds no reference and reads no features anymore
+  EXPECT_TRUE(status.get().cameras[0].attached);
+  EXPECT_EQ(camera_.use_count(), 1);
+  EXPECT_FALSE((*group)->status().cameras[0].attached);
+}
+
+TEST(PtpSyncTest, invalid_settings)
+{
+  using vimbax_camera::PtpSyncGroup;
+
+  EXPECT_FALSE(PtpSyncGroup::join("", {{"left"}, 1, 2, 4, std::chrono::milliseconds{0}}));
+  EXPECT_FALSE(
+    PtpSyncGroup::join("duplicate", {{"left", "left"}, 1, 2, 4, std::chrono::milliseconds{0}}));
+  EXPECT_FALSE(PtpSyncGroup::join("mask", {{"left"}, 1, 2, 0, std::chrono::milliseconds{0}}));
+
+  auto const group =
+    PtpSyncGroup::join("empty", {{"left"}, 1, 2, 4, std::chrono::milliseconds{0}});
+  ASSERT_TRUE(group);
+
+  auto const action_time = (*group)->schedule(std::chrono::milliseconds{1});
+  ASSERT_FALSE(action_time);
+  EXPECT_EQ(action_time.error().code, VmbErrorNotFound);
 }
 
 int main(int argc, char ** argv)